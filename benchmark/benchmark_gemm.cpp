@@ -0,0 +1,72 @@
+/**
+ * Measures the runtime of all GEMM providers built into pico-cnn (see pico-cnn/gemm/gemm.h) for the matrix shapes of
+ * typical fully connected layers and convolutions lowered with im2col.
+ *
+ * ./benchmark_gemm [NUM_ITERATIONS]
+ */
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "pico-cnn/pico-cnn.h"
+
+static std::vector<fp_t> random_matrix(uint32_t num_elements) {
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<fp_t> distribution(-1.0, 1.0);
+    std::vector<fp_t> matrix(num_elements);
+    for(fp_t &element: matrix) {
+        element = distribution(generator);
+    }
+    return matrix;
+}
+
+static void benchmark_gemm(const char *name, bool transpose_b, uint32_t m, uint32_t n, uint32_t k,
+                           uint32_t num_iterations) {
+    std::vector<fp_t> a = random_matrix(m * k);
+    std::vector<fp_t> b = random_matrix(k * n);
+    std::vector<fp_t> c(m * n);
+
+    printf("%-44s", name);
+
+    for(const std::string &provider_name: pico_cnn::naive::available_gemm_providers()) {
+        pico_cnn::naive::select_gemm_provider(provider_name);
+        pico_cnn::naive::GemmProvider *provider = pico_cnn::naive::gemm_provider();
+
+        // warm-up
+        provider->sgemm(false, transpose_b, m, n, k, 1, a.data(), k, b.data(), transpose_b ? k : n, 0, c.data(), n);
+
+        auto start = std::chrono::steady_clock::now();
+        for(uint32_t i = 0; i < num_iterations; i++) {
+            provider->sgemm(false, transpose_b, m, n, k, 1, a.data(), k, b.data(), transpose_b ? k : n,
+                            0, c.data(), n);
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        double milliseconds = std::chrono::duration<double, std::milli>(end - start).count() / num_iterations;
+        printf(" %8s %9.3f ms %7.2f GFLOP/s", provider_name.c_str(), milliseconds,
+               2.0 * m * n * k / milliseconds / 1e6);
+    }
+    printf("\n");
+}
+
+int32_t main(int32_t argc, char** argv) {
+
+    uint32_t num_iterations = 10;
+    if(argc > 1) {
+        num_iterations = atoi(argv[1]);
+    }
+
+    // fully connected layers: (1, X) * (Y, X)^T
+    benchmark_gemm("fc 9216->4096 (AlexNet)", true, 1, 4096, 9216, num_iterations);
+    benchmark_gemm("fc 4096->1000 batch 16", true, 16, 1000, 4096, num_iterations);
+    benchmark_gemm("fc 800->500 (LeNet)", true, 1, 500, 800, num_iterations);
+
+    // convolutions: kernel (Cout, Cin*KH*KW) * columns (Cin*KH*KW, OH*OW)
+    benchmark_gemm("conv 11x11/4 3->96 227x227 (AlexNet)", false, 96, 55 * 55, 3 * 11 * 11, num_iterations);
+    benchmark_gemm("conv 3x3/1 64->64 56x56 (VGG/ResNet)", false, 64, 56 * 56, 64 * 3 * 3, num_iterations);
+    benchmark_gemm("conv 1x1/1 256->64 28x28", false, 64, 28 * 28, 256, num_iterations);
+    benchmark_gemm("conv 5x5/1 20->50 12x12 (LeNet)", false, 50, 8 * 8, 20 * 5 * 5, num_iterations);
+
+    return 0;
+}
@@ -0,0 +1,137 @@
+/**
+ * Measures the runtime of the generic layer implementations (pico_cnn::naive::Convolution, MaxPooling) against the
+ * kernels specialized at compile time (pico_cnn::naive::Conv2d, MaxPool2d) for typical layer shapes.
+ *
+ * ./benchmark_kernels [NUM_ITERATIONS]
+ */
+#include <chrono>
+#include <cstdlib>
+#include <random>
+
+#include "pico-cnn/pico-cnn.h"
+
+static void fill_random(pico_cnn::naive::Tensor *tensor) {
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<fp_t> distribution(-1.0, 1.0);
+    for(uint32_t i = 0; i < tensor->num_elements(); i++) {
+        tensor->access_blob(i) = distribution(generator);
+    }
+}
+
+/**
+ * @return average runtime of layer->run(input, output) in milliseconds
+ */
+static double time_layer(pico_cnn::naive::Layer *layer, pico_cnn::naive::Tensor *input,
+                         pico_cnn::naive::Tensor *output, uint32_t num_iterations) {
+    // warm-up
+    layer->run(input, output);
+
+    auto start = std::chrono::steady_clock::now();
+    for(uint32_t i = 0; i < num_iterations; i++) {
+        layer->run(input, output);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::milli>(end - start).count() / num_iterations;
+}
+
+static void report(const char *name, double generic_ms, double specialized_ms,
+                   pico_cnn::naive::Tensor *generic_output, pico_cnn::naive::Tensor *specialized_output) {
+    fp_t max_difference = 0;
+    for(uint32_t i = 0; i < generic_output->num_elements(); i++) {
+        max_difference = MAX(max_difference,
+                             std::fabs(generic_output->access_blob(i) - specialized_output->access_blob(i)));
+    }
+    printf("%-40s %10.3f ms %10.3f ms %8.2fx   (max. difference %g)\n", name, generic_ms, specialized_ms,
+           generic_ms / specialized_ms, max_difference);
+}
+
+template<uint32_t OutChannels, uint32_t KernelHeight, uint32_t KernelWidth, uint32_t StrideHeight, uint32_t StrideWidth,
+         uint32_t InChannels, uint32_t InHeight, uint32_t InWidth, uint32_t Padding, uint32_t Groups>
+static void benchmark_conv2d(const char *name, uint32_t num_iterations) {
+    typedef pico_cnn::naive::Conv2d<OutChannels, KernelHeight, KernelWidth, StrideHeight, StrideWidth,
+                                    InChannels, InHeight, InWidth, Padding, Padding, Padding, Padding, Groups> Conv;
+
+    auto input = new pico_cnn::naive::Tensor(1, InChannels, InHeight, InWidth);
+    auto kernel = new pico_cnn::naive::Tensor(OutChannels, InChannels / Groups, KernelHeight, KernelWidth);
+    auto bias = new pico_cnn::naive::Tensor(OutChannels);
+    auto generic_output = new pico_cnn::naive::Tensor(1, OutChannels, Conv::OutHeight, Conv::OutWidth);
+    auto specialized_output = new pico_cnn::naive::Tensor(1, OutChannels, Conv::OutHeight, Conv::OutWidth);
+
+    fill_random(input);
+    fill_random(kernel);
+    fill_random(bias);
+
+    uint32_t padding[4] = {Padding, Padding, Padding, Padding};
+    uint32_t stride[2] = {StrideHeight, StrideWidth};
+
+    auto generic = new pico_cnn::naive::Convolution(name, 0, pico_cnn::op_type::Conv, kernel, bias,
+                                                    Padding > 0 ? padding : nullptr, stride, Groups);
+    auto specialized = new Conv(name, 0, pico_cnn::op_type::Conv, kernel, bias);
+
+    double generic_ms = time_layer((pico_cnn::naive::Layer*) generic, input, generic_output, num_iterations);
+    double specialized_ms = time_layer(specialized, input, specialized_output, num_iterations);
+
+    report(name, generic_ms, specialized_ms, generic_output, specialized_output);
+
+    delete specialized;
+    delete generic;
+    delete specialized_output;
+    delete generic_output;
+    delete bias;
+    delete kernel;
+    delete input;
+}
+
+template<uint32_t KernelSize, uint32_t Stride, uint32_t Channels, uint32_t InHeight, uint32_t InWidth, uint32_t Padding>
+static void benchmark_max_pool2d(const char *name, uint32_t num_iterations) {
+    typedef pico_cnn::naive::MaxPool2d<KernelSize, KernelSize, Stride, Stride, Channels, InHeight, InWidth,
+                                       Padding, Padding, Padding, Padding> Pool;
+
+    auto input = new pico_cnn::naive::Tensor(1, Channels, InHeight, InWidth);
+    auto generic_output = new pico_cnn::naive::Tensor(1, Channels, Pool::OutHeight, Pool::OutWidth);
+    auto specialized_output = new pico_cnn::naive::Tensor(1, Channels, Pool::OutHeight, Pool::OutWidth);
+
+    fill_random(input);
+
+    uint32_t kernel_size[2] = {KernelSize, KernelSize};
+    uint32_t padding[4] = {Padding, Padding, Padding, Padding};
+    uint32_t stride[2] = {Stride, Stride};
+
+    auto generic = new pico_cnn::naive::MaxPooling(name, 0, pico_cnn::op_type::MaxPool, kernel_size, stride,
+                                                   Padding > 0 ? padding : nullptr);
+    auto specialized = new Pool(name, 0, pico_cnn::op_type::MaxPool);
+
+    double generic_ms = time_layer((pico_cnn::naive::Layer*) generic, input, generic_output, num_iterations);
+    double specialized_ms = time_layer(specialized, input, specialized_output, num_iterations);
+
+    report(name, generic_ms, specialized_ms, generic_output, specialized_output);
+
+    delete specialized;
+    delete generic;
+    delete specialized_output;
+    delete generic_output;
+    delete input;
+}
+
+int32_t main(int32_t argc, char** argv) {
+
+    uint32_t num_iterations = 10;
+    if(argc > 1) {
+        num_iterations = atoi(argv[1]);
+    }
+
+    printf("%-40s %13s %13s %9s\n", "layer", "generic", "specialized", "speedup");
+
+    benchmark_conv2d<96, 11, 11, 4, 4, 3, 227, 227, 0, 1>("conv 11x11/4 3->96 227x227 (AlexNet)", num_iterations);
+    benchmark_conv2d<64, 3, 3, 1, 1, 64, 56, 56, 1, 1>("conv 3x3/1 64->64 56x56 (VGG/ResNet)", num_iterations);
+    benchmark_conv2d<128, 3, 3, 2, 2, 64, 56, 56, 1, 1>("conv 3x3/2 64->128 56x56", num_iterations);
+    benchmark_conv2d<64, 1, 1, 1, 1, 256, 28, 28, 0, 1>("conv 1x1/1 256->64 28x28", num_iterations);
+    benchmark_conv2d<128, 3, 3, 1, 1, 128, 56, 56, 1, 128>("depthwise conv 3x3/1 128 56x56", num_iterations);
+    benchmark_conv2d<50, 5, 5, 1, 1, 20, 12, 12, 0, 1>("conv 5x5/1 20->50 12x12 (LeNet)", num_iterations);
+
+    benchmark_max_pool2d<3, 2, 64, 112, 112, 1>("max pool 3x3/2 64 112x112", num_iterations);
+    benchmark_max_pool2d<2, 2, 64, 56, 56, 0>("max pool 2x2/2 64 56x56", num_iterations);
+
+    return 0;
+}
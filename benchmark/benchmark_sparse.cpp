@@ -0,0 +1,146 @@
+/**
+ * Compares the sparse kernels of pico-cnn (see pico-cnn/gemm/sparse_matrix.h) with the dense GEMM of the selected
+ * provider for pruned fully connected layers and convolutions lowered with im2col at decreasing weight densities. The
+ * generator uses the sparse kernels below the density where they become faster (--sparse-threshold).
+ *
+ * The second table compares fully connected layers that skip the weights of zero inputs (see
+ * pico-cnn/gemm/sparse_input_gemm.h) with the dense GEMM at decreasing input densities, batches above the density
+ * where they stop being faster are multiplied densely (SparseInputMaxDensity).
+ *
+ * ./benchmark_sparse [NUM_ITERATIONS]
+ */
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "pico-cnn/pico-cnn.h"
+
+static std::vector<fp_t> random_matrix(uint32_t num_elements, double density) {
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<fp_t> distribution(-1.0, 1.0);
+    std::bernoulli_distribution nonzero(density);
+    std::vector<fp_t> matrix(num_elements);
+    for(fp_t &element: matrix) {
+        element = nonzero(generator) ? distribution(generator) : 0;
+    }
+    return matrix;
+}
+
+template<typename Run>
+static double measure(Run run, uint32_t num_iterations) {
+    run();
+    auto start = std::chrono::steady_clock::now();
+    for(uint32_t i = 0; i < num_iterations; i++) {
+        run();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / num_iterations;
+}
+
+/**
+ * Kernel of shape (m, k), fully connected layers compute input (n, k) * kernel^T, convolutions kernel * columns (k, n).
+ */
+static void benchmark_sparse(const char *name, bool fully_connected, uint32_t m, uint32_t n, uint32_t k,
+                             uint32_t num_iterations) {
+    const double densities[] = {0.9, 0.7, 0.5, 0.4, 0.3, 0.2, 0.1, 0.05};
+
+    std::vector<fp_t> b = random_matrix(k * n, 1.0);
+    std::vector<fp_t> c(m * n);
+
+    printf("%-36s", name);
+
+    double threshold = 0;
+    for(double density: densities) {
+        std::vector<fp_t> a = random_matrix(m * k, density);
+        pico_cnn::naive::SparseMatrix *sparse = pico_cnn::naive::SparseMatrix::from_dense(a.data(), m, k);
+
+        double dense_milliseconds, sparse_milliseconds;
+        if(fully_connected) {
+            dense_milliseconds = measure([&] {
+                pico_cnn::naive::sgemm(false, true, n, m, k, 1, b.data(), k, a.data(), k, 0, c.data(), m);
+            }, num_iterations);
+            sparse_milliseconds = measure([&] {
+                sparse->multiply_transposed(n, b.data(), k, 0, c.data(), m);
+            }, num_iterations);
+        } else {
+            dense_milliseconds = measure([&] {
+                pico_cnn::naive::sgemm(false, false, m, n, k, 1, a.data(), k, b.data(), n, 0, c.data(), n);
+            }, num_iterations);
+            sparse_milliseconds = measure([&] {
+                sparse->multiply(0, m, n, b.data(), n, 0, c.data(), n);
+            }, num_iterations);
+        }
+
+        if(threshold == 0 && sparse_milliseconds < dense_milliseconds) {
+            threshold = density;
+        }
+
+        printf(" %4.2f: %5.2fx", density, dense_milliseconds / sparse_milliseconds);
+        delete sparse;
+    }
+    printf("  sparse faster below density %.2f\n", threshold);
+}
+
+/**
+ * Input of shape (n, k) with the given fraction of non-zeros, as after a ReLU, kernel stored as (k, m).
+ */
+static void benchmark_sparse_input(const char *name, uint32_t m, uint32_t n, uint32_t k, uint32_t num_iterations) {
+    const double densities[] = {0.9, 0.7, 0.6, 0.5, 0.4, 0.3, 0.2, 0.1};
+
+    std::vector<fp_t> kernel = random_matrix(k * m, 1.0);
+    std::vector<fp_t> c(n * m);
+    std::vector<uint32_t> indices(k);
+
+    printf("%-36s", name);
+
+    double threshold = 0;
+    for(double density: densities) {
+        std::vector<fp_t> input = random_matrix(n * k, density);
+
+        double dense_milliseconds = measure([&] {
+            pico_cnn::naive::sgemm(false, false, n, m, k, 1, input.data(), k, kernel.data(), m, 0, c.data(), m);
+        }, num_iterations);
+        double sparse_milliseconds = measure([&] {
+            pico_cnn::naive::sparse_input_sgemm(n, m, k, input.data(), k, kernel.data(), m, 0, c.data(), m,
+                                                indices.data());
+        }, num_iterations);
+
+        if(threshold == 0 && sparse_milliseconds < dense_milliseconds) {
+            threshold = density;
+        }
+
+        printf(" %4.2f: %5.2fx", density, dense_milliseconds / sparse_milliseconds);
+    }
+    printf("  sparse faster below density %.2f\n", threshold);
+}
+
+int32_t main(int32_t argc, char** argv) {
+
+    uint32_t num_iterations = 10;
+    if(argc > 1) {
+        num_iterations = atoi(argv[1]);
+    }
+
+    printf("Speedup of the sparse kernels over %s at weight density:\n", pico_cnn::naive::gemm_provider()->name());
+
+    // fully connected layers: (1, X) * (Y, X)^T
+    benchmark_sparse("fc 9216->4096 (AlexNet)", true, 4096, 1, 9216, num_iterations);
+    benchmark_sparse("fc 4096->1000 batch 16", true, 1000, 16, 4096, num_iterations);
+    benchmark_sparse("fc 800->500 (LeNet)", true, 500, 1, 800, num_iterations);
+
+    // convolutions: kernel (Cout, Cin*KH*KW) * columns (Cin*KH*KW, OH*OW)
+    benchmark_sparse("conv 3x3/1 64->64 56x56 (VGG/ResNet)", false, 64, 56 * 56, 64 * 3 * 3, num_iterations);
+    benchmark_sparse("conv 1x1/1 256->64 28x28", false, 64, 28 * 28, 256, num_iterations);
+    benchmark_sparse("conv 5x5/1 20->50 12x12 (LeNet)", false, 50, 8 * 8, 20 * 5 * 5, num_iterations);
+
+    printf("\nSpeedup of skipping zero inputs over %s at input density:\n", pico_cnn::naive::gemm_provider()->name());
+
+    // fully connected layers behind a ReLU: (N, X) * (X, Y)
+    benchmark_sparse_input("fc 9216->4096 (AlexNet)", 4096, 1, 9216, num_iterations);
+    benchmark_sparse_input("fc 4096->4096 (VGG)", 4096, 1, 4096, num_iterations);
+    benchmark_sparse_input("fc 4096->1000 batch 16", 1000, 16, 4096, num_iterations);
+    benchmark_sparse_input("fc 800->500 (LeNet)", 500, 1, 800, num_iterations);
+
+    return 0;
+}
@@ -0,0 +1,155 @@
+/**
+ * Measures the latency of the first run of freshly allocated layers against the steady state for every
+ * pico_cnn::naive::TensorMemory (see pico-cnn/runtime/tensor_memory.h). Every configuration runs in its own process,
+ * so it starts with untouched memory like a freshly started program.
+ *
+ * ./benchmark_tensor_memory [NUM_ITERATIONS]
+ */
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <string>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "pico-cnn/pico-cnn.h"
+
+static void fill_random(pico_cnn::naive::Tensor *tensor) {
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<fp_t> distribution(-1.0, 1.0);
+    for(uint32_t i = 0; i < tensor->num_elements(); i++) {
+        tensor->access_blob(i) = distribution(generator);
+    }
+}
+
+/**
+ * @return memory of the process backed by transparent huge pages in MB
+ */
+static double huge_page_megabytes() {
+    std::ifstream smaps("/proc/self/smaps_rollup");
+    std::string key;
+    uint64_t kilobytes;
+    while(smaps >> key) {
+        if(key == "AnonHugePages:" && smaps >> kilobytes) {
+            return kilobytes / 1024.0;
+        }
+    }
+    return 0;
+}
+
+/**
+ * A convolution on a large padded input followed by the fully connected layers of AlexNet, all allocated after the
+ * tensor memory has been selected.
+ */
+static void benchmark_tensor_memory(const char *name, pico_cnn::naive::TensorMemory memory, bool prefault,
+                                    uint32_t num_iterations) {
+    pico_cnn::naive::set_tensor_memory(memory, prefault);
+
+    auto start = std::chrono::steady_clock::now();
+
+    auto input = new pico_cnn::naive::Tensor(1, 64, 112, 112);
+    auto conv_kernel = new pico_cnn::naive::Tensor(64, 64, 3, 3);
+    auto conv_bias = new pico_cnn::naive::Tensor(64);
+    auto conv_output = new pico_cnn::naive::Tensor(1, 64, 112, 112);
+
+    const uint32_t fc_sizes[4] = {9216, 4096, 4096, 1000};
+    pico_cnn::naive::Tensor *fc_kernels[3], *fc_biases[3], *fc_outputs[4];
+    fc_outputs[0] = new pico_cnn::naive::Tensor(1, fc_sizes[0]);
+    for(uint32_t layer = 0; layer < 3; layer++) {
+        fc_kernels[layer] = new pico_cnn::naive::Tensor(fc_sizes[layer + 1], fc_sizes[layer]);
+        fc_biases[layer] = new pico_cnn::naive::Tensor(fc_sizes[layer + 1]);
+        fc_outputs[layer + 1] = new pico_cnn::naive::Tensor(1, fc_sizes[layer + 1]);
+    }
+
+    // the weights are written like by read_binary_weights(), the activations are only touched by the first run
+    fill_random(input);
+    fill_random(conv_kernel);
+    fill_random(conv_bias);
+    fill_random(fc_outputs[0]);
+    for(uint32_t layer = 0; layer < 3; layer++) {
+        fill_random(fc_kernels[layer]);
+        fill_random(fc_biases[layer]);
+    }
+
+    uint32_t padding[4] = {1, 1, 1, 1};
+    uint32_t stride[2] = {1, 1};
+    auto conv = new pico_cnn::naive::Convolution("conv", 0, pico_cnn::op_type::Conv, conv_kernel, conv_bias, padding,
+                                                 stride, 1);
+    pico_cnn::naive::FullyConnected *fcs[3];
+    for(uint32_t layer = 0; layer < 3; layer++) {
+        fcs[layer] = new pico_cnn::naive::FullyConnected("fc", 0, pico_cnn::op_type::Gemm, fc_kernels[layer],
+                                                         fc_biases[layer]);
+    }
+
+    double setup_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    auto run = [&]() {
+        auto run_start = std::chrono::steady_clock::now();
+        ((pico_cnn::naive::Layer*) conv)->run(input, conv_output);
+        for(uint32_t layer = 0; layer < 3; layer++) {
+            ((pico_cnn::naive::Layer*) fcs[layer])->run(fc_outputs[layer], fc_outputs[layer + 1]);
+        }
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - run_start).count();
+    };
+
+    double first_ms = run();
+    double steady_ms = 0;
+    for(uint32_t i = 0; i < num_iterations; i++) {
+        steady_ms += run();
+    }
+    steady_ms /= num_iterations;
+
+    printf("%-28s %10.2f ms %10.2f ms %10.2f ms %+10.2f ms %8.0f MB\n", name, setup_ms, first_ms, steady_ms,
+           first_ms - steady_ms, huge_page_megabytes());
+    fflush(stdout);
+
+    for(uint32_t layer = 0; layer < 3; layer++) {
+        delete fcs[layer];
+        delete fc_outputs[layer + 1];
+        delete fc_biases[layer];
+        delete fc_kernels[layer];
+    }
+    delete fc_outputs[0];
+    delete conv;
+    delete conv_output;
+    delete conv_bias;
+    delete conv_kernel;
+    delete input;
+}
+
+int32_t main(int32_t argc, char** argv) {
+
+    uint32_t num_iterations = 10;
+    if(argc > 1) {
+        num_iterations = atoi(argv[1]);
+    }
+
+    printf("%-28s %13s %13s %13s %13s %11s\n", "tensor memory", "setup", "first run", "steady state", "delta",
+           "huge pages");
+
+    struct {
+        const char *name;
+        pico_cnn::naive::TensorMemory memory;
+        bool prefault;
+    } configurations[] = {
+            {"heap", pico_cnn::naive::TensorMemory::Heap, false},
+            {"huge pages", pico_cnn::naive::TensorMemory::HugePages, false},
+            {"huge pages, prefaulted", pico_cnn::naive::TensorMemory::HugePages, true},
+            {"hugetlbfs, prefaulted", pico_cnn::naive::TensorMemory::HugeTlbfs, true},
+    };
+
+    for(auto &configuration: configurations) {
+        fflush(stdout);
+        pid_t pid = fork();
+        if(pid == 0) {
+            benchmark_tensor_memory(configuration.name, configuration.memory, configuration.prefault,
+                                    num_iterations);
+            return 0;
+        }
+        waitpid(pid, nullptr, 0);
+    }
+
+    return 0;
+}
@@ -0,0 +1,132 @@
+/**
+ * Evaluates a generated network on the MNIST test set or the ImageNet validation set. Samples are streamed from disk
+ * and preprocessed by background threads while the network is running.
+ *
+ * The input shape and the number of classes of the network are set at compile time, e.g. for AlexNet:
+ * -DINPUT_CHANNELS=3 -DINPUT_HEIGHT=224 -DINPUT_WIDTH=224 -DNUM_CLASSES=1000
+ */
+#define IMAGENET
+
+#ifndef INPUT_CHANNELS
+#define INPUT_CHANNELS 1
+#endif
+
+#ifndef INPUT_HEIGHT
+#define INPUT_HEIGHT 28
+#endif
+
+#ifndef INPUT_WIDTH
+#define INPUT_WIDTH 28
+#endif
+
+#ifndef NUM_CLASSES
+#define NUM_CLASSES 10
+#endif
+
+#include <cstdlib>
+#include <string>
+
+#include "pico-cnn/pico-cnn.h"
+#include "network.h"
+
+void usage() {
+    printf("./evaluate_dataset mnist PATH_TO_BINARY_WEIGHTS_FILE PATH_TO_MNIST [NUM_IMAGES] [NUM_THREADS]\n");
+    printf("./evaluate_dataset imagenet PATH_TO_BINARY_WEIGHTS_FILE PATH_TO_MEANS_FILE.means \\\n");
+    printf("PATH_TO_VALIDATION_IMAGES PATH_TO_VALIDATION_LABELS.txt [NUM_IMAGES] [NUM_THREADS]\n");
+}
+
+int32_t main(int32_t argc, char** argv) {
+
+    if(argc < 4) {
+        usage();
+        return 1;
+    }
+
+    std::string dataset(argv[1]);
+    char weights_path[1024];
+    strcpy(weights_path, argv[2]);
+
+    pico_cnn::naive::SampleSource *source;
+    uint32_t num_images = 0;
+    uint32_t num_threads = 2;
+
+    if(dataset == "mnist") {
+        std::string mnist_path(argv[3]);
+        if(argc > 4) {
+            num_images = atoi(argv[4]);
+        }
+        if(argc > 5) {
+            num_threads = atoi(argv[5]);
+        }
+
+        std::string images_path = mnist_path + "/t10k-images.idx3-ubyte";
+        std::string labels_path = mnist_path + "/t10k-labels.idx1-ubyte";
+
+        PRINT_INFO("Streaming images from " << images_path)
+
+        auto mnist_source = new pico_cnn::naive::MnistSource(images_path.c_str(), labels_path.c_str(), num_images,
+                                                             (INPUT_HEIGHT - 28) / 2, 0.0, 1.0);
+        if(!mnist_source->valid()) {
+            PRINT_ERROR("Could not read mnist dataset from " << mnist_path)
+            return 1;
+        }
+        source = mnist_source;
+
+    } else if(dataset == "imagenet" && argc >= 6) {
+        if(argc > 6) {
+            num_images = atoi(argv[6]);
+        }
+        if(argc > 7) {
+            num_threads = atoi(argv[7]);
+        }
+
+        fp_t means[3];
+        if(read_means(argv[3], means) != 0) {
+            PRINT_ERROR("Could not read means file " << argv[3])
+            return 1;
+        }
+
+        PRINT_INFO("Streaming images from " << argv[4])
+
+        auto imagenet_source = new pico_cnn::naive::ImageNetSource(argv[4], argv[5],
+                                                                   num_images > 0 ? num_images : 50000, means);
+        if(!imagenet_source->valid()) {
+            PRINT_ERROR("Could not read imagenet validation labels from " << argv[5])
+            return 1;
+        }
+        source = imagenet_source;
+
+    } else {
+        usage();
+        return 1;
+    }
+
+    Network *net = new Network();
+
+    PRINT_INFO("Reading weights from " << weights_path)
+
+    if(read_binary_weights(weights_path, &net->kernels, &net->biases) != 0) {
+        PRINT_ERROR("Could not read weights from " << weights_path)
+        return 1;
+    }
+
+    auto output_tensor = new pico_cnn::naive::Tensor(1, NUM_CLASSES);
+
+    auto evaluator = new pico_cnn::naive::PrefetchEvaluator(source, [] {
+        return new pico_cnn::naive::Tensor(1, INPUT_CHANNELS, INPUT_HEIGHT, INPUT_WIDTH);
+    }, 4 * num_threads, num_threads);
+
+    PRINT_INFO("Starting evaluation of " << (num_images > 0 ? num_images : source->num_samples()) << " images with "
+               << num_threads << " prefetching threads...")
+
+    evaluator->evaluate([&](pico_cnn::naive::Tensor *input, pico_cnn::naive::Tensor *output) {
+        net->run(input, output);
+    }, output_tensor, num_images);
+
+    delete evaluator;
+    delete output_tensor;
+    delete net;
+    delete source;
+
+    return 0;
+}
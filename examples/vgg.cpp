@@ -101,64 +101,31 @@ int32_t main(int32_t argc, char** argv) {
     // read input image
     PRINT_INFO("Reading input image " << jpeg_path)
 
-    fp_t** pre_mean_input;
-
-    uint16_t height;
-    uint16_t width;
-
-    if(read_jpeg(&pre_mean_input, jpeg_path, 0.0, 255.0, &height, &width) != 0) {
-        PRINT_ERROR("Could not read jpeg from " << jpeg_path)
-        return 1;
-    }
-
-    // substract mean from each channel
-    fp_t** input = (fp_t**) malloc(3*sizeof(fp_t*));
-    input[0] = (fp_t*) malloc(IMAGE_SIZE*IMAGE_SIZE*sizeof(fp_t));
-    input[1] = (fp_t*) malloc(IMAGE_SIZE*IMAGE_SIZE*sizeof(fp_t));
-    input[2] = (fp_t*) malloc(IMAGE_SIZE*IMAGE_SIZE*sizeof(fp_t));
-
-    uint16_t row;
-    uint16_t column;
+    pico_cnn::naive::Tensor *input_tensor = new pico_cnn::naive::Tensor(1, 3, IMAGE_SIZE, IMAGE_SIZE);
+    pico_cnn::naive::Tensor *output_tensor = new pico_cnn::naive::Tensor(1, 1000);
 
+    // decode, resize and subtract means in a single pass
+    pico_cnn::naive::JpegPreprocessing preprocessing;
     for(i = 0; i < 3; i++) {
-        for(row = 0; row < height; row++) {
-            for(column = 0; column < height; column++) {
-                input[i][row*width+column] = pre_mean_input[i][row*width+column] - means[i];
-            }
-        }
+        preprocessing.means[i] = means[i];
     }
 
-    // free pre mean input image
-    for(i = 0; i < 3; i++) {
-        free(pre_mean_input[i]);
+    if(pico_cnn::naive::read_jpeg_into_tensor(jpeg_path, input_tensor, 0, preprocessing) != 0) {
+        PRINT_ERROR("Could not read jpeg from " << jpeg_path)
+        return 1;
     }
-    free(pre_mean_input);
 
     // free means
     free(means);
 
     fp_t *output  = (float*) malloc(1000*sizeof(float));
 
-    pico_cnn::naive::Tensor *input_tensor = new pico_cnn::naive::Tensor(1, 3, 224, 224);
-    pico_cnn::naive::Tensor *output_tensor = new pico_cnn::naive::Tensor(1, 1000);
-
-    std::memcpy(input_tensor->data_+(0*224*224), input[0], 224*224*sizeof(fp_t));
-    std::memcpy(input_tensor->data_+(1*224*224), input[1], 224*224*sizeof(fp_t));
-    std::memcpy(input_tensor->data_+(2*224*224), input[2], 224*224*sizeof(fp_t));
-
     PRINT_INFO("Starting CNN");
 
     net->run(input_tensor, output_tensor);
 
     PRINT_INFO("After CNN");
 
-    // free memory
-    // input
-    free(input[0]);
-    free(input[1]);
-    free(input[2]);
-    free(input);
-
     // print prediction
     uint16_t* labels_pos;
     labels_pos = (uint16_t*) malloc(1000*sizeof(uint16_t));
@@ -0,0 +1,206 @@
+""" Selection of the fastest implementation of an operation by running micro-benchmarks on the target machine. """
+from jinja2 import Environment, FileSystemLoader
+
+import json
+import os
+import platform
+import subprocess
+import tempfile
+
+base_dir = os.path.dirname(os.path.abspath(__file__))
+template_dir = os.path.join(base_dir, "code_templates")
+pico_cnn_dir = os.path.join(base_dir, "..")
+
+template_env = Environment(loader=FileSystemLoader(template_dir))
+
+__author__ = "Alexander Jung (University of Tuebingen, Chair for Embedded Systems)"
+
+
+class TuningCache(object):
+    """
+    Stores the fastest implementation of an operation keyed by the CPU model, the operator, the shapes of its inputs
+    and outputs and its attributes, so that code generation can reuse the results without tuning again.
+    The cache is a JSON file: {cpu_model: {key: {"implementation": name, "milliseconds": {name: runtime}}}}
+    """
+    def __init__(self, path):
+        self.path = path
+        self.entries = {}
+        self.cpu = self.cpu_model()
+
+        if os.path.exists(path):
+            with open(path, "r") as f:
+                self.entries = json.load(f)
+            print("Read tuning cache {} ({} entries for this CPU)".format(path, len(self.entries.get(self.cpu, {}))))
+
+    @staticmethod
+    def cpu_model():
+        """
+        :return: Model name of the CPU as reported by /proc/cpuinfo (if available).
+        """
+        try:
+            with open("/proc/cpuinfo", "r") as f:
+                for line in f:
+                    if line.startswith("model name") or line.startswith("Model"):
+                        return line.split(":", 1)[1].strip()
+        except OSError:
+            pass
+        return platform.processor() or platform.machine()
+
+    @staticmethod
+    def key(graph, node):
+        """
+        :return: String identifying the operation of node independent of its name.
+        """
+        input_shapes = [list(graph.get_shape(id)) for id in node.inputs]
+        output_shapes = [list(graph.get_shape(id)) for id in node.outputs]
+        attributes = ["{}={}".format(name, list(value) if isinstance(value, tuple) else value)
+                      for name, value in sorted(node.attrs.items())
+                      if isinstance(value, (int, float, str, list, tuple))]
+
+        return "{}|{}|{}|{}".format(node.op_type, input_shapes, output_shapes, ",".join(attributes))
+
+    def lookup(self, graph, node):
+        """
+        :return: Name of the fastest implementation of node or None if node has not been tuned on this CPU.
+        """
+        entry = self.entries.get(self.cpu, {}).get(self.key(graph, node))
+        if entry is None:
+            return None
+        return entry["implementation"]
+
+    def store(self, graph, node, implementation, milliseconds):
+        self.entries.setdefault(self.cpu, {})[self.key(graph, node)] = {"implementation": implementation,
+                                                                         "milliseconds": milliseconds}
+
+    def save(self):
+        with open(self.path, "w") as f:
+            json.dump(self.entries, f, indent=2, sort_keys=True)
+        print("Saved tuning cache {}".format(self.path))
+
+
+class Autotuner(object):
+    """
+    Generates a micro-benchmark which runs all implementation candidates of the operations on random data, compiles it
+    against the pico-cnn library, runs it and stores the fastest implementation of every operation in the TuningCache.
+    """
+    def __init__(self, cache, min_milliseconds=50):
+        """
+        :param cache: TuningCache the results are stored in.
+        :param min_milliseconds: Minimal time each candidate is repeatedly run for.
+        """
+        self.cache = cache
+        self.min_milliseconds = min_milliseconds
+
+    @staticmethod
+    def _get_tensors(node, memory_manager, graph):
+        """
+        :return: List of the distinct input and output buffers of node or None if a buffer can not be created as
+        pico_cnn::naive::Tensor.
+        """
+        tensors = []
+        for id in node.inputs + node.outputs:
+            buffer = memory_manager.get_buffer(graph, id)
+            if not 1 <= len(buffer.shape) <= 4:
+                return None
+            if buffer.name not in [tensor["name"] for tensor in tensors]:
+                tensors.append({"name": buffer.name, "shape": [int(dim) for dim in buffer.shape]})
+        return tensors
+
+    def tune(self, graph, memory_manager, tasks):
+        """
+        Benchmark the candidates of all tasks and store the fastest ones in the cache.
+        :param graph: ComputeGraph of the parsed onnx model.
+        :param memory_manager: MemoryManager containing information about input and output buffers.
+        :param tasks: List of (node, candidates) tuples.
+        :return: Dictionary containing the fastest candidate of each node which could be benchmarked.
+        """
+        benchmarks = []
+        for node, candidates in tasks:
+            tensors = self._get_tensors(node, memory_manager, graph)
+            if tensors is None:
+                print("Can not tune {}: unsupported tensor shape".format(node.name))
+                continue
+
+            benchmarks.append({"index": len(benchmarks),
+                               "name": node.name,
+                               "node": node,
+                               "tensors": tensors,
+                               "candidates": [{"implementation": candidate,
+                                               "declaration": candidate.generate_declaration(),
+                                               "allocation": candidate.generate_allocation(),
+                                               "execution": candidate.generate_execution(),
+                                               "deletion": candidate.generate_deletion()}
+                                              for candidate in candidates]})
+
+        if not benchmarks:
+            return {}
+
+        template = template_env.get_template("main_program/tuning_benchmark.cpp")
+        benchmark_code = template.render(benchmarks=benchmarks, min_milliseconds=self.min_milliseconds)
+
+        milliseconds = self._run_benchmark(benchmark_code)
+        if milliseconds is None:
+            return {}
+
+        selection = {}
+        for benchmark in benchmarks:
+            candidates = benchmark["candidates"]
+            timings = {candidates[num]["implementation"].name: runtime
+                       for (index, num), runtime in milliseconds.items() if index == benchmark["index"]}
+            if len(timings) != len(candidates):
+                print("Benchmark of {} incomplete, keeping default implementation".format(benchmark["name"]))
+                continue
+
+            fastest = min(candidates, key=lambda candidate: timings[candidate["implementation"].name])
+            fastest = fastest["implementation"]
+            selection[benchmark["node"]] = fastest
+            self.cache.store(graph, benchmark["node"], fastest.name, timings)
+
+            print("Tuned {}: {} ({})".format(benchmark["name"], fastest.name,
+                                             ", ".join("{}: {:.3f} ms".format(name, runtime)
+                                                       for name, runtime in sorted(timings.items()))))
+
+        self.cache.save()
+
+        return selection
+
+    def _run_benchmark(self, benchmark_code):
+        """
+        Compile and run the micro-benchmark.
+        :return: Dictionary {(benchmark index, candidate index): milliseconds} or None on failure.
+        """
+        print("Building pico-cnn library for tuning")
+        if subprocess.call(["make", "-C", os.path.join(pico_cnn_dir, "pico-cnn")],
+                           stdout=subprocess.DEVNULL) != 0:
+            print("ERROR: Could not build pico-cnn library, tuning aborted")
+            return None
+
+        with tempfile.TemporaryDirectory() as tmp_dir:
+            source = os.path.join(tmp_dir, "tuning_benchmark.cpp")
+            binary = os.path.join(tmp_dir, "tuning_benchmark")
+            with open(source, "w") as f:
+                f.write(benchmark_code)
+
+            # same flags as the generated Makefile when specialized implementations are selected
+            command = ["g++", "-std=c++11", "-O3", "-march=native", "-pthread", source,
+                       "-I" + pico_cnn_dir, "-L" + os.path.join(pico_cnn_dir, "pico-cnn"),
+                       "-lpico-cnn", "-lm", "-ljpeg", "-pthread", "-o", binary]
+            print("Compiling tuning benchmark")
+            if subprocess.call(command) != 0:
+                print("ERROR: Could not compile tuning benchmark, tuning aborted")
+                return None
+
+            print("Running tuning benchmark")
+            try:
+                output = subprocess.check_output([binary], universal_newlines=True)
+            except subprocess.CalledProcessError:
+                print("ERROR: Tuning benchmark failed, tuning aborted")
+                return None
+
+        milliseconds = {}
+        for line in output.splitlines():
+            fields = line.split()
+            if len(fields) == 3 and fields[0].isdigit() and fields[1].isdigit():
+                milliseconds[(int(fields[0]), int(fields[1]))] = float(fields[2])
+
+        return milliseconds
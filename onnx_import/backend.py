@@ -2,7 +2,9 @@ from compute_graph import *
 from constprop import constant_propagation
 from memory_manager import MemoryManager
 from memory_allocation import *
+from utils import reduce_mult
 from generate_dummy import *
+from autotuner import Autotuner, TuningCache
 
 from typing import Any, Text, Optional
 
@@ -10,6 +12,7 @@ import onnx.backend.base as backend_base
 import onnx
 from onnx import ModelProto
 
+import numpy as np
 import os
 import struct
 
@@ -17,9 +20,27 @@ __author__ = "Christoph Gerum, Alexander Jung (University of Tuebingen, Chair fo
 
 
 class BackendRep(backend_base.BackendRep):
-    def __init__(self, onnx_model, model_name):
+    def __init__(self, onnx_model, model_name, parallel=False, schedule="onnx", pipeline_stages=0,
+                 specialize=False, autotune=False, tuning_cache="tuning_cache.json", profile=False,
+                 sparse_threshold=0, embed_weights=None, tile=False, tile_cache_kb=0,
+                 stream=False):
         self.onnx_model = onnx_model
         self.model_name = model_name
+        self.parallel = parallel
+        self.schedule = schedule
+        self.pipeline_stages = pipeline_stages
+        self.specialize = specialize
+        self.autotune = autotune
+        self.tuning_cache = tuning_cache
+        self.profile = profile
+        self.sparse_threshold = sparse_threshold
+        self.embed_weights = embed_weights
+        self.tile = tile
+        self.tile_cache_kb = tile_cache_kb
+        self.stream = stream
+        # operations executed row by row by a LineBufferStream and their intermediate tensors, which are not allocated
+        self.streamed_nodes = []
+        self.streamed_tensors = set()
         self.network_code = ""
         self.network_header = ""
         self.parameter_code = ""
@@ -31,9 +52,13 @@ class BackendRep(backend_base.BackendRep):
         self.destructor_code = ""
         self.weights_file = ""
         self.packed_file = list()
+        self.embedded_weights = list()
+        self.embedded_size = 0
+        self.inplace_outputs = {}
         self.makefile = ""
         self.dummy_input = ""
         self.reference_input = ""
+        self.pipeline_input = ""
         self._export_model()
 
     def _remove_constants(self, graph, constant_states):
@@ -98,6 +123,202 @@ class BackendRep(backend_base.BackendRep):
                                       input, "with", removed_input)
                                 node.inputs[num] = removed_input
 
+    @staticmethod
+    def _get_permutation(graph, node):
+        """
+        :return: Permutation of a Transpose node, the default reverses the dimensions.
+        """
+        num_dimensions = len(graph.get_shape(node.inputs[0]))
+        return list(node.attrs.get('perm', reversed(range(num_dimensions))))
+
+    @staticmethod
+    def _get_consumers(graph, edge):
+        return [node for node in graph.nodes if edge in node.inputs]
+
+    def _bypass(self, graph, node):
+        """
+        Remove a node whose output has the same data layout as its input.
+        :return: True if node was removed.
+        """
+        removed_input = node.inputs[0]
+        removed_output = node.outputs[0]
+
+        if graph.is_output(removed_output):
+            # the producer of the input writes the output of the network instead
+            producers = [other for other in graph.nodes if removed_input in other.outputs]
+            if len(producers) != 1 or len(self._get_consumers(graph, removed_input)) != 1:
+                return False
+            producer = producers[0]
+            producer.outputs[producer.outputs.index(removed_input)] = removed_output
+        else:
+            for other in graph.nodes:
+                for num, input in enumerate(other.inputs):
+                    if input == removed_output:
+                        other.inputs[num] = removed_input
+
+        graph.nodes.remove(node)
+        return True
+
+    def _propagate_layouts(self, graph):
+        """
+        Eliminate Transpose nodes by propagating the data layout through adjacent operations:
+        Transposes are moved behind element-wise operations, consecutive Transposes are merged, Transposes which keep
+        the order of all dimensions are removed and a Transpose of the input or the output of a 2D MatMul is absorbed
+        by reading or writing the transposed operand in the GEMM.
+        Transposes of constant tensors (e.g. weights) are already applied by the constant propagation.
+        :param graph: ComputeGraph of the parsed onnx model.
+        :return:
+        """
+        # Mul is only commuted with a Transpose if its factor is a scalar
+        elementwise_ops = ["Relu", "Clip", "Mul", "Sigmoid", "Tanh"]
+        num_transposes = len([node for node in graph.nodes if node.op_type == "Transpose"])
+
+        changed = True
+        while changed:
+            changed = False
+
+            for node in list(graph.nodes):
+                if node.op_type != "Transpose" or node not in graph.nodes:
+                    continue
+
+                permutation = self._get_permutation(graph, node)
+                consumers = self._get_consumers(graph, node.outputs[0])
+                single_consumer = consumers[0] if len(consumers) == 1 and \
+                    not graph.is_output(node.outputs[0]) else None
+
+                if permutation == sorted(permutation):
+                    if self._bypass(graph, node):
+                        print("Removing identity", node.name)
+                        changed = True
+
+                elif single_consumer is not None and single_consumer.op_type == "Transpose":
+                    # y = T2(T1(x)): dimension i of y is dimension permutation[perm2[i]] of x
+                    consumer_permutation = self._get_permutation(graph, single_consumer)
+                    single_consumer.attrs['perm'] = [permutation[dim] for dim in consumer_permutation]
+                    single_consumer.inputs[0] = node.inputs[0]
+                    graph.nodes.remove(node)
+                    print("Merging", node.name, "into", single_consumer.name)
+                    changed = True
+
+                elif single_consumer is not None and single_consumer.op_type in elementwise_ops and \
+                        single_consumer.inputs[0] == node.outputs[0] and \
+                        all(reduce_mult(graph.get_shape(input)) == 1 for input in single_consumer.inputs[1:]):
+                    # x -> T -> t -> op -> y becomes x -> op -> t -> T -> y
+                    transposed = node.outputs[0]
+                    single_consumer.inputs[0] = node.inputs[0]
+                    node.inputs[0] = transposed
+                    node.outputs[0], single_consumer.outputs[0] = single_consumer.outputs[0], transposed
+                    graph.shape_dict[transposed] = graph.get_shape(single_consumer.inputs[0])
+
+                    node_pos = graph.nodes.index(node)
+                    consumer_pos = graph.nodes.index(single_consumer)
+                    graph.nodes[node_pos], graph.nodes[consumer_pos] = single_consumer, node
+                    print("Moving", node.name, "behind", single_consumer.name)
+                    changed = True
+
+            if changed:
+                continue
+
+            for node in list(graph.nodes):
+                if node.op_type != "Transpose" or self._get_permutation(graph, node) != [1, 0]:
+                    continue
+
+                consumers = self._get_consumers(graph, node.outputs[0])
+                producers = [other for other in graph.nodes if node.inputs[0] in other.outputs]
+
+                if len(consumers) == 1 and not graph.is_output(node.outputs[0]) and \
+                        consumers[0].op_type == "MatMul" and consumers[0].inputs[0] == node.outputs[0] and \
+                        not consumers[0].attrs.get('transpose_input', 0):
+                    consumers[0].attrs['transpose_input'] = 1
+                    consumers[0].inputs[0] = node.inputs[0]
+                    graph.nodes.remove(node)
+                    print("Absorbing", node.name, "into", consumers[0].name)
+                    changed = True
+
+                elif len(producers) == 1 and producers[0].op_type == "MatMul" and \
+                        len(self._get_consumers(graph, node.inputs[0])) == 1 and \
+                        not graph.is_output(node.inputs[0]) and not producers[0].attrs.get('transpose_output', 0):
+                    producers[0].attrs['transpose_output'] = 1
+                    producers[0].outputs[0] = node.outputs[0]
+                    graph.nodes.remove(node)
+                    print("Absorbing", node.name, "into", producers[0].name)
+                    changed = True
+
+        remaining = len([node for node in graph.nodes if node.op_type == "Transpose"])
+        if num_transposes > 0:
+            print("Layout propagation: {} of {} Transpose operations eliminated".format(num_transposes - remaining,
+                                                                                       num_transposes))
+
+    def _select_sparse_kernels(self, graph):
+        """
+        Select the Conv and Gemm operations whose kernel has a density (fraction of non-zero weights) below
+        self.sparse_threshold. Their kernels are stored in the CSR format and only the non-zeros are multiplied. The
+        default threshold 0 keeps all kernels dense, around 0.4 the sparse kernels become faster than the dense GEMM,
+        see benchmark/benchmark_sparse.cpp. Kernels used by multiple operations stay dense.
+        :param graph: ComputeGraph of the parsed onnx model.
+        :return:
+        """
+        for node in graph.nodes:
+            if node.op_type == "Conv":
+                eligible = len(graph.get_shape(node.inputs[0])) == 4 and \
+                           all(dilation == 1 for dilation in node.attrs.get("dilations", [1, 1]))
+            elif node.op_type == "Gemm":
+                eligible = node.attrs.get('transA', 0) == 0 and node.attrs.get('transB', 0) == 1 and \
+                           node.attrs.get('alpha', 1.0) == 1.0 and node.attrs.get('beta', 1.0) == 1.0
+            else:
+                continue
+
+            kernel = node.inputs[1]
+            if not eligible or kernel not in node.input_tensors or \
+                    len([other for other in graph.nodes if kernel in other.inputs]) != 1:
+                continue
+
+            data = node.input_tensors[kernel]
+            density = np.count_nonzero(data) / data.size
+            if density < self.sparse_threshold:
+                node.metadata['sparse'] = True
+                print("{} {}: kernel density {:.2f}, using sparse kernel".format(node.op_type, node.name, density))
+
+    def _select_sparse_inputs(self, graph):
+        """
+        Select the Gemm and MatMul operations whose input is the output of a ReLU, possibly passed through operations
+        which keep its zeros (e.g. MaxPool and Flatten). They compact the indices of the non-zero inputs and only
+        accumulate the matching weights, see pico-cnn/gemm/sparse_input_gemm.h. The kernel of a Gemm is transposed to
+        (X, Y) for this, so that the weights of one input are contiguous. Operations with a sparse kernel stay as they
+        are.
+        :param graph: ComputeGraph of the parsed onnx model.
+        :return:
+        """
+        zero_preserving_ops = ["Flatten", "Reshape", "Squeeze", "Unsqueeze", "MaxPool", "GlobalMaxPool"]
+
+        for node in graph.nodes:
+            if node.op_type == "Gemm":
+                eligible = node.attrs.get('transA', 0) == 0 and node.attrs.get('transB', 0) == 1 and \
+                           node.attrs.get('alpha', 1.0) == 1.0 and node.attrs.get('beta', 1.0) == 1.0
+            elif node.op_type == "MatMul":
+                eligible = not node.attrs.get('transpose_input', 0) and not node.attrs.get('transpose_output', 0)
+            else:
+                continue
+
+            kernel = node.inputs[1]
+            if not eligible or node.metadata.get('sparse') or kernel not in node.input_tensors or \
+                    len([other for other in graph.nodes if kernel in other.inputs]) != 1:
+                continue
+
+            producers = [other for other in graph.nodes if node.inputs[0] in other.outputs]
+            while len(producers) == 1 and producers[0].op_type in zero_preserving_ops:
+                producers = [other for other in graph.nodes if producers[0].inputs[0] in other.outputs]
+            if len(producers) != 1 or producers[0].op_type != "Relu":
+                continue
+
+            if node.op_type == "Gemm":
+                node.input_tensors[kernel] = np.ascontiguousarray(node.input_tensors[kernel].transpose())
+                graph.shape_dict[kernel] = tuple(reversed(graph.get_shape(kernel)))
+                node.attrs['transB'] = 0
+
+            node.metadata['sparse_input'] = True
+            print("{} {}: input from {}, skipping zero inputs".format(node.op_type, node.name, producers[0].name))
+
     def _generate_parameters(self, graph, memory_manager):
         """
         Legacy function to generate a .h and .c file containing all kernel and bias values.
@@ -139,7 +360,11 @@ class BackendRep(backend_base.BackendRep):
         :return:
         """
 
-        ops_to_ignore = ['Reshape', 'Mul']
+        ops_to_ignore = ['Reshape']
+
+        # constant operands of element-wise operations are written flattened like biases and read into tensors of
+        # their actual shape
+        elementwise_ops = ['Add', 'Mul', 'PRelu']
 
         buffers_written = []
 
@@ -163,7 +388,7 @@ class BackendRep(backend_base.BackendRep):
             if len(node.input_tensors) > 0 and node.op_type not in ops_to_ignore:
                 layer_name = bytes(node.name + "\n", "ascii")
                 weights_packed.append(struct.pack('{}s'.format(len(layer_name)), layer_name))
-                layer_type = bytes(node.op_type + "\n", "ascii")
+                layer_type = bytes(("Sparse" if node.metadata.get('sparse') else "") + node.op_type + "\n", "ascii")
                 weights_packed.append(struct.pack('{}s'.format(len(layer_type)), layer_type))
             else:
                 continue
@@ -178,10 +403,28 @@ class BackendRep(backend_base.BackendRep):
 
                 data = node.input_tensors[input]
 
+                if node.op_type in elementwise_ops:
+                    data = data.reshape(-1)
+
                 # if node.op_type == "MatMul":
                 #     data = data.transpose()
 
-                if len(data.shape) == 4:
+                if node.metadata.get('sparse') and input == node.inputs[1]:
+
+                    # CSR: number of rows, columns and non-zeros, row offsets, column indices, values
+                    matrix = data.reshape(data.shape[0], -1)
+                    rows, cols = np.nonzero(matrix)
+                    row_offsets = np.concatenate(([0], np.cumsum(np.count_nonzero(matrix, axis=1))))
+
+                    if write_buffer:
+                        weights_packed.append(struct.pack('3i', matrix.shape[0], matrix.shape[1], len(rows)))
+                        weights_packed.append(struct.pack('{}I'.format(len(row_offsets)), *row_offsets))
+                        weights_packed.append(struct.pack('{}I'.format(len(cols)), *cols))
+                        weights_packed.append(struct.pack('{}f'.format(len(rows)), *matrix[rows, cols]))
+                    else:
+                        weights_packed.append(struct.pack('3i', 0, 0, 0))
+
+                elif len(data.shape) == 4:
 
                     if write_buffer:
                         num_output_channels = data.shape[0]
@@ -265,7 +508,7 @@ class BackendRep(backend_base.BackendRep):
 
                 # This handles the case that no bias values are available in the onnx file.
                 # So we need to add num_biases = 0 into the binary file.
-                if len(node.input_tensors) == 1 and node.op_type != "Add":
+                if len(node.input_tensors) == 1 and node.op_type not in elementwise_ops:
                     # print("No biases in onnx file.")
                     weights_packed.append(struct.pack('i', 0))
 
@@ -276,6 +519,117 @@ class BackendRep(backend_base.BackendRep):
 
         self.packed_file = packed_file
 
+    def _embed(self, data, dtype=np.float32):
+        """
+        Append an array to the weights embedded in the binary (--embed-weights). Every array starts at a multiple of
+        64 bytes.
+        :param data: Array which is stored with the given data type of 4 bytes.
+        :return: Position of the array in network_weights in 4-byte words.
+        """
+        offset = self.embedded_size
+        words = np.ascontiguousarray(data, dtype=dtype).reshape(-1).view(np.uint32)
+        padding = -len(words) % 16
+        self.embedded_weights.append(np.concatenate((words, np.zeros(padding, dtype=np.uint32))))
+        self.embedded_size += len(words) + padding
+        return offset
+
+    def _generate_embedded_weights(self):
+        """
+        Generate the definition of network_weights, which holds all kernels and biases embedded by _embed(): either a
+        const array (network_weights.cpp) or an assembler file (network_weights.S) including the raw data from
+        network.weights.raw with .incbin. The weights are then part of the read-only data of the binary, which is
+        mapped from the page cache and shared by all processes running it.
+        :return: (name of the source file, its code, raw data or None)
+        """
+        words = np.concatenate(self.embedded_weights) if self.embedded_weights else np.zeros(16, dtype=np.uint32)
+
+        if self.embed_weights == "incbin":
+            code = "/* weights of the network, see network.h */\n"
+            code += "    .section .rodata\n"
+            code += "    .balign 64\n"
+            code += "    .globl network_weights\n"
+            code += "    .type network_weights, @object\n"
+            code += "network_weights:\n"
+            code += "    .incbin \"network.weights.raw\"\n"
+            code += "    .size network_weights, .-network_weights\n"
+            code += "    .section .note.GNU-stack,\"\",@progbits\n"
+            return "network_weights.S", code, words.astype('<u4').tobytes()
+
+        code = "#include <cstdint>\n\n"
+        code += "// weights of the network, see network.h\n"
+        code += "extern \"C\" alignas(64) const uint32_t network_weights[{}] = {{\n".format(len(words))
+        for line in range(0, len(words), 8):
+            code += "    " + ", ".join("0x{:08x}".format(word) for word in words[line:line + 8]) + ",\n"
+        code += "};\n"
+        return "network_weights.cpp", code, None
+
+    def _get_concat_views(self, graph):
+        """
+        Find the inputs of Concat operations which can be allocated as channel views into the output of the Concat,
+        so their producers write in place and the Concat does not copy any data. This is possible for concatenations
+        along the channels of tensors with a batch size of 1 if the input is written by an operation of the network
+        and not used by any other Concat. Pipelined networks keep copying, as the buffers passed between the stages
+        are allocated by the pico_cnn::naive::Pipeline.
+        :param graph: ComputeGraph of the parsed onnx model.
+        :return: Dictionary {input: (output of the Concat, first channel of the input in the output)}
+        """
+        views = {}
+        if self.pipeline_stages > 0:
+            return views
+
+        produced = set(output for node in graph.nodes for output in node.outputs)
+        concats = [node for node in graph.nodes if node.op_type == "Concat"]
+        concat_inputs = [input for node in concats for input in node.inputs]
+
+        for node in concats:
+            output_shape = graph.get_shape(node.outputs[0])
+            if node.attrs.get('axis') != 1 or len(output_shape) not in [3, 4] or output_shape[0] != 1 or \
+                    graph.is_output(node.outputs[0]):
+                continue
+
+            first_channel = 0
+            for input in node.inputs:
+                if input in produced and concat_inputs.count(input) == 1 and not graph.is_output(input):
+                    views[input] = (node.outputs[0], first_channel)
+                first_channel += graph.get_shape(input)[1]
+
+            node.metadata['in_place'] = all(input in views for input in node.inputs)
+            print("Concat {}: {} of {} inputs are written in place".format(
+                node.name, len([input for input in node.inputs if input in views]), len(node.inputs)))
+
+        return views
+
+    def _get_inplace_outputs(self, graph, concat_views):
+        """
+        Find the outputs of Add operations which can share the buffer of one of their inputs, so the sum is
+        accumulated in place. This is possible if the input is written by an operation of the network, has the shape of
+        the output and is not read by any other operation. Inputs and outputs which are channel views into the output
+        of a Concat keep their own buffers, as do pipelined networks.
+        :param graph: ComputeGraph of the parsed onnx model.
+        :param concat_views: Inputs of Concat operations allocated as views, see _get_concat_views().
+        :return: Dictionary {output: input whose buffer is reused}
+        """
+        aliases = {}
+        if self.pipeline_stages > 0:
+            return aliases
+
+        produced = set(output for node in graph.nodes for output in node.outputs)
+
+        for node in graph.nodes:
+            output = node.outputs[0]
+            if node.op_type != "Add" or graph.is_output(output) or output in concat_views:
+                continue
+
+            for input in node.inputs:
+                if input in produced and input not in concat_views and not graph.is_output(input) and \
+                        self._get_consumers(graph, input) == [node] and \
+                        list(graph.get_shape(input)) == list(graph.get_shape(output)):
+                    aliases[output] = input
+                    print("Add {}: accumulating in place into {}".format(node.name, input))
+                    break
+
+        return aliases
+
     def _generate_network_initialization(self, graph, memory_manager):
         """
         Generate code that allocates all necessary input and output buffers of all operations.
@@ -288,13 +642,15 @@ class BackendRep(backend_base.BackendRep):
         # TODO: To be changed if we want to support multiple outputs
         output_buffer_name = graph.outputs[0].name
 
-        ops_to_ignore = ['Reshape', 'Mul']
+        ops_to_ignore = ['Reshape']
+        elementwise_ops = ['Add', 'Mul', 'PRelu']
 
         buffers_allocated = []
 
         buffer_declaration = ""
         buffer_declaration += "    pico_cnn::naive::Tensor **kernels;\n"
         buffer_declaration += "    pico_cnn::naive::Tensor **biases;\n"
+        buffer_declaration += "    pico_cnn::naive::SparseMatrix **sparse_kernels;\n"
 
         constructor_code = ""
         #constructor_code += "Network::Network() {\n\n"
@@ -302,6 +658,7 @@ class BackendRep(backend_base.BackendRep):
         num_layers = 0
         num_kernels = 0
         num_biases = 0
+        num_sparse_kernels = 0
 
         for node in graph.nodes:
             """Do not count the reshape layers as the input tensor will only define the dimensions"""
@@ -313,21 +670,36 @@ class BackendRep(backend_base.BackendRep):
                     else:
                         tensor = node.input_tensors[input]
                         buffers_allocated.append(input)
-                        if len(tensor.shape) == 1:
+                        if node.metadata.get('sparse') and input == node.inputs[1]:
+                            num_sparse_kernels += 1
+                        elif len(tensor.shape) == 1 or node.op_type in elementwise_ops:
                             num_biases += 1
                         else:
                             num_kernels += 1
 
+        buffer_declaration += "    // number of elements of kernels, biases and sparse_kernels\n"
+        buffer_declaration += "    static constexpr uint32_t num_kernels = {};\n".format(num_kernels)
+        buffer_declaration += "    static constexpr uint32_t num_biases = {};\n".format(num_biases)
+        buffer_declaration += "    static constexpr uint32_t num_sparse_kernels = {};\n".format(num_sparse_kernels)
+
         """The arrays kernels and biases will be used to pass only two variables to read_binary_weights"""
         constructor_code += "    kernels = new pico_cnn::naive::Tensor*[{}]();\n".format(num_kernels)
-        constructor_code += "    biases = new pico_cnn::naive::Tensor*[{}]();\n\n".format(num_biases)
+        constructor_code += "    biases = new pico_cnn::naive::Tensor*[{}]();\n".format(num_biases)
+        constructor_code += "    sparse_kernels = new pico_cnn::naive::SparseMatrix*[{}]();\n\n".format(num_sparse_kernels)
 
         pos = -1
         pos_kernel = -1
         pos_bias = -1
+        pos_sparse_kernel = -1
 
         buffers_allocated.clear()
 
+        # views are created after all other buffers, as the outputs of the Concat operations are allocated after
+        # their inputs
+        concat_views = self._get_concat_views(graph)
+        self.inplace_outputs = self._get_inplace_outputs(graph, concat_views)
+        view_code = ""
+
         """Iterate over all nodes in the graph and generate the corresponding allocation code."""
         for node_id, node in enumerate(graph.nodes):
 
@@ -351,7 +723,32 @@ class BackendRep(backend_base.BackendRep):
                     buffers_allocated.append(input)
 
                     tensor = node.input_tensors[input]
-                    if len(tensor.shape) == 1:
+                    elementwise = node.op_type in elementwise_ops
+
+                    if node.metadata.get('sparse') and input == node.inputs[1]:
+                        pos_sparse_kernel += 1
+                        buffer = memory_manager.get_buffer(graph, input)
+
+                        buffer_declaration += "    // " + str(buffer.shape) + " sparse\n"
+                        buffer_declaration += "    pico_cnn::naive::SparseMatrix *" + buffer.name + ";\n"
+
+                        constructor_code += "    // " + str(buffer.shape) + " sparse\n"
+
+                        embedded_offsets = None
+                        if self.embed_weights:
+                            matrix = tensor.reshape(tensor.shape[0], -1)
+                            rows, cols = np.nonzero(matrix)
+                            row_offsets = np.concatenate(([0], np.cumsum(np.count_nonzero(matrix, axis=1))))
+                            embedded_offsets = (self._embed(row_offsets, np.uint32), self._embed(cols, np.uint32),
+                                                self._embed(matrix[rows, cols]))
+
+                        functionality = CodeRegistry.get_funct("SparseKernelAllocation")
+                        impl = functionality[0].create(buffer, pos_sparse_kernel, np.count_nonzero(tensor),
+                                                       embedded_offsets)
+                        constructor_code += impl.generate_code() + "\n"
+                        continue
+
+                    if len(tensor.shape) == 1 or elementwise:
                         pos_bias += 1
                     else:
                         pos_kernel += 1
@@ -367,7 +764,8 @@ class BackendRep(backend_base.BackendRep):
                     constructor_code += "    // " + str(buffer.shape) + ""  # TODO maybe we sometimes need \n
 
                     functionality = CodeRegistry.get_funct("KernelAllocation")
-                    impl = functionality[0].create(buffer, pos, pos_kernel, pos_bias)
+                    impl = functionality[0].create(buffer, pos, pos_kernel, pos_bias, elementwise,
+                                                   self._embed(tensor) if self.embed_weights else None)
 
                     if impl:
                         constructor_code += impl.generate_code()
@@ -392,6 +790,23 @@ class BackendRep(backend_base.BackendRep):
 
                 constructor_code += "    // " + str(buffer.shape) + ""  # TODO maybe we sometimes need \n
 
+                if output in concat_views:
+                    constructor_code += " view allocated below\n"
+                    continue
+
+                if output in self.streamed_tensors:
+                    constructor_code += " streamed row by row by line_stream, not allocated\n"
+                    constructor_code += "    {} = nullptr;\n".format(buffer.name)
+                    continue
+
+                if output in self.inplace_outputs:
+                    constructor_code += " shares the buffer of its input\n"
+                    functionality = CodeRegistry.get_funct("AliasAllocation")
+                    impl = functionality[0].create(buffer, memory_manager.get_buffer(graph,
+                                                                                     self.inplace_outputs[output]))
+                    constructor_code += impl.generate_code() + "\n"
+                    continue
+
                 functionality = CodeRegistry.get_funct("OutputAllocation")
                 impl = functionality[0].create(buffer)
 
@@ -402,6 +817,24 @@ class BackendRep(backend_base.BackendRep):
             buffer_declaration += "\n\n"
             constructor_code += "\n\n"
 
+        # nested Concats: the view of an output has to be created before the views of the inputs
+        remaining = list(concat_views)
+        while remaining:
+            for output in list(remaining):
+                parent, first_channel = concat_views[output]
+                if parent in remaining:
+                    continue
+
+                functionality = CodeRegistry.get_funct("ViewAllocation")
+                impl = functionality[0].create(memory_manager.get_buffer(graph, output),
+                                               memory_manager.get_buffer(graph, parent), first_channel)
+                view_code += impl.generate_code() + "\n"
+                remaining.remove(output)
+
+        if view_code:
+            constructor_code += "    // Outputs written in place into the outputs of Concat operations\n"
+            constructor_code += view_code + "\n"
+
         #constructor_code += "}\n"
 
         self.buffer_declaration = buffer_declaration
@@ -424,7 +857,8 @@ class BackendRep(backend_base.BackendRep):
         for num, buffer_id in enumerate(memory_manager.buffers):
             buffer = memory_manager.get_buffer(graph, buffer_id)
 
-            if buffer_id == output_buffer_name:
+            # buffers shared with an input are deleted with it
+            if buffer_id == output_buffer_name or buffer_id in self.inplace_outputs:
                 continue
 
             functionality = CodeRegistry.get_funct("BufferCleanup")
@@ -434,7 +868,7 @@ class BackendRep(backend_base.BackendRep):
                 destructor_code += impl.generate_code()
                 destructor_code += "\n"
 
-        destructor_code += "\n    delete[] kernels;\n    delete[] biases;\n"
+        destructor_code += "\n    delete[] kernels;\n    delete[] biases;\n    delete[] sparse_kernels;\n"
 
         #destructor_code += "}\n"
 
@@ -442,44 +876,795 @@ class BackendRep(backend_base.BackendRep):
 
     def _select_implementations(self, graph, memory_manager):
         """
-        Function to select the first of possibly multiple implementation candidates
-        for a each operation in the ComputeGraph.
-        TODO: In the future this func will be extended to select different implementations (naive/armPerfLibs/openMP)
+        Function to select one of possibly multiple implementation candidates for a each operation in the ComputeGraph.
+        If the tuning cache contains the fastest implementation of an operation on this CPU it is selected. Otherwise
+        operations with multiple candidates are benchmarked if self.autotune is set. In all other cases the first
+        candidate is selected, preferring implementations with shapes fixed at compile time if self.specialize is set.
         :param graph: ComputeGraph of the parsed onnx model.
         :param memory_manager: MemoryManager containing information about input and output buffers of each operation.
         :return: Dictionary containing implementations of all the nodes in the ComputeGraph
         """
+        cache = TuningCache(self.tuning_cache) if self.tuning_cache else None
+
         implementations = {}
+        tuning_tasks = []
         for node in graph.nodes:
+            tuned = cache.lookup(graph, node) if cache else None
+
             choices = []
             for op in OperationRegistry.get_ops(node.op_type):
+                if op.specialized and not (self.specialize or self.autotune or op.name == tuned):
+                    continue
+                # the rows of a LineBufferStream are computed by the generic implementations
+                if op.specialized and node in self.streamed_nodes:
+                    continue
                 candidate = op.create(node, graph, memory_manager)
                 if candidate is not None:
                     choices.append(candidate)
 
+            if tuned is not None:
+                choices.sort(key=lambda candidate: candidate.name != tuned)
+            elif self.autotune and len(choices) > 1:
+                tuning_tasks.append((node, choices))
+            elif self.specialize:
+                choices.sort(key=lambda candidate: not candidate.specialized)
+
             if len(choices) >= 1:
                 implementations[node] = choices[0]
             else:
                 implementations[node] = None
 
+        if tuning_tasks:
+            print("Tuning {} operations".format(len(tuning_tasks)))
+            autotuner = Autotuner(cache if cache else TuningCache("tuning_cache.json"))
+            implementations.update(autotuner.tune(graph, memory_manager, tuning_tasks))
+
         return implementations
 
     def _get_schedule(self, graph, implementations):
         """
-        This is not a real scheduler, for now, just assume the onnx defines a valid schedule.
-        The functions just enumerates all implementations and returns a list.
+        Determine the order in which the operations are executed. Depending on self.schedule either the order of the
+        onnx file is used ("onnx", default) or a topological order minimizing the peak amount of live activation
+        memory is searched ("memory"). The order of the onnx file is kept if the search does not find a better one.
+        Only the execution order changes: the MemoryManager does not reuse buffers yet, so every intermediate tensor
+        keeps its own buffer and the memory allocated by the generated network is the same for both orders. The peak
+        is the memory a network would need if it freed every tensor after its last use.
         :param graph: ComputeGraph of the parsed onnx model.
         :param implementations: Dictionary containing the previously selected
         implementations of all operations in the ComputeGraph.
         :return: List of named tuples ("SchedulerTask", ["time", "node", "implementation"])
         """
         SchedulerTask = namedtuple("SchedulerTask", ["time", "node", "implementation"])
+
+        order = list(range(len(graph.nodes)))
+        if self.schedule == "memory":
+            memory_graph = self._get_memory_graph(graph)
+            onnx_peak = self._get_peak_live_bytes(memory_graph, order)
+            memory_order = self._get_memory_aware_order(memory_graph)
+            memory_peak = self._get_peak_live_bytes(memory_graph, memory_order)
+
+            print("Hypothetical peak live activation memory if buffers were reused: {} bytes (onnx order), "
+                  "{} bytes (memory-aware order)".format(onnx_peak, memory_peak))
+            print("Only the execution order changes, buffers of intermediate tensors are not reused.")
+            if memory_peak < onnx_peak:
+                order = memory_order
+            else:
+                print("Keeping order of the onnx file.")
+        elif self.schedule != "onnx":
+            print("ERROR: Unknown schedule: {}".format(self.schedule))
+            exit(1)
+
         schedule = []
-        for num, node in enumerate(graph.nodes):
+        for num, node_id in enumerate(order):
+            node = graph.nodes[node_id]
             schedule.append(SchedulerTask(num, node, implementations[node]))
 
         return schedule
 
+    def _get_memory_graph(self, graph):
+        """
+        Collect the information needed to track the live activation memory of a schedule. Constant tensors (weights
+        and biases) are ignored as they are live during the whole lifetime of the network anyway.
+        :param graph: ComputeGraph of the parsed onnx model.
+        :return: Named tuple ("MemoryGraph", ["predecessors", "inputs", "outputs", "num_consumers", "size",
+        "initial", "keep"]) where inputs and outputs contain the activations read and written by every node.
+        """
+        MemoryGraph = namedtuple("MemoryGraph", ["predecessors", "inputs", "outputs", "num_consumers",
+                                                 "size", "initial", "keep"])
+
+        producer = {}
+        for node_id, node in enumerate(graph.nodes):
+            for output in node.outputs:
+                producer[output] = node_id
+
+        size = {}
+        num_consumers = {}
+        inputs = []
+        outputs = []
+        predecessors = []
+        for node_id, node in enumerate(graph.nodes):
+            node_inputs = [i for i in dict.fromkeys(node.inputs) if i and i not in node.input_tensors]
+            node_outputs = list(dict.fromkeys(node.outputs))
+            for tensor in node_inputs + node_outputs:
+                # 4 bytes for every fp_t element
+                size[tensor] = reduce_mult(graph.get_shape(tensor)) * 4
+            for tensor in node_inputs:
+                num_consumers[tensor] = num_consumers.get(tensor, 0) + 1
+            inputs.append(node_inputs)
+            outputs.append(node_outputs)
+            predecessors.append(set(producer[i] for i in node_inputs if i in producer and producer[i] != node_id))
+
+        initial = [i.name for i in graph.inputs if i.name in size]
+        keep = set(o.name for o in graph.outputs)
+
+        return MemoryGraph(predecessors, inputs, outputs, num_consumers, size, initial, keep)
+
+    @staticmethod
+    def _execute_for_memory(memory_graph, node_id, live, live_bytes, remaining):
+        """
+        Simulate the execution of a single node.
+        :param memory_graph: MemoryGraph returned by _get_memory_graph().
+        :param node_id: Node to be executed.
+        :param live: Set of live activations before the execution, will be updated.
+        :param live_bytes: Size of all activations in live.
+        :param remaining: Dictionary with the number of consumers of every activation that have not been executed yet,
+        will be updated.
+        :return: Tuple of the number of bytes live during the execution of the node and after it.
+        """
+        size = memory_graph.size
+        for output in memory_graph.outputs[node_id]:
+            if output not in live:
+                live.add(output)
+                live_bytes += size[output]
+        peak_bytes = live_bytes
+
+        for input in memory_graph.inputs[node_id]:
+            remaining[input] -= 1
+        for tensor in memory_graph.inputs[node_id] + memory_graph.outputs[node_id]:
+            if tensor in live and remaining.get(tensor, 0) == 0 and tensor not in memory_graph.keep:
+                live.remove(tensor)
+                live_bytes -= size[tensor]
+
+        return peak_bytes, live_bytes
+
+    def _get_peak_live_bytes(self, memory_graph, order):
+        """
+        :param memory_graph: MemoryGraph returned by _get_memory_graph().
+        :param order: Order in which the nodes are executed.
+        :return: Maximum number of bytes of activations that are live at the same time.
+        """
+        live = set(memory_graph.initial)
+        live_bytes = sum(memory_graph.size[t] for t in live)
+        remaining = dict(memory_graph.num_consumers)
+
+        peak = live_bytes
+        for node_id in order:
+            peak_bytes, live_bytes = self._execute_for_memory(memory_graph, node_id, live, live_bytes, remaining)
+            peak = max(peak, peak_bytes)
+
+        return peak
+
+    def _get_memory_aware_order(self, memory_graph, max_states=20000, lookahead=2):
+        """
+        Search a topological order of the nodes with minimal peak live activation memory.
+        For small graphs all sets of already executed nodes are enumerated (dynamic programming over the downsets of
+        the graph), which yields an optimal order. If the number of states exceeds max_states, a greedy search is used
+        that selects the ready node with the lowest peak memory within the next 'lookahead' steps.
+        :param memory_graph: MemoryGraph returned by _get_memory_graph().
+        :param max_states: Maximum number of states of the dynamic programming search.
+        :param lookahead: Number of steps considered by the greedy search.
+        :return: List of node ids.
+        """
+        order = self._get_optimal_memory_order(memory_graph, max_states)
+        if order is None:
+            print("Graph too large for an exhaustive search, using greedy search with look-ahead {}.".format(lookahead))
+            order = self._get_greedy_memory_order(memory_graph, lookahead)
+
+        return order
+
+    def _get_optimal_memory_order(self, memory_graph, max_states):
+        num_nodes = len(memory_graph.inputs)
+        successors = [[] for _ in range(num_nodes)]
+        for node_id, predecessors in enumerate(memory_graph.predecessors):
+            for predecessor in predecessors:
+                successors[predecessor].append(node_id)
+
+        initial_live = frozenset(memory_graph.initial)
+        initial_bytes = sum(memory_graph.size[t] for t in initial_live)
+
+        # state: frozenset of executed nodes -> (peak, live, live_bytes, remaining, predecessor state, node)
+        states = {frozenset(): (initial_bytes, initial_live, initial_bytes,
+                                dict(memory_graph.num_consumers), None, None)}
+        frontier = [frozenset()]
+        num_states = 1
+
+        for _ in range(num_nodes):
+            next_states = {}
+            for executed in frontier:
+                peak, live, live_bytes, remaining, _, _ = states[executed]
+                for node_id in range(num_nodes):
+                    if node_id in executed or not memory_graph.predecessors[node_id] <= executed:
+                        continue
+                    next_live = set(live)
+                    next_remaining = dict(remaining)
+                    peak_bytes, next_bytes = self._execute_for_memory(memory_graph, node_id, next_live,
+                                                                      live_bytes, next_remaining)
+                    next_peak = max(peak, peak_bytes)
+                    next_executed = executed | {node_id}
+                    if next_executed not in next_states or next_peak < next_states[next_executed][0]:
+                        next_states[next_executed] = (next_peak, frozenset(next_live), next_bytes, next_remaining,
+                                                      executed, node_id)
+            num_states += len(next_states)
+            if num_states > max_states:
+                return None
+            states.update(next_states)
+            frontier = list(next_states.keys())
+
+        order = []
+        executed = frontier[0]
+        while states[executed][4] is not None:
+            order.append(states[executed][5])
+            executed = states[executed][4]
+
+        return list(reversed(order))
+
+    def _get_greedy_memory_order(self, memory_graph, lookahead):
+        num_nodes = len(memory_graph.inputs)
+
+        def ready_nodes(executed):
+            return [n for n in range(num_nodes)
+                    if n not in executed and memory_graph.predecessors[n] <= executed]
+
+        def evaluate(executed, live, live_bytes, remaining, node_id, depth):
+            """Peak and live memory after executing node_id followed by the best choices of the next depth-1 steps."""
+            live = set(live)
+            remaining = dict(remaining)
+            peak_bytes, live_bytes = self._execute_for_memory(memory_graph, node_id, live, live_bytes, remaining)
+            executed = executed | {node_id}
+            candidates = ready_nodes(executed)
+            if depth <= 1 or not candidates:
+                return peak_bytes, live_bytes
+            best = min(evaluate(executed, live, live_bytes, remaining, n, depth - 1) for n in candidates)
+            return max(peak_bytes, best[0]), best[1]
+
+        executed = frozenset()
+        live = set(memory_graph.initial)
+        live_bytes = sum(memory_graph.size[t] for t in live)
+        remaining = dict(memory_graph.num_consumers)
+        order = []
+
+        while len(order) < num_nodes:
+            candidates = ready_nodes(executed)
+            # ties are resolved in favour of the order of the onnx file
+            node_id = min(candidates,
+                          key=lambda n: evaluate(executed, live, live_bytes, remaining, n, lookahead) + (n,))
+            _, live_bytes = self._execute_for_memory(memory_graph, node_id, live, live_bytes, remaining)
+            executed = executed | {node_id}
+            order.append(node_id)
+
+        return order
+
+    def _get_task_dependencies(self, schedule):
+        """
+        Determine which tasks of the schedule have to be finished before another task may start. A task depends on
+        the last task writing one of its inputs (read after write), on all tasks reading a buffer since it was last
+        written if it overwrites this buffer (write after read) and on the last task writing the same buffer
+        (write after write).
+        :param schedule: Previously computed schedule.
+        :return: Dictionary mapping the position of every task in the schedule to a sorted list of the positions
+        of the tasks it depends on.
+        """
+        last_writer = {}
+        readers = {}
+        dependencies = {}
+
+        for num, task in enumerate(schedule):
+            node = task.node
+            depends_on = set()
+
+            for input in node.inputs:
+                if input in last_writer:
+                    depends_on.add(last_writer[input])
+
+            for output in node.outputs:
+                if output in last_writer:
+                    depends_on.add(last_writer[output])
+                depends_on.update(readers.get(output, []))
+
+            for input in node.inputs:
+                readers.setdefault(input, []).append(num)
+
+            for output in node.outputs:
+                last_writer[output] = num
+                readers[output] = []
+
+            depends_on.discard(num)
+            dependencies[num] = sorted(depends_on)
+
+        return dependencies
+
+    def _generate_profiling(self, num, execution_code):
+        """
+        Wrap the execution code of an operation into measuring the hardware performance counters.
+        :param num: Index of the operation in the schedule, which is its index in the LayerProfiler.
+        :param execution_code: Execution code of the operation.
+        :return: Execution code with profiling.
+        """
+        code = "    {\n"
+        # the counters are read on the calling thread only, so the kernels must not split their loops among the
+        # workers of the thread pool
+        code += "        pico_cnn::naive::IntraOpLimit profile_limit(1);\n"
+        code += "        pico_cnn::naive::PerfSample perf_sample = profiler->begin();\n"
+        code += "\n".join("    " + line if line.strip() else line
+                           for line in execution_code.strip("\n").split("\n")) + "\n"
+        code += "        profiler->end({}, perf_sample);\n".format(num)
+        code += "    }\n"
+        return code
+
+    def _generate_task_graph(self, schedule, layer_execution_codes, input_names, output_names):
+        """
+        Generate code that executes the network as a TaskGraph. Every operation becomes a task which is executed as soon
+        as all operations producing its inputs have finished. Independent branches of the network are therefore executed
+        concurrently.
+        :param schedule: Previously computed schedule.
+        :param layer_execution_codes: Execution code of every task of the schedule.
+        :param input_names: Names of the input buffers of the network.
+        :param output_names: Names of the output buffers of the network.
+        :return: Tuple of code for the constructor, the execution and the declaration of the TaskGraph.
+        """
+        dependencies = self._get_task_dependencies(schedule)
+
+        constructor_code = "    // Task graph executing independent operations concurrently\n"
+        constructor_code += "    task_graph = new pico_cnn::naive::TaskGraph();\n"
+        constructor_code += "    uint32_t tasks[{}];\n\n".format(len(schedule))
+
+        for num, task in enumerate(schedule):
+            constructor_code += "    // Task {}: {} {}\n".format(num, task.node.name, task.node.op_type)
+            constructor_code += "    tasks[{}] = task_graph->add_task([this]() {{\n".format(num)
+            constructor_code += "\n".join("    " + line if line.strip() else line
+                                          for line in layer_execution_codes[num].split("\n"))
+            constructor_code += "\n    });\n"
+            for depends_on in dependencies[num]:
+                constructor_code += "    task_graph->add_dependency(tasks[{}], tasks[{}]);\n".format(num, depends_on)
+            constructor_code += "\n"
+
+        constructor_code += "    task_graph->finalize();\n"
+
+        execution_code = ""
+        for name in input_names + output_names:
+            execution_code += "    this->{} = {};\n".format(name, name)
+        execution_code += "\n    task_graph->run();\n"
+
+        declaration_code = "    // Task graph and arguments of Network::run() used by its tasks\n"
+        declaration_code += "    pico_cnn::naive::TaskGraph *task_graph;\n"
+        for name in input_names + output_names:
+            declaration_code += "    pico_cnn::naive::Tensor *{};\n".format(name)
+        declaration_code += "\n"
+
+        return constructor_code, execution_code, declaration_code
+
+    # operations which compute every output row from a band of input rows, see pico_cnn::naive::FusedTileGroup
+    _tileable_operations = ["PicoCNNConv2D", "PicoCNNRelu", "PicoCNNClip", "PicoCNNBatchNorm", "PicoCNNMaxPool2D",
+                            "PicoCNNAveragePool"]
+
+    def _is_band_operation(self, graph, node, impl):
+        """
+        :return: True if impl computes a band of output rows from the band of input rows they depend on, so node can be
+        executed tile by tile (FusedTileGroup) or row by row (LineBufferStream).
+        """
+        if impl is None or impl.name not in self._tileable_operations:
+            return False
+        if len(graph.get_shape(node.inputs[0])) != 4 or len(graph.get_shape(node.outputs[0])) != 4:
+            return False
+        # the zero padding of pooling operations is not restricted to the borders of a band
+        if impl.operator in ["MaxPool", "AveragePool"] and impl.attributes['padding_needed']:
+            return False
+        return True
+
+    def _is_tileable(self, graph, task):
+        if task.node in self.streamed_nodes:
+            return False
+        return self._is_band_operation(graph, task.node, task.implementation)
+
+    def _get_fused_groups(self, graph, schedule):
+        """
+        Find chains of consecutive operations of the schedule which can be executed tile by tile: every operation is a
+        Conv, ReLU, Clip, BatchNormalization or unpadded pooling operation and reads the output of the previous one,
+        which is not used by any other operation. Only chains containing a Conv or pooling operation whose intermediate
+        tensors do not fit into the cache budget are fused.
+        :param graph: ComputeGraph of the parsed onnx model.
+        :param schedule: Previously computed schedule.
+        :return: List of groups, every group is a list of positions in the schedule.
+        """
+        # 0 selects the budget at runtime, chains with smaller tensors fit into the cache of every core
+        cache_bytes = self.tile_cache_kb * 1024 if self.tile_cache_kb > 0 else 256 * 1024
+
+        chains = []
+        chain = []
+        for num, task in enumerate(schedule):
+            if not self._is_tileable(graph, task):
+                if len(chain) > 1:
+                    chains.append(chain)
+                chain = []
+                continue
+
+            if chain:
+                previous = schedule[chain[-1]].node
+                intermediate = previous.outputs[0]
+                if task.node.inputs[0] != intermediate or graph.is_output(intermediate) or \
+                        self._get_consumers(graph, intermediate) != [task.node]:
+                    if len(chain) > 1:
+                        chains.append(chain)
+                    chain = []
+            chain.append(num)
+        if len(chain) > 1:
+            chains.append(chain)
+
+        groups = []
+        for chain in chains:
+            spatial = [num for num in chain if schedule[num].node.op_type in ["Conv", "MaxPool", "AveragePool"]]
+            largest = max(reduce_mult(graph.get_shape(schedule[num].node.outputs[0])) * 4 for num in chain[:-1])
+            if not spatial or largest <= cache_bytes:
+                continue
+            groups.append(chain)
+            print("Tiled execution: {} (largest intermediate tensor {} KiB)".format(
+                " -> ".join(schedule[num].node.name for num in chain), largest // 1024))
+
+        return groups
+
+    def _generate_band_operation(self, graph, task, identifier, scratch_argument):
+        """
+        Generate the call appending the operation of a task to a FusedTileGroup or LineBufferStream.
+        :param graph: ComputeGraph of the parsed onnx model.
+        :param task: Task of the schedule whose operation is a band operation, see _is_band_operation().
+        :param identifier: Name of the group or stream.
+        :param scratch_argument: Pass the scratch memory per output row (FusedTileGroup only).
+        :return: Code of the call.
+        """
+        impl = task.implementation
+        attributes = impl.attributes
+        layer = attributes['identifier'] + "_layer"
+        input_channels = graph.get_shape(task.node.inputs[0])[1]
+        output_shape = graph.get_shape(task.node.outputs[0])
+        kernel_height, stride_height, pad_top, pad_bottom, scratch = 1, 1, 0, 0, 0
+
+        if impl.operator == "Conv":
+            kernel_height, kernel_width = attributes['kernel_shape']
+            stride_height = attributes['stride'][0]
+            pad_top, pad_bottom = attributes['padding'][0], attributes['padding'][2]
+            pointwise = kernel_height == 1 and kernel_width == 1 and list(attributes['stride']) == [1, 1] \
+                and not attributes['padding_needed']
+            if not pointwise:
+                # columns of the im2col of a group per output row
+                scratch = input_channels // attributes['num_groups'] * kernel_height * kernel_width * \
+                    output_shape[3] * 4
+            run_code = "{}->run_rows(input, output, pad_top);".format(layer)
+            pad_names = "uint32_t pad_top, uint32_t"
+        else:
+            if impl.operator in ["MaxPool", "AveragePool"]:
+                kernel_height = attributes['kernel_shape'][0]
+                stride_height = attributes['stride'][0]
+            run_code = "{}->run(input, output);".format(layer)
+            pad_names = "uint32_t, uint32_t"
+
+        arguments = [kernel_height, stride_height, pad_top, pad_bottom, output_shape[1], output_shape[3]]
+        if scratch_argument:
+            arguments.append(scratch)
+
+        code = "    {}->add_operation([this](pico_cnn::naive::Tensor *input, " \
+               "pico_cnn::naive::Tensor *output, {}) {{\n".format(identifier, pad_names)
+        code += "        {}\n".format(run_code)
+        code += "    }}, {});\n".format(", ".join(str(argument) for argument in arguments))
+        return code
+
+    def _generate_fused_tiles(self, graph, schedule, layer_execution_codes):
+        """
+        Generate a FusedTileGroup for every chain found by _get_fused_groups(). The execution code of the first
+        operation of a chain is replaced by running the group, the code of the other operations is removed (their
+        tasks remain, so the positions in the schedule stay valid for task graphs and steps).
+        :param graph: ComputeGraph of the parsed onnx model.
+        :param schedule: Previously computed schedule.
+        :param layer_execution_codes: Execution code of every task of the schedule, modified in place.
+        :return: Tuple of code for the constructor, the declaration and the destructor.
+        """
+        constructor_code = ""
+        declaration_code = ""
+        deletion_code = ""
+
+        for group in self._get_fused_groups(graph, schedule):
+            first = schedule[group[0]]
+            last = schedule[group[-1]]
+            identifier = first.implementation.attributes['identifier'] + "_tiles"
+            input_shape = graph.get_shape(first.node.inputs[0])
+
+            constructor_code += "    // Tiled execution of {}\n".format(", ".join(schedule[num].node.name for num in group))
+            constructor_code += "    {} = new pico_cnn::naive::FusedTileGroup(\"{}\", {}, {}, {}, {});\n".format(
+                identifier, first.node.name + ".." + last.node.name, *input_shape)
+
+            for num in group:
+                constructor_code += self._generate_band_operation(graph, schedule[num], identifier, True)
+
+            constructor_code += "    {}->finalize({});\n\n".format(identifier, self.tile_cache_kb * 1024)
+            declaration_code += "    pico_cnn::naive::FusedTileGroup *{};\n".format(identifier)
+            deletion_code += "    delete {};\n".format(identifier)
+
+            execution_code = "    {}->run({}, {});\n".format(identifier, first.implementation.attributes['input_buffer'].name,
+                                                             last.implementation.attributes['output_buffer'].name)
+            if self.profile:
+                execution_code = self._generate_profiling(group[0], execution_code)
+            layer_execution_codes[group[0]] = execution_code
+            for num in group[1:]:
+                layer_execution_codes[num] = ""
+
+        return constructor_code, declaration_code, deletion_code
+
+    def _get_streamed_prefix(self, graph):
+        """
+        Find the chain of operations starting at the input of the network which can be executed row by row by a
+        LineBufferStream: every operation is a band operation (see _is_band_operation()) and reads the output of the
+        previous one, which is not used by any other operation. The chain ends at the output of the network or before
+        the first operation which can not be streamed. Streamed operations always use their generic implementation.
+        :param graph: ComputeGraph of the parsed onnx model.
+        :return: List of the nodes of the chain.
+        """
+        # the implementations are only created to check them, their buffers must not be allocated by the network
+        memory_manager = MemoryManager()
+
+        prefix = []
+        edge = graph.inputs[0].name
+        while not graph.is_output(edge):
+            consumers = self._get_consumers(graph, edge)
+            if len(consumers) != 1 or consumers[0].inputs[0] != edge:
+                break
+            node = consumers[0]
+
+            impl = None
+            for op in OperationRegistry.get_ops(node.op_type):
+                if not op.specialized:
+                    impl = op.create(node, graph, memory_manager)
+                    if impl is not None:
+                        break
+            if not self._is_band_operation(graph, node, impl):
+                break
+
+            prefix.append(node)
+            edge = node.outputs[0]
+
+        return prefix
+
+    def _generate_line_buffer_stream(self, graph, schedule, layer_execution_codes):
+        """
+        Generate the LineBufferStream of the operations found by _get_streamed_prefix(). Like a FusedTileGroup, the
+        execution code of the first operation is replaced by streaming the input through all of them and the code of
+        the other operations is removed.
+        :param graph: ComputeGraph of the parsed onnx model.
+        :param schedule: Previously computed schedule.
+        :param layer_execution_codes: Execution code of every task of the schedule, modified in place.
+        :return: Tuple of code for the constructor, the declaration and the destructor.
+        """
+        positions = [num for num, task in enumerate(schedule) if task.node in self.streamed_nodes]
+        first = schedule[positions[0]]
+        last = schedule[positions[-1]]
+        input_shape = graph.get_shape(first.node.inputs[0])
+
+        constructor_code = "    // Row by row execution of {}\n".format(
+            ", ".join(schedule[num].node.name for num in positions))
+        constructor_code += "    line_stream = new pico_cnn::naive::LineBufferStream(\"{}\", {}, {}, {});\n".format(
+            first.node.name + ".." + last.node.name, input_shape[0], input_shape[1], input_shape[3])
+        for num in positions:
+            constructor_code += self._generate_band_operation(graph, schedule[num], "line_stream", False)
+        constructor_code += "    line_stream->finalize();\n\n"
+
+        declaration_code = "    // Row by row execution of the operations from the input up to {}, rows can be fed incrementally with\n" \
+                           "    // begin(), push_rows() and finish(), see pico_cnn::naive::LineBufferStream\n".format(last.node.name)
+        declaration_code += "    pico_cnn::naive::LineBufferStream *line_stream;\n"
+        deletion_code = "    delete line_stream;\n"
+
+        execution_code = "    line_stream->run({}, {});\n".format(first.implementation.attributes['input_buffer'].name,
+                                                                  last.implementation.attributes['output_buffer'].name)
+        if self.profile:
+            execution_code = self._generate_profiling(positions[0], execution_code)
+        layer_execution_codes[positions[0]] = execution_code
+        for num in positions[1:]:
+            layer_execution_codes[num] = ""
+
+        return constructor_code, declaration_code, deletion_code
+
+    def _generate_steps(self, layer_execution_codes, input_defs, output_defs, input_names, output_names):
+        """
+        Generate a method executing a single operation of the schedule, so a scheduler can interleave the runs of
+        several networks at operation boundaries, and a method submitting a whole run to a DeadlineScheduler. The
+        operations are executed in the order of the schedule, also if the network is executed as a task graph.
+        :param layer_execution_codes: Execution code of every task of the schedule.
+        :param input_defs: Parameter declarations of the inputs of Network::run().
+        :param output_defs: Parameter declarations of the outputs of Network::run().
+        :param input_names: Names of the input buffers of the network.
+        :param output_names: Names of the output buffers of the network.
+        :return: Code of both methods.
+        """
+        step_code = "void Network::run_step(" + ", ".join(input_defs + output_defs) + ", uint32_t step) {\n"
+        step_code += "    switch(step) {\n"
+        for num, execution_code in enumerate(layer_execution_codes):
+            step_code += "    case {}: {{\n".format(num)
+            step_code += "\n".join("    " + line if line.strip() else line
+                                   for line in execution_code.strip("\n").split("\n"))
+            step_code += "\n        break;\n"
+            step_code += "    }\n"
+        step_code += "    default:\n"
+        step_code += "        PRINT_ERROR_AND_DIE(\"Network has no step \" << step)\n"
+        step_code += "    }\n"
+        step_code += "}\n\n"
+
+        step_code += "std::shared_future<pico_cnn::naive::RequestReport> Network::run_scheduled(" + \
+                     ", ".join(["pico_cnn::naive::DeadlineScheduler *scheduler"] + input_defs + output_defs) + \
+                     ", pico_cnn::naive::DeadlineScheduler::Clock::time_point deadline, int32_t priority) {\n"
+        step_code += "    return scheduler->submit([=](uint32_t step) {{ run_step({}, step); }}, num_steps, this, " \
+                     "deadline, priority);\n".format(", ".join(input_names + output_names))
+        step_code += "}\n\n"
+
+        return step_code
+
+    def _estimate_cost(self, graph, node):
+        """
+        Rough estimate of the computational cost of an operation (number of multiply-accumulate operations for
+        convolutions and fully connected layers, number of touched elements otherwise).
+        :param graph: ComputeGraph of the parsed onnx model.
+        :param node: ComputeNode of the operation.
+        :return: Estimated cost.
+        """
+        output_elements = sum(reduce_mult(graph.get_shape(o)) for o in node.outputs)
+        weights = [t for t in node.input_tensors.values() if len(t.shape) >= 2]
+
+        if node.op_type == "Conv" and weights:
+            return output_elements * reduce_mult(weights[0].shape[1:])
+        elif node.op_type in ["Gemm", "MatMul"] and weights:
+            return reduce_mult(weights[0].shape)
+        elif node.op_type in ["MaxPool", "AveragePool"] and "kernel_shape" in node.attrs:
+            return output_elements * reduce_mult(node.attrs["kernel_shape"])
+
+        input_elements = sum(reduce_mult(graph.get_shape(i)) for i in node.inputs if i not in node.input_tensors)
+        return input_elements + output_elements
+
+    def _get_pipeline_stages(self, graph, schedule, num_stages):
+        """
+        Partition the schedule into at most num_stages consecutive stages with balanced estimated cost. Stages can only
+        be separated at positions where exactly one activation is passed from the operations before to the operations
+        after the cut, so that each stage consumes and produces a single tensor.
+        :param graph: ComputeGraph of the parsed onnx model.
+        :param schedule: Previously computed schedule.
+        :param num_stages: Requested number of stages.
+        :return: List of tuples (first task, last task, input tensor, output tensor, cost) for every stage.
+        """
+        num_tasks = len(schedule)
+        costs = [self._estimate_cost(graph, task.node) for task in schedule]
+
+        produced = {}
+        last_use = {}
+        for i in graph.inputs:
+            produced[i.name] = -1
+        for num, task in enumerate(schedule):
+            for input in task.node.inputs:
+                if input not in task.node.input_tensors:
+                    last_use[input] = num
+            for output in task.node.outputs:
+                produced[output] = num
+        for o in graph.outputs:
+            last_use[o.name] = num_tasks
+
+        # cuts[k] = (position of the last task before the cut, tensor passed over the cut)
+        cuts = []
+        for position in range(num_tasks - 1):
+            crossing = [t for t in produced if produced[t] <= position < last_use.get(t, -1)]
+            if len(crossing) == 1 and produced[crossing[0]] >= 0:
+                cuts.append((position, crossing[0]))
+
+        if len(cuts) < num_stages - 1:
+            print("Warning: Only {} pipeline stages are possible for this network.".format(len(cuts) + 1))
+            num_stages = len(cuts) + 1
+
+        prefix_cost = [0]
+        for cost in costs:
+            prefix_cost.append(prefix_cost[-1] + cost)
+
+        def stage_cost(first, last):
+            return prefix_cost[last + 1] - prefix_cost[first]
+
+        # boundaries: -1 (start), positions of all cuts, num_tasks - 1 (end)
+        boundaries = [-1] + [position for position, _ in cuts] + [num_tasks - 1]
+
+        # best[k][b]: minimal maximum stage cost of splitting the tasks up to boundary b into k stages
+        infinity = float("inf")
+        best = [[infinity] * len(boundaries) for _ in range(num_stages + 1)]
+        previous = [[None] * len(boundaries) for _ in range(num_stages + 1)]
+        best[0][0] = 0
+        for k in range(1, num_stages + 1):
+            for b in range(1, len(boundaries)):
+                for a in range(b):
+                    if best[k - 1][a] == infinity:
+                        continue
+                    candidate = max(best[k - 1][a], stage_cost(boundaries[a] + 1, boundaries[b]))
+                    if candidate < best[k][b]:
+                        best[k][b] = candidate
+                        previous[k][b] = a
+
+        selected = []
+        b = len(boundaries) - 1
+        for k in range(num_stages, 0, -1):
+            selected.append(b)
+            b = previous[k][b]
+        selected = list(reversed(selected))
+
+        tensors = {position: tensor for position, tensor in cuts}
+        input_name = graph.inputs[0].name
+        output_name = graph.outputs[0].name
+
+        stages = []
+        first = 0
+        for b in selected:
+            last = boundaries[b]
+            stage_input = input_name if first == 0 else tensors[first - 1]
+            stage_output = output_name if last == num_tasks - 1 else tensors[last]
+            stages.append((first, last, stage_input, stage_output, stage_cost(first, last)))
+            first = last + 1
+
+        total_cost = max(prefix_cost[-1], 1)
+        for num, (first, last, stage_input, stage_output, cost) in enumerate(stages):
+            print("Pipeline stage {}: {} ({}) to {} ({}), estimated cost {} ({:.1f} %)".format(
+                num, schedule[first].node.name, first, schedule[last].node.name, last, cost,
+                100.0 * cost / total_cost))
+
+        return stages
+
+    def _generate_pipeline(self, graph, schedule, layer_execution_codes, memory_manager):
+        """
+        Generate one method per pipeline stage executing the operations of this stage and a method creating a
+        pico_cnn::naive::Pipeline from them. The parameters of the stage methods have the names of the buffers
+        passed between the stages, so the execution code of the operations can be used unchanged.
+        :param graph: ComputeGraph of the parsed onnx model.
+        :param schedule: Previously computed schedule.
+        :param layer_execution_codes: Execution code of every task of the schedule.
+        :param memory_manager: MemoryManager containing information about input and output buffers of each operation.
+        :return: Tuple of code for network.cpp and the declarations for network.h.
+        """
+        stages = self._get_pipeline_stages(graph, schedule, self.pipeline_stages)
+
+        def allocator(tensor):
+            shape = ", ".join(str(d) for d in graph.get_shape(tensor))
+            return "[]() {{ return new pico_cnn::naive::Tensor({}); }}".format(shape)
+
+        pipeline_code = ""
+        create_code = "pico_cnn::naive::Pipeline *Network::create_pipeline(uint32_t depth, int32_t first_core) {\n"
+        create_code += "    auto pipeline = new pico_cnn::naive::Pipeline({}, depth, first_core);\n\n".format(
+            allocator(stages[0][2]))
+
+        declaration_code = "    // Pipelined execution, every stage processes a different frame at the same time\n"
+        declaration_code += "    static const uint32_t num_pipeline_stages = {};\n".format(len(stages))
+        declaration_code += "    pico_cnn::naive::Pipeline *create_pipeline(uint32_t depth = 4, int32_t first_core = 0);\n"
+
+        for num, (first, last, stage_input, stage_output, cost) in enumerate(stages):
+            input_buffer = memory_manager.get_buffer(graph, stage_input)
+            output_buffer = memory_manager.get_buffer(graph, stage_output)
+            stage_def = "run_stage_{}(pico_cnn::naive::Tensor *{}, pico_cnn::naive::Tensor *{})".format(
+                num, input_buffer.name, output_buffer.name)
+
+            declaration_code += "    void " + stage_def + ";\n"
+
+            pipeline_code += "void Network::" + stage_def + " {\n"
+            for position in range(first, last + 1):
+                pipeline_code += layer_execution_codes[position] + "\n"
+            pipeline_code += "}\n\n"
+
+            create_code += "    // Stage {}: {} to {}, estimated cost {}\n".format(
+                num, schedule[first].node.name, schedule[last].node.name, cost)
+            create_code += "    pipeline->add_stage([this](pico_cnn::naive::Tensor *input, " \
+                           "pico_cnn::naive::Tensor *output) {{ run_stage_{}(input, output); }},\n".format(num)
+            create_code += "                        {});\n".format(allocator(stage_output))
+
+        create_code += "\n    return pipeline;\n}\n\n"
+        declaration_code += "\n"
+
+        return pipeline_code + create_code, declaration_code
+
     def _print_live_ranges(self, schedule):
         """
         Calculate Live Ranges and print them. For debug purposes.
@@ -541,6 +1726,11 @@ class BackendRep(backend_base.BackendRep):
             elif res.shape is not None:
                 graph.shape_dict[var] = res.shape
 
+        self._propagate_layouts(graph)
+        self._select_sparse_kernels(graph)
+
+        self._select_sparse_inputs(graph)
+
         print("Inference graph:")
         for node in graph.nodes:
             inputs = node.inputs
@@ -556,6 +1746,19 @@ class BackendRep(backend_base.BackendRep):
 
         memory_manager = MemoryManager()
 
+        if self.stream and self.pipeline_stages > 0:
+            print("Warning: Streaming execution is not available for pipelined networks, the operations run on whole "
+                  "tensors.")
+        elif self.stream:
+            self.streamed_nodes = self._get_streamed_prefix(graph)
+            self.streamed_tensors = set(node.outputs[0] for node in self.streamed_nodes[:-1])
+            if self.streamed_nodes:
+                print("Streaming execution: {} ({} KiB of intermediate tensors not allocated)".format(
+                    " -> ".join(node.name for node in self.streamed_nodes),
+                    sum(reduce_mult(graph.get_shape(tensor)) * 4 for tensor in self.streamed_tensors) // 1024))
+            else:
+                print("Warning: The first operation of the network can not be streamed.")
+
         self._generate_weights_file(graph)
 
         self.dummy_input = generate_dummy_main(graph)
@@ -623,10 +1826,23 @@ class BackendRep(backend_base.BackendRep):
         network_def = "void Network::run(" + ", ".join(input_defs) + ", " + ", ".join(output_defs) + ")"
         network_def_header = "void run(" + ", ".join(input_defs) + ", " + ", ".join(output_defs) + ")"
 
+        # Runs of the network queued on the worker pool, the tensors are captured by value
+        async_callback_def = "std::function<void(pico_cnn::naive::RunStatus)> callback"
+        async_def = "std::shared_ptr<pico_cnn::naive::AsyncRun> Network::run_async(" + \
+                    ", ".join(input_defs + output_defs) + ", " + async_callback_def + ")"
+        async_def_header = "std::shared_ptr<pico_cnn::naive::AsyncRun> run_async(" + \
+                           ", ".join(input_defs + output_defs) + ", " + async_callback_def + " = nullptr)"
+        async_code = async_def + " {\n"
+        async_code += "    return async_runner->submit([=]() {{ run({}); }}, callback);\n".format(
+            ", ".join(input_names + output_names))
+        async_code += "}\n\n"
+
         layer_declaration_code = ""
         layer_allocation_code = ""
         layer_execution_code = ""
+        layer_execution_codes = []
         layer_deletion_code = ""
+        profiler_code = ""
 
         """Iterate over all tasks in the schedule, put some debug info in the code and the pico-cnn implementation."""
         for task in schedule:
@@ -651,7 +1867,13 @@ class BackendRep(backend_base.BackendRep):
                 layer_allocation_code += impl.generate_allocation()
                 layer_allocation_code += "\n"
 
-                layer_execution_code += impl.generate_execution()
+                execution_code = impl.generate_execution()
+                if self.profile:
+                    execution_code = self._generate_profiling(len(layer_execution_codes), execution_code)
+                    profiler_code += "    profiler->add_layer(\"{}\", \"{}\");\n".format(
+                        node.name.replace('"', '\\"'), node.op_type)
+                layer_execution_codes.append(execution_code)
+                layer_execution_code += layer_execution_codes[-1]
                 layer_execution_code += "\n"
 
                 layer_deletion_code += impl.generate_deletion()
@@ -664,6 +1886,50 @@ class BackendRep(backend_base.BackendRep):
         self.constructor_code += layer_allocation_code + "\n"
         self.destructor_code += layer_deletion_code + "\n"
 
+        if self.streamed_nodes:
+            stream_constructor_code, stream_declaration_code, stream_deletion_code = \
+                self._generate_line_buffer_stream(graph, schedule, layer_execution_codes)
+            self.constructor_code += stream_constructor_code
+            self.destructor_code += stream_deletion_code
+            self.buffer_declaration += stream_declaration_code
+            layer_execution_code = "".join(code + "\n" for code in layer_execution_codes)
+
+        if self.tile and self.pipeline_stages > 0:
+            print("Warning: Tiled execution is not available for pipelined networks, the operations run untiled.")
+        elif self.tile:
+            tile_constructor_code, tile_declaration_code, tile_deletion_code = \
+                self._generate_fused_tiles(graph, schedule, layer_execution_codes)
+            self.constructor_code += tile_constructor_code
+            self.destructor_code += tile_deletion_code
+            self.buffer_declaration += tile_declaration_code
+            layer_execution_code = "".join(code + "\n" for code in layer_execution_codes)
+
+        step_code = self._generate_steps(layer_execution_codes, input_defs, output_defs, input_names, output_names)
+
+        if self.profile:
+            self.constructor_code += "    // Hardware performance counters of every operation\n"
+            self.constructor_code += "    profiler = new pico_cnn::naive::LayerProfiler();\n"
+            self.constructor_code += profiler_code + "\n"
+            # The statistics are aggregated across all runs of the network
+            self.destructor_code += "    profiler->print();\n"
+            self.destructor_code += "    delete profiler;\n"
+            self.buffer_declaration += "    pico_cnn::naive::LayerProfiler *profiler;\n"
+
+        if self.parallel:
+            task_graph_constructor_code, layer_execution_code, task_graph_declaration_code = \
+                self._generate_task_graph(schedule, layer_execution_codes, input_names, output_names)
+            self.constructor_code += task_graph_constructor_code
+            # The tasks use the layers, so the task graph has to be stopped first
+            self.destructor_code = "    delete task_graph;\n\n" + self.destructor_code
+            self.buffer_declaration += task_graph_declaration_code
+
+        pipeline_code = ""
+        pipeline_declaration_code = ""
+        if self.pipeline_stages > 0:
+            pipeline_code, pipeline_declaration_code = \
+                self._generate_pipeline(graph, schedule, layer_execution_codes, memory_manager)
+            self.pipeline_input = generate_pipeline_main(graph)
+
         # # TODO: What does this loop do?
         # for id, buffer in memory_manager.buffers.items():
         #     if graph.is_tensor(id):
@@ -673,6 +1939,12 @@ class BackendRep(backend_base.BackendRep):
         #     if graph.is_output(id):
         #         continue
 
+        self.constructor_code += "    // Executes the runs submitted with run_async(), the thread pool is started by the first one\n"
+        self.constructor_code += "    async_runner = new pico_cnn::naive::AsyncRunner();\n"
+        # Runs still queued use the layers, so they are cancelled (or finished) first
+        self.destructor_code = "    delete async_runner;\n\n" + self.destructor_code
+        self.buffer_declaration += "    pico_cnn::naive::AsyncRunner *async_runner;\n"
+
         network_code: Text = "#include \"network.h\"\n\n"
         network_code += "Network::Network() {\n\n"
         network_code += self.constructor_code + "\n"
@@ -684,15 +1956,35 @@ class BackendRep(backend_base.BackendRep):
         network_code += layer_execution_code
 
         network_code += "}\n\n"
+        network_code += async_code
+        network_code += step_code
+        network_code += pipeline_code
 
         network_header = "#ifndef NETWORK_H\n"
         network_header += "#define NETWORK_H\n\n"
         network_header += "#include \"pico-cnn/pico-cnn.h\"\n\n"
+        if self.embed_weights:
+            network_header += "// kernels and biases are embedded in the binary, read_binary_weights() is not needed\n"
+            network_header += "#define NETWORK_EMBEDDED_WEIGHTS\n"
+            network_header += "extern \"C\" const uint32_t network_weights[];\n\n"
         network_header += "class Network {\n"
         network_header += "public:\n"
         network_header += "Network();\n"
         network_header += "~Network();\n"
         network_header += network_def_header + "; \n\n"
+        network_header += "/**\n"
+        network_header += " * Queues a run on the worker pool and returns immediately, runs are executed one after another. The\n"
+        network_header += " * tensors must not be touched until the run has finished, see pico_cnn::naive::AsyncRunner.\n"
+        network_header += " */\n"
+        network_header += async_def_header + ";\n\n"
+        network_header += "// Execution of run() as resumable steps, one operation per step, see pico_cnn::naive::DeadlineScheduler\n"
+        network_header += "static const uint32_t num_steps = {};\n".format(len(layer_execution_codes))
+        network_header += "void run_step(" + ", ".join(input_defs + output_defs) + ", uint32_t step);\n"
+        network_header += "std::shared_future<pico_cnn::naive::RequestReport> run_scheduled(" + \
+                          ", ".join(["pico_cnn::naive::DeadlineScheduler *scheduler"] + input_defs + output_defs) + \
+                          ", pico_cnn::naive::DeadlineScheduler::Clock::time_point deadline" \
+                          " = pico_cnn::naive::DeadlineScheduler::Clock::time_point::max(), int32_t priority = 0);\n\n"
+        network_header += pipeline_declaration_code
         network_header += self.buffer_declaration + "\n"
         network_header += layer_declaration_code
         network_header += "};\n"
@@ -707,11 +1999,19 @@ class BackendRep(backend_base.BackendRep):
         """
         # TODO: Does this need to be more sophisticated?
         self.makefile = "CC = g++\n"
-        self.makefile += "CFLAGS = -std=c++11 -Wall -O2 -march=native -DINFO\n"
+        # The specialized kernels rely on the vectorizer, which -O2 only applies to very simple loops
+        specialized = any(impl is not None and impl.specialized for impl in implementations.values())
+        self.makefile += "CFLAGS = -std=c++11 -Wall {} -march=native -DINFO -pthread\n".format(
+            "-O3" if specialized else "-O2")
         self.makefile += "LDFLAGS = -L../../../pico-cnn\n"
-        self.makefile += "LD_LIBS = -lpico-cnn -lm\n\n"
+        self.makefile += "LD_LIBS = -lpico-cnn -lm -lrt -pthread\n\n"
+        self.makefile += "# set when pico-cnn is built with the CBLAS GEMM provider (make CBLAS=1)\n"
+        self.makefile += "CBLAS_LIBS ?= -lopenblas\n"
+        self.makefile += "ifdef CBLAS\nLD_LIBS += $(CBLAS_LIBS)\nendif\n\n"
         self.makefile += "# list of all generated .cpp files.\n"
         self.makefile += "NETWORK_LIST = network.cpp"
+        if self.embed_weights:
+            self.makefile += " network_weights.S" if self.embed_weights == "incbin" else " network_weights.cpp"
         self.makefile += "\n\ndummy_input: dummy_input.cpp $(NETWORK_LIST) libpico-cnn.a\n\t"
         self.makefile += "$(CC) dummy_input.cpp $(NETWORK_LIST) -I../../.. $(CFLAGS) $(LDFLAGS) $(LD_LIBS) -o dummy_input"
         self.makefile += "\n\nreference_input: reference_input.cpp $(NETWORK_LIST) libpico-cnn.a\n\t"
@@ -720,9 +2020,20 @@ class BackendRep(backend_base.BackendRep):
         self.makefile += "\n\n{}: {}.cpp $(NETWORK_LIST) libpico-cnn.a\n\t".format(self.model_name, self.model_name)
         self.makefile += "$(CC) {}.cpp $(NETWORK_LIST) -I../../.. $(CFLAGS) " \
                          "$(LDFLAGS) $(LD_LIBS) -o {}".format(self.model_name, self.model_name)
+        self.makefile += "\n\n# ./count_allocations fails if a run after the first one allocates memory on the heap"
+        self.makefile += "\n# the allocation counter replaces the global operator new, so it is not part of libpico-cnn.a"
+        self.makefile += "\nALLOCATION_COUNTER_SRC = ../../../pico-cnn/runtime/allocation_counter.cpp"
+        self.makefile += "\ncount_allocations: dummy_input.cpp $(NETWORK_LIST) $(ALLOCATION_COUNTER_SRC) " \
+                         "libpico-cnn.a\n\t"
+        self.makefile += "$(CC) dummy_input.cpp $(NETWORK_LIST) $(ALLOCATION_COUNTER_SRC) -I../../.. $(CFLAGS) " \
+                         "-DCOUNT_ALLOCATIONS $(LDFLAGS) $(LD_LIBS) -o count_allocations"
+        if self.pipeline_input:
+            self.makefile += "\n\npipeline_input: pipeline_input.cpp $(NETWORK_LIST) libpico-cnn.a\n\t"
+            self.makefile += "$(CC) pipeline_input.cpp $(NETWORK_LIST) -I../../.. $(CFLAGS) " \
+                             "$(LDFLAGS) $(LD_LIBS) -o pipeline_input"
         self.makefile += "\n\nall: dummy_input reference_input {}".format(self.model_name)
         self.makefile += "\n\n.PHONY: clean\n"
-        self.makefile += "clean:\n\trm -rf {} dummy_input reference_input\n".format(self.model_name)
+        self.makefile += "clean:\n\trm -rf {} dummy_input reference_input pipeline_input count_allocations\n".format(self.model_name)
         self.makefile += "\n\n.PHONY: libpico-cnn.a\n"
         self.makefile += "libpico-cnn.a:\n\t$(MAKE) -C ../../../pico-cnn"
 
@@ -762,6 +2073,14 @@ class BackendRep(backend_base.BackendRep):
             for packed_struct in self.packed_file:
                 f.write(packed_struct)
 
+        if self.embed_weights:
+            source_file, code, raw = self._generate_embedded_weights()
+            with open(os.path.join(folder, source_file), "w") as f:
+                f.write(code)
+            if raw is not None:
+                with open(os.path.join(folder, "network.weights.raw"), "wb") as f:
+                    f.write(raw)
+
         with open(os.path.join(folder, "Makefile"), "w") as f:
             f.write(self.makefile)
 
@@ -771,6 +2090,10 @@ class BackendRep(backend_base.BackendRep):
         with open(os.path.join(folder, "reference_input.cpp"), "w") as f:
             f.write(self.reference_input)
 
+        if self.pipeline_input:
+            with open(os.path.join(folder, "pipeline_input.cpp"), "w") as f:
+                f.write(self.pipeline_input)
+
 
 class Backend(object):
     @classmethod
@@ -783,7 +2106,7 @@ class Backend(object):
         # TODO Remove Optional from return type
         onnx.checker.check_model(model)
 
-        rep = BackendRep(model, model_name)
+        rep = BackendRep(model, model_name, **kwargs)
 
         return rep
 
@@ -0,0 +1 @@
+    {{identifier}}_layer = new pico_cnn::naive::ParameterizedReLU("{{name}}", 0, pico_cnn::op_type::ParamReLU, {{slope_buffer.name}});
@@ -0,0 +1 @@
+    pico_cnn::naive::ParameterizedReLU *{{identifier}}_layer;
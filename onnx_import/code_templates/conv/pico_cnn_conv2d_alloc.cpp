@@ -10,6 +10,9 @@
                                                    {% else %}
                                                    nullptr,
                                                    {% endif %}
+                                                   {% if sparse %}
+                                                   {{kernel_shape.0}}, {{kernel_shape.1}},
+                                                   {% endif %}
                                                    {{identifier}}_padding, {{identifier}}_stride, {{identifier}}_groups);
 {% else %}
     uint32_t {{identifier}}_stride[2] = { {{stride.0}}, {{stride.1}} };
@@ -22,6 +25,9 @@
                                                    {% else %}
                                                    nullptr,
                                                    {% endif %}
+                                                   {% if sparse %}
+                                                   {{kernel_shape.0}}, {{kernel_shape.1}},
+                                                   {% endif %}
                                                    nullptr, {{identifier}}_stride, {{identifier}}_groups);
 {% endif %}
 
@@ -0,0 +1,7 @@
+    {{identifier}}_layer = new {{layer_type}}("{{name}}", 0, pico_cnn::op_type::Conv,
+                                                   {{kernel.name}},
+                                                   {% if bias_buffer %}
+                                                   {{bias_buffer.name}});
+                                                   {% else %}
+                                                   nullptr);
+                                                   {% endif %}
@@ -1,5 +1,5 @@
 {% if bias_buffer %}
-    {{identifier}}_layer = new pico_cnn::naive::FullyConnected("{{name}}", 0, pico_cnn::op_type::Gemm, {{weight_buffer.name}}, {{bias_buffer.name}});
+    {{identifier}}_layer = new pico_cnn::naive::FullyConnected("{{name}}", 0, pico_cnn::op_type::Gemm, {{weight_buffer.name}}, {{bias_buffer.name}}{% if sparse_input %}, true{% endif %});
 {% else %}
-    {{identifier}}_layer = new pico_cnn::naive::FullyConnected("{{name}}", 0, pico_cnn::op_type::Gemm, {{weight_buffer.name}}, nullptr);
+    {{identifier}}_layer = new pico_cnn::naive::FullyConnected("{{name}}", 0, pico_cnn::op_type::Gemm, {{weight_buffer.name}}, nullptr{% if sparse_input %}, true{% endif %});
 {% endif %}
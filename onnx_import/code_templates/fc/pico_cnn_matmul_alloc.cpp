@@ -1,2 +1,2 @@
 
-    {{identifier}}_layer = new pico_cnn::naive::MatMul("{{name}}", 0, pico_cnn::op_type::MatMul, {{weight_buffer.name}});
+    {{identifier}}_layer = new pico_cnn::naive::MatMul("{{name}}", 0, pico_cnn::op_type::MatMul, {{weight_buffer.name}}, {{transpose_input}}, {{transpose_output}}, {{sparse_input}});
@@ -1,12 +1,18 @@
 #define LOWER_BOUND 0.0
 #define UPPER_BOUND 1.0
 
+#include <chrono>
 #include <cstdlib>
 #include <ctime>
 
 #include "pico-cnn/pico-cnn.h"
 #include "network.h"
 
+#ifdef COUNT_ALLOCATIONS
+// every run after the first one has to be free of heap allocations
+#include "pico-cnn/runtime/allocation_counter.h"
+#endif
+
 void usage() {
     printf("./dummy_input PATH_TO_BINARY_WEIGHTS_FILE RUNS GENERATE_ONCE\n");
 }
@@ -63,15 +69,36 @@ int32_t main(int32_t argc, char** argv) {
 
     Network *net = new Network();
 
-    PRINT_INFO("Reading weights from " << weights_path)
+#ifdef NETWORK_EMBEDDED_WEIGHTS
+    PRINT_INFO("Using the weights embedded in the binary, ignoring " << weights_path)
+#else
+    // processes started with the same segment name share one copy of the weights
+    const char *shared_weights = std::getenv("PICO_CNN_SHARED_WEIGHTS");
+    if(shared_weights) {
+        if(read_shared_weights(weights_path, shared_weights, net->kernels, Network::num_kernels, net->biases,
+                               Network::num_biases, net->sparse_kernels, Network::num_sparse_kernels) != 0) {
+            PRINT_ERROR("Could not use shared weights " << shared_weights)
+            return 1;
+        }
+    } else {
+        PRINT_INFO("Reading weights from " << weights_path)
 
-    if(read_binary_weights(weights_path, &net->kernels, &net->biases) != 0){
-        PRINT_ERROR("could not read weights from " << weights_path)
-        return 1;
+        if(read_binary_weights(weights_path, &net->kernels, &net->biases, &net->sparse_kernels) != 0){
+            PRINT_ERROR("could not read weights from " << weights_path)
+            return 1;
+        }
     }
+#endif
 
     PRINT_INFO("Starting CNN for " << RUNS << " runs...")
 
+#ifdef COUNT_ALLOCATIONS
+    uint64_t steady_state_allocations = 0;
+#endif
+    // the first run pays for page faults and lazily allocated buffers, see PICO_CNN_TENSOR_MEMORY
+    double first_run_ms = 0;
+    double steady_state_ms = 0;
+
     for(uint32_t run = 0; run < RUNS; run++) {
 
         PRINT_DEBUG("Run " << run+1 << " of " << RUNS)
@@ -83,16 +110,46 @@ int32_t main(int32_t argc, char** argv) {
                 input_tensor->access_blob(element) = urand(LOWER_BOUND, UPPER_BOUND);
             }
         }
+#ifdef COUNT_ALLOCATIONS
+        uint64_t allocations = pico_cnn::naive::num_allocations();
+#endif
+        auto start = std::chrono::steady_clock::now();
         net->run(input_tensor, output_tensor);
+        double run_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if(run == 0) {
+            first_run_ms = run_ms;
+        } else {
+            steady_state_ms += run_ms;
+        }
+#ifdef COUNT_ALLOCATIONS
+        allocations = pico_cnn::naive::num_allocations() - allocations;
+        PRINT_INFO("Run " << run+1 << ": " << allocations << " heap allocations")
+        if(run > 0) {
+            steady_state_allocations += allocations;
+        }
+#endif
     }
 
     PRINT_INFO("After CNN")
 
+    if(RUNS > 1) {
+        steady_state_ms /= RUNS - 1;
+        PRINT_INFO("First run: " << first_run_ms << " ms, steady state: " << steady_state_ms << " ms, delta: "
+                   << first_run_ms - steady_state_ms << " ms")
+    }
+
     delete net;
 
     delete input_tensor;
     delete output_tensor;
 
+#ifdef COUNT_ALLOCATIONS
+    if(steady_state_allocations > 0) {
+        PRINT_ERROR(steady_state_allocations << " heap allocations after the first run")
+        return 1;
+    }
+#endif
+
     return 0;
 
 }
\ No newline at end of file
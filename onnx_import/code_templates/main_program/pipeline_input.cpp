@@ -0,0 +1,122 @@
+#define LOWER_BOUND 0.0
+#define UPPER_BOUND 1.0
+
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+
+#include "pico-cnn/pico-cnn.h"
+#include "network.h"
+
+void usage() {
+    printf("./pipeline_input PATH_TO_BINARY_WEIGHTS_FILE FRAMES DEPTH\n");
+}
+
+static inline fp_t urand(fp_t min, fp_t max) {
+    return (fp_t) ((((fp_t)std::rand()/(fp_t)(RAND_MAX)) * 1.0f) * (max - min) + min);
+}
+
+int32_t main(int32_t argc, char** argv) {
+
+    if(argc != 4) {
+        usage();
+        return 1;
+    }
+
+    std::srand(std::time(0));
+
+    char weights_path[1024];
+    strcpy(weights_path, argv[1]);
+
+    uint64_t FRAMES = atoi(argv[2]);
+
+    uint32_t DEPTH = atoi(argv[3]);
+
+    {% if num_input_dims == 4 %}
+    auto input_tensor = new pico_cnn::naive::Tensor({{num_input_batches}}, {{num_input_channels}}, {{input_channel_height}}, {{input_channel_width}});
+    {% elif num_input_dims == 3 %}
+    auto input_tensor = new pico_cnn::naive::Tensor({{num_input_batches}}, {{num_input_channels}}, {{input_channel_width}});
+    {% elif num_input_dims == 2 %}
+    auto input_tensor = new pico_cnn::naive::Tensor({{input_channel_height}}, {{input_channel_width}});
+    {% endif %}
+
+    {% if num_output_dims == 4 %}
+    auto output_tensor = new pico_cnn::naive::Tensor({{num_output_batches}}, {{num_output_channels}}, {{output_channel_height}}, {{output_channel_width}});
+    {% elif num_output_dims == 3 %}
+    PRINT_ERROR_AND_DIE("3D output not supported.")
+    {% elif num_output_dims == 2 %}
+    auto output_tensor = new pico_cnn::naive::Tensor({{num_output_batches}}, {{num_output_channels}});
+    {% endif %}
+
+    for(uint32_t element = 0; element < input_tensor->num_elements(); element++) {
+        input_tensor->access_blob(element) = urand(LOWER_BOUND, UPPER_BOUND);
+    }
+
+    Network *net = new Network();
+
+#ifdef NETWORK_EMBEDDED_WEIGHTS
+    PRINT_INFO("Using the weights embedded in the binary, ignoring " << weights_path)
+#else
+    // processes started with the same segment name share one copy of the weights
+    const char *shared_weights = std::getenv("PICO_CNN_SHARED_WEIGHTS");
+    if(shared_weights) {
+        if(read_shared_weights(weights_path, shared_weights, net->kernels, Network::num_kernels, net->biases,
+                               Network::num_biases, net->sparse_kernels, Network::num_sparse_kernels) != 0) {
+            PRINT_ERROR("Could not use shared weights " << shared_weights)
+            return 1;
+        }
+    } else {
+        PRINT_INFO("Reading weights from " << weights_path)
+
+        if(read_binary_weights(weights_path, &net->kernels, &net->biases, &net->sparse_kernels) != 0){
+            PRINT_ERROR("could not read weights from " << weights_path)
+            return 1;
+        }
+    }
+#endif
+
+    PRINT_INFO("Sequential execution of " << FRAMES << " frames...")
+
+    auto start = std::chrono::steady_clock::now();
+    for(uint64_t frame = 0; frame < FRAMES; frame++) {
+        net->run(input_tensor, output_tensor);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    PRINT_INFO("Sequential execution processed " << FRAMES << " frames in " << seconds << " s ("
+               << FRAMES / seconds << " frames/s)")
+
+    PRINT_INFO("Pipelined execution of " << FRAMES << " frames with " << Network::num_pipeline_stages
+               << " stages and depth " << DEPTH << "...")
+
+    auto pipeline = net->create_pipeline(DEPTH);
+
+    uint64_t mismatches = 0;
+    auto statistics = pipeline->run([&](pico_cnn::naive::Tensor *input, uint64_t frame) {
+        if(frame == FRAMES) {
+            return false;
+        }
+        input_tensor->copy_data_into(input);
+        return true;
+    }, [&](pico_cnn::naive::Tensor *output, uint64_t frame) {
+        if(!(*output == *output_tensor)) {
+            mismatches++;
+        }
+    });
+
+    if(mismatches > 0) {
+        PRINT_ERROR(mismatches << " frames of the pipelined execution differ from the sequential execution!")
+    } else {
+        PRINT_INFO("Output of pipelined and sequential execution is equal.")
+    }
+    PRINT_INFO("Speedup: " << statistics.frames_per_second / (FRAMES / seconds))
+
+    delete pipeline;
+    delete net;
+
+    delete input_tensor;
+    delete output_tensor;
+
+    return mismatches > 0 ? 1 : 0;
+
+}
@@ -55,12 +55,26 @@ int32_t main(int32_t argc, char** argv) {
 
     Network *net = new Network();
 
-    PRINT_INFO("Reading weights from: " << weights_path)
+#ifdef NETWORK_EMBEDDED_WEIGHTS
+    PRINT_INFO("Using the weights embedded in the binary, ignoring " << weights_path)
+#else
+    // processes started with the same segment name share one copy of the weights
+    const char *shared_weights = std::getenv("PICO_CNN_SHARED_WEIGHTS");
+    if(shared_weights) {
+        if(read_shared_weights(weights_path, shared_weights, net->kernels, Network::num_kernels, net->biases,
+                               Network::num_biases, net->sparse_kernels, Network::num_sparse_kernels) != 0) {
+            PRINT_ERROR("Could not use shared weights " << shared_weights)
+            return 1;
+        }
+    } else {
+        PRINT_INFO("Reading weights from: " << weights_path)
 
-    if(read_binary_weights(weights_path, &net->kernels, &net->biases) != 0){
-        PRINT_ERROR("Could not read weights from: " << weights_path)
-        return 1;
+        if(read_binary_weights(weights_path, &net->kernels, &net->biases, &net->sparse_kernels) != 0){
+            PRINT_ERROR("Could not read weights from: " << weights_path)
+            return 1;
+        }
     }
+#endif
 
     PRINT_INFO("Starting CNN...")
 
@@ -0,0 +1,61 @@
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+#include "pico-cnn/pico-cnn.h"
+
+static void fill_random(pico_cnn::naive::Tensor *tensor, std::mt19937 &generator) {
+    std::uniform_real_distribution<fp_t> distribution(-1.0, 1.0);
+    for(uint32_t i = 0; i < tensor->num_elements(); i++) {
+        tensor->access_blob(i) = distribution(generator);
+    }
+}
+
+/**
+ * @return average runtime of run() in milliseconds, repeated for at least min_milliseconds after one warm-up run
+ */
+template<typename Run>
+static double measure(Run run, double min_milliseconds) {
+    run();
+
+    uint32_t num_iterations = 0;
+    double milliseconds;
+    auto start = std::chrono::steady_clock::now();
+    do {
+        run();
+        num_iterations++;
+        milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    } while(milliseconds < min_milliseconds);
+
+    return milliseconds / num_iterations;
+}
+
+int32_t main() {
+    std::mt19937 generator(0);
+{% for benchmark in benchmarks %}
+
+    // {{benchmark.name}}
+    {
+{% for tensor in benchmark.tensors %}
+        pico_cnn::naive::Tensor *{{tensor.name}} = new pico_cnn::naive::Tensor({{tensor.shape|join(", ")}});
+        fill_random({{tensor.name}}, generator);
+{% endfor %}
+{% for candidate in benchmark.candidates %}
+        {
+        {{candidate.declaration}}
+        {{candidate.allocation}}
+            double milliseconds = measure([&] {
+            {{candidate.execution}}
+            }, {{min_milliseconds}});
+            printf("{{benchmark.index}} {{loop.index0}} %f\n", milliseconds);
+        {{candidate.deletion}}
+        }
+{% endfor %}
+{% for tensor in benchmark.tensors %}
+        delete {{tensor.name}};
+{% endfor %}
+    }
+{% endfor %}
+
+    return 0;
+}
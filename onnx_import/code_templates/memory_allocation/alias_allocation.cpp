@@ -0,0 +1 @@
+    {{buffer_name}} = {{parent_name}};
@@ -1,4 +1,9 @@
-{% if num_dims == 4 %}
+{% if embedded_offset is not none %}
+    {
+        const uint32_t shape[] = { {{shape}} };
+        {{buffer_name}} = new pico_cnn::naive::Tensor({{num_dims}}, shape, (fp_t *) (network_weights + {{embedded_offset}}));
+    }
+{% elif num_dims == 4 %}
     {{buffer_name}} = new pico_cnn::naive::Tensor({{num_output_channels}}, {{num_input_channels}}, {{kernel_height}}, {{kernel_width}});
 {% elif num_dims == 3 %}
     {{buffer_name}} = new pico_cnn::naive::Tensor({{num_output_channels}}, {{num_input_channels}}, {{kernel_width}});
@@ -0,0 +1,6 @@
+{% if embedded_offsets %}
+    {{buffer_name}} = new pico_cnn::naive::SparseMatrix({{num_rows}}, {{num_columns}}, {{num_nonzeros}}, (uint32_t *) (network_weights + {{embedded_offsets.0}}), (uint32_t *) (network_weights + {{embedded_offsets.1}}), (fp_t *) (network_weights + {{embedded_offsets.2}}));
+{% else %}
+    {{buffer_name}} = new pico_cnn::naive::SparseMatrix({{num_rows}}, {{num_columns}}, {{num_nonzeros}});
+{% endif %}
+    sparse_kernels[{{pos_sparse_kernel}}] = {{buffer_name}};
@@ -0,0 +1 @@
+    {{buffer_name}} = {{parent_name}}->channel_view({{first_channel}}, {{num_channels}});
@@ -0,0 +1 @@
+    {{identifier}}_layer = new {{layer_type}}("{{name}}", 0, pico_cnn::op_type::MaxPool);
@@ -0,0 +1 @@
+    {{layer_type}} *{{identifier}}_layer;
@@ -1,5 +1,2 @@
-
-    {{input_buffers[0].name}}->copy_data_into({{output_buffer.name}});
-{% for input_buffer in input_buffers[1:] %}
-    {{output_buffer.name}}->add_tensor({{input_buffer.name}});
-{% endfor %}
+    pico_cnn::naive::Tensor *inputs_{{identifier}}[{{input_buffers|length}}] = {{'{'}}{% for input_buffer in input_buffers %}{{input_buffer.name}}{% if not loop.last %}, {% endif %}{% endfor %}{{'}'}};
+    {{output_buffer.name}}->add_from({{input_buffers|length}}, inputs_{{identifier}});
@@ -1,4 +1,8 @@
+{% if in_place %}
+    // {{output_buffer.name}} has been written in place by the producers of the inputs
+{% else %}
     {{input_declaration}}
 
     {{output_buffer.name}}->concatenate_from({{num_inputs}}, {{inputs}}, {{dimension}});
 
+{% endif %}
@@ -1,2 +1 @@
-
-    {{input_buffer.name}}->mul_with_factor({{output_buffer.name}}, {{factor}});
+    {{output_buffer.name}}->mul_from({{input_buffer.name}}, {{factor_buffer.name}});
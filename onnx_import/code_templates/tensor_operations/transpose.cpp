@@ -1,3 +1,4 @@
-{
-{{ transpose_code }}
-}
+    {
+        const uint32_t permutation[{{permutation|length}}] = {{'{'}}{{permutation|join(", ")}}{{'}'}};
+        {{input_buffer.name}}->transpose_into({{output_buffer.name}}, permutation);
+    }
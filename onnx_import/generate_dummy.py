@@ -9,13 +9,14 @@ template_env = Environment(loader=FileSystemLoader(template_dir))
 __author__ = "Alexander Jung (University of Tuebingen, Chair for Embedded Systems)"
 
 
-def generate_dummy_main(graph):
+def generate_dummy_main(graph, template_file="main_program/dummy_input.cpp"):
     """
     Generate code that creates random input values and calls the CNN.
     :param graph: ComputeGraph representing the CNN.
+    :param template_file: Template of the main program.
     :return: String containing the generated code.
     """
-    template = template_env.get_template("main_program/dummy_input.cpp")
+    template = template_env.get_template(template_file)
 
     attributes = {}
 
@@ -110,6 +111,16 @@ def generate_dummy_main(graph):
     return template.render(**attributes)
 
 
+def generate_pipeline_main(graph):
+    """
+    Generate code that streams random input frames through the pipelined CNN and compares the throughput
+    with the sequential execution.
+    :param graph: ComputeGraph representing the CNN.
+    :return: String containing the generated code.
+    """
+    return generate_dummy_main(graph, "main_program/pipeline_input.cpp")
+
+
 def generate_reference_main(graph):
     """
     Generate code that creates random input values and calls the CNN.
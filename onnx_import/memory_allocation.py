@@ -1,4 +1,5 @@
 from ir import *
+from utils import reduce_mult
 
 from jinja2 import Environment, FileSystemLoader
 import os
@@ -37,7 +38,7 @@ class KernelAllocationCode(BaseCode):
     template_file = "memory_allocation/kernel_allocation.cpp"
 
     @classmethod
-    def create(cls, buffer, pos=-1, pos_kernel=-1, pos_bias=-1):
+    def create(cls, buffer, pos=-1, pos_kernel=-1, pos_bias=-1, elementwise=False, embedded_offset=None):
         """
         Derive necessary information from the shapes of the inputs and pass them to the code template.
         :param buffer: Buffer object containing different information about the kernel/bias input.
@@ -47,11 +48,18 @@ class KernelAllocationCode(BaseCode):
         Needed for reading weights from binary weights file.
         :param pos_bias: Position of the bias-array when moving through the CNN.
         Needed for reading weights from binary weights file.
+        :param elementwise: The buffer is a constant operand of an element-wise operation, which is stored like a bias
+        but keeps its shape for broadcasting. Scalars are allocated as tensors with a single element.
+        :param embedded_offset: Position of the values in the weights embedded in the binary (network_weights), the
+        tensor is created on them instead of being allocated.
         :return: KernelAllocationCode object
         """
         operation = cls(buffer)
         buffer_shape = buffer.shape
 
+        if elementwise and len(buffer_shape) == 0:
+            buffer_shape = (1,)
+
         # print("Kernel shape: {}".format(str(buffer_shape)))
         if len(buffer_shape) == 4:
             num_dims = 4
@@ -90,6 +98,9 @@ class KernelAllocationCode(BaseCode):
             kernel_width = kernel_height = 0
             exit(1)
 
+        if elementwise:
+            buffer_type = "bias"
+
         operation.attributes['buffer_name'] = buffer.name
         operation.attributes['num_dims'] = num_dims
         operation.attributes['num_output_channels'] = num_output_channels
@@ -101,6 +112,8 @@ class KernelAllocationCode(BaseCode):
         operation.attributes['pos_kernel'] = pos_kernel
         operation.attributes['pos_bias'] = pos_bias
         operation.attributes['buffer_type'] = buffer_type
+        operation.attributes['shape'] = ", ".join(str(dim) for dim in buffer_shape)
+        operation.attributes['embedded_offset'] = embedded_offset
 
         return operation
 
@@ -108,6 +121,39 @@ class KernelAllocationCode(BaseCode):
 CodeRegistry.register(KernelAllocationCode)
 
 
+class SparseKernelAllocation(BaseCode):
+    """
+    Class implementing generation of memory allocation code for kernels stored in the CSR format.
+    """
+    name = "SparseKernelAllocation"
+    template_file = "memory_allocation/sparse_kernel_allocation.cpp"
+
+    @classmethod
+    def create(cls, buffer, pos_sparse_kernel=-1, num_nonzeros=0, embedded_offsets=None):
+        """
+        :param buffer: Buffer object of the kernel, the first dimension are the rows of the matrix.
+        :param pos_sparse_kernel: Position of the kernel in the sparse_kernels-array.
+        Needed for reading weights from binary weights file.
+        :param num_nonzeros: Number of non-zero weights.
+        :param embedded_offsets: Positions of the row offsets, column indices and values in the weights embedded in
+        the binary (network_weights), the matrix is created on them instead of being allocated.
+        :return: SparseKernelAllocation object
+        """
+        operation = cls(buffer)
+
+        operation.attributes['buffer_name'] = buffer.name
+        operation.attributes['num_rows'] = buffer.shape[0]
+        operation.attributes['num_columns'] = reduce_mult(buffer.shape[1:])
+        operation.attributes['num_nonzeros'] = num_nonzeros
+        operation.attributes['pos_sparse_kernel'] = pos_sparse_kernel
+        operation.attributes['embedded_offsets'] = embedded_offsets
+
+        return operation
+
+
+CodeRegistry.register(SparseKernelAllocation)
+
+
 class OutputAllocation(BaseCode):
     """
     Class implementing generation of memory allocation code for outputs of layers (used as input for the next layer).
@@ -207,6 +253,61 @@ class OutputAllocation(BaseCode):
 CodeRegistry.register(OutputAllocation)
 
 
+class ViewAllocation(BaseCode):
+    """
+    Class implementing generation of code for output buffers which are channel views into the output buffer of a
+    Concat operation, so the producing layer writes its output in place.
+    """
+    name = "ViewAllocation"
+    template_file = "memory_allocation/view_allocation.cpp"
+
+    @classmethod
+    def create(cls, buffer, parent=None, first_channel=0):
+        """
+        :param buffer: Buffer object of the output which is allocated as view.
+        :param parent: Buffer object of the output of the Concat operation.
+        :param first_channel: Position of buffer in the channels of parent.
+        :return: ViewAllocation object
+        """
+        operation = cls(buffer)
+
+        operation.attributes['buffer_name'] = buffer.name
+        operation.attributes['parent_name'] = parent.name
+        operation.attributes['first_channel'] = first_channel
+        operation.attributes['num_channels'] = buffer.shape[1]
+
+        return operation
+
+
+CodeRegistry.register(ViewAllocation)
+
+
+class AliasAllocation(BaseCode):
+    """
+    Class implementing generation of code for output buffers which share the buffer of an input of the operation, so
+    the operation writes its result in place.
+    """
+    name = "AliasAllocation"
+    template_file = "memory_allocation/alias_allocation.cpp"
+
+    @classmethod
+    def create(cls, buffer, parent=None):
+        """
+        :param buffer: Buffer object of the output which shares the buffer of the input.
+        :param parent: Buffer object of the input.
+        :return: AliasAllocation object
+        """
+        operation = cls(buffer)
+
+        operation.attributes['buffer_name'] = buffer.name
+        operation.attributes['parent_name'] = parent.name
+
+        return operation
+
+
+CodeRegistry.register(AliasAllocation)
+
+
 class BufferCleanup(BaseCode):
     """
     Class implementing generation of code that frees all previously allocated buffers.
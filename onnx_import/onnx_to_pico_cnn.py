@@ -10,7 +10,7 @@ from backend import Backend
 __author__ = "Christoph Gerum, Alexander Jung (University of Tuebingen, Chair for Embedded Systems)"
 
 
-def onnx_to_pico_cnn(onnx_model, model_name):
+def onnx_to_pico_cnn(onnx_model, model_name, **kwargs):
 
     # print(onnx_model.graph)
     # Set input batch size to 1
@@ -43,7 +43,7 @@ def onnx_to_pico_cnn(onnx_model, model_name):
 
     onnx.save(optimized_model, os.path.join("./polished_models", "{}_polished.onnx".format(model_name)))
 
-    backend_model = Backend.prepare(optimized_model, model_name)
+    backend_model = Backend.prepare(optimized_model, model_name, **kwargs)
 
     return 0
 
@@ -55,6 +55,77 @@ def main():
         type=Text, required=True,
         help="Path to the model.onnx input file.",
     )
+    parser.add_argument(
+        "--parallel",
+        action="store_true",
+        help="Execute independent operations (e.g. branches of Inception modules) concurrently using a task graph.",
+    )
+    parser.add_argument(
+        "--schedule",
+        choices=["memory", "onnx"], default="onnx",
+        help="Order of the operations: 'onnx' (default) keeps the order of the onnx file, 'memory' searches an order "
+             "with minimal hypothetical peak live activation memory. Only the execution order changes, the buffers "
+             "of intermediate tensors are not reused, so the allocated memory is the same.",
+    )
+    parser.add_argument(
+        "--pipeline-stages",
+        type=int, default=0,
+        help="Additionally generate a pipelined execution mode with the given number of stages, "
+             "each running on its own core.",
+    )
+    parser.add_argument(
+        "--specialize",
+        action="store_true",
+        help="Use layer kernels with shapes fixed at compile time (templated on channels, kernel size, stride and "
+             "spatial dimensions) where available.",
+    )
+    parser.add_argument(
+        "--autotune",
+        action="store_true",
+        help="Benchmark all implementations of operations which are not in the tuning cache yet on this machine "
+             "and select the fastest ones.",
+    )
+    parser.add_argument(
+        "--tuning-cache",
+        type=Text, default="tuning_cache.json",
+        help="Tuning results are read from and stored in this file (keyed by CPU model, operator and shapes).",
+    )
+    parser.add_argument(
+        "--profile",
+        action="store_true",
+        help="Measure time and hardware performance counters (IPC, LLC and dTLB misses) of every operation and print "
+             "them when the network is deleted.",
+    )
+    parser.add_argument(
+        "--sparse-threshold",
+        type=float, default=0,
+        help="Store kernels of Conv and Gemm operations with a smaller fraction of non-zero weights in a sparse format "
+             "and multiply only the non-zeros. Disabled by default (0), 0.4 is where sparse kernels became faster "
+             "than the blocked SGEMM in benchmark/benchmark_sparse.cpp.",
+    )
+    parser.add_argument(
+        "--embed-weights",
+        choices=["array", "incbin"], default=None,
+        help="Embed kernels and biases into the binary as const array (network_weights.cpp) or via .incbin of "
+             "network.weights.raw (network_weights.S) instead of reading network.weights.bin at startup.",
+    )
+    parser.add_argument(
+        "--tile",
+        action="store_true",
+        help="Execute chains of Conv, activation and pooling operations whose intermediate tensors do not fit into the "
+             "cache tile by tile (horizontal bands), so the intermediates of a tile stay in the L2 cache.",
+    )
+    parser.add_argument(
+        "--tile-cache-kb",
+        type=int, default=0,
+        help="Cache budget of a tile in KiB, 0 uses 3/4 of the L2 cache of the machine running the network.",
+    )
+    parser.add_argument(
+        "--stream",
+        action="store_true",
+        help="Execute the Conv, activation and pooling operations following the input row by row with line buffers "
+             "instead of allocating their full resolution intermediate tensors.",
+    )
     args = parser.parse_args()
 
     onnx_model = onnx.load(args.input)
@@ -63,7 +134,11 @@ def main():
     model_name = file_name.split(".")[0]
     print("Generating Pico-CNN Code for model: {}".format(model_name))
 
-    onnx_to_pico_cnn(onnx_model, model_name)
+    onnx_to_pico_cnn(onnx_model, model_name, parallel=args.parallel, schedule=args.schedule,
+                     pipeline_stages=args.pipeline_stages, specialize=args.specialize,
+                     autotune=args.autotune, tuning_cache=args.tuning_cache, profile=args.profile,
+                     sparse_threshold=args.sparse_threshold, embed_weights=args.embed_weights, tile=args.tile,
+                     tile_cache_kb=args.tile_cache_kb, stream=args.stream)
 
     return 0
 
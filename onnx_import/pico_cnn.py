@@ -1,6 +1,6 @@
 """ All operator related code will be generated from the corresponding operator classes. """
 from ir import *
-from utils import reduce_mult
+from utils import reduce_mult, broadcast_shape
 
 from jinja2 import Environment, FileSystemLoader
 
@@ -18,6 +18,9 @@ class BaseLayer(object):
     """
     Base layer class to inherit from. Operator implementations see below.
     """
+    # Specialized implementations (shapes fixed at compile time) are only selected when generating with --specialize
+    specialized = False
+
     def __init__(self, node, graph):
         print("Generating layer", node.name)
         self.node = node
@@ -118,6 +121,8 @@ class Conv2D(BaseLayer):
         operation.attributes['padding'] = padding
         operation.attributes['output_buffer'] = output_buffers[0]
         operation.attributes['num_groups'] = num_groups
+        operation.attributes['sparse'] = node.metadata.get('sparse', False)
+        operation.attributes['kernel_shape'] = kernel_shape
 
         if len(input_buffers) > 2:
             operation.attributes['bias_buffer'] = input_buffers[2]
@@ -128,6 +133,56 @@ class Conv2D(BaseLayer):
 OperationRegistry.register(Conv2D)
 
 
+class SpecializedConv2D(Conv2D):
+    """
+    2-dimensional convolution with channels, kernel size, stride, padding and spatial dimensions as template
+    arguments of pico_cnn::naive::Conv2d.
+    """
+    name = "PicoCNNSpecializedConv2D"
+    specialized = True
+    template_file_declaration = "conv/pico_cnn_specialized_conv2d_decl.cpp"
+    template_file_allocation = "conv/pico_cnn_specialized_conv2d_alloc.cpp"
+
+    @classmethod
+    def create(cls, node, graph, memory_manager):
+        operation = super(SpecializedConv2D, cls).create(node, graph, memory_manager)
+        if operation is None:
+            return None
+
+        if operation.attributes['sparse']:
+            print("{} has a sparse kernel and can not be specialized".format(node.name))
+            return None
+
+        dilations = node.attrs.get("dilations", [1, 1])
+        if any(dilation != 1 for dilation in dilations):
+            print("{} dilated convolution can not be specialized".format(node.name))
+            return None
+
+        input_shape = operation.attributes['input_buffer'].shape
+        output_shape = operation.attributes['output_buffer'].shape
+        kernel_shape = node.attrs["kernel_shape"]
+        stride = operation.attributes['stride']
+        padding = operation.attributes['padding']
+
+        output_height = (input_shape[2] + padding[0] + padding[2] - kernel_shape[0]) // stride[0] + 1
+        output_width = (input_shape[3] + padding[1] + padding[3] - kernel_shape[1]) // stride[1] + 1
+        if output_shape[2] != output_height or output_shape[3] != output_width:
+            print("{} output shape {} can not be specialized".format(node.name, output_shape))
+            return None
+
+        template_arguments = [output_shape[1], kernel_shape[0], kernel_shape[1], stride[0], stride[1],
+                              input_shape[1], input_shape[2], input_shape[3],
+                              padding[0], padding[1], padding[2], padding[3], operation.attributes['num_groups']]
+
+        operation.attributes['layer_type'] = "pico_cnn::naive::Conv2d<{}>".format(
+            ", ".join(str(argument) for argument in template_arguments))
+
+        return operation
+
+
+OperationRegistry.register(SpecializedConv2D)
+
+
 class Conv1D(BaseLayer):
     name = "PicoCNNConv1D"
     operator = "Conv"
@@ -250,6 +305,8 @@ class FullyConnected(BaseLayer):
         operation.attributes['weight_buffer'] = weight_buffer
         operation.attributes['bias_buffer'] = bias_buffer
         operation.attributes['output_buffer'] = output_buffer
+        # set by BackendRep._select_sparse_inputs(), the kernel is (X, Y) then
+        operation.attributes['sparse_input'] = node.metadata.get('sparse_input', False)
 
         return operation
 
@@ -325,6 +382,52 @@ class MaxPool2D(BaseLayer):
 OperationRegistry.register(MaxPool2D)
 
 
+class SpecializedMaxPool2D(MaxPool2D):
+    """
+    2-dimensional max-pooling operation with kernel size, stride, padding and input shape as template arguments of
+    pico_cnn::naive::MaxPool2d.
+    """
+    name = "PicoCNNSpecializedMaxPool2D"
+    specialized = True
+    template_file_declaration = "pool/pico_cnn_specialized_max_pool2d_decl.cpp"
+    template_file_allocation = "pool/pico_cnn_specialized_max_pool2d_alloc.cpp"
+
+    @classmethod
+    def create(cls, node, graph, memory_manager):
+        operation = super(SpecializedMaxPool2D, cls).create(node, graph, memory_manager)
+        if operation is None:
+            return None
+
+        input_shape = operation.attributes['input_buffer'].shape
+        output_shape = operation.attributes['output_buffer'].shape
+        kernel_shape = operation.attributes['kernel_shape']
+        stride = operation.attributes['stride']
+        padding = list(operation.attributes['padding'])
+
+        if len(input_shape) != 4 or len(padding) != 4 or \
+                any(padding[i] >= kernel_shape[i % 2] for i in range(4)):
+            print("{} can not be specialized".format(node.name))
+            return None
+
+        output_height = (input_shape[2] + padding[0] + padding[2] - kernel_shape[0]) // stride[0] + 1
+        output_width = (input_shape[3] + padding[1] + padding[3] - kernel_shape[1]) // stride[1] + 1
+        if output_shape[2] != output_height or output_shape[3] != output_width:
+            print("{} output shape {} can not be specialized".format(node.name, output_shape))
+            return None
+
+        template_arguments = [kernel_shape[0], kernel_shape[1], stride[0], stride[1],
+                              input_shape[1], input_shape[2], input_shape[3],
+                              padding[0], padding[1], padding[2], padding[3]]
+
+        operation.attributes['layer_type'] = "pico_cnn::naive::MaxPool2d<{}>".format(
+            ", ".join(str(argument) for argument in template_arguments))
+
+        return operation
+
+
+OperationRegistry.register(SpecializedMaxPool2D)
+
+
 class MaxPool1D(BaseLayer):
     name = "PicoCNNMaxPool1D"
     operator = "MaxPool"
@@ -503,6 +606,45 @@ class Clip(BaseLayer):
 OperationRegistry.register(Clip)
 
 
+class PRelu(BaseLayer):
+    """
+    Leaky rectified linear unit whose slope is a tensor broadcast to the input, e.g. one slope per channel.
+    """
+    name = "PicoCNNPRelu"
+    operator = "PRelu"
+    template_file_declaration = "activation/pico_cnn_prelu_decl.cpp"
+    template_file_allocation = "activation/pico_cnn_prelu_alloc.cpp"
+    template_file_execution = "layer_exec.cpp"
+    template_file_deletion = "layer_delete.cpp"
+
+    @classmethod
+    def create(cls, node, graph, memory_manager):
+
+        input_buffer = memory_manager.get_buffer(graph, node.inputs[0])
+        slope_buffer = memory_manager.get_buffer(graph, node.inputs[1])
+        output_buffer = memory_manager.get_buffer(graph, node.outputs[0])
+
+        if broadcast_shape([input_buffer.shape, slope_buffer.shape]) != tuple(input_buffer.shape):
+            print("ERROR: Slope of shape {} of {} can not be broadcast to its input of shape {}".format(
+                slope_buffer.shape, node.name, input_buffer.shape))
+            exit(1)
+
+        operation = cls(node, graph)
+
+        identifier = node.name.replace('.', '_').replace(':', '_').replace('/', '_')
+
+        operation.attributes['name'] = node.name
+        operation.attributes['identifier'] = identifier
+        operation.attributes['input_buffer'] = input_buffer
+        operation.attributes['slope_buffer'] = slope_buffer
+        operation.attributes['output_buffer'] = output_buffer
+
+        return operation
+
+
+OperationRegistry.register(PRelu)
+
+
 class MatMul(BaseLayer):
     name = "PicoCNNMatMul"
     operator = "MatMul"
@@ -531,6 +673,11 @@ class MatMul(BaseLayer):
         operation.attributes['input_buffer'] = input_buffer
         operation.attributes['weight_buffer'] = weight_buffer
         operation.attributes['output_buffer'] = output_buffer
+        # set by BackendRep._propagate_layouts() if a Transpose was absorbed
+        operation.attributes['transpose_input'] = "true" if attrs.get('transpose_input', 0) else "false"
+        operation.attributes['transpose_output'] = "true" if attrs.get('transpose_output', 0) else "false"
+        # set by BackendRep._select_sparse_inputs()
+        operation.attributes['sparse_input'] = "true" if node.metadata.get('sparse_input') else "false"
 
         return operation
 
@@ -548,27 +695,21 @@ class Mul(BaseLayer):
 
     @classmethod
     def create(cls, node, graph, memory_manager):
-        attrs = node.attrs
-
         input_buffer = memory_manager.get_buffer(graph, node.inputs[0])
+        factor_buffer = memory_manager.get_buffer(graph, node.inputs[1])
         output_buffer = memory_manager.get_buffer(graph, node.outputs[0])
 
-        factor = node.input_tensors[node.inputs[1]]
-
-        if factor.size != 1:
-            print("ERROR: Mul operation currently does not support Tensor-styled factors.")
+        # the factor is broadcast to the input (e.g. a scalar or one factor per channel)
+        if broadcast_shape([input_buffer.shape, factor_buffer.shape]) != tuple(output_buffer.shape):
+            print("ERROR: Factor of shape {} of {} can not be broadcast to its input of shape {}".format(
+                factor_buffer.shape, node.name, input_buffer.shape))
             exit(1)
 
-        input_shape = input_buffer.shape
-        output_shape = output_buffer.shape
-
-        assert(input_shape == output_shape)
-
         operation = cls(node, graph)
 
         operation.attributes['input_buffer'] = input_buffer
+        operation.attributes['factor_buffer'] = factor_buffer
         operation.attributes['output_buffer'] = output_buffer
-        operation.attributes['factor'] = factor
 
         return operation
 
@@ -769,69 +910,17 @@ class Transpose(BaseLayer):
         input_buffer = memory_manager.get_buffer(graph, node.inputs[0])
         output_buffer = memory_manager.get_buffer(graph, node.outputs[0])
 
-        permutations = attrs['perm']
-        orig_permutation = range(len(input_buffer.shape))
-        transpose_code = ""
-
-        input_shape = input_buffer.shape
-        output_shape = output_buffer.shape
-
-        for input_dim, output_dim in enumerate(permutations):
-            dim_size = input_buffer.shape[input_dim] if input_dim < len(input_buffer.shape) else 1
-            transpose_code += "    " * (input_dim + 1)
-            transpose_code += "for(uint32_t dim{} = 0; dim{} < {}; dim{}++)".format(input_dim, input_dim, dim_size,
-                                                                                    input_dim)
-            transpose_code += "\n"
-
-        transpose_code += "    " * len(permutations)
-
-        if len(permutations) == 4:
-            num_input_channels = input_shape[1]
-            input_height = input_shape[2]
-            input_width = input_shape[3]
+        num_dimensions = len(input_buffer.shape)
+        permutation = list(attrs.get('perm', reversed(range(num_dimensions))))
 
-            num_output_channels = output_shape[1]
-            output_height = output_shape[2]
-            output_width = output_shape[3]
-
-            test_code = "{}->access({}, {}, {}, {}, {}, {}, {})".format(output_buffer.name,
-                                                                        "dim" + str(permutations[0]),
-                                                                        "dim" + str(permutations[1]),
-                                                                        "dim" + str(permutations[2]),
-                                                                        "dim" + str(permutations[3]),
-                                                                        num_output_channels,
-                                                                        output_height,
-                                                                        output_width)\
-                        + " = " \
-                        + "{}->access({}, {}, {}, {}, {}, {}, {});".format(input_buffer.name,
-                                                                           "dim" + str(orig_permutation[0]),
-                                                                           "dim" + str(orig_permutation[1]),
-                                                                           "dim" + str(orig_permutation[2]),
-                                                                           "dim" + str(orig_permutation[3]),
-                                                                           num_input_channels,
-                                                                           input_height,
-                                                                           input_width)
-        elif len(permutations) == 2:
-            input_width = input_shape[1]
-            output_width = output_shape[1]
-
-            test_code = "{}->access({}, {}, {})".format(output_buffer.name,
-                                                        "dim"+str(permutations[0]),
-                                                        "dim"+str(permutations[1]),
-                                                        output_width) \
-                        + " = " \
-                        + "{}->access({}, {}, {});".format(input_buffer.name,
-                                                           "dim"+str(orig_permutation[0]),
-                                                           "dim"+str(orig_permutation[1]),
-                                                           input_width)
-        else:
+        if not 1 <= num_dimensions <= 4 or sorted(permutation) != list(range(num_dimensions)):
             print("ERROR: Unsupported permutation in Transpose operation.")
             exit(1)
 
-        transpose_code += "    " + test_code
-
         operation = cls(node, graph)
-        operation.attributes['transpose_code'] = transpose_code
+        operation.attributes['input_buffer'] = input_buffer
+        operation.attributes['output_buffer'] = output_buffer
+        operation.attributes['permutation'] = permutation
 
         return operation
 
@@ -902,6 +991,8 @@ class Concat(BaseLayer):
         operation.attributes['num_inputs'] = len(input_buffers)
         operation.attributes['inputs'] = "inputs_{}".format(identifier)
         operation.attributes['dimension'] = dimension
+        # all inputs are views into the output (see BackendRep._get_concat_views())
+        operation.attributes['in_place'] = node.metadata.get('in_place', False)
 
         return operation
 
@@ -1006,22 +1097,21 @@ class Add(BaseLayer):
 
     @classmethod
     def create(cls, node, graph, memory_manager):
-        attrs = node.attrs
         input_buffers = [memory_manager.get_buffer(graph, i) for i in node.inputs]
         output_buffer = memory_manager.get_buffer(graph, node.outputs[0])
 
-        input_shapes = [b.shape for b in input_buffers]
-        for shape in input_shapes:
-            if shape != input_shapes[0]:
-                if len(input_shapes[0]) <= 2 and len(shape) <= 2:
-                    print("Broadcasting, but it still works without doing anything...")
-                else:
-                    # TODO: This needs a better solution!!!
-                    print("Broadcasting is not supported for add operation")
-                    exit(1)
+        # all inputs are summed in a single pass by pico_cnn::naive::Tensor::add_from(), which broadcasts them
+        # following the numpy rules
+        if broadcast_shape([b.shape for b in input_buffers]) is None:
+            print("ERROR: Shapes {} of {} can not be broadcast".format([b.shape for b in input_buffers], node.name))
+            exit(1)
 
         operation = cls(node, graph)
+
+        identifier = node.name.replace('.', '_').replace(':', '_').replace('/', '_')
+
         operation.attributes['name'] = node.name
+        operation.attributes['identifier'] = identifier
         operation.attributes['input_buffers'] = input_buffers
         operation.attributes['output_buffer'] = output_buffer
 
@@ -6,3 +6,20 @@ __author__ = "Christoph Gerum (University of Tuebingen, Chair for Embedded Syste
 
 def reduce_mult(data: Iterable[int]) -> int:
     return reduce(lambda x, y: x * y, data, 1)
+
+
+def broadcast_shape(shapes: Iterable[Iterable[int]]):
+    """
+    :return: Shape of the result of an element-wise operation on tensors of the given shapes following the numpy
+    broadcasting rules or None if the shapes can not be broadcast.
+    """
+    shapes = [list(shape) for shape in shapes]
+    num_dimensions = max(len(shape) for shape in shapes)
+    result = [1] * num_dimensions
+    for shape in shapes:
+        padded = [1] * (num_dimensions - len(shape)) + shape
+        for i, dim in enumerate(padded):
+            if dim != 1 and result[i] != 1 and dim != result[i]:
+                return None
+            result[i] = max(result[i], dim)
+    return tuple(result)
@@ -0,0 +1,197 @@
+#include "blocked_gemm.h"
+
+#include <algorithm>
+
+#include "../runtime/buffer_pool.h"
+#include "../runtime/thread_pool.h"
+
+namespace pico_cnn {
+    namespace naive {
+
+        // blocks of op(A) and op(B) packed by a thread, layers of parallel networks multiply concurrently, so every
+        // thread multiplying takes its own buffer for a part of C
+        static BufferPool pack_buffers(BlockedGemm::BlockM * BlockedGemm::BlockK +
+                                       BlockedGemm::BlockK * BlockedGemm::BlockN);
+
+        /**
+         * Copies the block of op(source) starting at (row, col) into destination (rows x cols, row-major) and scales
+         * it by factor.
+         */
+        static void pack(const fp_t *source, uint32_t ld, bool transpose, uint32_t row, uint32_t col,
+                         uint32_t rows, uint32_t cols, fp_t factor, fp_t *destination) {
+            if(transpose) {
+                // the rows read are reused for the following rows of the block while they are still cached
+                for(uint32_t i = 0; i < rows; i++) {
+                    const fp_t *source_col = source + col * ld + row + i;
+                    for(uint32_t j = 0; j < cols; j++) {
+                        destination[i * cols + j] = factor * source_col[j * ld];
+                    }
+                }
+            } else {
+                for(uint32_t i = 0; i < rows; i++) {
+                    const fp_t *source_row = source + (row + i) * ld + col;
+                    for(uint32_t j = 0; j < cols; j++) {
+                        destination[i * cols + j] = factor * source_row[j];
+                    }
+                }
+            }
+        }
+
+        /**
+         * @return a * b of two vectors of length k, accumulated in independent partial sums which are vectorized
+         */
+        static fp_t dot(const fp_t *a, const fp_t *b, uint32_t k) {
+            fp_t sums[8] = {0};
+
+            uint32_t p = 0;
+            for(; p + 8 <= k; p += 8) {
+                for(uint32_t lane = 0; lane < 8; lane++) {
+                    sums[lane] += a[p + lane] * b[p + lane];
+                }
+            }
+
+            fp_t sum = 0;
+            for(; p < k; p++) {
+                sum += a[p] * b[p];
+            }
+            for(uint32_t lane = 0; lane < 8; lane++) {
+                sum += sums[lane];
+            }
+            return sum;
+        }
+
+        /**
+         * C += A * B for packed blocks A (m x k) and B (k x n)
+         */
+        static void multiply_block(uint32_t m, uint32_t n, uint32_t k, const fp_t *a, const fp_t *b,
+                                   fp_t *c, uint32_t ldc) {
+            uint32_t i = 0;
+
+            // every element of B loaded is used for four rows of C
+            for(; i + 4 <= m; i += 4) {
+                fp_t *c0 = c + i * ldc;
+                fp_t *c1 = c0 + ldc;
+                fp_t *c2 = c1 + ldc;
+                fp_t *c3 = c2 + ldc;
+                const fp_t *a0 = a + i * k;
+
+                for(uint32_t p = 0; p < k; p++) {
+                    const fp_t a0p = a0[p];
+                    const fp_t a1p = a0[k + p];
+                    const fp_t a2p = a0[2 * k + p];
+                    const fp_t a3p = a0[3 * k + p];
+                    const fp_t *b_row = b + p * n;
+
+                    for(uint32_t j = 0; j < n; j++) {
+                        const fp_t b_pj = b_row[j];
+                        c0[j] += a0p * b_pj;
+                        c1[j] += a1p * b_pj;
+                        c2[j] += a2p * b_pj;
+                        c3[j] += a3p * b_pj;
+                    }
+                }
+            }
+
+            for(; i < m; i++) {
+                fp_t *c_row = c + i * ldc;
+                const fp_t *a_row = a + i * k;
+
+                for(uint32_t p = 0; p < k; p++) {
+                    const fp_t a_ip = a_row[p];
+                    const fp_t *b_row = b + p * n;
+
+                    for(uint32_t j = 0; j < n; j++) {
+                        c_row[j] += a_ip * b_row[j];
+                    }
+                }
+            }
+        }
+
+        /**
+         * C = beta * C for the columns [first, last) of C (m rows), C is not read if beta == 0
+         */
+        static void scale(uint32_t m, uint32_t first, uint32_t last, fp_t beta, fp_t *c, uint32_t ldc) {
+            for(uint32_t i = 0; i < m; i++) {
+                fp_t *c_row = c + i * ldc;
+                if(beta == 0) {
+                    std::fill(c_row + first, c_row + last, (fp_t) 0);
+                } else if(beta != 1) {
+                    for(uint32_t j = first; j < last; j++) {
+                        c_row[j] *= beta;
+                    }
+                }
+            }
+        }
+
+        const char *BlockedGemm::name() const {
+            return "blocked";
+        }
+
+        void BlockedGemm::sgemm(bool transpose_a, bool transpose_b, uint32_t m, uint32_t n, uint32_t k,
+                                fp_t alpha, const fp_t *a, uint32_t lda, const fp_t *b, uint32_t ldb,
+                                fp_t beta, fp_t *c, uint32_t ldc) {
+
+            if(alpha == 0 || k == 0) {
+                scale(m, 0, n, beta, c, ldc);
+                return;
+            }
+
+            // few rows of A times transposed B (fully connected layers): both operands are read along their rows, so
+            // packing B would only add a copy of the (large) kernel
+            if(!transpose_a && transpose_b && m < 4) {
+                parallel_for(0, n, parallel_grain((uint64_t) m * k), [&](uint32_t first, uint32_t last) {
+                    scale(m, first, last, beta, c, ldc);
+                    for(uint32_t i = 0; i < m; i++) {
+                        for(uint32_t j = first; j < last; j++) {
+                            c[i * ldc + j] += alpha * dot(a + i * lda, b + j * ldb, k);
+                        }
+                    }
+                });
+                return;
+            }
+
+            // a buffer for every thread of the pool, so no multiplication allocates after the first one
+            pack_buffers.reserve(thread_pool()->num_threads());
+
+            // C is split into columns (or rows if it only has a few columns) between the threads, every thread packs
+            // the blocks of its part into its own buffers and every element of C is accumulated in the same order as by
+            // a single thread
+            auto multiply = [&](uint32_t first_row, uint32_t last_row, uint32_t first_col, uint32_t last_col) {
+                scale(last_row - first_row, first_col, last_col, beta, c + first_row * ldc, ldc);
+
+                fp_t *packed_a = pack_buffers.acquire();
+                fp_t *packed_b = packed_a + BlockM * BlockK;
+
+                for(uint32_t col = first_col; col < last_col; col += BlockN) {
+                    const uint32_t block_n = MIN(BlockN, last_col - col);
+
+                    for(uint32_t depth = 0; depth < k; depth += BlockK) {
+                        const uint32_t block_k = MIN(BlockK, k - depth);
+
+                        pack(b, ldb, transpose_b, depth, col, block_k, block_n, 1, packed_b);
+
+                        for(uint32_t row = first_row; row < last_row; row += BlockM) {
+                            const uint32_t block_m = MIN(BlockM, last_row - row);
+
+                            pack(a, lda, transpose_a, row, depth, block_m, block_k, alpha, packed_a);
+
+                            multiply_block(block_m, block_n, block_k, packed_a, packed_b,
+                                           c + row * ldc + col, ldc);
+                        }
+                    }
+                }
+                pack_buffers.release(packed_a);
+            };
+
+            if(n > BlockN || m <= BlockM) {
+                parallel_for(0, n, MIN(BlockN, parallel_grain((uint64_t) m * k)), [&](uint32_t first, uint32_t last) {
+                    multiply(0, m, first, last);
+                });
+            } else {
+                parallel_for(0, m, MIN(BlockM, parallel_grain((uint64_t) n * k)), [&](uint32_t first, uint32_t last) {
+                    multiply(first, last, 0, n);
+                });
+            }
+        }
+    }
+}
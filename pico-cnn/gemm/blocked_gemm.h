@@ -0,0 +1,32 @@
+/**
+ * @brief pico_cnn::naive::BlockedGemm is the in-tree SGEMM. op(A) and op(B) are copied block by block into contiguous
+ * buffers which fit into the caches, so both transposed and not transposed operands are read with unit stride. The
+ * inner kernel updates four rows of C per pass over a row of B, the loop over the columns is vectorized.
+ *
+ * @author Alexander Jung (University of Tuebingen, Chair for Embedded Systems)
+ */
+#ifndef PICO_CNN_BLOCKED_GEMM_H
+#define PICO_CNN_BLOCKED_GEMM_H
+
+#include "gemm.h"
+
+namespace pico_cnn {
+    namespace naive {
+
+        class BlockedGemm : public GemmProvider {
+        public:
+            // block of op(A): BlockM x BlockK (64 KiB), block of op(B): BlockK x BlockN (256 KiB)
+            static constexpr uint32_t BlockM = 64;
+            static constexpr uint32_t BlockN = 256;
+            static constexpr uint32_t BlockK = 256;
+
+            const char *name() const override;
+
+            void sgemm(bool transpose_a, bool transpose_b, uint32_t m, uint32_t n, uint32_t k,
+                       fp_t alpha, const fp_t *a, uint32_t lda, const fp_t *b, uint32_t ldb,
+                       fp_t beta, fp_t *c, uint32_t ldc) override;
+        };
+    }
+}
+
+#endif //PICO_CNN_BLOCKED_GEMM_H
@@ -0,0 +1,27 @@
+#include "cblas_gemm.h"
+
+#ifdef PICO_CNN_CBLAS
+
+#include <type_traits>
+
+#include <cblas.h>
+
+namespace pico_cnn {
+    namespace naive {
+
+        static_assert(std::is_same<fp_t, float>::value, "CblasGemm requires fp_t to be float");
+
+        const char *CblasGemm::name() const {
+            return "cblas";
+        }
+
+        void CblasGemm::sgemm(bool transpose_a, bool transpose_b, uint32_t m, uint32_t n, uint32_t k,
+                              fp_t alpha, const fp_t *a, uint32_t lda, const fp_t *b, uint32_t ldb,
+                              fp_t beta, fp_t *c, uint32_t ldc) {
+            cblas_sgemm(CblasRowMajor, transpose_a ? CblasTrans : CblasNoTrans, transpose_b ? CblasTrans : CblasNoTrans,
+                        m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+        }
+    }
+}
+
+#endif //PICO_CNN_CBLAS
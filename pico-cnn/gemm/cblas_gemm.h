@@ -0,0 +1,30 @@
+/**
+ * @brief pico_cnn::naive::CblasGemm forwards to cblas_sgemm() of a BLAS library installed on the host. Only built if
+ * PICO_CNN_CBLAS is defined, programs then have to be linked against the BLAS library as well.
+ *
+ * @author Alexander Jung (University of Tuebingen, Chair for Embedded Systems)
+ */
+#ifndef PICO_CNN_CBLAS_GEMM_H
+#define PICO_CNN_CBLAS_GEMM_H
+
+#ifdef PICO_CNN_CBLAS
+
+#include "gemm.h"
+
+namespace pico_cnn {
+    namespace naive {
+
+        class CblasGemm : public GemmProvider {
+        public:
+            const char *name() const override;
+
+            void sgemm(bool transpose_a, bool transpose_b, uint32_t m, uint32_t n, uint32_t k,
+                       fp_t alpha, const fp_t *a, uint32_t lda, const fp_t *b, uint32_t ldb,
+                       fp_t beta, fp_t *c, uint32_t ldc) override;
+        };
+    }
+}
+
+#endif //PICO_CNN_CBLAS
+
+#endif //PICO_CNN_CBLAS_GEMM_H
@@ -0,0 +1,89 @@
+#include "gemm.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+
+#include "blocked_gemm.h"
+#include "cblas_gemm.h"
+
+namespace pico_cnn {
+    namespace naive {
+
+        /**
+         * @return all providers built into the library, the first one is the default
+         */
+        static const std::vector<GemmProvider*> &providers() {
+            static BlockedGemm blocked_gemm;
+#ifdef PICO_CNN_CBLAS
+            static CblasGemm cblas_gemm;
+            static const std::vector<GemmProvider*> providers = {&cblas_gemm, &blocked_gemm};
+#else
+            static const std::vector<GemmProvider*> providers = {&blocked_gemm};
+#endif
+            return providers;
+        }
+
+        static GemmProvider *find_provider(const std::string &name) {
+            for(GemmProvider *provider: providers()) {
+                if(name == provider->name()) {
+                    return provider;
+                }
+            }
+            return nullptr;
+        }
+
+        static std::atomic<GemmProvider*> current_provider(nullptr);
+
+        GemmProvider *gemm_provider() {
+            GemmProvider *provider = current_provider.load(std::memory_order_acquire);
+
+            if(provider == nullptr) {
+                provider = providers().front();
+
+                const char *name = std::getenv("PICO_CNN_GEMM");
+                if(name != nullptr) {
+                    GemmProvider *requested = find_provider(name);
+                    if(requested) {
+                        provider = requested;
+                    } else {
+                        PRINT_WARNING("GEMM provider " << name << " is not available, using " << provider->name())
+                    }
+                }
+
+                // another thread may have selected a provider in the meantime
+                GemmProvider *expected = nullptr;
+                if(!current_provider.compare_exchange_strong(expected, provider)) {
+                    provider = expected;
+                }
+            }
+
+            return provider;
+        }
+
+        int32_t select_gemm_provider(const std::string &name) {
+            GemmProvider *provider = find_provider(name);
+            if(provider == nullptr) {
+                PRINT_ERROR("GEMM provider " << name << " is not available")
+                return 1;
+            }
+
+            current_provider.store(provider, std::memory_order_release);
+            return 0;
+        }
+
+        std::vector<std::string> available_gemm_providers() {
+            std::vector<std::string> names;
+            for(GemmProvider *provider: providers()) {
+                names.push_back(provider->name());
+            }
+            return names;
+        }
+
+        void sgemm(bool transpose_a, bool transpose_b, uint32_t m, uint32_t n, uint32_t k,
+                   fp_t alpha, const fp_t *a, uint32_t lda, const fp_t *b, uint32_t ldb,
+                   fp_t beta, fp_t *c, uint32_t ldc) {
+            gemm_provider()->sgemm(transpose_a, transpose_b, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+        }
+    }
+}
@@ -0,0 +1,69 @@
+/**
+ * @brief Interface of the matrix multiplications used by FullyConnected, MatMul and Convolution (im2col).
+ *
+ * All layers call pico_cnn::naive::sgemm(), which forwards to the currently selected GemmProvider. The in-tree
+ * BlockedGemm is always available, CblasGemm only if pico-cnn is built with PICO_CNN_CBLAS (CMake option
+ * PICO_CNN_WITH_CBLAS, make CBLAS=1). The provider can be switched at runtime with select_gemm_provider() or before
+ * the first multiplication by setting the environment variable PICO_CNN_GEMM to the name of a provider.
+ *
+ * @author Alexander Jung (University of Tuebingen, Chair for Embedded Systems)
+ */
+#ifndef PICO_CNN_GEMM_H
+#define PICO_CNN_GEMM_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../parameters.h"
+
+namespace pico_cnn {
+    namespace naive {
+
+        class GemmProvider {
+        public:
+            virtual ~GemmProvider() = default;
+
+            virtual const char *name() const = 0;
+
+            /**
+             * C = alpha * op(A) * op(B) + beta * C with all matrices stored row-major, op(X) is X or X^T.
+             * C is not read if beta == 0.
+             * @param m number of rows of op(A) and C
+             * @param n number of columns of op(B) and C
+             * @param k number of columns of op(A) and rows of op(B)
+             * @param lda, ldb, ldc distance between two rows of the stored (not transposed) matrices
+             */
+            virtual void sgemm(bool transpose_a, bool transpose_b, uint32_t m, uint32_t n, uint32_t k,
+                               fp_t alpha, const fp_t *a, uint32_t lda, const fp_t *b, uint32_t ldb,
+                               fp_t beta, fp_t *c, uint32_t ldc) = 0;
+        };
+
+        /**
+         * @return currently selected provider, on the first call the one named by PICO_CNN_GEMM or the default
+         * (CBLAS if available, the blocked in-tree implementation otherwise)
+         */
+        GemmProvider *gemm_provider();
+
+        /**
+         * Selects the provider used by all following multiplications. Can be called while networks are running, every
+         * multiplication uses the provider selected when it starts.
+         * @return 0 on success, 1 if there is no provider with this name
+         */
+        int32_t select_gemm_provider(const std::string &name);
+
+        /**
+         * @return names of all providers built into the library
+         */
+        std::vector<std::string> available_gemm_providers();
+
+        /**
+         * Multiplication with the currently selected provider, see GemmProvider::sgemm().
+         */
+        void sgemm(bool transpose_a, bool transpose_b, uint32_t m, uint32_t n, uint32_t k,
+                   fp_t alpha, const fp_t *a, uint32_t lda, const fp_t *b, uint32_t ldb,
+                   fp_t beta, fp_t *c, uint32_t ldc);
+    }
+}
+
+#endif //PICO_CNN_GEMM_H
@@ -0,0 +1,99 @@
+#include "sparse_input_gemm.h"
+
+#include <algorithm>
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+#include "gemm.h"
+#include "../runtime/thread_pool.h"
+
+namespace pico_cnn {
+    namespace naive {
+
+        uint32_t compress_nonzeros(const fp_t *x, uint32_t n, uint32_t *indices) {
+            uint32_t count = 0;
+            uint32_t i = 0;
+
+#ifdef __SSE__
+            // one comparison per four inputs, only the set bits of the mask are visited
+            const __m128 zero = _mm_setzero_ps();
+            for(; i + 4 <= n; i += 4) {
+                uint32_t mask = _mm_movemask_ps(_mm_cmpneq_ps(_mm_loadu_ps(x + i), zero));
+                while(mask) {
+                    indices[count++] = i + __builtin_ctz(mask);
+                    mask &= mask - 1;
+                }
+            }
+#endif
+
+            // without branches, the index is overwritten by the next one if the input is zero
+            for(; i < n; i++) {
+                indices[count] = i;
+                count += x[i] != 0;
+            }
+
+            return count;
+        }
+
+        void sparse_input_sgemm(uint32_t m, uint32_t n, uint32_t k, const fp_t *a, uint32_t lda,
+                                const fp_t *b, uint32_t ldb, fp_t beta, fp_t *c, uint32_t ldc, uint32_t *indices) {
+
+            if(m > 1) {
+                uint32_t num_nonzeros = 0;
+                for(uint32_t row = 0; row < m; row++) {
+                    for(uint32_t i = 0; i < k; i++) {
+                        num_nonzeros += a[row * lda + i] != 0;
+                    }
+                }
+                if(num_nonzeros > SparseInputMaxDensity * m * k) {
+                    sgemm(false, false, m, n, k, 1, a, lda, b, ldb, beta, c, ldc);
+                    return;
+                }
+            }
+
+            for(uint32_t row = 0; row < m; row++) {
+                const fp_t *a_row = a + row * lda;
+                fp_t *c_row = c + row * ldc;
+
+                const uint32_t num_nonzeros = compress_nonzeros(a_row, k, indices);
+
+                // the columns of the row are split between the threads, all of them use the same indices
+                parallel_for(0, n, parallel_grain(num_nonzeros), [&](uint32_t first, uint32_t last) {
+                    if(beta == 0) {
+                        std::fill(c_row + first, c_row + last, (fp_t) 0);
+                    } else if(beta != 1) {
+                        for(uint32_t j = first; j < last; j++) {
+                            c_row[j] *= beta;
+                        }
+                    }
+
+                    // four rows of B are accumulated per pass over the row of C, the loop over the columns is
+                    // vectorized
+                    uint32_t nonzero = 0;
+                    for(; nonzero + 4 <= num_nonzeros; nonzero += 4) {
+                        const fp_t a0 = a_row[indices[nonzero]];
+                        const fp_t a1 = a_row[indices[nonzero + 1]];
+                        const fp_t a2 = a_row[indices[nonzero + 2]];
+                        const fp_t a3 = a_row[indices[nonzero + 3]];
+                        const fp_t *b0 = b + indices[nonzero] * ldb;
+                        const fp_t *b1 = b + indices[nonzero + 1] * ldb;
+                        const fp_t *b2 = b + indices[nonzero + 2] * ldb;
+                        const fp_t *b3 = b + indices[nonzero + 3] * ldb;
+                        for(uint32_t j = first; j < last; j++) {
+                            c_row[j] += a0 * b0[j] + a1 * b1[j] + a2 * b2[j] + a3 * b3[j];
+                        }
+                    }
+                    for(; nonzero < num_nonzeros; nonzero++) {
+                        const fp_t a0 = a_row[indices[nonzero]];
+                        const fp_t *b0 = b + indices[nonzero] * ldb;
+                        for(uint32_t j = first; j < last; j++) {
+                            c_row[j] += a0 * b0[j];
+                        }
+                    }
+                });
+            }
+        }
+    }
+}
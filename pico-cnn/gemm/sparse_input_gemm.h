@@ -0,0 +1,44 @@
+/**
+ * @brief Matrix multiplication for fully connected layers and MatMul whose input is mostly zero, e.g. because it is the
+ * output of a ReLU. The indices of the non-zero inputs of every row are compacted first, then only the matching rows of
+ * the weights are accumulated, so the weights of zero inputs are not even read. Inputs of several rows with many
+ * non-zeros are multiplied by the selected GEMM provider instead (see gemm/gemm.h), a single row is always accumulated
+ * because the GEMM degenerates to a matrix-vector product then, which reads all weights in the same order.
+ *
+ * @author Alexander Jung (University of Tuebingen, Chair for Embedded Systems)
+ */
+#ifndef PICO_CNN_SPARSE_INPUT_GEMM_H
+#define PICO_CNN_SPARSE_INPUT_GEMM_H
+
+#include <cstdint>
+
+#include "../parameters.h"
+
+namespace pico_cnn {
+    namespace naive {
+
+        /**
+         * A with more than one row and a larger fraction of non-zeros is multiplied densely, see
+         * benchmark/benchmark_sparse.cpp.
+         */
+        constexpr fp_t SparseInputMaxDensity = 0.4;
+
+        /**
+         * @param indices receives the positions of the non-zero elements of x in ascending order, room for n indices
+         * @return number of non-zero elements of x
+         */
+        uint32_t compress_nonzeros(const fp_t *x, uint32_t n, uint32_t *indices);
+
+        /**
+         * C = A * B + beta * C with all matrices stored row-major, C is not read if beta == 0.
+         * @param m number of rows of A and C
+         * @param n number of columns of B and C
+         * @param k number of columns of A and rows of B
+         * @param indices scratch for k indices
+         */
+        void sparse_input_sgemm(uint32_t m, uint32_t n, uint32_t k, const fp_t *a, uint32_t lda,
+                                const fp_t *b, uint32_t ldb, fp_t beta, fp_t *c, uint32_t ldc, uint32_t *indices);
+    }
+}
+
+#endif //PICO_CNN_SPARSE_INPUT_GEMM_H
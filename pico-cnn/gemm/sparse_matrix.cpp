@@ -0,0 +1,157 @@
+#include "sparse_matrix.h"
+
+#include <algorithm>
+
+#include "../runtime/thread_pool.h"
+
+namespace pico_cnn {
+    namespace naive {
+
+        // columns of B and C processed per pass over the non-zeros of a row, the rows of B read by one row of S stay
+        // in the cache for the following rows
+        static constexpr uint32_t ColumnBlock = 512;
+
+        SparseMatrix::SparseMatrix(uint32_t num_rows, uint32_t num_columns, uint32_t num_nonzeros) :
+                num_rows_(num_rows), num_columns_(num_columns), num_nonzeros_(num_nonzeros), owns_data_(true) {
+            row_offsets_ = new uint32_t[num_rows + 1]();
+            column_indices_ = new uint32_t[num_nonzeros]();
+            values_ = new fp_t[num_nonzeros]();
+            row_offsets_[num_rows] = num_nonzeros;
+        }
+
+        SparseMatrix::SparseMatrix(uint32_t num_rows, uint32_t num_columns, uint32_t num_nonzeros,
+                                   uint32_t *row_offsets, uint32_t *column_indices, fp_t *values) :
+                row_offsets_(row_offsets), column_indices_(column_indices), values_(values),
+                num_rows_(num_rows), num_columns_(num_columns), num_nonzeros_(num_nonzeros), owns_data_(false) {
+        }
+
+        SparseMatrix::~SparseMatrix() {
+            if(owns_data_) {
+                delete[] row_offsets_;
+                delete[] column_indices_;
+                delete[] values_;
+            }
+        }
+
+        void SparseMatrix::use_external_data(uint32_t *row_offsets, uint32_t *column_indices, fp_t *values) {
+            if(owns_data_) {
+                delete[] row_offsets_;
+                delete[] column_indices_;
+                delete[] values_;
+            }
+            row_offsets_ = row_offsets;
+            column_indices_ = column_indices;
+            values_ = values;
+            owns_data_ = false;
+        }
+
+        SparseMatrix *SparseMatrix::from_dense(const fp_t *dense, uint32_t num_rows, uint32_t num_columns) {
+            uint32_t num_nonzeros = 0;
+            for(uint32_t i = 0; i < num_rows * num_columns; i++) {
+                if(dense[i] != 0) {
+                    num_nonzeros++;
+                }
+            }
+
+            auto *matrix = new SparseMatrix(num_rows, num_columns, num_nonzeros);
+
+            uint32_t nonzero = 0;
+            for(uint32_t row = 0; row < num_rows; row++) {
+                matrix->row_offsets_[row] = nonzero;
+                for(uint32_t col = 0; col < num_columns; col++) {
+                    if(dense[row * num_columns + col] != 0) {
+                        matrix->column_indices_[nonzero] = col;
+                        matrix->values_[nonzero] = dense[row * num_columns + col];
+                        nonzero++;
+                    }
+                }
+            }
+
+            return matrix;
+        }
+
+        fp_t SparseMatrix::density() const {
+            if(num_rows_ * num_columns_ == 0) {
+                return 0;
+            }
+            return (fp_t) num_nonzeros_ / ((fp_t) num_rows_ * num_columns_);
+        }
+
+        void SparseMatrix::multiply(uint32_t first_row, uint32_t m, uint32_t n, const fp_t *b, uint32_t ldb,
+                                    fp_t beta, fp_t *c, uint32_t ldc) const {
+
+            // the rows of C are split between the threads
+            const uint64_t nonzeros_per_row = num_rows_ > 0 ? num_nonzeros_ / num_rows_ + 1 : 1;
+            parallel_for(0, m, parallel_grain(nonzeros_per_row * n), [&](uint32_t first, uint32_t last) {
+                for(uint32_t col = 0; col < n; col += ColumnBlock) {
+                    const uint32_t cols = std::min(ColumnBlock, n - col);
+
+                    for(uint32_t row = first; row < last; row++) {
+                        fp_t *c_row = c + row * ldc + col;
+
+                        if(beta == 0) {
+                            std::fill(c_row, c_row + cols, (fp_t) 0);
+                        } else if(beta != 1) {
+                            for(uint32_t j = 0; j < cols; j++) {
+                                c_row[j] *= beta;
+                            }
+                        }
+
+                        // every non-zero adds a scaled row of B, the loop over the columns is vectorized
+                        for(uint32_t nonzero = row_offsets_[first_row + row];
+                            nonzero < row_offsets_[first_row + row + 1]; nonzero++) {
+                            const fp_t value = values_[nonzero];
+                            const fp_t *b_row = b + column_indices_[nonzero] * ldb + col;
+                            for(uint32_t j = 0; j < cols; j++) {
+                                c_row[j] += value * b_row[j];
+                            }
+                        }
+                    }
+                }
+            });
+        }
+
+        void SparseMatrix::multiply_transposed(uint32_t m, const fp_t *a, uint32_t lda, fp_t beta, fp_t *c,
+                                               uint32_t ldc) const {
+
+            // the columns of C (rows of S) are split between the threads
+            const uint64_t nonzeros_per_row = num_rows_ > 0 ? num_nonzeros_ / num_rows_ + 1 : 1;
+            parallel_for(0, num_rows_, parallel_grain(nonzeros_per_row * m), [&](uint32_t first, uint32_t last) {
+                // element (row, i) of C is the dot product of row i of S with row row of A, four rows of A share every
+                // column index and value loaded from S
+                uint32_t row = 0;
+                for(; row + 4 <= m; row += 4) {
+                    const fp_t *a_rows = a + row * lda;
+                    fp_t *c_rows = c + row * ldc;
+
+                    for(uint32_t i = first; i < last; i++) {
+                        fp_t sums[4] = {0, 0, 0, 0};
+                        for(uint32_t nonzero = row_offsets_[i]; nonzero < row_offsets_[i + 1]; nonzero++) {
+                            const fp_t value = values_[nonzero];
+                            const uint32_t col = column_indices_[nonzero];
+                            for(uint32_t r = 0; r < 4; r++) {
+                                sums[r] += value * a_rows[r * lda + col];
+                            }
+                        }
+                        for(uint32_t r = 0; r < 4; r++) {
+                            c_rows[r * ldc + i] = beta == 0 ? sums[r] : beta * c_rows[r * ldc + i] + sums[r];
+                        }
+                    }
+                }
+
+                for(; row < m; row++) {
+                    const fp_t *a_row = a + row * lda;
+                    fp_t *c_row = c + row * ldc;
+
+                    for(uint32_t i = first; i < last; i++) {
+                        fp_t sum = 0;
+                        for(uint32_t nonzero = row_offsets_[i]; nonzero < row_offsets_[i + 1]; nonzero++) {
+                            sum += values_[nonzero] * a_row[column_indices_[nonzero]];
+                        }
+                        c_row[i] = beta == 0 ? sum : beta * c_row[i] + sum;
+                    }
+                }
+            });
+        }
+    }
+}
@@ -0,0 +1,98 @@
+/**
+ * @brief pico_cnn::naive::SparseMatrix stores the kernel of a pruned layer in the compressed sparse row (CSR) format:
+ * the non-zero values of every row and their columns are stored consecutively, row_offsets_[row] is the position of the
+ * first non-zero of row, row_offsets_[num_rows] the number of non-zeros.
+ *
+ * Convolutions and fully connected layers constructed with a SparseMatrix multiply only the non-zero weights. The
+ * generator stores kernels whose density is below a threshold in this format (see benchmark/benchmark_sparse.cpp),
+ * read_binary_weights() reads them into SparseMatrix objects of the matching size.
+ *
+ * @author Alexander Jung (University of Tuebingen, Chair for Embedded Systems)
+ */
+#ifndef PICO_CNN_SPARSE_MATRIX_H
+#define PICO_CNN_SPARSE_MATRIX_H
+
+#include <cstdint>
+
+#include "../parameters.h"
+
+namespace pico_cnn {
+    namespace naive {
+
+        class SparseMatrix {
+        public:
+            /**
+             * Allocates a matrix with room for num_nonzeros values, which are filled by read_binary_weights().
+             */
+            SparseMatrix(uint32_t num_rows, uint32_t num_columns, uint32_t num_nonzeros);
+
+            /**
+             * Matrix on arrays owned by somebody else, e.g. weights embedded in the binary, which are not freed.
+             */
+            SparseMatrix(uint32_t num_rows, uint32_t num_columns, uint32_t num_nonzeros,
+                         uint32_t *row_offsets, uint32_t *column_indices, fp_t *values);
+            ~SparseMatrix();
+
+            SparseMatrix(const SparseMatrix&) = delete;
+            SparseMatrix &operator=(const SparseMatrix&) = delete;
+
+            /**
+             * @param dense row-major matrix of shape (num_rows, num_columns)
+             * @return compressed copy of dense without its zeros
+             */
+            static SparseMatrix *from_dense(const fp_t *dense, uint32_t num_rows, uint32_t num_columns);
+
+            uint32_t num_rows() const {
+                return num_rows_;
+            }
+
+            uint32_t num_columns() const {
+                return num_columns_;
+            }
+
+            uint32_t num_nonzeros() const {
+                return num_nonzeros_;
+            }
+
+            /**
+             * @return fraction of non-zero elements
+             */
+            fp_t density() const;
+
+            /**
+             * C = S[first_row : first_row + m] * B + beta * C, where S is this matrix and B is dense. Used by
+             * convolutions, where B is the column matrix of im2col.
+             * @param b row-major matrix of shape (num_columns, n)
+             * @param c row-major matrix of shape (m, n), not read if beta == 0
+             */
+            void multiply(uint32_t first_row, uint32_t m, uint32_t n, const fp_t *b, uint32_t ldb,
+                          fp_t beta, fp_t *c, uint32_t ldc) const;
+
+            /**
+             * C = A * S^T + beta * C, where S is this matrix and A is dense. Used by fully connected layers, whose
+             * kernel is stored as (Y, X).
+             * @param a row-major matrix of shape (m, num_columns)
+             * @param c row-major matrix of shape (m, num_rows), not read if beta == 0
+             */
+            void multiply_transposed(uint32_t m, const fp_t *a, uint32_t lda, fp_t beta, fp_t *c, uint32_t ldc) const;
+
+            /**
+             * Frees the arrays of this matrix and uses arrays of the same size owned by somebody else instead, e.g.
+             * weights in shared memory (see io/shared_weights.h).
+             */
+            void use_external_data(uint32_t *row_offsets, uint32_t *column_indices, fp_t *values);
+
+            uint32_t *row_offsets_;
+            uint32_t *column_indices_;
+            fp_t *values_;
+
+        private:
+            uint32_t num_rows_;
+            uint32_t num_columns_;
+            uint32_t num_nonzeros_;
+            bool owns_data_;
+        };
+    }
+}
+
+#endif //PICO_CNN_SPARSE_MATRIX_H
@@ -0,0 +1,178 @@
+#include "jpeg_ingest.h"
+
+#include <atomic>
+#include <cmath>
+#include <csetjmp>
+#include <thread>
+
+#include <jpeglib.h>
+
+namespace pico_cnn {
+    namespace naive {
+
+        struct JpegErrorManager {
+            struct jpeg_error_mgr pub;
+            jmp_buf jump;
+        };
+
+        /**
+         * replaces the default error_exit() of libjpeg which would terminate the program on a corrupted image
+         */
+        static void jpeg_error_exit(j_common_ptr cinfo) {
+            char message[JMSG_LENGTH_MAX];
+            (*cinfo->err->format_message)(cinfo, message);
+            PRINT_ERROR(message)
+            longjmp(((JpegErrorManager*) cinfo->err)->jump, 1);
+        }
+
+        int32_t read_jpeg_into_tensor(const char* jpeg_path, Tensor *input, uint32_t batch,
+                                      const JpegPreprocessing &preprocessing) {
+
+            if(input->num_dimensions() != 4 || input->num_channels() != 3 || batch >= input->num_batches()) {
+                PRINT_ERROR("Input tensor has to be of shape (N, 3, height, width) with N > " << batch)
+                return 1;
+            }
+
+            const uint32_t height = input->height();
+            const uint32_t width = input->width();
+
+            // every possible pixel value is converted once per channel instead of once per pixel
+            fp_t lookup[3][256];
+            const fp_t scale = fabs(preprocessing.lower_bound - preprocessing.upper_bound) / 255.0f;
+            for(uint32_t channel = 0; channel < 3; channel++) {
+                for(uint32_t value = 0; value < 256; value++) {
+                    lookup[channel][value] = value * scale + preprocessing.lower_bound - preprocessing.means[channel];
+                }
+            }
+
+            FILE *jpeg_file = fopen(jpeg_path, "rb");
+            if(jpeg_file == nullptr) {
+                PRINT_ERROR("Could not open " << jpeg_path)
+                return 1;
+            }
+
+            struct jpeg_decompress_struct cinfo;
+            JpegErrorManager jerr;
+
+            cinfo.err = jpeg_std_error(&jerr.pub);
+            jerr.pub.error_exit = jpeg_error_exit;
+
+            if(setjmp(jerr.jump)) {
+                jpeg_destroy_decompress(&cinfo);
+                fclose(jpeg_file);
+                return 1;
+            }
+
+            jpeg_create_decompress(&cinfo);
+            jpeg_stdio_src(&cinfo, jpeg_file);
+            (void) jpeg_read_header(&cinfo, TRUE);
+
+            // largest DCT downscaling (1/8, 1/4, 1/2) which still yields at least the size of the tensor
+            uint32_t scale_denom = 8;
+            while(scale_denom > 1 && ((cinfo.image_width + scale_denom - 1) / scale_denom < width ||
+                                      (cinfo.image_height + scale_denom - 1) / scale_denom < height)) {
+                scale_denom /= 2;
+            }
+            cinfo.scale_num = 1;
+            cinfo.scale_denom = scale_denom;
+
+            if(preprocessing.fast_dct) {
+                cinfo.dct_method = JDCT_IFAST;
+                cinfo.do_fancy_upsampling = FALSE;
+            }
+
+            (void) jpeg_start_decompress(&cinfo);
+
+            const uint32_t decoded_height = cinfo.output_height;
+            const uint32_t decoded_width = cinfo.output_width;
+            const uint32_t components = cinfo.output_components;
+
+            JSAMPARRAY scanline = (*cinfo.mem->alloc_sarray)((j_common_ptr) &cinfo, JPOOL_IMAGE,
+                                                             decoded_width * components, 1);
+
+            // offset of the first component of the source pixel of every column
+            uint32_t *columns = (uint32_t*) (*cinfo.mem->alloc_small)((j_common_ptr) &cinfo, JPOOL_IMAGE,
+                                                                      width * sizeof(uint32_t));
+            for(uint32_t column = 0; column < width; column++) {
+                columns[column] = (uint32_t) ((uint64_t) column * decoded_width / width) * components;
+            }
+
+            // component of the decoded pixel (R, G, B) written to each channel of the tensor, gray images are
+            // replicated to all channels
+            uint32_t component[3];
+            for(uint32_t channel = 0; channel < 3; channel++) {
+                if(components < 3) {
+                    component[channel] = 0;
+                } else {
+                    component[channel] = preprocessing.bgr ? 2 - channel : channel;
+                }
+            }
+
+            fp_t *channels[3];
+            for(uint32_t channel = 0; channel < 3; channel++) {
+                channels[channel] = input->get_ptr_to_channel(batch, channel);
+            }
+
+            for(uint32_t row = 0; row < height; row++) {
+                uint32_t source_row = (uint32_t) ((uint64_t) row * decoded_height / height);
+                while(cinfo.output_scanline <= source_row) {
+                    (void) jpeg_read_scanlines(&cinfo, scanline, 1);
+                }
+
+                const JSAMPLE *pixels = scanline[0];
+                for(uint32_t channel = 0; channel < 3; channel++) {
+                    const fp_t *channel_lookup = lookup[channel];
+                    const JSAMPLE *source = pixels + component[channel];
+                    fp_t *destination = channels[channel] + row * width;
+                    for(uint32_t column = 0; column < width; column++) {
+                        destination[column] = channel_lookup[source[columns[column]]];
+                    }
+                }
+            }
+
+            // the remaining scanlines are not needed
+            jpeg_abort_decompress(&cinfo);
+            jpeg_destroy_decompress(&cinfo);
+            fclose(jpeg_file);
+
+            return 0;
+        }
+
+        uint32_t read_jpeg_batch_into_tensor(const std::vector<std::string> &jpeg_paths, Tensor *input,
+                                             const JpegPreprocessing &preprocessing, uint32_t num_threads) {
+
+            const uint32_t num_images = jpeg_paths.size();
+
+            if(input->num_dimensions() != 4 || num_images > input->num_batches()) {
+                PRINT_ERROR("Input tensor holds less than " << num_images << " images")
+                return num_images;
+            }
+
+            std::atomic<uint32_t> next_image(0);
+            std::atomic<uint32_t> num_errors(0);
+
+            auto decode = [&] {
+                uint32_t image;
+                while((image = next_image++) < num_images) {
+                    if(read_jpeg_into_tensor(jpeg_paths[image].c_str(), input, image, preprocessing) != 0) {
+                        num_errors++;
+                    }
+                }
+            };
+
+            num_threads = MIN(num_threads, num_images);
+
+            std::vector<std::thread> threads;
+            for(uint32_t i = 1; i < num_threads; i++) {
+                threads.push_back(std::thread(decode));
+            }
+            decode();
+
+            for(std::thread &thread: threads) {
+                thread.join();
+            }
+
+            return num_errors;
+        }
+    }
+}
@@ -0,0 +1,76 @@
+/**
+ * @brief decodes jpeg images directly into a preallocated input Tensor of shape (N, 3, height, width)
+ * The DCT scaling of libjpeg (scale_num/scale_denom) is used to decode the image close to the size of the tensor, then
+ * resizing (nearest neighbour), channel reordering, range scaling and mean subtraction are done in a single pass over
+ * the decoded scanlines.
+ *
+ * @author Alexander Jung (University of Tuebingen, Chair for Embedded Systems)
+ */
+
+#ifndef PICO_CNN_JPEG_INGEST_H
+#define PICO_CNN_JPEG_INGEST_H
+
+#include "../parameters.h"
+#include "../tensor.h"
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace pico_cnn {
+    namespace naive {
+
+        struct JpegPreprocessing {
+            /**
+             * range to which a pixel should be scaled [lower_bound, upper_bound]
+             */
+            fp_t lower_bound = 0.0;
+            fp_t upper_bound = 255.0;
+
+            /**
+             * mean of every channel of the tensor which is subtracted after scaling (in the order of the tensor)
+             */
+            fp_t means[3] = {0.0, 0.0, 0.0};
+
+            /**
+             * channel order of the tensor: BGR (as read_jpeg() and read_means()) or RGB
+             */
+            bool bgr = true;
+
+            /**
+             * use the fast integer IDCT and plain chroma upsampling of libjpeg, which is faster but less accurate than
+             * the default decoding of read_jpeg()
+             */
+            bool fast_dct = false;
+        };
+
+        /**
+         * @brief decodes a jpeg file into one batch of a preallocated tensor
+         *
+         * @param jpeg_path full path to jpeg image which should be read
+         * @param input Tensor of shape (N, 3, height, width), the image is resized to height x width
+         * @param batch index of the batch the image is written to
+         * @param preprocessing scaling, mean subtraction and channel order
+         *
+         * @return error (0 = success, 1 = error)
+         */
+        int32_t read_jpeg_into_tensor(const char* jpeg_path, Tensor *input, uint32_t batch,
+                                      const JpegPreprocessing &preprocessing);
+
+        /**
+         * @brief decodes jpeg files concurrently, image i is written into batch i of the tensor
+         *
+         * @param jpeg_paths full paths to the jpeg images (at most input->num_batches())
+         * @param input Tensor of shape (N, 3, height, width)
+         * @param preprocessing scaling, mean subtraction and channel order
+         * @param num_threads number of decoding threads
+         *
+         * @return number of images which could not be read (0 = success)
+         */
+        uint32_t read_jpeg_batch_into_tensor(const std::vector<std::string> &jpeg_paths, Tensor *input,
+                                             const JpegPreprocessing &preprocessing, uint32_t num_threads);
+    }
+}
+
+#endif //PICO_CNN_JPEG_INGEST_H
@@ -1,6 +1,27 @@
 #include "read_binary_weights.h"
 
-int32_t read_binary_weights(const char* path_to_weights_file, pico_cnn::naive::Tensor ***kernels, pico_cnn::naive::Tensor ***biases) {
+// number of tensors of a network passed to read_binary_weights(), which does not check the weights file
+static const uint32_t Unchecked = UINT32_MAX;
+
+/**
+ * @return true if the network has a tensor index with num_elements elements or if num_tensors is Unchecked
+ */
+static bool matches_network(pico_cnn::naive::Tensor **tensors, uint32_t num_tensors, uint32_t index,
+                            uint32_t num_elements, const char *layer) {
+    if(num_tensors == Unchecked) {
+        return true;
+    }
+    if(index >= num_tensors || tensors[index]->num_elements() != num_elements) {
+        PRINT_ERROR("ERROR: Layer " << layer << " does not match the network")
+        return false;
+    }
+    return true;
+}
+
+static int32_t read_weights(const char* path_to_weights_file, pico_cnn::naive::Tensor ***kernels,
+                            uint32_t num_network_kernels, pico_cnn::naive::Tensor ***biases,
+                            uint32_t num_network_biases, pico_cnn::naive::SparseMatrix ***sparse_kernels,
+                            uint32_t num_network_sparse_kernels) {
 
     FILE *binary_file;
     binary_file = fopen(path_to_weights_file, "r");
@@ -52,9 +73,10 @@ int32_t read_binary_weights(const char* path_to_weights_file, pico_cnn::naive::T
         // With the support for BatchNormalization we need separate counters
         // for kernels and biases as the BatchNormalization layer only has
         // four bias like arrays of values.
-        uint32_t layer, kernel_idx, bias_idx;
+        uint32_t layer, kernel_idx, bias_idx, sparse_kernel_idx;
         kernel_idx = 0;
         bias_idx = 0;
+        sparse_kernel_idx = 0;
 
         for(layer = 0; layer < num_layers; layer++) {
 
@@ -119,6 +141,13 @@ int32_t read_binary_weights(const char* path_to_weights_file, pico_cnn::naive::T
                             kernel_width << ", kernel_idx: " << kernel_idx)
 
                 if(kernel_height != 0 && kernel_width != 0 && num_output_channels != 0 && num_input_channels != 0) {
+                    if(!matches_network(*kernels, num_network_kernels, kernel_idx,
+                                        num_output_channels * num_input_channels * kernel_height * kernel_width,
+                                        buffer)) {
+                        fclose(binary_file);
+                        return 1;
+                    }
+
                     auto *values = new fp_t[kernel_height*kernel_width]();
 
                     for (uint32_t out_ch = 0; out_ch < num_output_channels; out_ch++) {
@@ -156,6 +185,11 @@ int32_t read_binary_weights(const char* path_to_weights_file, pico_cnn::naive::T
                         fclose(binary_file);
                         return 1;
                     }
+                    if(!matches_network(*biases, num_network_biases, bias_idx, num_biases, buffer)) {
+                        delete[] bias_values;
+                        fclose(binary_file);
+                        return 1;
+                    }
                     std::memcpy((*biases)[bias_idx]->get_ptr_to_channel(0, 0), bias_values, num_biases*sizeof(fp_t));
 
                     bias_idx++;
@@ -163,6 +197,74 @@ int32_t read_binary_weights(const char* path_to_weights_file, pico_cnn::naive::T
                     delete[] bias_values;
                 }
 
+            } else if (strcmp(buffer_layer_type, "SparseConv") == 0 || strcmp(buffer_layer_type, "SparseGemm") == 0) {
+
+                // kernel in the CSR format: number of rows, columns and non-zeros, row offsets, column indices, values
+                uint32_t shape[3] = {0, 0, 0};
+                if(fread((void *) shape, sizeof(uint32_t), 3, binary_file) != 3) {
+                    PRINT_ERROR("ERROR while reading shape of sparse kernel")
+                    fclose(binary_file);
+                    return 1;
+                }
+                PRINT_DEBUG("Sparse kernel rows: " << shape[0] << ", columns: " << shape[1] << ", non-zeros: " <<
+                            shape[2] << ", sparse_kernel_idx: " << sparse_kernel_idx)
+
+                // shape (0, 0, 0): kernel of a previous layer which is shared
+                if(shape[0] != 0) {
+                    if(sparse_kernels == nullptr) {
+                        PRINT_ERROR("ERROR: Layer " << buffer << " has a sparse kernel, but no sparse kernels were passed")
+                        fclose(binary_file);
+                        return 1;
+                    }
+
+                    if(num_network_sparse_kernels != Unchecked && sparse_kernel_idx >= num_network_sparse_kernels) {
+                        PRINT_ERROR("ERROR: Layer " << buffer << " does not match the network")
+                        fclose(binary_file);
+                        return 1;
+                    }
+
+                    pico_cnn::naive::SparseMatrix *kernel = (*sparse_kernels)[sparse_kernel_idx];
+                    if(kernel->num_rows() != shape[0] || kernel->num_columns() != shape[1] ||
+                       kernel->num_nonzeros() != shape[2]) {
+                        PRINT_ERROR("ERROR: Sparse kernel of layer " << buffer << " does not match the network")
+                        fclose(binary_file);
+                        return 1;
+                    }
+
+                    if(fread((void *) kernel->row_offsets_, sizeof(uint32_t), shape[0] + 1, binary_file) != shape[0] + 1 ||
+                       fread((void *) kernel->column_indices_, sizeof(uint32_t), shape[2], binary_file) != shape[2] ||
+                       fread((void *) kernel->values_, sizeof(float), shape[2], binary_file) != shape[2]) {
+                        PRINT_ERROR("ERROR while reading sparse kernel values.")
+                        fclose(binary_file);
+                        return 1;
+                    }
+
+                    sparse_kernel_idx++;
+                }
+
+                uint32_t num_biases = 0;
+                if(fread((void *) &num_biases, sizeof(num_biases), 1, binary_file) != 1) {
+                    PRINT_ERROR("ERROR while reading number of biases")
+                    fclose(binary_file);
+                    return 1;
+                }
+                PRINT_DEBUG("Number of biases: " << num_biases)
+
+                if(num_biases) {
+                    if(!matches_network(*biases, num_network_biases, bias_idx, num_biases, buffer)) {
+                        fclose(binary_file);
+                        return 1;
+                    }
+                    if(fread((void *) (*biases)[bias_idx]->get_ptr_to_channel(0, 0), sizeof(float), num_biases,
+                             binary_file) != num_biases) {
+                        PRINT_ERROR("ERROR while reading bias values.")
+                        fclose(binary_file);
+                        return 1;
+                    }
+
+                    bias_idx++;
+                }
+
             } else if (strcmp(buffer_layer_type, "BatchNormalization") == 0) {
                 // read gamma values
                 uint32_t num_gamma = 0;
@@ -182,6 +284,11 @@ int32_t read_binary_weights(const char* path_to_weights_file, pico_cnn::naive::T
                         fclose(binary_file);
                         return 1;
                     }
+                    if(!matches_network(*biases, num_network_biases, bias_idx, num_gamma, buffer)) {
+                        delete[] gamma_values;
+                        fclose(binary_file);
+                        return 1;
+                    }
                     std::memcpy((*biases)[bias_idx]->get_ptr_to_channel(0, 0), gamma_values, num_gamma*sizeof(fp_t));
 
                     bias_idx++;
@@ -207,6 +314,11 @@ int32_t read_binary_weights(const char* path_to_weights_file, pico_cnn::naive::T
                         fclose(binary_file);
                         return 1;
                     }
+                    if(!matches_network(*biases, num_network_biases, bias_idx, num_beta, buffer)) {
+                        delete[] beta_values;
+                        fclose(binary_file);
+                        return 1;
+                    }
                     std::memcpy((*biases)[bias_idx]->get_ptr_to_channel(0, 0), beta_values, num_beta*sizeof(fp_t));
 
                     bias_idx++;
@@ -232,6 +344,11 @@ int32_t read_binary_weights(const char* path_to_weights_file, pico_cnn::naive::T
                         fclose(binary_file);
                         return 1;
                     }
+                    if(!matches_network(*biases, num_network_biases, bias_idx, num_mean, buffer)) {
+                        delete[] mean_values;
+                        fclose(binary_file);
+                        return 1;
+                    }
                     std::memcpy((*biases)[bias_idx]->get_ptr_to_channel(0, 0), mean_values, num_mean*sizeof(fp_t));
 
                     bias_idx++;
@@ -257,6 +374,11 @@ int32_t read_binary_weights(const char* path_to_weights_file, pico_cnn::naive::T
                         fclose(binary_file);
                         return 1;
                     }
+                    if(!matches_network(*biases, num_network_biases, bias_idx, num_variance, buffer)) {
+                        delete[] variance_values;
+                        fclose(binary_file);
+                        return 1;
+                    }
                     std::memcpy((*biases)[bias_idx]->get_ptr_to_channel(0, 0), variance_values, num_variance*sizeof(fp_t));
 
                     bias_idx++;
@@ -290,12 +412,19 @@ int32_t read_binary_weights(const char* path_to_weights_file, pico_cnn::naive::T
 
                 PRINT_DEBUG("Num kernels: " << num_kernels << ", height: " << kernel_height << ", width: " << kernel_width << ", kernel_idx: " << kernel_idx)
 
+                if(num_kernels != 1) {
+                    PRINT_ERROR("ERROR: Number of kernels != 1")
+                    fclose(binary_file);
+                    return 1;
+                }
+                if(!matches_network(*kernels, num_network_kernels, kernel_idx, kernel_height * kernel_width, buffer)) {
+                    fclose(binary_file);
+                    return 1;
+                }
+
                 uint32_t kernel;
                 auto *values = new fp_t[kernel_height*kernel_width]();
 
-                if(num_kernels != 1)
-                    PRINT_ERROR_AND_DIE("Number of kernels != 1")
-
                 for(kernel = 0; kernel < num_kernels; kernel++) {
                     if(fread((void *) values, sizeof(float), kernel_height * kernel_width, binary_file) != (kernel_height*kernel_width)) {
                         PRINT_ERROR("ERROR while reading kernel values.")
@@ -327,13 +456,20 @@ int32_t read_binary_weights(const char* path_to_weights_file, pico_cnn::naive::T
                         fclose(binary_file);
                         return 1;
                     }
+                    if(!matches_network(*biases, num_network_biases, bias_idx, num_biases, buffer)) {
+                        delete[] bias_values;
+                        fclose(binary_file);
+                        return 1;
+                    }
                     std::memcpy((*biases)[bias_idx]->get_ptr_to_channel(0, 0), bias_values, num_biases*sizeof(fp_t));
 
                     bias_idx++;
 
                     delete[] bias_values;
                 }
-            } else if (strcmp(buffer_layer_type, "Add") == 0) {
+            } else if (strcmp(buffer_layer_type, "Add") == 0 || strcmp(buffer_layer_type, "Mul") == 0 ||
+                       strcmp(buffer_layer_type, "PRelu") == 0) {
+                // constant operand of an element-wise operation, stored flattened
                 uint32_t num_biases = 0;
                 if(fread((void *) &num_biases, sizeof(num_biases), 1, binary_file) != 1) {
                     PRINT_ERROR("ERROR while reading number of biases")
@@ -351,6 +487,11 @@ int32_t read_binary_weights(const char* path_to_weights_file, pico_cnn::naive::T
                         fclose(binary_file);
                         return 1;
                     }
+                    if(!matches_network(*biases, num_network_biases, bias_idx, num_biases, buffer)) {
+                        delete[] bias_values;
+                        fclose(binary_file);
+                        return 1;
+                    }
                     std::memcpy((*biases)[bias_idx]->get_ptr_to_channel(0, 0), bias_values, num_biases*sizeof(fp_t));
 
                     bias_idx++;
@@ -382,8 +523,34 @@ int32_t read_binary_weights(const char* path_to_weights_file, pico_cnn::naive::T
         }
         PRINT_DEBUG(end_marker)
 
+        if((num_network_kernels != Unchecked && kernel_idx != num_network_kernels) ||
+           (num_network_biases != Unchecked && bias_idx != num_network_biases) ||
+           (num_network_sparse_kernels != Unchecked && sparse_kernel_idx != num_network_sparse_kernels)) {
+            PRINT_ERROR("ERROR: Weights file has " << kernel_idx << " kernels, " << bias_idx << " biases and " <<
+                        sparse_kernel_idx << " sparse kernels, the network " << num_network_kernels << ", " <<
+                        num_network_biases << " and " << num_network_sparse_kernels)
+            fclose(binary_file);
+            return 1;
+        }
+
+    } else {
+        PRINT_ERROR("ERROR: Could not open weights file " << path_to_weights_file)
+        return 1;
     }
     fclose(binary_file);
     return 0;
 
 }
+
+int32_t read_binary_weights(const char* path_to_weights_file, pico_cnn::naive::Tensor ***kernels, pico_cnn::naive::Tensor ***biases,
+                            pico_cnn::naive::SparseMatrix ***sparse_kernels) {
+    return read_weights(path_to_weights_file, kernels, Unchecked, biases, Unchecked, sparse_kernels, Unchecked);
+}
+
+int32_t read_binary_weights_checked(const char* path_to_weights_file,
+                                    pico_cnn::naive::Tensor **kernels, uint32_t num_kernels,
+                                    pico_cnn::naive::Tensor **biases, uint32_t num_biases,
+                                    pico_cnn::naive::SparseMatrix **sparse_kernels, uint32_t num_sparse_kernels) {
+    return read_weights(path_to_weights_file, &kernels, num_kernels, &biases, num_biases, &sparse_kernels,
+                        num_sparse_kernels);
+}
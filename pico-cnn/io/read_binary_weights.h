@@ -14,7 +14,25 @@
 #include <cstring>
 
 #include "../tensor.h"
+#include "../gemm/sparse_matrix.h"
 
-int32_t read_binary_weights(const char* path_to_weights_file, pico_cnn::naive::Tensor ***kernels, pico_cnn::naive::Tensor ***biases);
+/**
+ * @param sparse_kernels kernels of layers stored as "SparseConv" or "SparseGemm", only needed if the weights file
+ * contains such layers
+ */
+int32_t read_binary_weights(const char* path_to_weights_file, pico_cnn::naive::Tensor ***kernels, pico_cnn::naive::Tensor ***biases,
+                            pico_cnn::naive::SparseMatrix ***sparse_kernels = nullptr);
+
+/**
+ * Same as read_binary_weights(), but fails instead of writing past the tensors if the weights file does not match the
+ * network, i.e. if it has more or fewer kernels, biases or sparse kernels than the network or one of them has another
+ * number of elements. Tensors may have been partially overwritten when it fails.
+ * @param num_kernels number of elements of kernels, the same for biases and sparse_kernels
+ */
+int32_t read_binary_weights_checked(const char* path_to_weights_file,
+                                    pico_cnn::naive::Tensor **kernels, uint32_t num_kernels,
+                                    pico_cnn::naive::Tensor **biases, uint32_t num_biases,
+                                    pico_cnn::naive::SparseMatrix **sparse_kernels = nullptr,
+                                    uint32_t num_sparse_kernels = 0);
 
 #endif //PICO_CNN_READ_BINARY_WEIGHTS_H
@@ -0,0 +1,163 @@
+#include "sample_source.h"
+
+#include <unistd.h>
+#include <vector>
+
+#include "read_mnist.h"
+#include "read_imagenet_validation_labels.h"
+
+namespace pico_cnn {
+    namespace naive {
+
+        MnistSource::MnistSource(const char* path_to_mnist_images, const char* path_to_mnist_labels,
+                                 uint32_t num_images, uint8_t padding, fp_t lower_bound, fp_t upper_bound) :
+                images_(nullptr),
+                labels_(nullptr),
+                num_images_(0),
+                height_(0),
+                width_(0),
+                padding_(padding),
+                lower_bound_(lower_bound),
+                upper_bound_(upper_bound) {
+
+            images_ = fopen(path_to_mnist_images, "rb");
+            if(images_ == nullptr) {
+                PRINT_ERROR("Could not open " << path_to_mnist_images)
+                return;
+            }
+
+            uint32_t header[4];
+            if(fread(header, sizeof(uint32_t), 4, images_) != 4 || change_endianess(header[0]) != 2051) {
+                PRINT_ERROR("Wrong magic number in " << path_to_mnist_images)
+                fclose(images_);
+                images_ = nullptr;
+                return;
+            }
+
+            uint32_t num_images_provided = change_endianess(header[1]);
+            height_ = change_endianess(header[2]);
+            width_ = change_endianess(header[3]);
+
+            if(num_images == 0 || num_images > num_images_provided) {
+                num_images = num_images_provided;
+            }
+
+            num_images_ = read_mnist_labels(path_to_mnist_labels, &labels_, num_images);
+            if(num_images_ != num_images) {
+                PRINT_ERROR(num_images << " images != " << num_images_ << " labels")
+                num_images_ = 0;
+            }
+        }
+
+        MnistSource::~MnistSource() {
+            if(images_ != nullptr) {
+                fclose(images_);
+            }
+            free(labels_);
+        }
+
+        bool MnistSource::valid() const {
+            return images_ != nullptr && num_images_ > 0;
+        }
+
+        uint32_t MnistSource::num_samples() const {
+            return num_images_;
+        }
+
+        int32_t MnistSource::load(uint32_t index, Tensor *input, uint32_t *label) {
+            const uint32_t padded_height = height_ + 2 * padding_;
+            const uint32_t padded_width = width_ + 2 * padding_;
+
+            if(index >= num_images_ || input->num_elements() != padded_height * padded_width) {
+                PRINT_ERROR("Invalid sample " << index << " or input tensor size " << input->num_elements())
+                return 1;
+            }
+
+            // pixels of the image, one buffer per loading thread which is only enlarged for larger images
+            static thread_local std::vector<uint8_t> pixels;
+            if(pixels.size() < height_ * width_) {
+                pixels.resize(height_ * width_);
+            }
+            uint8_t *buffer = pixels.data();
+
+            // pread() reads at the offset of the image without moving the offset of the file
+            off_t offset = 4 * sizeof(uint32_t) + (off_t) index * height_ * width_;
+            if(pread(fileno(images_), buffer, height_ * width_, offset) != (ssize_t) (height_ * width_)) {
+                PRINT_ERROR("Could not read image " << index)
+                return 1;
+            }
+
+            const fp_t scale = fabs(lower_bound_ - upper_bound_) / 255.0f;
+            fp_t *data = input->data_;
+
+            for(uint32_t row = 0; row < padded_height; row++) {
+                for(uint32_t column = 0; column < padded_width; column++) {
+                    if(row < padding_ || row >= height_ + padding_ || column < padding_ || column >= width_ + padding_) {
+                        data[row * padded_width + column] = lower_bound_;
+                    } else {
+                        data[row * padded_width + column] =
+                                buffer[(row - padding_) * width_ + column - padding_] * scale + lower_bound_;
+                    }
+                }
+            }
+
+            *label = labels_[index];
+
+            return 0;
+        }
+
+        ImageNetSource::ImageNetSource(const char* path_to_images, const char* path_to_imagenet_validation_labels,
+                                       uint32_t num_images, const fp_t *means) :
+                path_to_images_(path_to_images),
+                labels_(nullptr),
+                num_images_(0) {
+
+            for(uint32_t channel = 0; channel < 3; channel++) {
+                preprocessing_.means[channel] = means != nullptr ? means[channel] : 0;
+            }
+
+            // labels are stored from position 1 on
+            int32_t num_labels = read_imagenet_validation_labels(path_to_imagenet_validation_labels, &labels_,
+                                                                 num_images + 1);
+            if(num_labels < 2) {
+                PRINT_ERROR("Could not read imagenet validation labels " << path_to_imagenet_validation_labels)
+                return;
+            }
+
+            num_images_ = num_labels - 1;
+        }
+
+        ImageNetSource::~ImageNetSource() {
+            free(labels_);
+        }
+
+        bool ImageNetSource::valid() const {
+            return num_images_ > 0;
+        }
+
+        uint32_t ImageNetSource::num_samples() const {
+            return num_images_;
+        }
+
+        int32_t ImageNetSource::load(uint32_t index, Tensor *input, uint32_t *label) {
+            if(index >= num_images_ || input->num_dimensions() != 4 || input->num_channels() != 3) {
+                PRINT_ERROR("Invalid sample " << index << " or input tensor shape")
+                return 1;
+            }
+
+            // the validation images are numbered with 8 digits, but a uint32_t may have up to 10
+            char file_name[FILE_NAME_LENGTH + 3];
+            snprintf(file_name, sizeof(file_name), "ILSVRC2012_val_%08u.JPEG", index + 1);
+            std::string jpeg_path = path_to_images_ + "/" + file_name;
+
+            if(read_jpeg_into_tensor(jpeg_path.c_str(), input, 0, preprocessing_) != 0) {
+                PRINT_ERROR("Could not read jpeg from " << jpeg_path)
+                return 1;
+            }
+
+            *label = labels_[index + 1];
+
+            return 0;
+        }
+    }
+}
@@ -0,0 +1,128 @@
+/**
+ * @brief provides sources of labeled samples (MNIST, ImageNet validation set) which load and preprocess one sample at
+ * a time directly into a Tensor instead of reading the whole dataset into memory upfront
+ *
+ * @author Alexander Jung (University of Tuebingen, Chair for Embedded Systems)
+ */
+
+#ifndef PICO_CNN_SAMPLE_SOURCE_H
+#define PICO_CNN_SAMPLE_SOURCE_H
+
+#include "../parameters.h"
+#include "../tensor.h"
+#include "jpeg_ingest.h"
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace pico_cnn {
+    namespace naive {
+
+        class SampleSource {
+        public:
+            virtual ~SampleSource() {};
+
+            /**
+             * @return number of samples provided by the source
+             */
+            virtual uint32_t num_samples() const = 0;
+
+            /**
+             * @brief loads and preprocesses a single sample
+             * Has to be thread-safe for different samples, as multiple samples are loaded concurrently.
+             *
+             * @param index of the sample (0 <= index < num_samples())
+             * @param input Tensor the preprocessed sample is written to
+             * @param label of the sample
+             *
+             * @return error (0 = success, 1 = error)
+             */
+            virtual int32_t load(uint32_t index, Tensor *input, uint32_t *label) = 0;
+        };
+
+        /**
+         * @brief reads MNIST images on demand from an idx3 file, the labels are read once from the idx1 file
+         *
+         * The pixels of an image are read into a buffer of the calling thread, which is allocated by its first load,
+         * so concurrent loads do not wait for each other and later loads do not allocate memory.
+         */
+        class MnistSource : public SampleSource {
+        public:
+            /**
+             * @param path_to_mnist_images full path to file which contains MNIST images
+             * @param path_to_mnist_labels full path to file which contains MNIST labels
+             * @param num_images maximum number of images which should be provided (0 = all)
+             * @param padding number of lower_bound pixels which should be added to the border of each image
+             * @param lower_bound to which float range should the images be converted [lower_bound, upper_bound]
+             * @param upper_bound to which float range should the images be converted [lower_bound, upper_bound]
+             */
+            MnistSource(const char* path_to_mnist_images, const char* path_to_mnist_labels, uint32_t num_images,
+                        uint8_t padding, fp_t lower_bound, fp_t upper_bound);
+            ~MnistSource() override;
+
+            /**
+             * @return false if one of the files could not be read
+             */
+            bool valid() const;
+
+            uint32_t num_samples() const override;
+
+            /**
+             * @param input Tensor of shape (1, 1, height+2*padding, width+2*padding)
+             */
+            int32_t load(uint32_t index, Tensor *input, uint32_t *label) override;
+
+        private:
+            FILE *images_;
+            uint8_t *labels_;
+            uint32_t num_images_;
+            uint32_t height_;
+            uint32_t width_;
+            uint8_t padding_;
+            fp_t lower_bound_;
+            fp_t upper_bound_;
+        };
+
+        /**
+         * @brief reads images of the ImageNet validation set (ILSVRC2012_val_XXXXXXXX.JPEG) from a directory, the
+         * labels are read with read_imagenet_validation_labels()
+         */
+        class ImageNetSource : public SampleSource {
+        public:
+            /**
+             * @param path_to_images directory containing the validation images
+             * @param path_to_imagenet_validation_labels file with the labels of the validation images
+             * @param num_images maximum number of images which should be provided
+             * @param means mean of the blue, green and red channel which is subtracted from every pixel
+             * (nullptr = no mean subtraction)
+             */
+            ImageNetSource(const char* path_to_images, const char* path_to_imagenet_validation_labels,
+                           uint32_t num_images, const fp_t *means);
+            ~ImageNetSource() override;
+
+            /**
+             * @return false if the labels could not be read
+             */
+            bool valid() const;
+
+            uint32_t num_samples() const override;
+
+            /**
+             * Images are decoded with read_jpeg_into_tensor(), i.e. downscaled by libjpeg and resized (nearest
+             * neighbour) to the size of the input tensor.
+             * @param input Tensor of shape (1, 3, height, width), channels in BGR order and values in [0, 255]
+             */
+            int32_t load(uint32_t index, Tensor *input, uint32_t *label) override;
+
+        private:
+            std::string path_to_images_;
+            uint32_t *labels_;
+            uint32_t num_images_;
+            JpegPreprocessing preprocessing_;
+        };
+    }
+}
+
+#endif //PICO_CNN_SAMPLE_SOURCE_H
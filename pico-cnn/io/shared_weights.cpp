@@ -0,0 +1,254 @@
+#include "shared_weights.h"
+
+#include <cerrno>
+#include <chrono>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "read_binary_weights.h"
+
+using pico_cnn::naive::SharedWeightsHeader;
+using pico_cnn::naive::SharedWeightsEntry;
+
+// the data of every entry starts at a multiple of this, e.g. for aligned vector loads
+static const uint64_t SharedWeightsAlignment = 64;
+
+static uint64_t align(uint64_t offset) {
+    return (offset + SharedWeightsAlignment - 1) / SharedWeightsAlignment * SharedWeightsAlignment;
+}
+
+/**
+ * @param data receives the data of the kernels, biases and arrays of the sparse kernels in the order of the segment
+ * @param num_bytes receives their sizes
+ */
+static void collect_entries(pico_cnn::naive::Tensor **kernels, uint32_t num_kernels,
+                            pico_cnn::naive::Tensor **biases, uint32_t num_biases,
+                            pico_cnn::naive::SparseMatrix **sparse_kernels, uint32_t num_sparse_kernels,
+                            std::vector<const void *> &data, std::vector<uint64_t> &num_bytes) {
+    for(uint32_t i = 0; i < num_kernels; i++) {
+        data.push_back(kernels[i]->data_);
+        num_bytes.push_back(kernels[i]->size_bytes());
+    }
+    for(uint32_t i = 0; i < num_biases; i++) {
+        data.push_back(biases[i]->data_);
+        num_bytes.push_back(biases[i]->size_bytes());
+    }
+    for(uint32_t i = 0; i < num_sparse_kernels; i++) {
+        pico_cnn::naive::SparseMatrix *matrix = sparse_kernels[i];
+        data.push_back(matrix->row_offsets_);
+        num_bytes.push_back((uint64_t) (matrix->num_rows() + 1) * sizeof(uint32_t));
+        data.push_back(matrix->column_indices_);
+        num_bytes.push_back((uint64_t) matrix->num_nonzeros() * sizeof(uint32_t));
+        data.push_back(matrix->values_);
+        num_bytes.push_back((uint64_t) matrix->num_nonzeros() * sizeof(fp_t));
+    }
+}
+
+/**
+ * Switches all tensors and sparse kernels to the data of their entries in the segment mapped at base.
+ */
+static void use_segment(const char *base, pico_cnn::naive::Tensor **kernels, uint32_t num_kernels,
+                        pico_cnn::naive::Tensor **biases, uint32_t num_biases,
+                        pico_cnn::naive::SparseMatrix **sparse_kernels, uint32_t num_sparse_kernels) {
+    auto entries = (const SharedWeightsEntry *) (base + sizeof(SharedWeightsHeader));
+    auto entry = [&](uint32_t index) {
+        return (void *) (base + entries[index].offset);
+    };
+
+    uint32_t index = 0;
+    for(uint32_t i = 0; i < num_kernels; i++) {
+        kernels[i]->use_external_data((fp_t *) entry(index++));
+    }
+    for(uint32_t i = 0; i < num_biases; i++) {
+        biases[i]->use_external_data((fp_t *) entry(index++));
+    }
+    for(uint32_t i = 0; i < num_sparse_kernels; i++) {
+        sparse_kernels[i]->use_external_data((uint32_t *) entry(index), (uint32_t *) entry(index + 1),
+                                             (fp_t *) entry(index + 2));
+        index += 3;
+    }
+}
+
+static int32_t create_segment(int fd, const char *path_to_weights_file, const char *segment_name,
+                              const struct stat &file_status,
+                              pico_cnn::naive::Tensor **kernels, uint32_t num_kernels,
+                              pico_cnn::naive::Tensor **biases, uint32_t num_biases,
+                              pico_cnn::naive::SparseMatrix **sparse_kernels, uint32_t num_sparse_kernels) {
+
+    if(read_binary_weights_checked(path_to_weights_file, kernels, num_kernels, biases, num_biases,
+                                   sparse_kernels, num_sparse_kernels) != 0) {
+        return 1;
+    }
+
+    std::vector<const void *> data;
+    std::vector<uint64_t> num_bytes;
+    collect_entries(kernels, num_kernels, biases, num_biases, sparse_kernels, num_sparse_kernels, data, num_bytes);
+
+    uint64_t size = align(sizeof(SharedWeightsHeader) + data.size() * sizeof(SharedWeightsEntry));
+    std::vector<uint64_t> offsets;
+    for(uint64_t bytes: num_bytes) {
+        offsets.push_back(size);
+        size = align(size + bytes);
+    }
+
+    if(ftruncate(fd, size) != 0) {
+        PRINT_ERROR("Could not resize shared weights " << segment_name << ": " << strerror(errno))
+        return 1;
+    }
+
+    auto base = (char *) mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if(base == MAP_FAILED) {
+        PRINT_ERROR("Could not map shared weights " << segment_name << ": " << strerror(errno))
+        return 1;
+    }
+
+    auto header = new(base) SharedWeightsHeader();
+    header->magic = pico_cnn::naive::SharedWeightsMagic;
+    header->version = pico_cnn::naive::SharedWeightsVersion;
+    header->num_entries = data.size();
+    header->size = size;
+    header->file_size = file_status.st_size;
+    header->file_mtime_ns = file_status.st_mtim.tv_sec * 1000000000LL + file_status.st_mtim.tv_nsec;
+
+    auto entries = (SharedWeightsEntry *) (base + sizeof(SharedWeightsHeader));
+    for(uint32_t i = 0; i < data.size(); i++) {
+        entries[i].offset = offsets[i];
+        entries[i].num_bytes = num_bytes[i];
+        std::memcpy(base + offsets[i], data[i], num_bytes[i]);
+    }
+
+    header->ready.store(1, std::memory_order_release);
+
+    // the private copies read from the file are freed, this process uses the segment like all others
+    mprotect(base, size, PROT_READ);
+    use_segment(base, kernels, num_kernels, biases, num_biases, sparse_kernels, num_sparse_kernels);
+
+    PRINT_INFO("Created shared weights " << segment_name << " (" << size << " bytes)")
+    return 0;
+}
+
+static int32_t attach_segment(int fd, const char *segment_name, const struct stat *file_status,
+                              pico_cnn::naive::Tensor **kernels, uint32_t num_kernels,
+                              pico_cnn::naive::Tensor **biases, uint32_t num_biases,
+                              pico_cnn::naive::SparseMatrix **sparse_kernels, uint32_t num_sparse_kernels,
+                              uint32_t timeout_ms) {
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    auto timed_out = [&]() {
+        if(std::chrono::steady_clock::now() > deadline) {
+            PRINT_ERROR("Shared weights " << segment_name << " were not created within " << timeout_ms << " ms")
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        return false;
+    };
+
+    // the creating process sets the size before it writes the data
+    struct stat segment_status;
+    while(fstat(fd, &segment_status) != 0 || (uint64_t) segment_status.st_size < sizeof(SharedWeightsHeader)) {
+        if(timed_out()) {
+            return 1;
+        }
+    }
+
+    uint64_t size = segment_status.st_size;
+    auto base = (const char *) mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    if(base == MAP_FAILED) {
+        PRINT_ERROR("Could not map shared weights " << segment_name << ": " << strerror(errno))
+        return 1;
+    }
+
+    auto header = (const SharedWeightsHeader *) base;
+    while(header->ready.load(std::memory_order_acquire) != 1) {
+        if(timed_out()) {
+            munmap((void *) base, size);
+            return 1;
+        }
+    }
+
+    std::vector<const void *> data;
+    std::vector<uint64_t> num_bytes;
+    collect_entries(kernels, num_kernels, biases, num_biases, sparse_kernels, num_sparse_kernels, data, num_bytes);
+
+    bool valid = header->magic == pico_cnn::naive::SharedWeightsMagic &&
+                 header->version == pico_cnn::naive::SharedWeightsVersion && header->size == size &&
+                 header->num_entries == data.size();
+    // without the weights file (e.g. on workers) the segment is trusted
+    if(valid && file_status) {
+        valid = header->file_size == (uint64_t) file_status->st_size &&
+                header->file_mtime_ns == file_status->st_mtim.tv_sec * 1000000000LL + file_status->st_mtim.tv_nsec;
+    }
+    auto entries = (const SharedWeightsEntry *) (base + sizeof(SharedWeightsHeader));
+    for(uint32_t i = 0; valid && i < data.size(); i++) {
+        valid = entries[i].num_bytes == num_bytes[i] && entries[i].offset + entries[i].num_bytes <= size;
+    }
+
+    if(!valid) {
+        PRINT_ERROR("Shared weights " << segment_name << " do not match the network or the weights file, "
+                    "remove them with unlink_shared_weights()")
+        munmap((void *) base, size);
+        return 1;
+    }
+
+    use_segment(base, kernels, num_kernels, biases, num_biases, sparse_kernels, num_sparse_kernels);
+
+    PRINT_INFO("Attached shared weights " << segment_name << " (" << size << " bytes)")
+    return 0;
+}
+
+int32_t read_shared_weights(const char *path_to_weights_file, const char *segment_name,
+                            pico_cnn::naive::Tensor **kernels, uint32_t num_kernels,
+                            pico_cnn::naive::Tensor **biases, uint32_t num_biases,
+                            pico_cnn::naive::SparseMatrix **sparse_kernels, uint32_t num_sparse_kernels,
+                            uint32_t timeout_ms) {
+
+    struct stat file_status;
+    bool file_exists = stat(path_to_weights_file, &file_status) == 0;
+
+    int fd = -1;
+    if(file_exists) {
+        fd = shm_open(segment_name, O_RDWR | O_CREAT | O_EXCL, 0644);
+    }
+
+    if(fd >= 0) {
+        int32_t result = create_segment(fd, path_to_weights_file, segment_name, file_status,
+                                        kernels, num_kernels, biases, num_biases, sparse_kernels, num_sparse_kernels);
+        close(fd);
+        if(result != 0) {
+            // processes waiting for the segment time out
+            shm_unlink(segment_name);
+        }
+        return result;
+    }
+
+    if(file_exists && errno != EEXIST) {
+        PRINT_ERROR("Could not create shared weights " << segment_name << ": " << strerror(errno))
+        return 1;
+    }
+
+    fd = shm_open(segment_name, O_RDONLY, 0);
+    if(fd < 0) {
+        PRINT_ERROR("Could not open shared weights " << segment_name << ": " << strerror(errno))
+        return 1;
+    }
+
+    int32_t result = attach_segment(fd, segment_name, file_exists ? &file_status : nullptr,
+                                    kernels, num_kernels, biases, num_biases, sparse_kernels, num_sparse_kernels,
+                                    timeout_ms);
+    close(fd);
+    return result;
+}
+
+int32_t unlink_shared_weights(const char *segment_name) {
+    if(shm_unlink(segment_name) != 0) {
+        PRINT_ERROR("Could not remove shared weights " << segment_name << ": " << strerror(errno))
+        return 1;
+    }
+    return 0;
+}
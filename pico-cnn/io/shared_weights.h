@@ -0,0 +1,74 @@
+/**
+ * @brief provides read_shared_weights(), which shares the weights of a network between processes through a named
+ * POSIX shared-memory segment: the first process reads the weights file with read_binary_weights() and copies the
+ * decoded kernels and biases into the segment, all later processes only map it read-only and do not need the weights
+ * file. The kernels and biases of every process are switched to the segment, so a host holds one copy of the weights
+ * regardless of the number of worker processes.
+ *
+ * Layout of the segment: SharedWeightsHeader, one SharedWeightsEntry per kernel, bias and array of a sparse kernel (row
+ * offsets, column indices, values) in this order, then the data of the entries, each aligned to 64 bytes.
+ *
+ * @author Alexander Jung (University of Tuebingen, Chair for Embedded Systems)
+ */
+
+#ifndef PICO_CNN_SHARED_WEIGHTS_H
+#define PICO_CNN_SHARED_WEIGHTS_H
+
+#include "../parameters.h"
+#include <atomic>
+#include <cstdint>
+
+#include "../tensor.h"
+#include "../gemm/sparse_matrix.h"
+
+namespace pico_cnn {
+    namespace naive {
+
+        // "PCSW"
+        constexpr uint32_t SharedWeightsMagic = 0x57534350;
+        // incremented whenever the layout of the segment changes
+        constexpr uint32_t SharedWeightsVersion = 1;
+
+        struct SharedWeightsHeader {
+            uint32_t magic;
+            uint32_t version;
+            // set by the creating process after all data has been written
+            std::atomic<uint32_t> ready;
+            uint32_t num_entries;
+            uint64_t size;
+            // size and modification time of the weights file the segment was created from
+            uint64_t file_size;
+            int64_t file_mtime_ns;
+        };
+
+        struct SharedWeightsEntry {
+            // from the start of the segment
+            uint64_t offset;
+            uint64_t num_bytes;
+        };
+    }
+}
+
+/**
+ * Creates the segment segment_name from the weights file or attaches to it if it already exists, and switches the
+ * kernels and biases (allocated by the Network) to the data in the segment. Processes attaching while another one
+ * creates the segment wait until it is ready.
+ * @param segment_name name of the segment, e.g. "/pico-cnn-alexnet"
+ * @param num_kernels number of elements of kernels, the same for biases and sparse_kernels
+ * @param timeout_ms maximal time to wait for the creating process
+ * @return 0 on success, 1 if the weights file could not be read or the segment does not match the tensors or the
+ * weights file (e.g. after the weights have been updated, remove it with unlink_shared_weights() then)
+ */
+int32_t read_shared_weights(const char *path_to_weights_file, const char *segment_name,
+                            pico_cnn::naive::Tensor **kernels, uint32_t num_kernels,
+                            pico_cnn::naive::Tensor **biases, uint32_t num_biases,
+                            pico_cnn::naive::SparseMatrix **sparse_kernels = nullptr, uint32_t num_sparse_kernels = 0,
+                            uint32_t timeout_ms = 60000);
+
+/**
+ * Removes the name of the segment, processes which have attached to it keep their mapping.
+ * @return 0 on success, 1 if there is no such segment
+ */
+int32_t unlink_shared_weights(const char *segment_name);
+
+#endif //PICO_CNN_SHARED_WEIGHTS_H
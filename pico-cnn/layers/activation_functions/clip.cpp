@@ -1,4 +1,6 @@
 #include "clip.h"
+#include "../../runtime/thread_pool.h"
+
 namespace pico_cnn {
     namespace naive {
 
@@ -17,14 +19,16 @@ namespace pico_cnn {
 
         void Clip::activate(Tensor *input, Tensor *output) {
             uint32_t num_elements = input->num_elements();
-            for (uint32_t element = 0; element < num_elements; element++) {
-                if(input->access_blob(element) < min)
-                    output->access_blob(element) = min;
-                else if(input->access_blob(element) > max)
-                    output->access_blob(element) = max;
-                else
-                    output->access_blob(element) = input->access_blob(element);
-            }
+            parallel_for(0, num_elements, parallel_grain(1), [&](uint32_t first, uint32_t last) {
+                for (uint32_t element = first; element < last; element++) {
+                    if(input->access_blob(element) < min)
+                        output->access_blob(element) = min;
+                    else if(input->access_blob(element) > max)
+                        output->access_blob(element) = max;
+                    else
+                        output->access_blob(element) = input->access_blob(element);
+                }
+            });
         }
     }
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "relu.h"
 
+#include "../../runtime/thread_pool.h"
+
 namespace pico_cnn {
     namespace naive {
         ReLU::ReLU(std::string name, uint32_t id, op_type op) : ActivationFunction(name, id, op) {
@@ -16,9 +18,11 @@ namespace pico_cnn {
 
         void ReLU::activate(Tensor *input, Tensor *output) {
             uint32_t num_elements = input->num_elements();
-            for (uint32_t element = 0; element < num_elements; element++) {
-                output->access_blob(element) = (input->access_blob(element) < 0.0) ? 0.0 : input->access_blob(element);
-            }
+            parallel_for(0, num_elements, parallel_grain(1), [&](uint32_t first, uint32_t last) {
+                for (uint32_t element = first; element < last; element++) {
+                    output->access_blob(element) = (input->access_blob(element) < 0.0) ? 0.0 : input->access_blob(element);
+                }
+            });
         }
 
         LeakyReLU::LeakyReLU(std::string name, uint32_t id, op_type op, fp_t leak) :
@@ -32,10 +36,12 @@ namespace pico_cnn {
 
         void LeakyReLU::activate(Tensor *input, Tensor *output) {
             uint32_t num_elements = input->num_elements();
-            for(uint32_t element = 0; element < num_elements; element++) {
-                output->access_blob(element) = (input->access_blob(element) < 0.0) ?
-                        (leak_*input->access_blob(element)) : input->access_blob(element);
-            }
+            parallel_for(0, num_elements, parallel_grain(1), [&](uint32_t first, uint32_t last) {
+                for(uint32_t element = first; element < last; element++) {
+                    output->access_blob(element) = (input->access_blob(element) < 0.0) ?
+                            (leak_*input->access_blob(element)) : input->access_blob(element);
+                }
+            });
         }
 
         ParameterizedReLU::ParameterizedReLU(std::string name, uint32_t id, op_type op, Tensor *slope) :
@@ -44,20 +50,39 @@ namespace pico_cnn {
         }
 
         void ParameterizedReLU::run(Tensor *input, Tensor *output) {
-            if (input->num_dimensions() != slope_->num_dimensions()){
-                PRINT_ERROR_AND_DIE("Broadcasting is not supported at the moment.")
-            } else {
-                this->activate(input, output);
-            }
+            this->activate(input, output);
         }
 
         void ParameterizedReLU::activate(Tensor *input, Tensor *output) {
-            uint32_t num_elements = input->num_elements();
-            for(uint32_t i = 0; i < num_elements; i++) {
-                output->access_blob(i) = (input->access_blob(i) < 0.0) ?
-                        (slope_->access_blob(i) * input->access_blob(i)) : input->access_blob(i);
+            uint32_t shape[4];
+            uint32_t strides[4];
+            input->padded_shape(shape);
+            if(!slope_->broadcast_strides(shape, strides)) {
+                PRINT_ERROR_AND_DIE("Slope can not be broadcast to the shape of the input")
             }
 
+            for(uint32_t i0 = 0; i0 < shape[0]; i0++) {
+                for(uint32_t i1 = 0; i1 < shape[1]; i1++) {
+                    for(uint32_t i2 = 0; i2 < shape[2]; i2++) {
+                        const uint32_t offset = ((i0 * shape[1] + i1) * shape[2] + i2) * shape[3];
+                        const fp_t *input_row = input->data_ + offset;
+                        const fp_t *slope_row = slope_->data_ + i0 * strides[0] + i1 * strides[1] + i2 * strides[2];
+                        fp_t *output_row = output->data_ + offset;
+
+                        // scalar and per-channel slopes are constant within a row
+                        if(strides[3] == 0) {
+                            const fp_t slope = slope_row[0];
+                            for(uint32_t i = 0; i < shape[3]; i++) {
+                                output_row[i] = input_row[i] < 0 ? slope * input_row[i] : input_row[i];
+                            }
+                        } else {
+                            for(uint32_t i = 0; i < shape[3]; i++) {
+                                output_row[i] = input_row[i] < 0 ? slope_row[i] * input_row[i] : input_row[i];
+                            }
+                        }
+                    }
+                }
+            }
         }
     }
 }
\ No newline at end of file
@@ -1,4 +1,6 @@
 #include "sigmoid.h"
+#include "../../runtime/thread_pool.h"
+
 namespace pico_cnn {
     namespace naive {
 
@@ -12,12 +14,15 @@ namespace pico_cnn {
 
         void Sigmoid::activate(Tensor *input, Tensor *output) {
             uint32_t num_elements = input->num_elements();
-            for(uint32_t element = 0; element < num_elements; element++) {
-                output->access_blob(element) = 1 / (1 + expf(-input->access_blob(element)));
+            // expf costs about as much as a few multiply-adds
+            parallel_for(0, num_elements, parallel_grain(8), [&](uint32_t first, uint32_t last) {
+                for(uint32_t element = first; element < last; element++) {
+                    output->access_blob(element) = 1 / (1 + expf(-input->access_blob(element)));
 
-                // alternative formula:
-                //  output->access_blob(element) = 0.5 * (1 + tanhf(input->access_blob(element) / 2));
-            }
+                    // alternative formula:
+                    //  output->access_blob(element) = 0.5 * (1 + tanhf(input->access_blob(element) / 2));
+                }
+            });
         }
     }
 }
\ No newline at end of file
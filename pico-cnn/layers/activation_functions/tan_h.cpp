@@ -1,4 +1,6 @@
 #include "tan_h.h"
+#include "../../runtime/thread_pool.h"
+
 namespace pico_cnn {
     namespace naive {
 
@@ -13,9 +15,11 @@ namespace pico_cnn {
         void TanH::activate(Tensor *input, Tensor *output) {
             uint32_t num_elements = input->num_elements();
 
-            for(uint32_t i = 0; i < num_elements; i++) {
-                output->access_blob(i) = tanhf(input->access_blob(i));
-            }
+            parallel_for(0, num_elements, parallel_grain(8), [&](uint32_t first, uint32_t last) {
+                for(uint32_t i = first; i < last; i++) {
+                    output->access_blob(i) = tanhf(input->access_blob(i));
+                }
+            });
         }
     }
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "batch_normalization.h"
 
+#include "../runtime/thread_pool.h"
+
 pico_cnn::naive::BatchNormalization::BatchNormalization(std::string name, uint32_t id, pico_cnn::op_type op,
                                                         Tensor *gammas, Tensor *betas, Tensor *means, Tensor *variances,
                                                         fp_t epsilon) : Layer(name, id, op) {
@@ -21,9 +23,12 @@ void pico_cnn::naive::BatchNormalization::run(pico_cnn::naive::Tensor *input, pi
 
     uint32_t num_input_channels = input->num_channels();
 
-    for (uint32_t channel = 0; channel < num_input_channels; channel++) {
-        this->normalize(input, output, channel);
-    }
+    parallel_for(0, num_input_channels, parallel_grain((uint64_t) input->height() * input->width()),
+                 [&](uint32_t first, uint32_t last) {
+        for (uint32_t channel = first; channel < last; channel++) {
+            this->normalize(input, output, channel);
+        }
+    });
 
 }
 
@@ -1,5 +1,8 @@
 #include "convolution.h"
 
+#include "../runtime/buffer_pool.h"
+#include "../runtime/thread_pool.h"
+
 namespace pico_cnn {
     namespace naive {
 
@@ -7,6 +10,7 @@ namespace pico_cnn {
                                  uint32_t *padding, uint32_t *stride, uint32_t num_groups) : Layer(name, id, op) {
 
             kernel_ = kernel;
+            sparse_kernel_ = nullptr;
             bias_ = bias;
 
             if (padding) {
@@ -21,18 +25,59 @@ namespace pico_cnn {
 
             num_groups_ = num_groups;
 
+            padded_input_ = nullptr;
+            tmp_tensor_ = nullptr;
+
             kernel_height = kernel_->height();
             kernel_width = kernel_->width();
         }
 
+        Convolution::Convolution(std::string name, uint32_t id, op_type op, SparseMatrix *kernel, Tensor *bias,
+                                 uint32_t kernel_height, uint32_t kernel_width,
+                                 uint32_t *padding, uint32_t *stride, uint32_t num_groups) : Layer(name, id, op) {
+
+            kernel_ = nullptr;
+            sparse_kernel_ = kernel;
+            bias_ = bias;
+
+            if (padding) {
+                padding_ = new uint32_t[4]();
+                std::memcpy(padding_, padding, 4 * sizeof(uint32_t));
+            } else {
+                padding_ = padding;
+            }
+
+            stride_ = new uint32_t[2]();
+            std::memcpy(stride_, stride, 2*sizeof(uint32_t));
+
+            num_groups_ = num_groups;
+
+            padded_input_ = nullptr;
+            tmp_tensor_ = nullptr;
+
+            this->kernel_height = kernel_height;
+            this->kernel_width = kernel_width;
+        }
+
         Convolution::~Convolution() {
             delete [] padding_;
             delete [] stride_;
+            delete padded_input_;
+            delete tmp_tensor_;
         }
 
         void Convolution::run(Tensor *input, Tensor *output) {
 
-            if (input->num_dimensions() != 4 && input->num_dimensions() != 3) {
+            if (input->num_dimensions() == 4) {
+                this->convolve_gemm(input, output, padding_ ? padding_[0] : 0);
+                return;
+            }
+
+            if (sparse_kernel_) {
+                PRINT_ERROR_AND_DIE("Sparse kernels are only supported by 2D convolutions")
+            }
+
+            if (input->num_dimensions() != 3) {
                 PRINT_ERROR("Not implemented for Tensor with number of dimensions: " << input->num_dimensions());
             }
 
@@ -43,13 +88,13 @@ namespace pico_cnn {
             Tensor *input_tensor;
 
             if (padding_) {
-                input_tensor = input->expand_with_padding(padding_);
+                padded_input_ = input->expand_with_padding_reusing(padding_, padded_input_);
+                input_tensor = padded_input_;
             } else {
                 input_tensor = input;
             }
 
             uint32_t num_input_channels = input_tensor->num_channels();
-            uint32_t input_height = input_tensor->height();
             uint32_t input_width = input_tensor->width();
 
             uint32_t num_output_channels = output->num_channels();
@@ -58,7 +103,12 @@ namespace pico_cnn {
 
             uint32_t num_kernel_input_channel = kernel_->num_channels();
 
-            auto *tmp_tensor = new Tensor(num_batches, num_output_channels, output_height, output_width);
+            // scratch for the partial result of every input channel, allocated by the first run only
+            if (!tmp_tensor_ || tmp_tensor_->num_elements() != output->num_elements()) {
+                delete tmp_tensor_;
+                tmp_tensor_ = new Tensor(num_batches, num_output_channels, output_height, output_width);
+            }
+            Tensor *tmp_tensor = tmp_tensor_;
 
             for (uint32_t batch = 0; batch < num_batches; batch++) {
 
@@ -66,16 +116,9 @@ namespace pico_cnn {
                     for (uint32_t i = g * num_output_channels / num_groups_;
                          i < (g + 1) * num_output_channels / num_groups_; i++) {
 
-                        if (input_tensor->num_dimensions() == 4) {
-                            this->convolve(input_tensor, output, g * num_input_channels / num_groups_, i, 0,
-                                           num_input_channels, input_height, input_width,
-                                           num_output_channels, output_height, output_width, num_kernel_input_channel);
-                        } else if (input_tensor->num_dimensions() == 3) {
-                            this->convolve_1d(input_tensor, output, g * num_input_channels / num_groups_, i, 0,
-                                           num_input_channels, input_width,
-                                           num_output_channels, output_width, num_kernel_input_channel);
-                        }
-
+                        this->convolve_1d(input_tensor, output, g * num_input_channels / num_groups_, i, 0,
+                                          num_input_channels, input_width,
+                                          num_output_channels, output_width, num_kernel_input_channel);
 
                         if (num_input_channels > num_groups_) {
                             uint32_t cnt = 1;
@@ -83,24 +126,11 @@ namespace pico_cnn {
                             for (uint32_t j = g * num_input_channels / num_groups_ + 1;
                                  j < (g + 1) * (num_input_channels / num_groups_); j++) {
 
-
-                                if (input_tensor->num_dimensions() == 4) {
-                                    this->convolve(input_tensor, tmp_tensor, j, i, cnt,
-                                                   num_input_channels, input_height, input_width,
-                                                   num_output_channels, output_height, output_width, num_kernel_input_channel);
-                                } else if (input_tensor->num_dimensions() == 3) {
-                                    this->convolve_1d(input_tensor, tmp_tensor, j, i, cnt,
-                                                   num_input_channels, input_width,
-                                                   num_output_channels, output_width, num_kernel_input_channel);
-                                }
+                                this->convolve_1d(input_tensor, tmp_tensor, j, i, cnt,
+                                                  num_input_channels, input_width,
+                                                  num_output_channels, output_width, num_kernel_input_channel);
 
                                 output->add_channel(tmp_tensor, 0, i);
-//                                for (uint32_t tmp = 0; tmp < output_height; tmp++){
-//                                    for (uint32_t tmp2 = 0; tmp2 < output_width; tmp2++) {
-//                                        output->data_[(0*num_output_channels*output_height*output_width) + (i*output_height*output_width) + (tmp*output_width) + tmp2] +=
-//                                                tmp_tensor->data_[(0*num_output_channels*output_height*output_width) + (i*output_height*output_width) + (tmp*output_width) + tmp2];
-//                                    }
-//                                }
 
                                 cnt++;
                             }
@@ -109,67 +139,166 @@ namespace pico_cnn {
                 }
             }
 
-            delete tmp_tensor;
+        }
 
-            if (padding_) {
-                delete input_tensor;
+        void Convolution::run_rows(Tensor *input, Tensor *output, uint32_t pad_top) {
+            if (input->num_dimensions() != 4) {
+                PRINT_ERROR_AND_DIE("Only 2D convolutions can be computed in bands, " << name() << " has "
+                                    << input->num_dimensions() << " dimensions")
             }
+            this->convolve_gemm(input, output, pad_top);
+        }
 
+        // column bands of all convolutions, a convolution takes one for the duration of its run
+        static BufferPool column_buffers(Convolution::ColumnBandElements);
 
-        }
+        void Convolution::convolve_gemm(Tensor *input, Tensor *output, uint32_t pad_top) {
 
-        void Convolution::convolve(Tensor *input, Tensor *output, uint32_t input_channel, uint32_t output_channel,
-                                   uint32_t cnt,
-                                   uint32_t num_input_channels, uint32_t input_height, uint32_t input_width,
-                                   uint32_t num_output_channels, uint32_t output_height, uint32_t output_width,
-                                   uint32_t num_kernel_channels) {
+            uint32_t num_batches = input->num_batches();
+            uint32_t num_input_channels = input->num_channels();
+            uint32_t input_height = input->height();
+            uint32_t input_width = input->width();
 
-            uint32_t channel_row, channel_col;
-            uint32_t kernel_row, kernel_col;
-            uint32_t height_crop = kernel_height/2;
-            uint32_t width_crop = kernel_width/2;
+            uint32_t num_output_channels = output->num_channels();
+            uint32_t output_height = output->height();
+            uint32_t output_width = output->width();
 
+            uint32_t group_input_channels = num_input_channels / num_groups_;
+            uint32_t group_output_channels = num_output_channels / num_groups_;
+
+            // rows of the column matrix: one per kernel element, columns: one per output pixel
+            uint32_t num_rows = group_input_channels * kernel_height * kernel_width;
+            uint32_t num_pixels = output_height * output_width;
+
+            uint32_t pad_left = padding_ ? padding_[1] : 0;
             uint32_t stride_height = stride_[0];
             uint32_t stride_width = stride_[1];
 
-            fp_t pixel;
-
-            uint32_t output_channel_row = 0;
-            uint32_t output_channel_col = 0;
+            // a 1x1 kernel without padding and stride reads every input channel as it is
+            bool pointwise = kernel_height == 1 && kernel_width == 1 && stride_height == 1 && stride_width == 1 &&
+                             pad_top == 0 && pad_left == 0 &&
+                             input_height == output_height && input_width == output_width;
+
+            // output pixels per band, the columns of a band fit into a column buffer
+            uint32_t band_pixels = num_pixels;
+            fp_t *columns = nullptr;
+            if (!pointwise) {
+                if (num_rows > ColumnBandElements) {
+                    PRINT_ERROR_AND_DIE(name() << ": a column of " << num_rows << " elements exceeds the column buffer")
+                }
+                band_pixels = (uint32_t) MIN((uint64_t) num_pixels, ColumnBandElements / num_rows);
 
-            for(channel_row = height_crop; channel_row < input_height-height_crop; channel_row+=stride_height) {
-                for(channel_col = width_crop; channel_col < input_width - width_crop; channel_col += stride_width) {
-                    pixel = 0.0;
+                // a buffer for every thread of the pool, so concurrent convolutions do not allocate after their
+                // first run
+                column_buffers.reserve(thread_pool()->num_threads());
+                columns = column_buffers.acquire();
+            }
 
-                    for(kernel_row = 0; kernel_row < kernel_height; kernel_row++) {
-                        for(kernel_col = 0; kernel_col < kernel_width; kernel_col++) {
+            for (uint32_t batch = 0; batch < num_batches; batch++) {
+                for (uint32_t g = 0; g < num_groups_; g++) {
 
-                            pixel += kernel_->access(output_channel, cnt, kernel_row, kernel_col,
-                                                     num_kernel_channels, kernel_height, kernel_width) *
-                                     input->access(0, input_channel, channel_row-height_crop+kernel_row, channel_col-width_crop+kernel_col,
-                                                   num_input_channels, input_height, input_width);
-//                            pixel += kernel_->data_[(output_channel*num_input_channels*kernel_height*kernel_width) + (cnt*kernel_height*kernel_width) + (kernel_row*kernel_width) + kernel_col] *
-//                                     input->data_[(0*num_input_channels*input_height*input_width) + (input_channel*input_height*input_width) + ((channel_row-height_crop+kernel_row)*input_width) + (channel_col-width_crop+kernel_col)];
-                        }
+                    const fp_t *group_input = input->get_ptr_to_channel(batch, g * group_input_channels);
+                    fp_t *group_output = output->get_ptr_to_channel(batch, g * group_output_channels);
+                    const fp_t *group_kernel = nullptr;
+                    if (kernel_) {
+                        group_kernel = kernel_->data_ + (uint64_t) g * group_output_channels * num_rows;
                     }
 
-                    if (cnt == 0 && bias_) {
-//                        pixel += bias_->data_[output_channel];
-                        pixel += bias_->access(output_channel);
+                    if (bias_) {
+                        parallel_for(0, group_output_channels, parallel_grain(num_pixels),
+                                     [&](uint32_t first, uint32_t last) {
+                            for (uint32_t i = first; i < last; i++) {
+                                std::fill(group_output + (uint64_t) i * num_pixels,
+                                          group_output + (uint64_t) (i + 1) * num_pixels,
+                                          bias_->data_[g * group_output_channels + i]);
+                            }
+                        });
                     }
 
-                    output->access(0, output_channel, output_channel_row, output_channel_col,
-                                   num_output_channels, output_height, output_width) = pixel;
-//                    output->data_[(0*num_output_channels*output_height*output_width) + (output_channel*output_height*output_width) + (output_channel_row*output_width) + output_channel_col] = pixel;
-                    output_channel_col++;
+                    for (uint32_t first_pixel = 0; first_pixel < num_pixels; first_pixel += band_pixels) {
+                        const uint32_t num_band_pixels = MIN(band_pixels, num_pixels - first_pixel);
 
+                        const fp_t *band_columns = group_input;
+                        uint32_t ld_columns = num_pixels;
+                        if (!pointwise) {
+                            this->im2col(group_input, group_input_channels, input_height, input_width, output_width,
+                                         first_pixel, first_pixel + num_band_pixels, pad_top, pad_left, columns);
+                            band_columns = columns;
+                            ld_columns = num_band_pixels;
+                        }
+
+                        // output (Cout/g, pixels of the band) =
+                        //     kernel (Cout/g, Cin/g*KH*KW) * columns (Cin/g*KH*KW, pixels of the band)
+                        if (sparse_kernel_) {
+                            sparse_kernel_->multiply(g * group_output_channels, group_output_channels, num_band_pixels,
+                                                     band_columns, ld_columns, bias_ ? 1 : 0,
+                                                     group_output + first_pixel, num_pixels);
+                            continue;
+                        }
+
+                        sgemm(false, false, group_output_channels, num_band_pixels, num_rows,
+                              1, group_kernel, num_rows,
+                              band_columns, ld_columns,
+                              bias_ ? 1 : 0, group_output + first_pixel, num_pixels);
+                    }
                 }
-                output_channel_row++;
-                output_channel_col = 0;
+            }
 
+            if (columns) {
+                column_buffers.release(columns);
             }
         }
 
+        void Convolution::im2col(const fp_t *input, uint32_t num_input_channels, uint32_t input_height,
+                                 uint32_t input_width, uint32_t output_width, uint32_t first_pixel,
+                                 uint32_t last_pixel, uint32_t pad_top, uint32_t pad_left, fp_t *columns) const {
+
+            uint32_t stride_height = stride_[0];
+            uint32_t stride_width = stride_[1];
+
+            const uint64_t num_band_pixels = last_pixel - first_pixel;
+            const uint64_t rows_per_channel = kernel_height * kernel_width;
+
+            // the rows of the column matrix of every input channel are written by one thread
+            parallel_for(0, num_input_channels, parallel_grain(rows_per_channel * num_band_pixels),
+                         [&](uint32_t first, uint32_t last) {
+                for (uint32_t channel = first; channel < last; channel++) {
+                    const fp_t *input_channel = input + (uint64_t) channel * input_height * input_width;
+                    fp_t *channel_columns = columns + channel * rows_per_channel * num_band_pixels;
+
+                    for (uint32_t kernel_row = 0; kernel_row < kernel_height; kernel_row++) {
+                        for (uint32_t kernel_col = 0; kernel_col < kernel_width; kernel_col++) {
+
+                            // the band starts and ends within output rows
+                            uint32_t pixel = first_pixel;
+                            while (pixel < last_pixel) {
+                                const uint32_t output_row = pixel / output_width;
+                                const uint32_t first_col = pixel - output_row * output_width;
+                                const uint32_t last_col = MIN(output_width, first_col + (last_pixel - pixel));
+
+                                // position in the unpadded input, padded pixels are 0
+                                int64_t input_row = (int64_t) output_row * stride_height + kernel_row - pad_top;
+                                bool row_inside = input_row >= 0 && input_row < (int64_t) input_height;
+                                const fp_t *input_line = input_channel + (row_inside ? input_row * input_width : 0);
+
+                                for (uint32_t output_col = first_col; output_col < last_col; output_col++) {
+                                    int64_t input_col = (int64_t) output_col * stride_width + kernel_col - pad_left;
+
+                                    if (row_inside && input_col >= 0 && input_col < (int64_t) input_width) {
+                                        *channel_columns = input_line[input_col];
+                                    } else {
+                                        *channel_columns = 0;
+                                    }
+                                    channel_columns++;
+                                }
+                                pixel += last_col - first_col;
+                            }
+                        }
+                    }
+                }
+            });
+        }
+
         void Convolution::convolve_1d(Tensor *input, Tensor *output, uint32_t input_channel, uint32_t output_channel,
                                       uint32_t cnt, uint32_t num_input_channels, uint32_t input_width,
                                       uint32_t num_output_channels, uint32_t output_width,
@@ -1,5 +1,10 @@
 /**
- * @brief pico_cnn::naive::Convolution provides naive implementation of convolution operation
+ * @brief pico_cnn::naive::Convolution provides implementation of convolution operation
+ * 2D convolutions are lowered to matrix multiplications (im2col) per batch and group, which are computed by the
+ * selected GEMM provider (see gemm/gemm.h). The column matrix is built and multiplied in bands of output pixels which
+ * fit into a scratch buffer shared by all convolutions, so its size does not depend on the resolution of the image.
+ * 1D convolutions are computed directly. 2D convolutions with a pruned kernel multiply only its non-zeros with the
+ * column matrix (see gemm/sparse_matrix.h).
  *
  * @author Alexander Jung (University of Tuebingen, Chair for Embedded Systems)
  */
@@ -8,24 +13,49 @@
 
 #include "../parameters.h"
 #include "../tensor.h"
+#include "../gemm/gemm.h"
+#include "../gemm/sparse_matrix.h"
 #include "layer.h"
 
 namespace pico_cnn {
     namespace naive {
         class Convolution : Layer {
         public:
+            // elements of the column buffer of a band (2 MiB), a band has at least one output pixel
+            static constexpr uint64_t ColumnBandElements = 1 << 19;
+
             Convolution(std::string name, uint32_t id, op_type op, Tensor *kernel, Tensor *bias,
                         uint32_t *padding, uint32_t *stride, uint32_t num_groups);
+
+            /**
+             * 2D convolution with a sparse kernel
+             * @param kernel kernel of shape (Cout, Cin/num_groups * kernel_height * kernel_width)
+             */
+            Convolution(std::string name, uint32_t id, op_type op, SparseMatrix *kernel, Tensor *bias,
+                        uint32_t kernel_height, uint32_t kernel_width,
+                        uint32_t *padding, uint32_t *stride, uint32_t num_groups);
             ~Convolution();
 
             void run(Tensor *input, Tensor *output) override;
 
+            /**
+             * 2D convolution of a horizontal band of the image, e.g. a tile of a FusedTileGroup: input holds the input
+             * rows the output rows of the band depend on. pad_top zero rows are inserted above them instead of the top
+             * padding of the layer, rows the kernel reaches below the input are zero as well.
+             */
+            void run_rows(Tensor *input, Tensor *output, uint32_t pad_top);
+
         private:
-            void convolve(Tensor *input, Tensor *output, uint32_t input_channel, uint32_t output_channel,
-                          uint32_t cnt,
-                          uint32_t num_input_channels, uint32_t input_height, uint32_t input_width,
-                          uint32_t num_output_channels, uint32_t output_height, uint32_t output_width,
-                          uint32_t num_kernel_channels);
+            void convolve_gemm(Tensor *input, Tensor *output, uint32_t pad_top);
+
+            /**
+             * Copies the input pixels covered by every kernel element into one row of columns for the output pixels
+             * first_pixel, ..., last_pixel - 1 (in row-major order):
+             * columns[(channel * kernel_height + kernel_row) * kernel_width + kernel_col][output_pixel - first_pixel]
+             */
+            void im2col(const fp_t *input, uint32_t num_input_channels, uint32_t input_height, uint32_t input_width,
+                        uint32_t output_width, uint32_t first_pixel, uint32_t last_pixel, uint32_t pad_top,
+                        uint32_t pad_left, fp_t *columns) const;
 
             void convolve_1d(Tensor *input, Tensor *output, uint32_t input_channel, uint32_t output_channel,
                              uint32_t cnt,
@@ -36,10 +66,15 @@ namespace pico_cnn {
             uint32_t kernel_height, kernel_width;
 
             Tensor *kernel_;
+            SparseMatrix *sparse_kernel_;
             Tensor *bias_;
             uint32_t *padding_;
             uint32_t *stride_;
             uint32_t num_groups_;
+
+            // scratch of 1D convolutions, reused by every run
+            Tensor *padded_input_;
+            Tensor *tmp_tensor_;
         };
     }
 }
@@ -3,10 +3,23 @@
 namespace pico_cnn {
     namespace naive {
 
-        FullyConnected::FullyConnected(std::string name, uint32_t id, op_type op, Tensor *kernel, Tensor *bias) :
-                Layer(name, id, op) {
+        FullyConnected::FullyConnected(std::string name, uint32_t id, op_type op, Tensor *kernel, Tensor *bias,
+                                       bool sparse_input) :
+                Layer(name, id, op), sparse_input_(sparse_input) {
             kernel_ = kernel;
+            sparse_kernel_ = nullptr;
+            bias_ = bias;
+            if(sparse_input_) {
+                nonzero_indices_.resize(kernel_->num_elements() / kernel_->width());
+            }
+        }
+
+        FullyConnected::FullyConnected(std::string name, uint32_t id, op_type op, SparseMatrix *kernel, Tensor *bias) :
+                Layer(name, id, op) {
+            kernel_ = nullptr;
+            sparse_kernel_ = kernel;
             bias_ = bias;
+            sparse_input_ = false;
         }
 
         void FullyConnected::run(Tensor *input, Tensor *output) {
@@ -18,31 +31,46 @@ namespace pico_cnn {
 
         void FullyConnected::gemm(Tensor *input, Tensor *output) {
 
+            uint32_t num_rows = input->height();
             uint32_t output_width = output->width();
             uint32_t input_width = input->width();
-            uint32_t kernel_width = kernel_->width();
 
-            for (uint32_t i = 0; i < output_width; i++) {
-
-                fp_t pixel = 0.0;
-
-                for (uint32_t j = 0; j < input_width; j++) {
-                    // With the kernel layout used in the onnx format we can use this memory optimized
-                    // access pattern (i, j) instead of (j, i) as the "normal" matrix multiplication is defined
-                    pixel += input->access(0, j, input_width) * kernel_->access(i, j, kernel_width);
+            // output = input * kernel^T + bias, the onnx layout (Y, X) of the kernel is the transposed operand
+            if(bias_) {
+                for (uint32_t row = 0; row < num_rows; row++) {
+                    std::memcpy(output->data_ + row * output_width, bias_->data_, output_width * sizeof(fp_t));
                 }
+            }
 
-                if(bias_) {
-                    pixel += bias_->access(i);
-                }
+            if(sparse_kernel_) {
+                sparse_kernel_->multiply_transposed(num_rows, input->data_, input_width,
+                                                    bias_ ? 1 : 0, output->data_, output_width);
+                return;
+            }
 
-                output->access(0, i, output_width) = pixel;
+            if(sparse_input_) {
+                sparse_input_sgemm(num_rows, output_width, input_width, input->data_, input_width,
+                                   kernel_->data_, output_width, bias_ ? 1 : 0, output->data_, output_width,
+                                   nonzero_indices_.data());
+                return;
             }
+
+            sgemm(false, true, num_rows, output_width, input_width,
+                  1, input->data_, input_width, kernel_->data_, input_width,
+                  bias_ ? 1 : 0, output->data_, output_width);
         }
 
-        MatMul::MatMul(std::string name, uint32_t id, op_type op, Tensor *weights) :
-                Layer(name, id, op) {
+        MatMul::MatMul(std::string name, uint32_t id, op_type op, Tensor *weights,
+                       bool transpose_input, bool transpose_output, bool sparse_input) :
+                Layer(name, id, op), transpose_input_(transpose_input), transpose_output_(transpose_output),
+                sparse_input_(sparse_input) {
             weights_ = weights;
+            if(sparse_input_) {
+                if(transpose_input_ || transpose_output_) {
+                    PRINT_ERROR_AND_DIE("MatMul with sparse input does not support transposed operands.")
+                }
+                nonzero_indices_.resize(weights_->num_elements() / weights_->width());
+            }
         }
 
         void MatMul::run(Tensor *input, Tensor *output) {
@@ -50,20 +78,27 @@ namespace pico_cnn {
         }
 
         void MatMul::matmul(Tensor *input, Tensor *output) {
-            uint32_t output_width = output->width();
-            uint32_t input_width = input->width();
-            uint32_t weights_width = weights_->width();
-
-            for (uint32_t i = 0; i < output_width; i++) {
-
-                fp_t pixel = 0.0;
-
-                for (uint32_t j = 0; j < input_width; j++) {
-                    // TODO: Improve performance of this operation. See FullyConnected.
-                    pixel += input->access(0, j, input_width) * weights_->access(j, i, weights_width);
-                }
+            uint32_t output_width = weights_->width();
+            uint32_t input_width = weights_->num_elements() / output_width;
+            uint32_t num_rows = input->num_elements() / input_width;
+            uint32_t input_stride = transpose_input_ ? num_rows : input_width;
+
+            if(sparse_input_) {
+                sparse_input_sgemm(num_rows, output_width, input_width, input->data_, input_width,
+                                   weights_->data_, output_width, 0, output->data_, output_width,
+                                   nonzero_indices_.data());
+                return;
+            }
 
-                output->access(0, i, output_width) = pixel;
+            if(!transpose_output_) {
+                sgemm(transpose_input_, false, num_rows, output_width, input_width,
+                      1, input->data_, input_stride, weights_->data_, output_width,
+                      0, output->data_, output_width);
+            } else {
+                // output^T = weights^T * input^T
+                sgemm(true, !transpose_input_, output_width, num_rows, input_width,
+                      1, weights_->data_, output_width, input->data_, input_stride,
+                      0, output->data_, num_rows);
             }
         }
     }
@@ -1,15 +1,23 @@
 /**
- * @brief pico_cnn::naive::FullyConnected class provides naive implementation of FC operation
+ * @brief pico_cnn::naive::FullyConnected class provides implementation of FC operation
  * This implementation assumes the following data layout:
- * input: (1, X), kernel: (Y, X), bias: (1, Y), output: (1, Y)
+ * input: (N, X), kernel: (Y, X), bias: (1, Y), output: (N, Y)
+ * FullyConnected and MatMul are computed by the selected GEMM provider (see gemm/gemm.h), fully connected layers with a
+ * pruned kernel multiply only its non-zeros (see gemm/sparse_matrix.h). Layers behind a ReLU can skip the weights of
+ * zero inputs instead (see gemm/sparse_input_gemm.h).
  *
  * @author Alexander Jung (University of Tuebingen, Chair for Embedded Systems)
  */
 #ifndef PICO_CNN_FULLY_CONNECTED_H
 #define PICO_CNN_FULLY_CONNECTED_H
 
+#include <vector>
+
 #include "../parameters.h"
 #include "../tensor.h"
+#include "../gemm/gemm.h"
+#include "../gemm/sparse_matrix.h"
+#include "../gemm/sparse_input_gemm.h"
 #include "layer.h"
 
 namespace pico_cnn {
@@ -23,14 +31,22 @@ namespace pico_cnn {
              * @param op
              * @param kernel We use the same data layout as used in the onnx file format: kernel->shape == (Y, X)
              * @param bias We use the same data layout as used in the onnx file format: bias->shape == (1, Y)
+             * @param sparse_input only the weights of non-zero inputs are accumulated, kernel->shape == (X, Y) so that
+             * the weights of one input are contiguous
+             */
+            FullyConnected(std::string name, uint32_t id, op_type op, Tensor *kernel, Tensor *bias,
+                           bool sparse_input = false);
+
+            /**
+             * @param kernel sparse kernel of shape (Y, X)
              */
-            FullyConnected(std::string name, uint32_t id, op_type op, Tensor *kernel, Tensor *bias);
+            FullyConnected(std::string name, uint32_t id, op_type op, SparseMatrix *kernel, Tensor *bias);
             ~FullyConnected() override = default;
 
             /**
              *
-             * @param input input->shape == (1, X)
-             * @param output output->shape == (1, Y)
+             * @param input input->shape == (N, X)
+             * @param output output->shape == (N, Y)
              */
             void run(Tensor *input, Tensor *output) override;
 
@@ -38,12 +54,24 @@ namespace pico_cnn {
             void gemm(Tensor *input, Tensor *output);
 
             Tensor *kernel_;
+            SparseMatrix *sparse_kernel_;
             Tensor *bias_;
+            bool sparse_input_;
+            std::vector<uint32_t> nonzero_indices_;
         };
 
         class MatMul : Layer {
         public:
-            MatMul(std::string name, uint32_t id, op_type op, Tensor *weights);
+            /**
+             * The generator absorbs a Transpose of the input or of the output of a 2D MatMul into the layer, the
+             * GEMM then reads or writes the transposed operand instead of copying it.
+             * @param weights weights->shape == (X, Y)
+             * @param transpose_input input->shape == (X, N) instead of (N, X)
+             * @param transpose_output output->shape == (Y, N) instead of (N, Y)
+             * @param sparse_input only the weights of non-zero inputs are accumulated, not combined with transpositions
+             */
+            MatMul(std::string name, uint32_t id, op_type op, Tensor *weights,
+                   bool transpose_input = false, bool transpose_output = false, bool sparse_input = false);
             ~MatMul() override = default;
 
             void run(Tensor *input, Tensor *output) override; 
@@ -52,6 +80,10 @@ namespace pico_cnn {
             void matmul(Tensor *input, Tensor *output);
 
             Tensor *weights_;
+            bool transpose_input_;
+            bool transpose_output_;
+            bool sparse_input_;
+            std::vector<uint32_t> nonzero_indices_;
         };
     }
 }
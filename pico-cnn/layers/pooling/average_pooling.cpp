@@ -1,5 +1,7 @@
 #include "average_pooling.h"
 
+#include "../../runtime/thread_pool.h"
+
 pico_cnn::naive::AveragePooling::AveragePooling(std::string name, uint32_t id, pico_cnn::op_type op,
                                                 uint32_t *kernel_size, uint32_t *stride, uint32_t *padding,
                                                 bool count_include_pad) :
@@ -18,20 +20,25 @@ void pico_cnn::naive::AveragePooling::pool(pico_cnn::naive::Tensor *input, pico_
     uint32_t output_height = output->height();
     uint32_t output_width = output->width();
 
-    uint32_t channel_row, channel_column;
-    uint32_t output_channel_row, output_channel_column;
     uint32_t output_channel_height, output_channel_width;
 
-    uint32_t kernel_row, kernel_column;
-
     if (num_dims == 4) {
         output_channel_height = (height-kernel_size_[0])/stride_[0]+1;
         output_channel_width = (width-kernel_size_[1])/stride_[1]+1;
 
+        uint64_t work_per_channel = (uint64_t) output_height * output_width * kernel_size_[0] * kernel_size_[1];
+
         if(count_include_pad_ == 1) {
 
-            for (uint32_t batch = 0; batch < num_batches; batch++) {
-                for (uint32_t channel = 0; channel < num_channels; channel++) {
+            // every channel of every batch is pooled by one thread
+            parallel_for(0, num_batches * num_channels, parallel_grain(work_per_channel), [&](uint32_t first, uint32_t last) {
+                for (uint32_t plane = first; plane < last; plane++) {
+                    uint32_t batch = plane / num_channels;
+                    uint32_t channel = plane % num_channels;
+
+                    uint32_t channel_row, channel_column;
+                    uint32_t output_channel_row, output_channel_column;
+                    uint32_t kernel_row, kernel_column;
 
                     output_channel_row = 0;
                     output_channel_column = 0;
@@ -62,12 +69,18 @@ void pico_cnn::naive::AveragePooling::pool(pico_cnn::naive::Tensor *input, pico_
                         output_channel_column = 0;
                     }
                 }
-            }
+            });
 
         } else if(count_include_pad_ == 0) {
 
-            for (uint32_t batch = 0; batch < num_batches; batch++) {
-                for (uint32_t channel = 0; channel < num_channels; channel++) {
+            parallel_for(0, num_batches * num_channels, parallel_grain(work_per_channel), [&](uint32_t first, uint32_t last) {
+                for (uint32_t plane = first; plane < last; plane++) {
+                    uint32_t batch = plane / num_channels;
+                    uint32_t channel = plane % num_channels;
+
+                    uint32_t channel_row, channel_column;
+                    uint32_t output_channel_row, output_channel_column;
+                    uint32_t kernel_row, kernel_column;
 
                     output_channel_row = 0;
                     output_channel_column = 0;
@@ -128,13 +141,15 @@ void pico_cnn::naive::AveragePooling::pool(pico_cnn::naive::Tensor *input, pico_
                         output_channel_column = 0;
                     }
                 }
-            }
+            });
         } else {
             PRINT_ERROR("ERROR: Unsupported values for 'count_include_pad'.")
         }
 
     } else if (num_dims == 3) {
 
+        uint32_t channel_column, output_channel_column, kernel_column;
+
         output_channel_width = (width-kernel_size_[0])/stride_[0]+1;
 
         if(count_include_pad_ == 1) {
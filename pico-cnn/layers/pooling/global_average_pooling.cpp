@@ -1,5 +1,7 @@
 #include "global_average_pooling.h"
 
+#include "../../runtime/thread_pool.h"
+
 pico_cnn::naive::GlobalAveragePooling::GlobalAveragePooling(std::string name, uint32_t id, pico_cnn::op_type op,
                                                             uint32_t *kernel_size, uint32_t *stride, uint32_t *padding):
                                                             Pooling(name, id, op, kernel_size, stride, padding) {
@@ -20,20 +22,23 @@ void pico_cnn::naive::GlobalAveragePooling::pool(pico_cnn::naive::Tensor *input,
 
     if (num_dims == 4) {
 
-        for (uint32_t batch = 0; batch < num_batches; batch++) {
-            for (uint32_t channel = 0; channel < num_channels; channel++) {
+        // every channel of every batch is reduced by one thread
+        parallel_for(0, num_batches * num_channels, parallel_grain((uint64_t) height * width),
+                     [&](uint32_t first, uint32_t last) {
+            for (uint32_t plane = first; plane < last; plane++) {
+                uint32_t batch = plane / num_channels;
+                uint32_t channel = plane % num_channels;
 
+                fp_t channel_sum = 0.0;
                 for (uint32_t row = 0; row < height; row++) {
                     for (uint32_t col = 0; col < width; col++) {
 
-                        global_sum += input->access(batch, channel, row, col, num_channels, height, width);
+                        channel_sum += input->access(batch, channel, row, col, num_channels, height, width);
                     }
                 }
-                output->access(batch, channel, 0, 0, num_channels, output_height, output_width) = global_sum / (fp_t)(height*width);
-
-                global_sum = 0.0;
+                output->access(batch, channel, 0, 0, num_channels, output_height, output_width) = channel_sum / (fp_t)(height*width);
             }
-        }
+        });
 
     } else if (num_dims == 3) {
 
@@ -1,5 +1,7 @@
 #include "global_max_pooling.h"
 
+#include "../../runtime/thread_pool.h"
+
 pico_cnn::naive::GlobalMaxPooling::GlobalMaxPooling(std::string name, uint32_t id, pico_cnn::op_type op,
                                                     uint32_t *kernel_size, uint32_t *stride, uint32_t *padding) :
                                                     Pooling(name, id, op, kernel_size, stride, padding) {
@@ -20,25 +22,29 @@ void pico_cnn::naive::GlobalMaxPooling::pool(pico_cnn::naive::Tensor *input, pic
     fp_t candidate = 1000.0;
 
     if (num_dims == 4) {
-        for (uint32_t batch = 0; batch < num_batches; batch++) {
-            for (uint32_t channel = 0; channel < num_channels; channel++) {
+        // every channel of every batch is reduced by one thread
+        parallel_for(0, num_batches * num_channels, parallel_grain((uint64_t) height * width),
+                     [&](uint32_t first, uint32_t last) {
+            for (uint32_t plane = first; plane < last; plane++) {
+                uint32_t batch = plane / num_channels;
+                uint32_t channel = plane % num_channels;
 
-                global_maximum = input->access(batch, channel, 0, 0,
-                                               num_channels, height, width);
+                fp_t channel_maximum = input->access(batch, channel, 0, 0,
+                                                     num_channels, height, width);
 
                 for (uint32_t row = 0; row < height; row++) {
                     for (uint32_t col = 1; col < width; col++) {
 
-                        candidate = input->access(batch, channel, row, col, num_channels, height, width);
+                        fp_t channel_candidate = input->access(batch, channel, row, col, num_channels, height, width);
 
-                        if (candidate > global_maximum) {
-                            global_maximum = candidate;
+                        if (channel_candidate > channel_maximum) {
+                            channel_maximum = channel_candidate;
                         }
                     }
                 }
-                output->access(batch, channel, 0, 0, num_channels, output_height, output_width) = global_maximum;
+                output->access(batch, channel, 0, 0, num_channels, output_height, output_width) = channel_maximum;
             }
-        }
+        });
     } else if (num_dims == 3) {
         for (uint32_t batch = 0; batch < num_batches; batch++) {
             for (uint32_t channel = 0; channel < num_channels; channel++) {
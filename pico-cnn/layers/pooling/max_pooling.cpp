@@ -1,5 +1,7 @@
 #include "max_pooling.h"
 
+#include "../../runtime/thread_pool.h"
+
 pico_cnn::naive::MaxPooling::MaxPooling(std::string name, uint32_t id, pico_cnn::op_type op, uint32_t *kernel_size,
                                         uint32_t *stride, uint32_t *padding) :
                                         Pooling(name, id, op, kernel_size, stride, padding) {
@@ -19,28 +21,26 @@ void pico_cnn::naive::MaxPooling::pool(pico_cnn::naive::Tensor *input, pico_cnn:
         uint32_t output_height = output->height();
         uint32_t output_width = output->width();
 
-        uint32_t output_channel_row, output_channel_column;
-        uint32_t output_channel_height, output_channel_width;
-
+        uint32_t output_channel_height = (height - kernel_size_[0]) / stride_[0] + 1;
+        uint32_t output_channel_width = (width - kernel_size_[1]) / stride_[1] + 1;
 
-        output_channel_height = (height - kernel_size_[0]) / stride_[0] + 1;
-        output_channel_width = (width - kernel_size_[1]) / stride_[1] + 1;
+        // every channel of every batch is pooled by one thread
+        uint64_t work_per_channel = (uint64_t) output_height * output_width * kernel_size_[0] * kernel_size_[1];
+        parallel_for(0, num_batches * num_channels, parallel_grain(work_per_channel), [&](uint32_t first, uint32_t last) {
+            for (uint32_t plane = first; plane < last; plane++) {
+                uint32_t batch = plane / num_channels;
+                uint32_t channel = plane % num_channels;
 
-        fp_t pixel, candidate;
-
-        for (uint32_t batch = 0; batch < num_batches; batch++) {
-            for (uint32_t channel = 0; channel < num_channels; channel++) {
-
-                output_channel_row = 0;
-                output_channel_column = 0;
+                uint32_t output_channel_row = 0;
+                uint32_t output_channel_column = 0;
 
                 for (uint32_t channel_row = 0;
                      channel_row < height && output_channel_row < output_channel_height; channel_row += stride_[0]) {
                     for (uint32_t channel_column = 0; channel_column < width && output_channel_column <
                                                                                 output_channel_width; channel_column += stride_[1]) {
 
-                        pixel = input->access(batch, channel, channel_row, channel_column,
-                                              num_channels, height, width);
+                        fp_t pixel = input->access(batch, channel, channel_row, channel_column,
+                                                   num_channels, height, width);
 
                         for (uint32_t kernel_row = channel_row;
                              kernel_row < channel_row + kernel_size_[0] && kernel_row < height; kernel_row++) {
@@ -49,8 +49,8 @@ void pico_cnn::naive::MaxPooling::pool(pico_cnn::naive::Tensor *input, pico_cnn:
                                  kernel_column < width; kernel_column++) {
 
 
-                                candidate = input->access(batch, channel, kernel_row, kernel_column, num_channels,
-                                                          height, width);
+                                fp_t candidate = input->access(batch, channel, kernel_row, kernel_column, num_channels,
+                                                               height, width);
 
                                 if (candidate > pixel) {
                                     pixel = candidate;
@@ -67,7 +67,7 @@ void pico_cnn::naive::MaxPooling::pool(pico_cnn::naive::Tensor *input, pico_cnn:
                     output_channel_column = 0;
                 }
             }
-        }
+        });
     } else if (num_dims == 3) {
 
         uint32_t width = input->width();
@@ -1,7 +1,7 @@
 #include "pooling.h"
 
 pico_cnn::naive::Pooling::Pooling(std::string name, uint32_t id, pico_cnn::op_type op, uint32_t *kernel_size,
-                                  uint32_t *stride, uint32_t *padding) : Layer(name, id, op) {
+                                  uint32_t *stride, uint32_t *padding) : Layer(name, id, op), padded_input_(nullptr) {
 
     if (kernel_size) {
         kernel_size_ = new uint32_t[2]();
@@ -29,6 +29,7 @@ pico_cnn::naive::Pooling::~Pooling() {
     delete [] kernel_size_;
     delete [] stride_;
     delete [] padding_;
+    delete padded_input_;
 }
 
 void pico_cnn::naive::Pooling::run(pico_cnn::naive::Tensor *input, pico_cnn::naive::Tensor *output) {
@@ -38,16 +39,14 @@ void pico_cnn::naive::Pooling::run(pico_cnn::naive::Tensor *input, pico_cnn::nai
         Tensor *input_tensor;
 
         if (padding_) {
-            input_tensor = input->expand_with_padding(padding_);
+            // allocated by the first run only
+            padded_input_ = input->expand_with_padding_reusing(padding_, padded_input_);
+            input_tensor = padded_input_;
         } else {
             input_tensor = input;
         }
 
         this->pool(input_tensor, output);
-
-        if (padding_) {
-            delete input_tensor;
-        }
     } else {
         PRINT_ERROR_AND_DIE("Not implemented for Tensor with num_dims: " << input->num_dimensions());
     }
@@ -25,6 +25,9 @@ namespace pico_cnn {
             uint32_t *kernel_size_;
             uint32_t *stride_;
             uint32_t *padding_;
+
+            // padded copy of the input, reused by every run
+            Tensor *padded_input_;
         };
     }
 }
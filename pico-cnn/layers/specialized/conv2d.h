@@ -0,0 +1,139 @@
+/**
+ * @brief pico_cnn::naive::Conv2d is a 2D convolution whose shape is fixed at compile time. It computes the same result
+ * as pico_cnn::naive::Convolution, but as all loop bounds are constants the compiler can fully unroll the kernel
+ * window and vectorize the loops over the output rows with known trip counts. The padded input is copied into a buffer
+ * allocated once in the constructor instead of a new Tensor per run.
+ *
+ * The generator emits these kernels instead of pico_cnn::naive::Convolution when the network is generated with
+ * --specialize, as all shapes are known after constant propagation.
+ *
+ * @author Alexander Jung (University of Tuebingen, Chair for Embedded Systems)
+ */
+#ifndef PICO_CNN_SPECIALIZED_CONV2D_H
+#define PICO_CNN_SPECIALIZED_CONV2D_H
+
+#include "../../parameters.h"
+#include "../../tensor.h"
+#include "../layer.h"
+
+namespace pico_cnn {
+    namespace naive {
+
+        template<uint32_t OutChannels, uint32_t KernelHeight, uint32_t KernelWidth,
+                 uint32_t StrideHeight, uint32_t StrideWidth,
+                 uint32_t InChannels, uint32_t InHeight, uint32_t InWidth,
+                 uint32_t PadTop = 0, uint32_t PadLeft = 0, uint32_t PadBottom = 0, uint32_t PadRight = 0,
+                 uint32_t Groups = 1>
+        class Conv2d : public Layer {
+        public:
+            static constexpr uint32_t OutHeight = (InHeight + PadTop + PadBottom - KernelHeight) / StrideHeight + 1;
+            static constexpr uint32_t OutWidth = (InWidth + PadLeft + PadRight - KernelWidth) / StrideWidth + 1;
+            static constexpr uint32_t GroupInChannels = InChannels / Groups;
+            static constexpr uint32_t GroupOutChannels = OutChannels / Groups;
+
+            static_assert(InChannels % Groups == 0 && OutChannels % Groups == 0,
+                          "Number of channels has to be divisible by the number of groups");
+            static_assert(InHeight + PadTop + PadBottom >= KernelHeight && InWidth + PadLeft + PadRight >= KernelWidth,
+                          "Kernel is larger than the padded input");
+
+            /**
+             * @param kernel Tensor of shape (OutChannels, InChannels/Groups, KernelHeight, KernelWidth)
+             * @param bias Tensor of shape (OutChannels) or nullptr
+             */
+            Conv2d(std::string name, uint32_t id, op_type op, Tensor *kernel, Tensor *bias) :
+                    Layer(name, id, op), kernel_(kernel), bias_(bias), padded_input_(nullptr) {
+
+                if(kernel_->num_elements() != OutChannels * GroupInChannels * KernelHeight * KernelWidth) {
+                    PRINT_ERROR_AND_DIE("Kernel of " << name << " does not match the specialized shape")
+                }
+
+                if(Padded) {
+                    // the border stays zero, only the inner part is overwritten by every run
+                    padded_input_ = new fp_t[InChannels * PaddedHeight * PaddedWidth]();
+                }
+            }
+
+            ~Conv2d() override {
+                delete[] padded_input_;
+            }
+
+            void run(Tensor *input, Tensor *output) override {
+
+                const uint32_t num_batches = input->num_batches();
+
+                if(input->num_elements() != num_batches * InChannels * InHeight * InWidth ||
+                   output->num_elements() != num_batches * OutChannels * OutHeight * OutWidth) {
+                    PRINT_ERROR_AND_DIE("Tensors of " << name() << " do not match the specialized shape")
+                }
+
+                for(uint32_t batch = 0; batch < num_batches; batch++) {
+                    const fp_t *input_data = input->data_ + batch * InChannels * InHeight * InWidth;
+                    fp_t *output_data = output->data_ + batch * OutChannels * OutHeight * OutWidth;
+
+                    if(Padded) {
+                        for(uint32_t channel = 0; channel < InChannels; channel++) {
+                            for(uint32_t row = 0; row < InHeight; row++) {
+                                std::memcpy(padded_input_ + (channel * PaddedHeight + row + PadTop) * PaddedWidth + PadLeft,
+                                            input_data + (channel * InHeight + row) * InWidth, InWidth * sizeof(fp_t));
+                            }
+                        }
+                        input_data = padded_input_;
+                    }
+
+                    for(uint32_t output_channel = 0; output_channel < OutChannels; output_channel++) {
+                        convolve(input_data, output_data + output_channel * OutHeight * OutWidth, output_channel);
+                    }
+                }
+            }
+
+        private:
+            static constexpr bool Padded = PadTop + PadLeft + PadBottom + PadRight > 0;
+            static constexpr uint32_t PaddedHeight = InHeight + PadTop + PadBottom;
+            static constexpr uint32_t PaddedWidth = InWidth + PadLeft + PadRight;
+
+            /**
+             * @param input padded input of all channels
+             * @param output output channel output_channel
+             */
+            void convolve(const fp_t *input, fp_t *output, uint32_t output_channel) const {
+
+                const fp_t bias = bias_ ? bias_->data_[output_channel] : 0;
+                for(uint32_t i = 0; i < OutHeight * OutWidth; i++) {
+                    output[i] = bias;
+                }
+
+                const uint32_t group = output_channel / GroupOutChannels;
+
+                for(uint32_t channel = 0; channel < GroupInChannels; channel++) {
+                    const fp_t *input_channel = input + (group * GroupInChannels + channel) * PaddedHeight * PaddedWidth;
+                    const fp_t *kernel = kernel_->data_ +
+                                         (output_channel * GroupInChannels + channel) * KernelHeight * KernelWidth;
+
+                    for(uint32_t row = 0; row < OutHeight; row++) {
+                        const fp_t *window = input_channel + row * StrideHeight * PaddedWidth;
+                        fp_t *output_row = output + row * OutWidth;
+
+                        // the whole window is accumulated in a register, the kernel loops are fully unrolled and the
+                        // loop over the output row is vectorized
+                        for(uint32_t col = 0; col < OutWidth; col++) {
+                            fp_t pixel = output_row[col];
+                            for(uint32_t kernel_row = 0; kernel_row < KernelHeight; kernel_row++) {
+                                for(uint32_t kernel_col = 0; kernel_col < KernelWidth; kernel_col++) {
+                                    pixel += kernel[kernel_row * KernelWidth + kernel_col] *
+                                             window[kernel_row * PaddedWidth + col * StrideWidth + kernel_col];
+                                }
+                            }
+                            output_row[col] = pixel;
+                        }
+                    }
+                }
+            }
+
+            Tensor *kernel_;
+            Tensor *bias_;
+            fp_t *padded_input_;
+        };
+    }
+}
+
+#endif //PICO_CNN_SPECIALIZED_CONV2D_H
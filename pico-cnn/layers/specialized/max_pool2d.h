@@ -0,0 +1,83 @@
+/**
+ * @brief pico_cnn::naive::MaxPool2d is a 2D max-pooling operation whose shape is fixed at compile time. It computes the
+ * same result as pico_cnn::naive::MaxPooling (padded pixels are 0), but with constant loop bounds and without creating
+ * a padded copy of the input.
+ *
+ * @author Alexander Jung (University of Tuebingen, Chair for Embedded Systems)
+ */
+#ifndef PICO_CNN_SPECIALIZED_MAX_POOL2D_H
+#define PICO_CNN_SPECIALIZED_MAX_POOL2D_H
+
+#include <limits>
+
+#include "../../parameters.h"
+#include "../../tensor.h"
+#include "../layer.h"
+
+namespace pico_cnn {
+    namespace naive {
+
+        template<uint32_t KernelHeight, uint32_t KernelWidth, uint32_t StrideHeight, uint32_t StrideWidth,
+                 uint32_t Channels, uint32_t InHeight, uint32_t InWidth,
+                 uint32_t PadTop = 0, uint32_t PadLeft = 0, uint32_t PadBottom = 0, uint32_t PadRight = 0>
+        class MaxPool2d : public Layer {
+        public:
+            static constexpr uint32_t OutHeight = (InHeight + PadTop + PadBottom - KernelHeight) / StrideHeight + 1;
+            static constexpr uint32_t OutWidth = (InWidth + PadLeft + PadRight - KernelWidth) / StrideWidth + 1;
+
+            static_assert(InHeight + PadTop + PadBottom >= KernelHeight && InWidth + PadLeft + PadRight >= KernelWidth,
+                          "Kernel is larger than the padded input");
+            static_assert(PadTop < KernelHeight && PadLeft < KernelWidth &&
+                          PadBottom < KernelHeight && PadRight < KernelWidth,
+                          "Padding has to be smaller than the kernel");
+
+            MaxPool2d(std::string name, uint32_t id, op_type op) : Layer(name, id, op) {}
+
+            void run(Tensor *input, Tensor *output) override {
+
+                const uint32_t num_batches = input->num_batches();
+
+                if(input->num_elements() != num_batches * Channels * InHeight * InWidth ||
+                   output->num_elements() != num_batches * Channels * OutHeight * OutWidth) {
+                    PRINT_ERROR_AND_DIE("Tensors of " << name() << " do not match the specialized shape")
+                }
+
+                for(uint32_t channel = 0; channel < num_batches * Channels; channel++) {
+                    pool(input->data_ + channel * InHeight * InWidth, output->data_ + channel * OutHeight * OutWidth);
+                }
+            }
+
+        private:
+            static void pool(const fp_t *input, fp_t *output) {
+                for(uint32_t row = 0; row < OutHeight; row++) {
+                    // window in coordinates of the unpadded input
+                    const int32_t window_top = (int32_t) (row * StrideHeight) - (int32_t) PadTop;
+                    const uint32_t row_begin = MAX(window_top, 0);
+                    const uint32_t row_end = MIN(window_top + (int32_t) KernelHeight, (int32_t) InHeight);
+
+                    for(uint32_t col = 0; col < OutWidth; col++) {
+                        const int32_t window_left = (int32_t) (col * StrideWidth) - (int32_t) PadLeft;
+                        const uint32_t col_begin = MAX(window_left, 0);
+                        const uint32_t col_end = MIN(window_left + (int32_t) KernelWidth, (int32_t) InWidth);
+
+                        fp_t pixel = std::numeric_limits<fp_t>::lowest();
+                        for(uint32_t input_row = row_begin; input_row < row_end; input_row++) {
+                            for(uint32_t input_col = col_begin; input_col < col_end; input_col++) {
+                                pixel = MAX(pixel, input[input_row * InWidth + input_col]);
+                            }
+                        }
+
+                        // the window covers padding
+                        if(row_end - row_begin < KernelHeight || col_end - col_begin < KernelWidth) {
+                            pixel = MAX(pixel, (fp_t) 0);
+                        }
+
+                        output[row * OutWidth + col] = pixel;
+                    }
+                }
+            }
+        };
+    }
+}
+
+#endif //PICO_CNN_SPECIALIZED_MAX_POOL2D_H
@@ -28,8 +28,35 @@
 #include "layers/fully_connected.h"
 #include "layers/batch_normalization.h"
 
+#include "gemm/gemm.h"
+#include "gemm/sparse_matrix.h"
+#include "gemm/sparse_input_gemm.h"
+
+#include "layers/specialized/conv2d.h"
+#include "layers/specialized/max_pool2d.h"
+
+#include "runtime/async_runner.h"
+#include "runtime/buffer_pool.h"
+#include "runtime/deadline_scheduler.h"
+#include "runtime/fused_tiles.h"
+#include "runtime/line_buffer_stream.h"
+#include "runtime/numa.h"
+#include "runtime/perf_counters.h"
+#include "runtime/pipeline.h"
+#include "runtime/prefetch_evaluator.h"
+#include "runtime/spsc_ring.h"
+#include "runtime/task_graph.h"
+#include "runtime/tensor_memory.h"
+#include "runtime/thread_affinity.h"
+#include "runtime/thread_pool.h"
+#include "runtime/weight_set.h"
+#include "runtime/weights_reloader.h"
+
 #include "io/read_binary_weights.h"
+#include "io/shared_weights.h"
 #include "io/read_binary_reference_data.h"
+#include "io/jpeg_ingest.h"
+#include "io/sample_source.h"
 //#include "io/read_pgm.h"
 
 #ifdef MNIST
@@ -0,0 +1,72 @@
+#include "allocation_counter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<uint64_t> allocations(0);
+
+static void *allocate(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+
+    // malloc(0) may return nullptr, but operator new has to return a unique pointer
+    void *pointer = std::malloc(size > 0 ? size : 1);
+    if(pointer == nullptr) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+static void *allocate(std::size_t size, const std::nothrow_t&) noexcept {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size > 0 ? size : 1);
+}
+
+void *operator new(std::size_t size) {
+    return allocate(size);
+}
+
+void *operator new[](std::size_t size) {
+    return allocate(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &tag) noexcept {
+    return allocate(size, tag);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &tag) noexcept {
+    return allocate(size, tag);
+}
+
+void operator delete(void *pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, const std::nothrow_t&) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer, const std::nothrow_t&) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+namespace pico_cnn {
+    namespace naive {
+
+        uint64_t num_allocations() {
+            return allocations.load(std::memory_order_relaxed);
+        }
+    }
+}
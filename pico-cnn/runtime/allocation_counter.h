@@ -0,0 +1,26 @@
+/**
+ * @brief Counts the calls of the global operator new to check that networks do not allocate memory on the heap after
+ * their first run.
+ *
+ * allocation_counter.cpp replaces the global operator new and delete (forwarding to malloc and free). It is not part of
+ * libpico-cnn.a, programs which count allocations (the unit tests and the count_allocations target of generated
+ * networks) compile it in explicitly, all others keep the default allocator.
+ *
+ * @author Alexander Jung (University of Tuebingen, Chair for Embedded Systems)
+ */
+#ifndef PICO_CNN_ALLOCATION_COUNTER_H
+#define PICO_CNN_ALLOCATION_COUNTER_H
+
+#include <cstdint>
+
+namespace pico_cnn {
+    namespace naive {
+
+        /**
+         * @return number of calls of operator new and operator new[] by all threads since the program was started
+         */
+        uint64_t num_allocations();
+    }
+}
+
+#endif //PICO_CNN_ALLOCATION_COUNTER_H
@@ -0,0 +1,112 @@
+#include "async_runner.h"
+
+#include <chrono>
+
+namespace pico_cnn {
+    namespace naive {
+
+        AsyncRun::AsyncRun(std::function<void()> run, std::function<void(RunStatus)> callback) :
+                run_(run), callback_(callback), state_(Pending) {
+            future_ = promise_.get_future().share();
+        }
+
+        bool AsyncRun::cancel() {
+            uint32_t expected = Pending;
+            if(!state_.compare_exchange_strong(expected, Finished)) {
+                return false;
+            }
+            finish(RunStatus::Cancelled);
+            return true;
+        }
+
+        RunStatus AsyncRun::wait() const {
+            return future_.get();
+        }
+
+        std::shared_future<RunStatus> AsyncRun::future() const {
+            return future_;
+        }
+
+        bool AsyncRun::done() const {
+            return future_.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        }
+
+        void AsyncRun::finish(RunStatus status) {
+            // the future becomes ready last, so a thread waiting for it may release what the callback uses
+            if(callback_) {
+                callback_(status);
+            }
+            promise_.set_value(status);
+        }
+
+        void AsyncRunner::DrainTask::execute() {
+            runner->drain();
+        }
+
+        AsyncRunner::AsyncRunner(ThreadPool *pool) : pool_(pool), active_(false) {
+            drain_task_.runner = this;
+        }
+
+        AsyncRunner::~AsyncRunner() {
+            std::deque<std::shared_ptr<AsyncRun>> queued;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                queued.swap(queue_);
+            }
+            for(std::shared_ptr<AsyncRun> &run: queued) {
+                run->cancel();
+            }
+            wait();
+        }
+
+        std::shared_ptr<AsyncRun> AsyncRunner::submit(std::function<void()> run,
+                                                      std::function<void(RunStatus)> callback) {
+            std::shared_ptr<AsyncRun> async_run(new AsyncRun(run, callback));
+
+            bool start;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if(!pool_) {
+                    pool_ = thread_pool();
+                }
+                queue_.push_back(async_run);
+                // runs submitted while the queue is drained are picked up by the same task
+                start = !active_;
+                active_ = true;
+            }
+            if(start) {
+                pool_->submit(&drain_task_);
+            }
+            return async_run;
+        }
+
+        void AsyncRunner::wait() {
+            std::unique_lock<std::mutex> lock(mutex_);
+            idle_.wait(lock, [this] { return !active_; });
+        }
+
+        void AsyncRunner::drain() {
+            while(true) {
+                std::shared_ptr<AsyncRun> run;
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if(queue_.empty()) {
+                        // the runner may be destroyed as soon as the lock is released
+                        active_ = false;
+                        idle_.notify_all();
+                        return;
+                    }
+                    run = queue_.front();
+                    queue_.pop_front();
+                }
+
+                uint32_t expected = AsyncRun::Pending;
+                if(run->state_.compare_exchange_strong(expected, AsyncRun::Running)) {
+                    run->run_();
+                    run->state_.store(AsyncRun::Finished);
+                    run->finish(RunStatus::Completed);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,135 @@
+/**
+ * @brief pico_cnn::naive::AsyncRunner executes the runs of a network asynchronously on the workers of the ThreadPool,
+ * so an event loop does not need a blocking thread per network. submit() returns immediately with an AsyncRun, whose
+ * future becomes ready (and whose callback is called) when the run has finished. Runs of the same runner are executed
+ * one after another in the order they were submitted, as a network can only execute one run at a time, and a run can
+ * be cancelled as long as it has not started.
+ *
+ * While a run is executed, the submitting thread can already prepare the input of the next one, e.g. alternating
+ * between two input tensors. The tensors of a run must not be touched until it has finished.
+ *
+ * @author Alexander Jung (University of Tuebingen, Chair for Embedded Systems)
+ */
+#ifndef PICO_CNN_ASYNC_RUNNER_H
+#define PICO_CNN_ASYNC_RUNNER_H
+
+#include <cstdint>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+
+#include "../parameters.h"
+#include "thread_pool.h"
+
+namespace pico_cnn {
+    namespace naive {
+
+        enum class RunStatus {
+            Completed,
+            // cancelled before it was started, the network did not touch the tensors of the run
+            Cancelled
+        };
+
+        class AsyncRun {
+        public:
+            /**
+             * Cancels the run if it has not been started yet. The callback is then called by this thread.
+             * @return true if the run was cancelled, false if it is running or has already finished
+             */
+            bool cancel();
+
+            /**
+             * Blocks until the run has finished or was cancelled.
+             */
+            RunStatus wait() const;
+
+            /**
+             * @return future which is ready when the run has finished or was cancelled, after the callback returned
+             */
+            std::shared_future<RunStatus> future() const;
+
+            /**
+             * @return true once the run has finished or was cancelled
+             */
+            bool done() const;
+
+        private:
+            friend class AsyncRunner;
+
+            enum State : uint32_t {
+                Pending,
+                Running,
+                Finished
+            };
+
+            AsyncRun(std::function<void()> run, std::function<void(RunStatus)> callback);
+
+            void finish(RunStatus status);
+
+            std::function<void()> run_;
+            std::function<void(RunStatus)> callback_;
+            std::atomic<uint32_t> state_;
+            std::promise<RunStatus> promise_;
+            std::shared_future<RunStatus> future_;
+        };
+
+        class AsyncRunner {
+        public:
+            /**
+             * @param pool pool executing the runs, nullptr selects the global pool when the first run is submitted
+             */
+            explicit AsyncRunner(ThreadPool *pool = nullptr);
+
+            /**
+             * Cancels all runs which have not been started and waits for the running one. Must not be called from a
+             * callback.
+             */
+            ~AsyncRunner();
+
+            AsyncRunner(const AsyncRunner&) = delete;
+            AsyncRunner &operator=(const AsyncRunner&) = delete;
+
+            /**
+             * Queues the run, it is executed by a worker of the pool after all runs submitted before (by the calling
+             * thread itself if the pool has a single thread).
+             * @param run executes the network, e.g. [&]() { network->run(input, output); }
+             * @param callback called by the thread which executed or cancelled the run, should return quickly
+             */
+            std::shared_ptr<AsyncRun> submit(std::function<void()> run,
+                                             std::function<void(RunStatus)> callback = nullptr);
+
+            /**
+             * Blocks until all submitted runs have finished or were cancelled.
+             */
+            void wait();
+
+        private:
+            struct DrainTask : public Task {
+                void execute() override;
+
+                AsyncRunner *runner;
+            };
+
+            /**
+             * Executes the queued runs until the queue is empty.
+             */
+            void drain();
+
+            ThreadPool *pool_;
+            DrainTask drain_task_;
+
+            std::mutex mutex_;
+            std::condition_variable idle_;
+            std::deque<std::shared_ptr<AsyncRun>> queue_;
+            // a DrainTask has been submitted and not yet returned
+            bool active_;
+        };
+    }
+}
+
+#endif //PICO_CNN_ASYNC_RUNNER_H
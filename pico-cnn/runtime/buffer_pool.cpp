@@ -0,0 +1,48 @@
+#include "buffer_pool.h"
+
+namespace pico_cnn {
+    namespace naive {
+
+        BufferPool::BufferPool(uint64_t buffer_size) :
+                buffer_size_(buffer_size),
+                num_allocated_(0) {
+
+        }
+
+        BufferPool::~BufferPool() {
+            // buffers which are still taken belong to kernels running while the program exits
+            for(fp_t *buffer: free_) {
+                delete[] buffer;
+            }
+        }
+
+        void BufferPool::reserve(uint32_t num_buffers) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if(num_allocated_ >= num_buffers) {
+                return;
+            }
+            free_.reserve(num_buffers);
+            for(; num_allocated_ < num_buffers; num_allocated_++) {
+                free_.push_back(new fp_t[buffer_size_]);
+            }
+        }
+
+        fp_t *BufferPool::acquire() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if(free_.empty()) {
+                num_allocated_++;
+                // release() must not allocate
+                free_.reserve(num_allocated_);
+                return new fp_t[buffer_size_];
+            }
+            fp_t *buffer = free_.back();
+            free_.pop_back();
+            return buffer;
+        }
+
+        void BufferPool::release(fp_t *buffer) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            free_.push_back(buffer);
+        }
+    }
+}
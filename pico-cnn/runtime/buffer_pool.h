@@ -0,0 +1,62 @@
+/**
+ * @brief pico_cnn::naive::BufferPool hands out scratch buffers of a fixed size to kernels which run concurrently, e.g.
+ * the packing buffers of the blocked SGEMM or the column bands of the 2D convolution. A caller takes a buffer for the
+ * duration of its work and returns it afterwards, so all layers share a few buffers instead of owning one each.
+ *
+ * Buffers are only allocated by reserve() or if more buffers are taken at the same time than ever before, and are kept
+ * until the pool is destroyed. Reserving a buffer for every thread of the ThreadPool keeps the kernels free of heap
+ * allocations after their first run, no matter which threads run them.
+ *
+ * @author Alexander Jung (University of Tuebingen, Chair for Embedded Systems)
+ */
+#ifndef PICO_CNN_BUFFER_POOL_H
+#define PICO_CNN_BUFFER_POOL_H
+
+#include <cstdint>
+
+#include <mutex>
+#include <vector>
+
+#include "../parameters.h"
+
+namespace pico_cnn {
+    namespace naive {
+
+        class BufferPool {
+        public:
+            /**
+             * @param buffer_size number of elements of every buffer
+             */
+            explicit BufferPool(uint64_t buffer_size);
+            ~BufferPool();
+
+            BufferPool(const BufferPool&) = delete;
+            BufferPool &operator=(const BufferPool&) = delete;
+
+            /**
+             * Allocates buffers until the pool owns at least num_buffers.
+             */
+            void reserve(uint32_t num_buffers);
+
+            /**
+             * @return buffer of buffer_size elements which is used exclusively by the caller until it is released
+             */
+            fp_t *acquire();
+
+            void release(fp_t *buffer);
+
+            uint64_t buffer_size() const {
+                return buffer_size_;
+            }
+
+        private:
+            const uint64_t buffer_size_;
+
+            std::mutex mutex_;
+            std::vector<fp_t*> free_;
+            uint32_t num_allocated_;
+        };
+    }
+}
+
+#endif //PICO_CNN_BUFFER_POOL_H
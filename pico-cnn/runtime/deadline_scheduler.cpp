@@ -0,0 +1,167 @@
+#include "deadline_scheduler.h"
+
+namespace pico_cnn {
+    namespace naive {
+
+        DeadlineScheduler::DeadlineScheduler(SchedulingPolicy policy) :
+                policy_(policy), next_id_(0), shutdown_(false), statistics_{0, 0, 0, 0.0} {
+            dispatcher_ = std::thread(&DeadlineScheduler::dispatcher_loop, this);
+        }
+
+        DeadlineScheduler::~DeadlineScheduler() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                shutdown_ = true;
+            }
+            pending_.notify_one();
+            dispatcher_.join();
+        }
+
+        std::shared_future<RequestReport> DeadlineScheduler::submit(std::function<void(uint32_t step)> step,
+                                                                    uint32_t num_steps, const void *instance,
+                                                                    Clock::time_point deadline, int32_t priority) {
+            Request *request = new Request();
+            request->step = step;
+            request->num_steps = num_steps;
+            request->next_step = 0;
+            request->instance = instance;
+            request->submitted = Clock::now();
+            request->deadline = deadline;
+            request->priority = priority;
+            request->num_preemptions = 0;
+            std::shared_future<RequestReport> future = request->promise.get_future().share();
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                request->id = next_id_++;
+                requests_.push_back(request);
+            }
+            pending_.notify_one();
+            return future;
+        }
+
+        void DeadlineScheduler::wait() {
+            std::unique_lock<std::mutex> lock(mutex_);
+            idle_.wait(lock, [this] { return requests_.empty(); });
+        }
+
+        SchedulerStatistics DeadlineScheduler::statistics() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return statistics_;
+        }
+
+        bool DeadlineScheduler::more_urgent(const Request *a, const Request *b) const {
+            if(policy_ == SchedulingPolicy::EarliestDeadline) {
+                if(a->deadline != b->deadline) {
+                    return a->deadline < b->deadline;
+                }
+                if(a->priority != b->priority) {
+                    return a->priority > b->priority;
+                }
+            } else {
+                if(a->priority != b->priority) {
+                    return a->priority > b->priority;
+                }
+                if(a->deadline != b->deadline) {
+                    return a->deadline < b->deadline;
+                }
+            }
+            return a->id < b->id;
+        }
+
+        DeadlineScheduler::Request *DeadlineScheduler::select() {
+            Request *selected = nullptr;
+            for(Request *request: requests_) {
+                if(selected && !more_urgent(request, selected)) {
+                    continue;
+                }
+                // a request which has not started yet must not overwrite the tensors of a started one, there are only
+                // a few requests in flight, so they are simply searched
+                bool blocked = false;
+                if(request->next_step == 0) {
+                    for(Request *other: requests_) {
+                        if(other != request && other->instance == request->instance && other->next_step > 0) {
+                            blocked = true;
+                            break;
+                        }
+                    }
+                }
+                if(!blocked) {
+                    selected = request;
+                }
+            }
+            return selected;
+        }
+
+        void DeadlineScheduler::dispatcher_loop() {
+            std::unique_lock<std::mutex> lock(mutex_);
+            // request whose step was executed last, nullptr if it has finished
+            Request *previous = nullptr;
+
+            while(true) {
+                pending_.wait(lock, [this] { return shutdown_ || !requests_.empty(); });
+                if(requests_.empty()) {
+                    return;
+                }
+
+                // the started request of every instance is never blocked, so there always is one
+                Request *request = select();
+                if(previous && previous != request) {
+                    previous->num_preemptions++;
+                    statistics_.num_preemptions++;
+                }
+                previous = request;
+
+                if(request->next_step < request->num_steps) {
+                    const uint32_t step = request->next_step;
+                    // new requests may be submitted meanwhile, the steps of this request are only executed here
+                    lock.unlock();
+                    request->step(step);
+                    lock.lock();
+                    request->next_step++;
+                }
+
+                if(request->next_step == request->num_steps) {
+                    finish(request);
+                    previous = nullptr;
+                }
+            }
+        }
+
+        void DeadlineScheduler::finish(Request *request) {
+            const Clock::time_point now = Clock::now();
+
+            RequestReport report;
+            report.id = request->id;
+            report.latency_seconds = std::chrono::duration<double>(now - request->submitted).count();
+            if(request->deadline == Clock::time_point::max()) {
+                report.deadline_missed = false;
+                report.lateness_seconds = 0.0;
+            } else {
+                report.deadline_missed = now > request->deadline;
+                report.lateness_seconds = std::chrono::duration<double>(now - request->deadline).count();
+            }
+            report.num_preemptions = request->num_preemptions;
+
+            statistics_.num_completed++;
+            if(report.deadline_missed) {
+                statistics_.num_deadline_misses++;
+                statistics_.max_lateness_seconds = MAX(statistics_.max_lateness_seconds, report.lateness_seconds);
+                PRINT_DEBUG("Request " << report.id << " missed its deadline by " << report.lateness_seconds << " s")
+            }
+
+            for(auto it = requests_.begin(); it != requests_.end(); ++it) {
+                if(*it == request) {
+                    requests_.erase(it);
+                    break;
+                }
+            }
+            request->promise.set_value(report);
+            delete request;
+
+            if(requests_.empty()) {
+                idle_.notify_all();
+            }
+        }
+    }
+}
@@ -0,0 +1,149 @@
+/**
+ * @brief pico_cnn::naive::DeadlineScheduler executes inference requests of several networks on a single dispatcher
+ * thread as resumable sequences of steps, one operation of the network per step (see Network::run_step() of the
+ * generated code). After every step the dispatcher continues with the most urgent pending request, so a request with a
+ * close deadline waits for at most one operation of a long running bulk request instead of its whole run. The
+ * operations themselves are still parallelized on the ThreadPool.
+ *
+ * Requests are ordered by their deadline (earliest deadline first) or by their priority, see SchedulingPolicy. The
+ * intermediate tensors of a network belong to the network instance, so requests of the same instance are never
+ * interleaved: once a request has started, the other requests of its instance wait until it has finished. Urgent and
+ * bulk requests should therefore use separate instances of the network.
+ *
+ * Every finished request is reported with its latency, whether it missed its deadline and how often it was preempted.
+ *
+ * @author Alexander Jung (University of Tuebingen, Chair for Embedded Systems)
+ */
+#ifndef PICO_CNN_DEADLINE_SCHEDULER_H
+#define PICO_CNN_DEADLINE_SCHEDULER_H
+
+#include <cstdint>
+#include <iostream>
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../parameters.h"
+
+namespace pico_cnn {
+    namespace naive {
+
+        enum class SchedulingPolicy {
+            // earliest deadline first, requests with the same deadline by priority
+            EarliestDeadline,
+            // highest priority first, requests with the same priority by deadline
+            HighestPriority
+        };
+
+        struct RequestReport {
+            uint64_t id;
+            bool deadline_missed;
+            // from submit() until the last step has finished
+            double latency_seconds;
+            // how long the request finished after its deadline, negative if it finished before, 0 without deadline
+            double lateness_seconds;
+            // number of times other requests were executed between two of its steps
+            uint32_t num_preemptions;
+        };
+
+        struct SchedulerStatistics {
+            uint64_t num_completed;
+            uint64_t num_deadline_misses;
+            uint64_t num_preemptions;
+            // largest lateness of a request which missed its deadline
+            double max_lateness_seconds;
+        };
+
+        class DeadlineScheduler {
+        public:
+            typedef std::chrono::steady_clock Clock;
+
+            /**
+             * Starts the dispatcher thread.
+             */
+            explicit DeadlineScheduler(SchedulingPolicy policy = SchedulingPolicy::EarliestDeadline);
+
+            /**
+             * Executes all submitted requests and stops the dispatcher thread.
+             */
+            ~DeadlineScheduler();
+
+            DeadlineScheduler(const DeadlineScheduler&) = delete;
+            DeadlineScheduler &operator=(const DeadlineScheduler&) = delete;
+
+            /**
+             * Queues a request, its steps are executed by the dispatcher thread in the order 0, ..., num_steps - 1.
+             * @param step executes a single step, e.g. [=](uint32_t step) { network->run_step(input, output, step); }
+             * @param num_steps number of steps of the request, e.g. Network::num_steps
+             * @param instance network used by the request, requests of the same instance are not interleaved
+             * @param deadline point in time the request should be finished at, requests without one are executed
+             * after all requests with a deadline (with SchedulingPolicy::EarliestDeadline)
+             * @param priority larger values are more important
+             * @return future which is ready when the request has finished
+             */
+            std::shared_future<RequestReport> submit(std::function<void(uint32_t step)> step, uint32_t num_steps,
+                                                     const void *instance,
+                                                     Clock::time_point deadline = Clock::time_point::max(),
+                                                     int32_t priority = 0);
+
+            /**
+             * Blocks until all submitted requests have finished.
+             */
+            void wait();
+
+            /**
+             * @return statistics of all requests finished so far
+             */
+            SchedulerStatistics statistics();
+
+        private:
+            struct Request {
+                uint64_t id;
+                std::function<void(uint32_t step)> step;
+                uint32_t num_steps;
+                uint32_t next_step;
+                const void *instance;
+                Clock::time_point submitted;
+                Clock::time_point deadline;
+                int32_t priority;
+                uint32_t num_preemptions;
+                std::promise<RequestReport> promise;
+            };
+
+            /**
+             * @return true if a should be executed before b
+             */
+            bool more_urgent(const Request *a, const Request *b) const;
+
+            /**
+             * @return the most urgent request whose instance is not used by another started request, nullptr if there
+             * is none
+             */
+            Request *select();
+
+            void dispatcher_loop();
+
+            void finish(Request *request);
+
+            SchedulingPolicy policy_;
+
+            std::mutex mutex_;
+            std::condition_variable pending_;
+            std::condition_variable idle_;
+            // requests not finished yet, in the order they were submitted
+            std::vector<Request*> requests_;
+            uint64_t next_id_;
+            bool shutdown_;
+            SchedulerStatistics statistics_;
+
+            std::thread dispatcher_;
+        };
+    }
+}
+
+#endif //PICO_CNN_DEADLINE_SCHEDULER_H
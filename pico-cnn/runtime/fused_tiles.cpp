@@ -0,0 +1,222 @@
+#include "fused_tiles.h"
+
+#include <unistd.h>
+
+#include "thread_pool.h"
+
+namespace pico_cnn {
+    namespace naive {
+
+        // assumed if the size of the L2 cache can not be queried
+        static const uint64_t DefaultL2CacheBytes = 1024 * 1024;
+
+        static uint64_t l2_cache_bytes() {
+#ifdef _SC_LEVEL2_CACHE_SIZE
+            long size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+            if(size > 0) {
+                return (uint64_t) size;
+            }
+#endif
+            return DefaultL2CacheBytes;
+        }
+
+        /**
+         * Copies rows [first_row, first_row + num_rows) of every plane (batch and channel) of tensor into band, or the
+         * band back into these rows.
+         */
+        static void copy_rows(fp_t *tensor, uint32_t height, fp_t *band, uint32_t first_row, uint32_t num_rows,
+                              uint32_t num_planes, uint32_t width, bool into_band) {
+            const uint32_t row_elements = num_rows * width;
+            parallel_for(0, num_planes, parallel_grain(row_elements), [&](uint32_t first, uint32_t last) {
+                for(uint32_t plane = first; plane < last; plane++) {
+                    fp_t *rows = tensor + ((uint64_t) plane * height + first_row) * width;
+                    fp_t *band_rows = band + (uint64_t) plane * row_elements;
+                    if(into_band) {
+                        std::memcpy(band_rows, rows, row_elements * sizeof(fp_t));
+                    } else {
+                        std::memcpy(rows, band_rows, row_elements * sizeof(fp_t));
+                    }
+                }
+            });
+        }
+
+        FusedTileGroup::FusedTileGroup(std::string name, uint32_t num_batches, uint32_t num_channels,
+                                       uint32_t height, uint32_t width) :
+                name_(name), num_batches_(num_batches), tile_rows_(0), num_tiles_(0), working_set_bytes_(0),
+                recomputation_(1.0) {
+            channels_.push_back(num_channels);
+            heights_.push_back(height);
+            widths_.push_back(width);
+        }
+
+        FusedTileGroup::~FusedTileGroup() {
+            for(std::vector<Tensor*> &tile: tensors_) {
+                for(Tensor *tensor: tile) {
+                    delete tensor;
+                }
+            }
+        }
+
+        void FusedTileGroup::add_operation(BandOperation operation, uint32_t kernel_height, uint32_t stride_height,
+                                           uint32_t pad_top, uint32_t pad_bottom, uint32_t num_output_channels,
+                                           uint32_t output_width, uint64_t scratch_bytes_per_row) {
+            const uint32_t height = heights_.back();
+            if(stride_height == 0 || kernel_height == 0 || height + pad_top + pad_bottom < kernel_height) {
+                PRINT_ERROR_AND_DIE("Operation " << operations_.size() << " of " << name_ << " does not fit its input of "
+                                    << height << " rows")
+            }
+
+            Operation op;
+            op.run = operation;
+            op.kernel_height = kernel_height;
+            op.stride_height = stride_height;
+            op.pad_top = pad_top;
+            op.scratch_bytes_per_row = scratch_bytes_per_row;
+            operations_.push_back(op);
+
+            channels_.push_back(num_output_channels);
+            heights_.push_back((height + pad_top + pad_bottom - kernel_height) / stride_height + 1);
+            widths_.push_back(output_width);
+        }
+
+        std::vector<FusedTileGroup::Band> FusedTileGroup::tile_bands(uint32_t first_row, uint32_t tile_rows) const {
+            const uint32_t num_levels = operations_.size() + 1;
+            std::vector<Band> bands(num_levels);
+
+            Band &output = bands[num_levels - 1];
+            output.first = first_row;
+            output.last = MIN(first_row + tile_rows, heights_.back());
+            output.pad_top = 0;
+            output.pad_bottom = 0;
+
+            // the input rows of the output rows of every operation, from the last to the first one
+            for(uint32_t level = num_levels - 1; level-- > 0;) {
+                const Operation &op = operations_[level];
+                int64_t start = (int64_t) bands[level + 1].first * op.stride_height - op.pad_top;
+                int64_t end = (int64_t) (bands[level + 1].last - 1) * op.stride_height + op.kernel_height - op.pad_top;
+
+                Band &band = bands[level];
+                band.first = (uint32_t) MAX(start, (int64_t) 0);
+                band.last = (uint32_t) MIN(end, (int64_t) heights_[level]);
+                band.pad_top = band.first - start;
+                band.pad_bottom = end - band.last;
+            }
+            return bands;
+        }
+
+        uint64_t FusedTileGroup::working_set(uint32_t tile_rows) const {
+            uint64_t working_set = 0;
+            for(uint32_t first_row = 0; first_row < heights_.back(); first_row += tile_rows) {
+                std::vector<Band> bands = tile_bands(first_row, tile_rows);
+                for(uint32_t level = 0; level < operations_.size(); level++) {
+                    const uint32_t output_rows = bands[level + 1].last - bands[level + 1].first;
+                    uint64_t bytes = (uint64_t) num_batches_ * channels_[level] * (bands[level].last - bands[level].first) *
+                                     widths_[level] * sizeof(fp_t);
+                    bytes += (uint64_t) num_batches_ * channels_[level + 1] * output_rows * widths_[level + 1] *
+                             sizeof(fp_t);
+                    bytes += operations_[level].scratch_bytes_per_row * output_rows;
+                    working_set = MAX(working_set, bytes);
+                }
+            }
+            return working_set;
+        }
+
+        void FusedTileGroup::finalize(uint64_t cache_bytes, uint32_t tile_rows) {
+            if(operations_.empty()) {
+                PRINT_ERROR_AND_DIE(name_ << " has no operations")
+            }
+            const uint32_t output_height = heights_.back();
+            if(cache_bytes == 0) {
+                cache_bytes = l2_cache_bytes() / 4 * 3;
+            }
+
+            if(tile_rows == 0) {
+                // the working set grows with the tile height, the largest tile fitting into the budget is searched
+                uint32_t low = 1;
+                uint32_t high = output_height;
+                while(low < high) {
+                    uint32_t rows = low + (high - low + 1) / 2;
+                    if(working_set(rows) <= cache_bytes) {
+                        low = rows;
+                    } else {
+                        high = rows - 1;
+                    }
+                }
+                tile_rows = low;
+            }
+            tile_rows_ = MIN(tile_rows, output_height);
+            num_tiles_ = (output_height + tile_rows_ - 1) / tile_rows_;
+            working_set_bytes_ = working_set(tile_rows_);
+
+            const uint32_t num_levels = operations_.size() + 1;
+            uint64_t buffer_elements[2] = {0, 0};
+            uint64_t computed_rows = 0;
+            for(uint32_t tile = 0; tile < num_tiles_; tile++) {
+                bands_.push_back(tile_bands(tile * tile_rows_, tile_rows_));
+                for(uint32_t level = 0; level < num_levels; level++) {
+                    const Band &band = bands_[tile][level];
+                    uint64_t elements = (uint64_t) num_batches_ * channels_[level] * (band.last - band.first) *
+                                        widths_[level];
+                    buffer_elements[level % 2] = MAX(buffer_elements[level % 2], elements);
+                    if(level > 0) {
+                        computed_rows += band.last - band.first;
+                    }
+                }
+            }
+            buffers_[0].resize(buffer_elements[0]);
+            buffers_[1].resize(buffer_elements[1]);
+
+            // the bands of consecutive operations alternate between the buffers
+            for(uint32_t tile = 0; tile < num_tiles_; tile++) {
+                std::vector<Tensor*> tensors;
+                for(uint32_t level = 0; level < num_levels; level++) {
+                    const Band &band = bands_[tile][level];
+                    uint32_t shape[4] = {num_batches_, channels_[level], band.last - band.first, widths_[level]};
+                    tensors.push_back(new Tensor(4, shape, buffers_[level % 2].data()));
+                }
+                tensors_.push_back(tensors);
+            }
+
+            uint64_t rows = 0;
+            for(uint32_t level = 1; level < num_levels; level++) {
+                rows += heights_[level];
+            }
+            recomputation_ = (double) computed_rows / rows;
+
+            PRINT_INFO("Fused " << name_ << ": " << operations_.size() << " operations in " << num_tiles_
+                       << " tiles of " << tile_rows_ << " output rows, working set " << working_set_bytes_ / 1024
+                       << " KiB (budget " << cache_bytes / 1024 << " KiB), " << (recomputation_ - 1.0) * 100
+                       << " % of the rows recomputed")
+        }
+
+        void FusedTileGroup::run(Tensor *input, Tensor *output) {
+            const uint32_t num_levels = operations_.size() + 1;
+            const uint32_t last_level = num_levels - 1;
+            if(tensors_.empty()) {
+                PRINT_ERROR_AND_DIE(name_ << " is not finalized")
+            }
+            if(input->num_elements() != (uint64_t) num_batches_ * channels_[0] * heights_[0] * widths_[0] ||
+               output->num_elements() != (uint64_t) num_batches_ * channels_[last_level] * heights_[last_level] *
+                                         widths_[last_level]) {
+                PRINT_ERROR_AND_DIE("Tensors do not match the shape of " << name_)
+            }
+
+            for(uint32_t tile = 0; tile < num_tiles_; tile++) {
+                const std::vector<Band> &bands = bands_[tile];
+                const std::vector<Tensor*> &tensors = tensors_[tile];
+
+                copy_rows(input->data_, heights_[0], tensors[0]->data_, bands[0].first,
+                          bands[0].last - bands[0].first, num_batches_ * channels_[0], widths_[0], true);
+
+                for(uint32_t level = 0; level < last_level; level++) {
+                    operations_[level].run(tensors[level], tensors[level + 1], bands[level].pad_top,
+                                           bands[level].pad_bottom);
+                }
+
+                copy_rows(output->data_, heights_[last_level], tensors[last_level]->data_, bands[last_level].first,
+                          bands[last_level].last - bands[last_level].first, num_batches_ * channels_[last_level],
+                          widths_[last_level], false);
+            }
+        }
+    }
+}
@@ -0,0 +1,149 @@
+/**
+ * @brief pico_cnn::naive::FusedTileGroup executes a chain of operations (e.g. Conv, ReLU, Conv, ReLU, MaxPool) depth
+ * first in horizontal bands (tiles) instead of one operation after another over the whole image. For every tile of
+ * output rows the group computes the input rows it depends on backwards through the chain, copies them out of the input
+ * tensor and runs all operations on the band, so the intermediate tensors of a tile are only a few rows high and stay in
+ * the L2 cache between producer and consumer. Rows needed by two neighbouring tiles (the halo of the kernels) are
+ * computed by both.
+ *
+ * The tile height is chosen as large as possible such that the bands read and written by any operation (including
+ * scratch memory like the im2col columns of a convolution) fit into the cache budget. All bands and their tensors are
+ * allocated by finalize(), so runs do not allocate memory.
+ *
+ * @author Alexander Jung (University of Tuebingen, Chair for Embedded Systems)
+ */
+#ifndef PICO_CNN_FUSED_TILES_H
+#define PICO_CNN_FUSED_TILES_H
+
+#include <cstdint>
+#include <iostream>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "../parameters.h"
+#include "../tensor.h"
+
+namespace pico_cnn {
+    namespace naive {
+
+        class FusedTileGroup {
+        public:
+            /**
+             * Computes a band of output rows from the band of input rows they depend on. pad_top and pad_bottom are
+             * the zero rows of the vertical padding of the operation above and below the input band, only bands at
+             * the borders of the image have them.
+             */
+            typedef std::function<void(Tensor *input, Tensor *output, uint32_t pad_top, uint32_t pad_bottom)>
+                    BandOperation;
+
+            /**
+             * @param name used in the report printed by finalize()
+             * @param num_batches, num_channels, height, width shape of the input of the first operation
+             */
+            FusedTileGroup(std::string name, uint32_t num_batches, uint32_t num_channels, uint32_t height,
+                           uint32_t width);
+            ~FusedTileGroup();
+
+            FusedTileGroup(const FusedTileGroup&) = delete;
+            FusedTileGroup &operator=(const FusedTileGroup&) = delete;
+
+            /**
+             * Appends an operation whose output row r depends on the input rows r * stride_height - pad_top, ...,
+             * r * stride_height - pad_top + kernel_height - 1 (e.g. kernel_height = stride_height = 1 for
+             * element-wise operations).
+             * @param scratch_bytes_per_row memory touched per output row besides input and output, e.g. the im2col
+             * columns of a convolution
+             */
+            void add_operation(BandOperation operation, uint32_t kernel_height, uint32_t stride_height,
+                               uint32_t pad_top, uint32_t pad_bottom, uint32_t num_output_channels,
+                               uint32_t output_width, uint64_t scratch_bytes_per_row = 0);
+
+            /**
+             * Chooses the tile height and allocates the bands.
+             * @param cache_bytes budget of the working set of a tile, 0 selects 3/4 of the L2 cache of a core
+             * @param tile_rows fixed number of output rows per tile, 0 chooses it from the cache budget
+             */
+            void finalize(uint64_t cache_bytes = 0, uint32_t tile_rows = 0);
+
+            /**
+             * Executes all operations on the input and writes the output of the last one.
+             */
+            void run(Tensor *input, Tensor *output);
+
+            uint32_t tile_rows() const {
+                return tile_rows_;
+            }
+
+            uint32_t num_tiles() const {
+                return num_tiles_;
+            }
+
+            uint32_t output_height() const {
+                return heights_.back();
+            }
+
+            /**
+             * @return largest working set of an operation of a tile in bytes
+             */
+            uint64_t working_set_bytes() const {
+                return working_set_bytes_;
+            }
+
+            /**
+             * @return rows computed by all tiles divided by the rows of the intermediate and output tensors, 1 if no row
+             * is computed twice
+             */
+            double recomputation() const {
+                return recomputation_;
+            }
+
+        private:
+            struct Operation {
+                BandOperation run;
+                uint32_t kernel_height;
+                uint32_t stride_height;
+                uint32_t pad_top;
+                uint64_t scratch_bytes_per_row;
+            };
+
+            // rows [first, last) of the input of operation 'level' (or the output of the group for the last level),
+            // with pad_top and pad_bottom zero rows around them
+            struct Band {
+                uint32_t first;
+                uint32_t last;
+                uint32_t pad_top;
+                uint32_t pad_bottom;
+            };
+
+            /**
+             * @return bands of all levels of the tile whose output rows start at first_row
+             */
+            std::vector<Band> tile_bands(uint32_t first_row, uint32_t tile_rows) const;
+
+            uint64_t working_set(uint32_t tile_rows) const;
+
+            std::string name_;
+            uint32_t num_batches_;
+
+            std::vector<Operation> operations_;
+            // shape of the input of every operation and of the output of the group
+            std::vector<uint32_t> channels_;
+            std::vector<uint32_t> heights_;
+            std::vector<uint32_t> widths_;
+
+            uint32_t tile_rows_;
+            uint32_t num_tiles_;
+            uint64_t working_set_bytes_;
+            double recomputation_;
+
+            // bands[tile][level], the tensors of a level alternate between two buffers
+            std::vector<std::vector<Band>> bands_;
+            std::vector<std::vector<Tensor*>> tensors_;
+            std::vector<fp_t> buffers_[2];
+        };
+    }
+}
+
+#endif //PICO_CNN_FUSED_TILES_H
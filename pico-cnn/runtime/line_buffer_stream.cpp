@@ -0,0 +1,239 @@
+#include "line_buffer_stream.h"
+
+#include <cstring>
+
+namespace pico_cnn {
+    namespace naive {
+
+        LineBufferStream::LineBufferStream(std::string name, uint32_t num_batches, uint32_t num_channels,
+                                           uint32_t width) :
+                name_(name), num_batches_(num_batches), output_row_tensor_(nullptr), buffer_bytes_(0),
+                finalized_(false), output_(nullptr) {
+            channels_.push_back(num_channels);
+            widths_.push_back(width);
+        }
+
+        LineBufferStream::~LineBufferStream() {
+            for(Level &level: levels_) {
+                for(Tensor *slot: level.slots) {
+                    delete slot;
+                }
+                for(Tensor *band: level.bands) {
+                    delete band;
+                }
+            }
+            delete output_row_tensor_;
+        }
+
+        void LineBufferStream::add_operation(BandOperation operation, uint32_t kernel_height, uint32_t stride_height,
+                                             uint32_t pad_top, uint32_t pad_bottom, uint32_t num_output_channels,
+                                             uint32_t output_width) {
+            if(finalized_) {
+                PRINT_ERROR_AND_DIE(name_ << " is already finalized")
+            }
+            // every output row has to depend on at least one row of the image
+            if(stride_height == 0 || kernel_height == 0 || pad_top >= kernel_height || pad_bottom >= kernel_height) {
+                PRINT_ERROR_AND_DIE("Operation " << levels_.size() << " of " << name_ << " can not be streamed: kernel "
+                                    << kernel_height << ", stride " << stride_height << ", padding " << pad_top
+                                    << ", " << pad_bottom)
+            }
+
+            Level level;
+            level.run = operation;
+            level.kernel_height = kernel_height;
+            level.stride_height = stride_height;
+            level.pad_top = pad_top;
+            level.pad_bottom = pad_bottom;
+            level.num_slots = 0;
+            level.rows_received = 0;
+            level.next_output_row = 0;
+            levels_.push_back(level);
+
+            channels_.push_back(num_output_channels);
+            widths_.push_back(output_width);
+        }
+
+        void LineBufferStream::finalize() {
+            if(levels_.empty()) {
+                PRINT_ERROR_AND_DIE(name_ << " has no operations")
+            }
+            if(finalized_) {
+                return;
+            }
+
+            for(uint32_t l = 0; l < levels_.size(); l++) {
+                Level &level = levels_[l];
+                const uint64_t row_elements = (uint64_t) num_batches_ * channels_[l] * widths_[l];
+
+                // the rows of the next output row plus the rows arriving until it can be computed
+                level.num_slots = level.kernel_height + level.stride_height;
+                level.window.resize(level.num_slots * row_elements);
+                for(uint32_t slot = 0; slot < level.num_slots; slot++) {
+                    uint32_t shape[4] = {num_batches_, channels_[l], 1, widths_[l]};
+                    level.slots.push_back(new Tensor(4, shape, level.window.data() + slot * row_elements));
+                }
+
+                level.band.resize(level.kernel_height * row_elements);
+                for(uint32_t rows = 1; rows <= level.kernel_height; rows++) {
+                    uint32_t shape[4] = {num_batches_, channels_[l], rows, widths_[l]};
+                    level.bands.push_back(new Tensor(4, shape, level.band.data()));
+                }
+
+                buffer_bytes_ += (level.window.size() + level.band.size()) * sizeof(fp_t);
+            }
+
+            output_row_.resize((uint64_t) num_batches_ * channels_.back() * widths_.back());
+            uint32_t shape[4] = {num_batches_, channels_.back(), 1, widths_.back()};
+            output_row_tensor_ = new Tensor(4, shape, output_row_.data());
+            buffer_bytes_ += output_row_.size() * sizeof(fp_t);
+            finalized_ = true;
+
+            PRINT_INFO("Streaming " << name_ << ": " << levels_.size() << " operations, "
+                       << buffer_bytes_ / 1024 << " KiB of line buffers for any image height")
+        }
+
+        void LineBufferStream::begin(RowCallback callback) {
+            if(!finalized_) {
+                PRINT_ERROR_AND_DIE(name_ << " is not finalized")
+            }
+            callback_ = callback;
+            output_ = nullptr;
+            for(Level &level: levels_) {
+                level.rows_received = 0;
+                level.next_output_row = 0;
+            }
+        }
+
+        void LineBufferStream::push_rows(const Tensor *rows) {
+            const uint32_t width = widths_[0];
+            const uint32_t num_planes = num_batches_ * channels_[0];
+            if(rows->num_dimensions() != 4 || rows->num_batches() != num_batches_ ||
+               rows->num_channels() != channels_[0] || rows->width() != width) {
+                PRINT_ERROR_AND_DIE("Rows do not match the input of " << name_)
+            }
+
+            const uint32_t num_rows = rows->height();
+            for(uint32_t row = 0; row < num_rows; row++) {
+                Tensor *slot = output_slot(0, levels_[0].rows_received);
+                for(uint32_t plane = 0; plane < num_planes; plane++) {
+                    std::memcpy(slot->data_ + (uint64_t) plane * width,
+                                rows->data_ + ((uint64_t) plane * num_rows + row) * width, width * sizeof(fp_t));
+                }
+                received(0);
+            }
+        }
+
+        uint32_t LineBufferStream::finish() {
+            // the rows of every level are complete once all levels above it are finished
+            for(uint32_t l = 0; l < levels_.size(); l++) {
+                Level &level = levels_[l];
+                const uint32_t height = level.rows_received;
+                if(height + level.pad_top + level.pad_bottom < level.kernel_height) {
+                    PRINT_ERROR_AND_DIE("Operation " << l << " of " << name_ << " does not fit its input of "
+                                        << height << " rows")
+                }
+                const uint32_t output_height = (height + level.pad_top + level.pad_bottom - level.kernel_height) /
+                                               level.stride_height + 1;
+                while(level.next_output_row < output_height) {
+                    compute(l, height);
+                }
+            }
+            return levels_.back().next_output_row;
+        }
+
+        void LineBufferStream::run(Tensor *input, Tensor *output) {
+            if(!finalized_) {
+                PRINT_ERROR_AND_DIE(name_ << " is not finalized")
+            }
+            if(output->num_dimensions() != 4 || output->num_batches() != num_batches_ ||
+               output->num_channels() != channels_.back() || output->height() != output_height(input->height()) ||
+               output->width() != widths_.back()) {
+                PRINT_ERROR_AND_DIE("Tensors do not match the shape of " << name_)
+            }
+
+            for(Level &level: levels_) {
+                level.rows_received = 0;
+                level.next_output_row = 0;
+            }
+            output_ = output;
+            push_rows(input);
+            finish();
+            output_ = nullptr;
+        }
+
+        uint32_t LineBufferStream::output_height(uint32_t height) const {
+            for(const Level &level: levels_) {
+                if(height + level.pad_top + level.pad_bottom < level.kernel_height) {
+                    return 0;
+                }
+                height = (height + level.pad_top + level.pad_bottom - level.kernel_height) / level.stride_height + 1;
+            }
+            return height;
+        }
+
+        Tensor *LineBufferStream::output_slot(uint32_t level, uint32_t row) {
+            if(level == levels_.size()) {
+                return output_row_tensor_;
+            }
+            return levels_[level].slots[row % levels_[level].num_slots];
+        }
+
+        void LineBufferStream::received(uint32_t l) {
+            Level &level = levels_[l];
+            level.rows_received++;
+
+            // output rows whose last input row has arrived, the rows below the image are only known in finish()
+            while((uint64_t) level.next_output_row * level.stride_height + level.kernel_height <=
+                  (uint64_t) level.rows_received + level.pad_top) {
+                compute(l, level.rows_received);
+            }
+        }
+
+        void LineBufferStream::compute(uint32_t l, uint32_t height) {
+            Level &level = levels_[l];
+            const uint32_t width = widths_[l];
+            const uint32_t num_planes = num_batches_ * channels_[l];
+            const uint32_t output_row = level.next_output_row;
+
+            const int64_t start = (int64_t) output_row * level.stride_height - level.pad_top;
+            const int64_t end = start + level.kernel_height;
+            const uint32_t first = (uint32_t) MAX(start, (int64_t) 0);
+            const uint32_t last = (uint32_t) MIN(end, (int64_t) height);
+            const uint32_t num_rows = last - first;
+
+            // the operations expect the rows of a channel to be contiguous
+            fp_t *band = level.band.data();
+            for(uint32_t plane = 0; plane < num_planes; plane++) {
+                for(uint32_t row = 0; row < num_rows; row++) {
+                    const Tensor *slot = level.slots[(first + row) % level.num_slots];
+                    std::memcpy(band + ((uint64_t) plane * num_rows + row) * width,
+                                slot->data_ + (uint64_t) plane * width, width * sizeof(fp_t));
+                }
+            }
+
+            Tensor *output = output_slot(l + 1, output_row);
+            level.run(level.bands[num_rows - 1], output, first - start, end - last);
+            level.next_output_row++;
+
+            if(l + 1 == levels_.size()) {
+                emit(output, output_row);
+            } else {
+                received(l + 1);
+            }
+        }
+
+        void LineBufferStream::emit(const Tensor *row, uint32_t row_index) {
+            if(output_) {
+                const uint32_t width = widths_.back();
+                const uint32_t height = output_->height();
+                const uint32_t num_planes = num_batches_ * channels_.back();
+                for(uint32_t plane = 0; plane < num_planes; plane++) {
+                    std::memcpy(output_->data_ + ((uint64_t) plane * height + row_index) * width,
+                                row->data_ + (uint64_t) plane * width, width * sizeof(fp_t));
+                }
+            } else if(callback_) {
+                callback_(row, row_index);
+            }
+        }
+    }
+}
@@ -0,0 +1,179 @@
+/**
+ * @brief pico_cnn::naive::LineBufferStream executes a chain of operations (e.g. the fully convolutional prefix of a
+ * network: Conv, ReLU, Conv, MaxPool) on an image which is fed row by row, e.g. while a high resolution frame is decoded
+ * or received. Every operation keeps a rolling window of the last kernel_height + stride_height rows of its input and
+ * computes an output row as soon as the rows it depends on have arrived, which is passed on to the next operation. The
+ * output rows of the last operation are emitted one by one to a callback.
+ *
+ * No operation ever holds more than its window, so the memory of a stream depends on the widths and channels of the
+ * operations but not on the height of the image, and the full resolution intermediate tensors are never materialized.
+ * All windows are allocated by finalize(), so streaming does not allocate memory. The height of the image does not
+ * have to be known in advance, the zero padding below the last row is applied by finish().
+ *
+ * The operations themselves are parallelized on the ThreadPool, the rows of a stream have to be pushed by a single
+ * thread.
+ *
+ * @author Alexander Jung (University of Tuebingen, Chair for Embedded Systems)
+ */
+#ifndef PICO_CNN_LINE_BUFFER_STREAM_H
+#define PICO_CNN_LINE_BUFFER_STREAM_H
+
+#include <cstdint>
+#include <iostream>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "../parameters.h"
+#include "../tensor.h"
+#include "fused_tiles.h"
+
+namespace pico_cnn {
+    namespace naive {
+
+        class LineBufferStream {
+        public:
+            /**
+             * Computes output rows from the band of input rows they depend on, see FusedTileGroup::BandOperation. The
+             * stream computes a single output row per call.
+             */
+            typedef FusedTileGroup::BandOperation BandOperation;
+
+            /**
+             * Receives an output row of the last operation, a tensor of shape (num_batches, num_channels, 1, width)
+             * which is only valid during the call.
+             */
+            typedef std::function<void(const Tensor *row, uint32_t row_index)> RowCallback;
+
+            /**
+             * @param name used in the report printed by finalize()
+             * @param num_batches, num_channels, width shape of the input rows of the first operation
+             */
+            LineBufferStream(std::string name, uint32_t num_batches, uint32_t num_channels, uint32_t width);
+            ~LineBufferStream();
+
+            LineBufferStream(const LineBufferStream&) = delete;
+            LineBufferStream &operator=(const LineBufferStream&) = delete;
+
+            /**
+             * Appends an operation whose output row r depends on the input rows r * stride_height - pad_top, ...,
+             * r * stride_height - pad_top + kernel_height - 1 (e.g. kernel_height = stride_height = 1 for
+             * element-wise operations).
+             */
+            void add_operation(BandOperation operation, uint32_t kernel_height, uint32_t stride_height,
+                               uint32_t pad_top, uint32_t pad_bottom, uint32_t num_output_channels,
+                               uint32_t output_width);
+
+            /**
+             * Allocates the windows of all operations.
+             */
+            void finalize();
+
+            /**
+             * Starts a new image, rows of a previous image which was not finished are discarded.
+             * @param callback called with every output row of the last operation, in order
+             */
+            void begin(RowCallback callback);
+
+            /**
+             * Feeds the next rows of the image and emits all output rows which depend only on the rows fed so far.
+             * @param rows tensor of shape (num_batches, num_channels, num_rows, width)
+             */
+            void push_rows(const Tensor *rows);
+
+            /**
+             * Ends the image after the rows fed so far and emits the remaining output rows, which reach into the
+             * padding below the image.
+             * @return number of output rows emitted for the image
+             */
+            uint32_t finish();
+
+            /**
+             * Streams a whole image through all operations and writes the output rows into output.
+             * @param input tensor of shape (num_batches, num_channels, height, width)
+             * @param output tensor of shape (num_batches, output channels, output height, output width)
+             */
+            void run(Tensor *input, Tensor *output);
+
+            /**
+             * @return number of output rows of an image with height input rows
+             */
+            uint32_t output_height(uint32_t height) const;
+
+            uint32_t num_output_channels() const {
+                return channels_.back();
+            }
+
+            uint32_t output_width() const {
+                return widths_.back();
+            }
+
+            /**
+             * @return memory of the windows, bands and the output row of all operations in bytes
+             */
+            uint64_t buffer_bytes() const {
+                return buffer_bytes_;
+            }
+
+        private:
+            struct Level {
+                BandOperation run;
+                uint32_t kernel_height;
+                uint32_t stride_height;
+                uint32_t pad_top;
+                uint32_t pad_bottom;
+
+                // ring of the last num_slots input rows, row i is stored in slot i % num_slots as a tensor of shape
+                // (num_batches, channels, 1, width)
+                uint32_t num_slots;
+                std::vector<fp_t> window;
+                std::vector<Tensor*> slots;
+                // contiguous copy of the input rows of an output row, bands[r - 1] has r rows
+                std::vector<fp_t> band;
+                std::vector<Tensor*> bands;
+
+                uint32_t rows_received;
+                uint32_t next_output_row;
+            };
+
+            /**
+             * @return row of the input ring of level (or the output row of the stream) an output row of level - 1 is
+             * written to
+             */
+            Tensor *output_slot(uint32_t level, uint32_t row);
+
+            /**
+             * Passes a row which has been written into the ring of level on and computes the output rows depending on
+             * it.
+             */
+            void received(uint32_t level);
+
+            /**
+             * Computes the next output row of level from the rows in its ring.
+             */
+            void compute(uint32_t level, uint32_t height);
+
+            void emit(const Tensor *row, uint32_t row_index);
+
+            std::string name_;
+            uint32_t num_batches_;
+
+            std::vector<Level> levels_;
+            // shape of the input rows of every operation and of the output rows of the stream
+            std::vector<uint32_t> channels_;
+            std::vector<uint32_t> widths_;
+
+            std::vector<fp_t> output_row_;
+            Tensor *output_row_tensor_;
+            uint64_t buffer_bytes_;
+            bool finalized_;
+
+            RowCallback callback_;
+            // written by run() instead of calling the callback
+            Tensor *output_;
+        };
+    }
+}
+
+#endif //PICO_CNN_LINE_BUFFER_STREAM_H
@@ -0,0 +1,135 @@
+#include "numa.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include "thread_affinity.h"
+
+namespace pico_cnn {
+    namespace naive {
+
+        std::vector<uint32_t> parse_cpulist(const std::string &cpulist) {
+            std::vector<uint32_t> cores;
+            std::stringstream ranges(cpulist);
+            std::string range;
+            while(std::getline(ranges, range, ',')) {
+                if(range.find_first_of("0123456789") == std::string::npos) {
+                    continue;
+                }
+                const size_t dash = range.find('-');
+                const uint32_t first = std::strtoul(range.c_str(), nullptr, 10);
+                const uint32_t last = dash == std::string::npos ? first :
+                                      std::strtoul(range.c_str() + dash + 1, nullptr, 10);
+                for(uint32_t core = first; core <= last; core++) {
+                    cores.push_back(core);
+                }
+            }
+            std::sort(cores.begin(), cores.end());
+            return cores;
+        }
+
+        NumaTopology NumaTopology::detect(const std::string &sysfs_root) {
+            NumaTopology topology;
+
+            // node ids may have gaps, e.g. after hot-unplugging
+            std::ifstream possible(sysfs_root + "/possible");
+            std::string possible_nodes;
+            std::getline(possible, possible_nodes);
+            for(uint32_t node: parse_cpulist(possible_nodes)) {
+                std::ifstream cpulist(sysfs_root + "/node" + std::to_string(node) + "/cpulist");
+                std::string cores;
+                if(std::getline(cpulist, cores)) {
+                    std::vector<uint32_t> node_cores = parse_cpulist(cores);
+                    if(!node_cores.empty()) {
+                        topology.cores_.push_back(node_cores);
+                    }
+                }
+            }
+
+            if(topology.cores_.empty()) {
+                std::vector<uint32_t> all_cores;
+                for(uint32_t core = 0; core < num_cores(); core++) {
+                    all_cores.push_back(core);
+                }
+                topology.cores_.push_back(all_cores);
+            }
+
+            return topology;
+        }
+
+        uint32_t NumaTopology::num_nodes() const {
+            return cores_.size();
+        }
+
+        const std::vector<uint32_t> &NumaTopology::cores(uint32_t node) const {
+            return cores_[node];
+        }
+
+        uint32_t NumaTopology::node_of_worker(uint32_t worker) const {
+            return worker % num_nodes();
+        }
+
+        uint32_t NumaTopology::core_of_worker(uint32_t worker) const {
+            const std::vector<uint32_t> &node_cores = cores_[node_of_worker(worker)];
+            return node_cores[(worker / num_nodes()) % node_cores.size()];
+        }
+
+        uint32_t NumaTopology::pin_worker(uint32_t worker) const {
+            if(!pin_current_thread(core_of_worker(worker))) {
+                PRINT_DEBUG("Could not pin worker " << worker << " to core " << core_of_worker(worker))
+            }
+            return node_of_worker(worker);
+        }
+
+        NumaWeights::NumaWeights(const NumaTopology &topology, Tensor **kernels, uint32_t num_kernels,
+                                 Tensor **biases, uint32_t num_biases,
+                                 SparseMatrix **sparse_kernels, uint32_t num_sparse_kernels) :
+                replicas_(topology.num_nodes(), nullptr) {
+
+            auto replicate = [&](uint32_t node) {
+                replicas_[node] = new WeightSet(kernels, num_kernels, biases, num_biases,
+                                                sparse_kernels, num_sparse_kernels);
+                replicas_[node]->copy_from(kernels, biases, sparse_kernels);
+            };
+
+            if(topology.num_nodes() == 1) {
+                replicate(0);
+            } else {
+                for(uint32_t node = 0; node < topology.num_nodes(); node++) {
+                    std::thread thread([&, node]() {
+                        pin_current_thread(topology.cores(node).front());
+                        replicate(node);
+                    });
+                    thread.join();
+                }
+            }
+
+            replicas_[0]->use(kernels, biases, sparse_kernels);
+            PRINT_INFO("Replicated the weights on " << replicas_.size() << " NUMA node(s)")
+        }
+
+        NumaWeights::~NumaWeights() {
+            for(WeightSet *replica: replicas_) {
+                delete replica;
+            }
+        }
+
+        uint32_t NumaWeights::num_replicas() const {
+            return replicas_.size();
+        }
+
+        void NumaWeights::use_replica(uint32_t node, Tensor **kernels, Tensor **biases,
+                                      SparseMatrix **sparse_kernels) const {
+            if(node >= replicas_.size()) {
+                PRINT_ERROR_AND_DIE("No replica of the weights on NUMA node " << node)
+            }
+            if(!replicas_[node]->matches(kernels, biases, sparse_kernels)) {
+                PRINT_ERROR_AND_DIE("The network does not match the replicated weights")
+            }
+            replicas_[node]->use(kernels, biases, sparse_kernels);
+        }
+    }
+}
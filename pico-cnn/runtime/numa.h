@@ -0,0 +1,113 @@
+/**
+ * @brief NUMA support for multi-socket hosts: pico_cnn::naive::NumaTopology reads the nodes and their cores from sysfs
+ * and pins worker threads to cores, pico_cnn::naive::NumaWeights replicates the kernels and biases of a network on
+ * every node, so every worker reads them from the memory of its own socket. On machines with a single node (or
+ * without sysfs) there is one replica and pinning stays optional.
+ *
+ * Typical use with one network per worker thread:
+ *
+ *     auto topology = NumaTopology::detect();
+ *     NumaWeights weights(topology, net->kernels, Network::num_kernels, net->biases, Network::num_biases,
+ *                         net->sparse_kernels, Network::num_sparse_kernels);
+ *     // in worker thread i
+ *     uint32_t node = topology.pin_worker(i);
+ *     Network *local = new Network();  // activations are allocated on the node of the worker
+ *     weights.use_replica(node, local->kernels, local->biases, local->sparse_kernels);
+ *
+ * @author Alexander Jung (University of Tuebingen, Chair for Embedded Systems)
+ */
+#ifndef PICO_CNN_NUMA_H
+#define PICO_CNN_NUMA_H
+
+#include <cstdint>
+
+#include <string>
+#include <vector>
+
+#include "../parameters.h"
+#include "../tensor.h"
+#include "../gemm/sparse_matrix.h"
+#include "weight_set.h"
+
+namespace pico_cnn {
+    namespace naive {
+
+        /**
+         * @param cpulist list of cores as in sysfs, e.g. "0-3,8-11"
+         * @return the cores in ascending order
+         */
+        std::vector<uint32_t> parse_cpulist(const std::string &cpulist);
+
+        class NumaTopology {
+        public:
+            /**
+             * Reads the cores of every node from sysfs_root/node<N>/cpulist, nodes without cores (e.g. memory only)
+             * are skipped. Without sysfs the topology has a single node with all cores.
+             */
+            static NumaTopology detect(const std::string &sysfs_root = "/sys/devices/system/node");
+
+            /**
+             * @return number of nodes with cores, at least 1
+             */
+            uint32_t num_nodes() const;
+
+            /**
+             * @param node index in [0, num_nodes()), which is not necessarily the id of the node in sysfs
+             */
+            const std::vector<uint32_t> &cores(uint32_t node) const;
+
+            /**
+             * Workers are distributed round-robin across the nodes and then across the cores of a node, so any
+             * number of workers uses all sockets evenly.
+             */
+            uint32_t node_of_worker(uint32_t worker) const;
+            uint32_t core_of_worker(uint32_t worker) const;
+
+            /**
+             * Pins the calling thread to core_of_worker(worker).
+             * @return node_of_worker(worker)
+             */
+            uint32_t pin_worker(uint32_t worker) const;
+
+        private:
+            // cores of every node with cores
+            std::vector<std::vector<uint32_t>> cores_;
+        };
+
+        class NumaWeights {
+        public:
+            /**
+             * Copies the weights of a network into one replica per node, each allocated and written by a thread
+             * pinned to the node, so the first-touch policy of the kernel places it in the memory of the node. The
+             * network itself is switched to the replica of the first node.
+             * @param num_kernels number of elements of kernels, the same for biases and sparse_kernels (e.g.
+             * Network::num_kernels)
+             */
+            NumaWeights(const NumaTopology &topology, Tensor **kernels, uint32_t num_kernels,
+                        Tensor **biases, uint32_t num_biases,
+                        SparseMatrix **sparse_kernels = nullptr, uint32_t num_sparse_kernels = 0);
+
+            /**
+             * Frees all replicas, the networks using them must not run anymore.
+             */
+            ~NumaWeights();
+
+            NumaWeights(const NumaWeights&) = delete;
+            NumaWeights &operator=(const NumaWeights&) = delete;
+
+            uint32_t num_replicas() const;
+
+            /**
+             * Switches the kernels and biases of a network of the same type to the replica of node, its own weights
+             * are freed.
+             */
+            void use_replica(uint32_t node, Tensor **kernels, Tensor **biases,
+                             SparseMatrix **sparse_kernels = nullptr) const;
+
+        private:
+            std::vector<WeightSet*> replicas_;
+        };
+    }
+}
+
+#endif //PICO_CNN_NUMA_H
@@ -0,0 +1,212 @@
+#include "perf_counters.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "../parameters.h"
+
+namespace pico_cnn {
+    namespace naive {
+
+        /**
+         * Counters of one thread, opened on first use by this thread and closed when it exits.
+         */
+        class ThreadCounters {
+        public:
+            ThreadCounters() {
+                int error = ENOSYS;
+                for(uint32_t event = 0; event < NumPerfEvents; event++) {
+                    fds_[event] = -1;
+                }
+#ifdef __linux__
+                const uint64_t cache_miss = PERF_COUNT_HW_CACHE_OP_READ << 8 | PERF_COUNT_HW_CACHE_RESULT_MISS << 16;
+
+                fds_[PerfCycles] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+                error = errno;
+                fds_[PerfInstructions] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+                fds_[PerfLlcMisses] = open(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | cache_miss);
+                if(fds_[PerfLlcMisses] < 0) {
+                    // generic cache misses are last-level misses on most CPUs
+                    fds_[PerfLlcMisses] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+                }
+                fds_[PerfDtlbMisses] = open(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | cache_miss);
+#endif
+                static std::atomic<bool> warned(false);
+                if(fds_[PerfCycles] < 0 && fds_[PerfInstructions] < 0 && !warned.exchange(true)) {
+                    PRINT_WARNING("Hardware performance counters are not available (" << std::strerror(error)
+                                  << "), only the time of the layers is measured. Counting requires "
+                                     "kernel.perf_event_paranoid <= 2 and perf_event_open to be permitted.")
+                }
+            }
+
+            ~ThreadCounters() {
+#ifdef __linux__
+                for(uint32_t event = 0; event < NumPerfEvents; event++) {
+                    if(fds_[event] >= 0) {
+                        close(fds_[event]);
+                    }
+                }
+#endif
+            }
+
+            ThreadCounters(const ThreadCounters&) = delete;
+            ThreadCounters &operator=(const ThreadCounters&) = delete;
+
+            bool available(uint32_t event) const {
+                return fds_[event] >= 0;
+            }
+
+            /**
+             * @return false if the event is not available or could not be read
+             */
+            bool read(uint32_t event, uint64_t *values) const {
+#ifdef __linux__
+                if(fds_[event] >= 0) {
+                    return ::read(fds_[event], values, 3 * sizeof(uint64_t)) == 3 * sizeof(uint64_t);
+                }
+#else
+                (void) event;
+                (void) values;
+#endif
+                return false;
+            }
+
+        private:
+#ifdef __linux__
+            static int open(uint32_t type, uint64_t config) {
+                struct perf_event_attr attributes;
+                std::memset(&attributes, 0, sizeof(attributes));
+                attributes.size = sizeof(attributes);
+                attributes.type = type;
+                attributes.config = config;
+                attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+                // only the network itself is of interest, this is also permitted for unprivileged processes
+                attributes.exclude_kernel = 1;
+                attributes.exclude_hv = 1;
+
+                // calling thread on any cpu
+                return (int) syscall(__NR_perf_event_open, &attributes, 0, -1, -1, 0);
+            }
+#endif
+
+            int fds_[NumPerfEvents];
+        };
+
+        static const ThreadCounters &thread_counters() {
+            static thread_local ThreadCounters counters;
+            return counters;
+        }
+
+        uint32_t LayerProfiler::add_layer(const std::string &name, const std::string &op_type) {
+            LayerStatistics statistics;
+            statistics.name = name;
+            statistics.op_type = op_type;
+            statistics.num_runs = 0;
+            statistics.milliseconds = 0;
+            for(uint32_t event = 0; event < NumPerfEvents; event++) {
+                statistics.counts[event] = 0;
+                statistics.num_counted[event] = 0;
+            }
+
+            layers_.push_back(statistics);
+            return layers_.size() - 1;
+        }
+
+        PerfSample LayerProfiler::begin() const {
+            const ThreadCounters &counters = thread_counters();
+
+            PerfSample sample;
+            for(uint32_t event = 0; event < NumPerfEvents; event++) {
+                sample.valid[event] = counters.read(event, sample.counters[event]);
+            }
+            sample.time = std::chrono::steady_clock::now();
+            return sample;
+        }
+
+        void LayerProfiler::end(uint32_t layer, const PerfSample &start) {
+            auto end_time = std::chrono::steady_clock::now();
+            const ThreadCounters &counters = thread_counters();
+
+            LayerStatistics &statistics = layers_[layer];
+            statistics.num_runs++;
+            statistics.milliseconds += std::chrono::duration<double, std::milli>(end_time - start.time).count();
+
+            for(uint32_t event = 0; event < NumPerfEvents; event++) {
+                uint64_t values[3];
+                if(!start.valid[event] || !counters.read(event, values)) {
+                    continue;
+                }
+
+                uint64_t enabled = values[1] - start.counters[event][1];
+                uint64_t running = values[2] - start.counters[event][2];
+                if(running == 0) {
+                    // the counter was not scheduled during the layer
+                    continue;
+                }
+
+                statistics.counts[event] += (double) (values[0] - start.counters[event][0]) * enabled / running;
+                statistics.num_counted[event]++;
+            }
+        }
+
+        bool LayerProfiler::available(PerfEvent event) {
+            return thread_counters().available(event);
+        }
+
+        void LayerProfiler::print(std::ostream &out) const {
+
+            // average count of an event per run, negative if it was never counted
+            auto average = [](const LayerStatistics &statistics, uint32_t event) {
+                return statistics.num_counted[event] > 0 ? statistics.counts[event] / statistics.num_counted[event] : -1.0;
+            };
+
+            auto print_value = [&out](double value) {
+                if(value < 0) {
+                    out << std::setw(11) << "n/a";
+                } else {
+                    out << std::setw(11) << std::fixed << std::setprecision(2) << value;
+                }
+            };
+
+            out << std::left << std::setw(32) << "layer" << std::setw(20) << "op_type" << std::right
+                << std::setw(8) << "runs" << std::setw(11) << "ms/run" << std::setw(11) << "IPC"
+                << std::setw(11) << "LLC MPKI" << std::setw(11) << "dTLB MPKI" << std::endl;
+
+            double total_milliseconds = 0;
+            for(const LayerStatistics &statistics: layers_) {
+                out << std::left << std::setw(32) << statistics.name << std::setw(20) << statistics.op_type
+                    << std::right << std::setw(8) << statistics.num_runs;
+
+                if(statistics.num_runs == 0) {
+                    out << std::endl;
+                    continue;
+                }
+
+                double milliseconds = statistics.milliseconds / statistics.num_runs;
+                total_milliseconds += milliseconds;
+                out << std::setw(11) << std::fixed << std::setprecision(3) << milliseconds;
+
+                double cycles = average(statistics, PerfCycles);
+                double instructions = average(statistics, PerfInstructions);
+
+                print_value(cycles > 0 && instructions >= 0 ? instructions / cycles : -1);
+                for(uint32_t event: {PerfLlcMisses, PerfDtlbMisses}) {
+                    double misses = average(statistics, event);
+                    print_value(misses >= 0 && instructions > 0 ? 1000 * misses / instructions : -1);
+                }
+                out << std::endl;
+            }
+
+            out << std::left << std::setw(60) << "total" << std::right << std::setw(11) << std::fixed
+                << std::setprecision(3) << total_milliseconds << std::endl;
+        }
+    }
+}
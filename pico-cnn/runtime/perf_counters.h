@@ -0,0 +1,92 @@
+/**
+ * @brief Per-layer hardware performance counters based on Linux perf_event_open.
+ *
+ * pico_cnn::naive::LayerProfiler measures cycles, instructions, last-level cache misses and dTLB misses (if the CPU
+ * and the kernel provide them) as well as the wall-clock time of every layer and aggregates them across runs.
+ * Networks generated with --profile wrap every operation into begin() and end() and print the statistics when they
+ * are deleted. Counters are opened per thread and only count the thread which called begin(), so the generated code
+ * runs every profiled layer under an IntraOpLimit(1): its parallel loops stay on that thread instead of being split
+ * among the workers of the pool, whose share would not be counted. Layers executed by the worker threads of a
+ * TaskGraph or a Pipeline are measured on the thread running them. Times are therefore those of single-threaded
+ * layers. If perf_event_open is not permitted (e.g. in containers or with kernel.perf_event_paranoid > 2) only the
+ * wall-clock time is reported.
+ *
+ * @author Alexander Jung (University of Tuebingen, Chair for Embedded Systems)
+ */
+#ifndef PICO_CNN_PERF_COUNTERS_H
+#define PICO_CNN_PERF_COUNTERS_H
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace pico_cnn {
+    namespace naive {
+
+        enum PerfEvent {
+            PerfCycles,
+            PerfInstructions,
+            PerfLlcMisses,
+            PerfDtlbMisses,
+            NumPerfEvents
+        };
+
+        /**
+         * Counter values of the calling thread at the start of a layer.
+         */
+        struct PerfSample {
+            // value, time enabled and time running of every event (the latter two are needed to scale the value if
+            // the kernel multiplexes the counters)
+            uint64_t counters[NumPerfEvents][3];
+            bool valid[NumPerfEvents];
+            std::chrono::steady_clock::time_point time;
+        };
+
+        class LayerProfiler {
+        public:
+            /**
+             * @return index of the layer which has to be passed to end()
+             */
+            uint32_t add_layer(const std::string &name, const std::string &op_type);
+
+            /**
+             * @return counter values of the calling thread before the layer is run
+             */
+            PerfSample begin() const;
+
+            /**
+             * Adds the counts since start to the statistics of the layer. Has to be called on the thread which called
+             * begin(). A layer must not be measured by two threads at the same time. Work the layer handed to other
+             * threads in between is not counted.
+             */
+            void end(uint32_t layer, const PerfSample &start);
+
+            /**
+             * Prints time, IPC and misses per kilo-instruction (MPKI) averaged over all runs of every layer.
+             */
+            void print(std::ostream &out = std::cout) const;
+
+            /**
+             * @return true if the event can be counted on the calling thread
+             */
+            static bool available(PerfEvent event);
+
+        private:
+            struct LayerStatistics {
+                std::string name;
+                std::string op_type;
+                uint64_t num_runs;
+                double milliseconds;
+                // sum of the counts and number of runs in which the event was counted
+                double counts[NumPerfEvents];
+                uint64_t num_counted[NumPerfEvents];
+            };
+
+            std::vector<LayerStatistics> layers_;
+        };
+    }
+}
+
+#endif //PICO_CNN_PERF_COUNTERS_H
@@ -0,0 +1,164 @@
+#include "pipeline.h"
+
+#include <chrono>
+#include <thread>
+
+#include "thread_affinity.h"
+#include "thread_pool.h"
+
+namespace pico_cnn {
+    namespace naive {
+
+        Pipeline::Pipeline(TensorAllocator input_allocator, uint32_t depth, int32_t first_core) :
+                depth_(MAX(depth, 1u)),
+                first_core_(first_core) {
+
+            tensors_.push_back(std::vector<Tensor*>());
+            filled_.push_back(new SpscRing<Tensor*>(depth_ + 1));
+            free_.push_back(new SpscRing<Tensor*>(depth_));
+            for(uint32_t i = 0; i < depth_; i++) {
+                tensors_.back().push_back(input_allocator());
+                free_.back()->push(tensors_.back().back());
+            }
+        }
+
+        Pipeline::~Pipeline() {
+            for(std::vector<Tensor*> &boundary: tensors_) {
+                for(Tensor *tensor: boundary) {
+                    delete tensor;
+                }
+            }
+            for(SpscRing<Tensor*> *ring: filled_) {
+                delete ring;
+            }
+            for(SpscRing<Tensor*> *ring: free_) {
+                delete ring;
+            }
+        }
+
+        void Pipeline::add_stage(Stage stage, TensorAllocator output_allocator) {
+            stages_.push_back(stage);
+
+            tensors_.push_back(std::vector<Tensor*>());
+            // one additional slot for the nullptr marking the end of the stream
+            filled_.push_back(new SpscRing<Tensor*>(depth_ + 1));
+            free_.push_back(new SpscRing<Tensor*>(depth_));
+            for(uint32_t i = 0; i < depth_; i++) {
+                tensors_.back().push_back(output_allocator());
+                free_.back()->push(tensors_.back().back());
+            }
+        }
+
+        uint32_t Pipeline::num_stages() const {
+            return stages_.size();
+        }
+
+        void Pipeline::stage_loop(uint32_t stage, double *busy_seconds) {
+            if(first_core_ >= 0) {
+                if(!pin_current_thread(first_core_ + stage)) {
+                    PRINT_WARNING("Could not pin pipeline stage " << stage << " to core " << first_core_ + stage)
+                }
+            }
+
+            // every stage has its own core, parallel loops of its kernels would compete with the other stages for the
+            // workers of the global pool
+            IntraOpLimit limit(1);
+
+            double busy = 0.0;
+
+            while(true) {
+                Tensor *input = filled_[stage]->pop();
+                if(input == nullptr) {
+                    filled_[stage + 1]->push(nullptr);
+                    break;
+                }
+                Tensor *output = free_[stage + 1]->pop();
+
+                auto start = std::chrono::steady_clock::now();
+                stages_[stage](input, output);
+                busy += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+                free_[stage]->push(input);
+                filled_[stage + 1]->push(output);
+            }
+
+            *busy_seconds = busy;
+        }
+
+        PipelineStatistics Pipeline::run(std::function<bool(Tensor *input, uint64_t frame)> source,
+                                         std::function<void(Tensor *output, uint64_t frame)> sink) {
+            const uint32_t num_stages = stages_.size();
+            if(num_stages == 0) {
+                PRINT_ERROR_AND_DIE("Pipeline does not contain any stages.")
+            }
+
+            PipelineStatistics statistics;
+            statistics.stage_busy_seconds.resize(num_stages, 0.0);
+
+            auto start = std::chrono::steady_clock::now();
+
+            std::vector<std::thread> threads;
+            for(uint32_t stage = 0; stage < num_stages; stage++) {
+                threads.push_back(std::thread(&Pipeline::stage_loop, this, stage,
+                                              &statistics.stage_busy_seconds[stage]));
+            }
+
+            // the calling thread produces new frames and consumes finished ones
+            uint64_t frames_in = 0;
+            uint64_t frames_out = 0;
+            // input tensor taken for the frame the source did not produce, stage 0 is the only producer of the free
+            // inputs, so it is returned once the stage threads are joined
+            Tensor *unused_input = nullptr;
+            bool source_done = false;
+            while(true) {
+                bool progress = false;
+
+                Tensor *input;
+                if(!source_done && free_[0]->try_pop(input)) {
+                    if(source(input, frames_in)) {
+                        filled_[0]->push(input);
+                        frames_in++;
+                    } else {
+                        unused_input = input;
+                        filled_[0]->push(nullptr);
+                        source_done = true;
+                    }
+                    progress = true;
+                }
+
+                Tensor *output;
+                if(filled_[num_stages]->try_pop(output)) {
+                    if(output == nullptr) {
+                        break;
+                    }
+                    sink(output, frames_out++);
+                    free_[num_stages]->push(output);
+                    progress = true;
+                }
+
+                if(!progress) {
+                    std::this_thread::yield();
+                }
+            }
+
+            for(std::thread &thread: threads) {
+                thread.join();
+            }
+            free_[0]->push(unused_input);
+
+            statistics.num_frames = frames_out;
+            statistics.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            statistics.frames_per_second = statistics.seconds > 0.0 ? frames_out / statistics.seconds : 0.0;
+
+            PRINT_INFO("Pipeline with " << num_stages << " stages processed " << frames_out << " frames in "
+                       << statistics.seconds << " s (" << statistics.frames_per_second << " frames/s)")
+            for(uint32_t stage = 0; stage < num_stages; stage++) {
+                PRINT_INFO("    Stage " << stage << ": busy " << statistics.stage_busy_seconds[stage] << " s ("
+                           << (statistics.seconds > 0.0 ? 100.0 * statistics.stage_busy_seconds[stage] / statistics.seconds : 0.0)
+                           << " %)")
+            }
+
+            return statistics;
+        }
+    }
+}
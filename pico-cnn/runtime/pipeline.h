@@ -0,0 +1,85 @@
+/**
+ * @brief pico_cnn::naive::Pipeline streams frames through a sequence of stages, each running on its own (pinned) core.
+ * Consecutive stages exchange their boundary tensors through single-producer/single-consumer lock-free rings. Every
+ * boundary owns a fixed set of 'depth' tensors which circulate between a ring of filled and a ring of free tensors, so
+ * no memory is allocated while streaming. The kernels of a stage run on its thread only, their parallel loops are not
+ * split among the threads of the global pool (see IntraOpLimit).
+ *
+ * @author Alexander Jung (University of Tuebingen, Chair for Embedded Systems)
+ */
+#ifndef PICO_CNN_PIPELINE_H
+#define PICO_CNN_PIPELINE_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+#include <functional>
+#include <vector>
+
+#include "../parameters.h"
+#include "../tensor.h"
+#include "spsc_ring.h"
+
+namespace pico_cnn {
+    namespace naive {
+
+        struct PipelineStatistics {
+            uint64_t num_frames;
+            double seconds;
+            double frames_per_second;
+            // time every stage spent executing frames
+            std::vector<double> stage_busy_seconds;
+        };
+
+        class Pipeline {
+        public:
+            typedef std::function<void(Tensor *input, Tensor *output)> Stage;
+            typedef std::function<Tensor*()> TensorAllocator;
+
+            /**
+             * @param input_allocator Allocates an input tensor of the first stage.
+             * @param depth Number of tensors in flight between two consecutive stages.
+             * @param first_core Core the first stage is pinned to, stage k is pinned to core first_core + k.
+             * A negative value disables pinning.
+             */
+            Pipeline(TensorAllocator input_allocator, uint32_t depth = 4, int32_t first_core = 0);
+            ~Pipeline();
+
+            Pipeline(const Pipeline&) = delete;
+            Pipeline &operator=(const Pipeline&) = delete;
+
+            /**
+             * Appends a stage to the pipeline.
+             * @param stage Computes the output tensor of the stage from the output of the previous stage.
+             * @param output_allocator Allocates an output tensor of the stage.
+             */
+            void add_stage(Stage stage, TensorAllocator output_allocator);
+
+            /**
+             * Streams frames through the pipeline until source returns false. Returns after the last frame was passed
+             * to sink. Frames are passed to sink in the order in which they were produced by source.
+             * @param source Fills the input tensor of frame 'frame', returns false if there are no more frames.
+             * @param sink Consumes the output tensor of frame 'frame'.
+             */
+            PipelineStatistics run(std::function<bool(Tensor *input, uint64_t frame)> source,
+                                   std::function<void(Tensor *output, uint64_t frame)> sink);
+
+            uint32_t num_stages() const;
+
+        private:
+            void stage_loop(uint32_t stage, double *busy_seconds);
+
+            uint32_t depth_;
+            int32_t first_core_;
+            std::vector<Stage> stages_;
+
+            // boundary b connects stage b-1 and stage b, boundary 0 is the input, boundary num_stages the output
+            std::vector<std::vector<Tensor*>> tensors_;
+            std::vector<SpscRing<Tensor*>*> filled_;
+            std::vector<SpscRing<Tensor*>*> free_;
+        };
+    }
+}
+
+#endif //PICO_CNN_PIPELINE_H
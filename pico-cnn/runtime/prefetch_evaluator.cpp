@@ -0,0 +1,149 @@
+#include "prefetch_evaluator.h"
+
+#include <chrono>
+#include <thread>
+
+namespace pico_cnn {
+    namespace naive {
+
+        PrefetchEvaluator::PrefetchEvaluator(SampleSource *source, TensorAllocator input_allocator,
+                                             uint32_t ring_size, uint32_t num_threads) :
+                source_(source),
+                num_threads_(MAX(num_threads, 1u)),
+                next_sample_(0) {
+
+            slots_.resize(MAX(ring_size, 1u));
+            for(Slot &slot: slots_) {
+                slot.input = input_allocator();
+            }
+        }
+
+        PrefetchEvaluator::~PrefetchEvaluator() {
+            for(Slot &slot: slots_) {
+                delete slot.input;
+            }
+        }
+
+        void PrefetchEvaluator::worker_loop(uint32_t num_samples) {
+            const uint32_t ring_size = slots_.size();
+
+            while(true) {
+                uint32_t index;
+                Slot *slot;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    if(next_sample_ >= num_samples) {
+                        return;
+                    }
+                    index = next_sample_++;
+                    slot = &slots_[index % ring_size];
+                    // wait until the consumer has released the slot for this sample
+                    slot_released_.wait(lock, [&] { return slot->next_index == index; });
+                }
+
+                uint32_t label = 0;
+                int32_t status = source_->load(index, slot->input, &label);
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    slot->label = label;
+                    slot->status = status;
+                    slot->ready = true;
+                }
+                slot_filled_.notify_all();
+            }
+        }
+
+        EvaluationResult PrefetchEvaluator::evaluate(Inference inference, Tensor *output, uint32_t num_samples) {
+            if(num_samples == 0 || num_samples > source_->num_samples()) {
+                num_samples = source_->num_samples();
+            }
+
+            const uint32_t ring_size = slots_.size();
+            for(uint32_t i = 0; i < ring_size; i++) {
+                slots_[i].next_index = i;
+                slots_[i].ready = false;
+            }
+            next_sample_ = 0;
+
+            EvaluationResult result = {};
+
+            auto start = std::chrono::steady_clock::now();
+
+            std::vector<std::thread> workers;
+            for(uint32_t i = 0; i < num_threads_; i++) {
+                workers.push_back(std::thread(&PrefetchEvaluator::worker_loop, this, num_samples));
+            }
+
+            const uint32_t num_classes = output->num_elements();
+
+            for(uint32_t index = 0; index < num_samples; index++) {
+                Slot &slot = slots_[index % ring_size];
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    slot_filled_.wait(lock, [&] { return slot.ready; });
+                }
+
+                if(slot.status != 0) {
+                    result.num_errors++;
+                } else {
+                    inference(slot.input, output);
+
+                    if(slot.label < num_classes) {
+                        // rank of the correct class = number of classes with a higher score
+                        fp_t score = output->access_blob(slot.label);
+                        uint32_t rank = 0;
+                        for(uint32_t i = 0; i < num_classes && rank < 5; i++) {
+                            if(output->access_blob(i) > score) {
+                                rank++;
+                            }
+                        }
+                        if(rank < 1) {
+                            result.top1_correct++;
+                        }
+                        if(rank < 5) {
+                            result.top5_correct++;
+                        }
+                    } else {
+                        PRINT_WARNING("Label " << slot.label << " of sample " << index << " exceeds number of classes")
+                    }
+                    result.num_samples++;
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    slot.ready = false;
+                    slot.next_index = index + ring_size;
+                }
+                slot_released_.notify_all();
+
+                if(DEBUG && (index + 1) % 1000 == 0) {
+                    PRINT_DEBUG("Evaluated " << index + 1 << " of " << num_samples << " samples")
+                }
+            }
+
+            for(std::thread &worker: workers) {
+                worker.join();
+            }
+
+            result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            result.images_per_second = result.seconds > 0.0 ? result.num_samples / result.seconds : 0.0;
+            if(result.num_samples > 0) {
+                result.top1_accuracy = (fp_t) result.top1_correct / result.num_samples;
+                result.top5_accuracy = (fp_t) result.top5_correct / result.num_samples;
+            }
+
+            PRINT_INFO("Evaluated " << result.num_samples << " samples in " << result.seconds << " s ("
+                       << result.images_per_second << " images/s)")
+            PRINT_INFO("Top-1 accuracy: " << 100.0 * result.top1_accuracy << " % (" << result.top1_correct << "/"
+                       << result.num_samples << ")")
+            PRINT_INFO("Top-5 accuracy: " << 100.0 * result.top5_accuracy << " % (" << result.top5_correct << "/"
+                       << result.num_samples << ")")
+            if(result.num_errors > 0) {
+                PRINT_WARNING(result.num_errors << " samples could not be loaded")
+            }
+
+            return result;
+        }
+    }
+}
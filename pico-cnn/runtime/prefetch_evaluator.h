@@ -0,0 +1,88 @@
+/**
+ * @brief pico_cnn::naive::PrefetchEvaluator evaluates a network on a labeled dataset. A pool of background threads
+ * loads and preprocesses the next samples into a bounded ring of reusable input tensors while the network is
+ * running, so decoding and inference overlap and the dataset never has to be held in memory.
+ *
+ * @author Alexander Jung (University of Tuebingen, Chair for Embedded Systems)
+ */
+#ifndef PICO_CNN_PREFETCH_EVALUATOR_H
+#define PICO_CNN_PREFETCH_EVALUATOR_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "../parameters.h"
+#include "../tensor.h"
+#include "../io/sample_source.h"
+
+namespace pico_cnn {
+    namespace naive {
+
+        struct EvaluationResult {
+            uint32_t num_samples;
+            uint32_t num_errors;
+            uint32_t top1_correct;
+            uint32_t top5_correct;
+            fp_t top1_accuracy;
+            fp_t top5_accuracy;
+            double seconds;
+            double images_per_second;
+        };
+
+        class PrefetchEvaluator {
+        public:
+            typedef std::function<Tensor*()> TensorAllocator;
+            typedef std::function<void(Tensor *input, Tensor *output)> Inference;
+
+            /**
+             * @param source Dataset to evaluate.
+             * @param input_allocator Allocates an input tensor of the network.
+             * @param ring_size Number of input tensors, i.e. the maximum number of samples prefetched ahead.
+             * @param num_threads Number of background threads loading samples.
+             */
+            PrefetchEvaluator(SampleSource *source, TensorAllocator input_allocator,
+                              uint32_t ring_size = 16, uint32_t num_threads = 2);
+            ~PrefetchEvaluator();
+
+            PrefetchEvaluator(const PrefetchEvaluator&) = delete;
+            PrefetchEvaluator &operator=(const PrefetchEvaluator&) = delete;
+
+            /**
+             * Runs the network on the samples of the source and determines top-1 and top-5 accuracy.
+             * @param inference Runs the network, e.g. [&](Tensor *input, Tensor *output) { net->run(input, output); }
+             * @param output Output tensor of the network containing one score per class.
+             * @param num_samples Number of samples to evaluate (0 = all samples of the source).
+             */
+            EvaluationResult evaluate(Inference inference, Tensor *output, uint32_t num_samples = 0);
+
+        private:
+            struct Slot {
+                Tensor *input;
+                uint32_t label;
+                int32_t status;
+                // index of the sample the slot may be filled with next / currently contains
+                uint32_t next_index;
+                bool ready;
+            };
+
+            void worker_loop(uint32_t num_samples);
+
+            SampleSource *source_;
+            std::vector<Slot> slots_;
+            uint32_t num_threads_;
+
+            std::mutex mutex_;
+            std::condition_variable slot_filled_;
+            std::condition_variable slot_released_;
+            uint32_t next_sample_;
+        };
+    }
+}
+
+#endif //PICO_CNN_PREFETCH_EVALUATOR_H
@@ -0,0 +1,115 @@
+/**
+ * @brief pico_cnn::naive::SpscRing is a bounded lock-free ring buffer for exactly one producer and one consumer thread.
+ *
+ * @author Alexander Jung (University of Tuebingen, Chair for Embedded Systems)
+ */
+#ifndef PICO_CNN_SPSC_RING_H
+#define PICO_CNN_SPSC_RING_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <atomic>
+#include <new>
+#include <thread>
+
+namespace pico_cnn {
+    namespace naive {
+
+        template <typename T>
+        class SpscRing {
+        public:
+            /**
+             * @param capacity Maximum number of elements stored in the ring at the same time.
+             */
+            explicit SpscRing(uint32_t capacity) :
+                    size_(capacity + 1),
+                    elements_(new T[capacity + 1]),
+                    head_(0),
+                    tail_(0) {
+
+            }
+
+            ~SpscRing() {
+                delete[] elements_;
+            }
+
+            SpscRing(const SpscRing&) = delete;
+            SpscRing &operator=(const SpscRing&) = delete;
+
+            /**
+             * The global operator new only guarantees the alignment of std::max_align_t before C++17, rings created
+             * with new are aligned to the cache lines of head_ and tail_ by posix_memalign.
+             */
+            static void *operator new(std::size_t size) {
+                void *memory = nullptr;
+                if(posix_memalign(&memory, alignof(SpscRing), size) != 0) {
+                    throw std::bad_alloc();
+                }
+                return memory;
+            }
+
+            static void operator delete(void *memory) noexcept {
+                std::free(memory);
+            }
+
+            /**
+             * Must only be called by the producer thread.
+             * @return false if the ring is full
+             */
+            bool try_push(const T &element) {
+                const uint32_t tail = tail_.load(std::memory_order_relaxed);
+                const uint32_t next = (tail + 1) % size_;
+                if(next == head_.load(std::memory_order_acquire)) {
+                    return false;
+                }
+                elements_[tail] = element;
+                tail_.store(next, std::memory_order_release);
+                return true;
+            }
+
+            /**
+             * Must only be called by the consumer thread.
+             * @return false if the ring is empty
+             */
+            bool try_pop(T &element) {
+                const uint32_t head = head_.load(std::memory_order_relaxed);
+                if(head == tail_.load(std::memory_order_acquire)) {
+                    return false;
+                }
+                element = elements_[head];
+                head_.store((head + 1) % size_, std::memory_order_release);
+                return true;
+            }
+
+            /**
+             * Blocking variant of try_push(), yields while the ring is full.
+             */
+            void push(const T &element) {
+                while(!try_push(element)) {
+                    std::this_thread::yield();
+                }
+            }
+
+            /**
+             * Blocking variant of try_pop(), yields while the ring is empty.
+             */
+            T pop() {
+                T element;
+                while(!try_pop(element)) {
+                    std::this_thread::yield();
+                }
+                return element;
+            }
+
+        private:
+            const uint32_t size_;
+            T *elements_;
+
+            // head and tail are written by different threads, keep them on separate cache lines
+            alignas(64) std::atomic<uint32_t> head_;
+            alignas(64) std::atomic<uint32_t> tail_;
+        };
+    }
+}
+
+#endif //PICO_CNN_SPSC_RING_H
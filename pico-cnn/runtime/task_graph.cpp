@@ -0,0 +1,175 @@
+#include "task_graph.h"
+
+namespace pico_cnn {
+    namespace naive {
+
+        TaskGraph::TaskGraph(uint32_t num_threads) :
+                pending_(nullptr),
+                group_(nullptr),
+                requested_threads_(num_threads),
+                num_threads_(1),
+                inter_op_width_(1),
+                intra_op_threads_(1),
+                finalized_(false) {
+
+        }
+
+        TaskGraph::~TaskGraph() {
+            delete[] pending_;
+        }
+
+        uint32_t TaskGraph::add_task(std::function<void()> task) {
+            if(finalized_) {
+                PRINT_ERROR_AND_DIE("Tasks can not be added after finalize() was called.")
+            }
+            tasks_.push_back(task);
+            successors_.push_back(std::vector<uint32_t>());
+            num_predecessors_.push_back(0);
+            return tasks_.size() - 1;
+        }
+
+        void TaskGraph::add_dependency(uint32_t task, uint32_t depends_on) {
+            if(finalized_) {
+                PRINT_ERROR_AND_DIE("Dependencies can not be added after finalize() was called.")
+            }
+            if(task >= tasks_.size() || depends_on >= tasks_.size()) {
+                PRINT_ERROR_AND_DIE("Invalid task id: " << task << " depends on " << depends_on)
+            }
+            if(task == depends_on) {
+                return;
+            }
+            for(uint32_t successor: successors_[depends_on]) {
+                if(successor == task) {
+                    return;
+                }
+            }
+            successors_[depends_on].push_back(task);
+            num_predecessors_[task]++;
+        }
+
+        void TaskGraph::finalize() {
+            if(finalized_) {
+                return;
+            }
+            finalized_ = true;
+
+            const uint32_t num_tasks = tasks_.size();
+
+            // determine the level of every task (length of the longest path from a source) in topological order
+            std::vector<uint32_t> remaining(num_predecessors_);
+            std::vector<uint32_t> level(num_tasks, 0);
+            std::vector<uint32_t> order;
+            order.reserve(num_tasks);
+
+            for(uint32_t task = 0; task < num_tasks; task++) {
+                if(num_predecessors_[task] == 0) {
+                    initial_tasks_.push_back(task);
+                    order.push_back(task);
+                }
+            }
+            for(uint32_t i = 0; i < order.size(); i++) {
+                uint32_t task = order[i];
+                for(uint32_t successor: successors_[task]) {
+                    level[successor] = MAX(level[successor], level[task] + 1);
+                    if(--remaining[successor] == 0) {
+                        order.push_back(successor);
+                    }
+                }
+            }
+            if(order.size() != num_tasks) {
+                PRINT_ERROR_AND_DIE("Task graph contains a cycle.")
+            }
+
+            std::vector<uint32_t> level_width(num_tasks + 1, 0);
+            inter_op_width_ = num_tasks > 0 ? 1 : 0;
+            for(uint32_t task = 0; task < num_tasks; task++) {
+                level_width[level[task]]++;
+                inter_op_width_ = MAX(inter_op_width_, level_width[level[task]]);
+            }
+
+            // balance inter- and intra-operator parallelism: as many threads as there are independent operations,
+            // the remaining threads of the pool are split among the operations
+            const uint32_t pool_threads = thread_pool()->num_threads();
+            if(requested_threads_ > 0) {
+                num_threads_ = requested_threads_;
+            } else {
+                num_threads_ = MIN(MAX(inter_op_width_, 1u), pool_threads);
+            }
+            intra_op_threads_ = MAX(pool_threads / num_threads_, 1u);
+
+            pending_ = new std::atomic<uint32_t>[num_tasks];
+            nodes_.resize(num_tasks);
+            for(uint32_t task = 0; task < num_tasks; task++) {
+                nodes_[task].graph = this;
+                nodes_[task].id = task;
+            }
+
+            PRINT_DEBUG("Task graph with " << num_tasks << " tasks, inter-op width " << inter_op_width_
+                        << ", " << num_threads_ << " threads, " << intra_op_threads_ << " intra-op threads")
+        }
+
+        void TaskGraph::Node::execute() {
+            graph->execute_task(id);
+        }
+
+        void TaskGraph::execute_task(uint32_t task) {
+            // the kernels of the operation split their loops among its share of the pool
+            IntraOpLimit limit(intra_op_threads_);
+
+            while(true) {
+                tasks_[task]();
+
+                // the first successor made ready is executed by this thread, the others are spawned
+                int64_t next = -1;
+                for(uint32_t successor: successors_[task]) {
+                    if(pending_[successor].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                        if(next < 0) {
+                            next = successor;
+                        } else {
+                            group_->run(&nodes_[successor]);
+                        }
+                    }
+                }
+                if(next < 0) {
+                    break;
+                }
+                task = next;
+            }
+        }
+
+        void TaskGraph::run() {
+            if(!finalized_) {
+                finalize();
+            }
+
+            const uint32_t num_tasks = tasks_.size();
+            for(uint32_t task = 0; task < num_tasks; task++) {
+                pending_[task].store(num_predecessors_[task], std::memory_order_relaxed);
+            }
+
+            TaskGroup group;
+            group_ = &group;
+            for(uint32_t task: initial_tasks_) {
+                group.run(&nodes_[task]);
+            }
+            group.wait();
+            group_ = nullptr;
+        }
+
+        uint32_t TaskGraph::num_tasks() const {
+            return tasks_.size();
+        }
+
+        uint32_t TaskGraph::num_threads() const {
+            return num_threads_;
+        }
+
+        uint32_t TaskGraph::inter_op_width() const {
+            return inter_op_width_;
+        }
+
+        uint32_t TaskGraph::intra_op_threads() const {
+            return intra_op_threads_;
+        }
+    }
+}
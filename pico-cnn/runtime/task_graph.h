@@ -0,0 +1,111 @@
+/**
+ * @brief pico_cnn::naive::TaskGraph executes the operations of a generated network as a dependency graph.
+ * Operations without a dependency between each other (e.g. the branches of an Inception module or the shortcut
+ * of a residual block) are executed concurrently by the threads of the global ThreadPool, which also execute the
+ * parallel loops inside the operations.
+ *
+ * Ready-node tracking is lock-free: every task carries an atomic counter of unfinished predecessors and a task
+ * whose counter drops to zero is spawned into the pool. The thread finishing an operation continues with one of the
+ * successors it made ready itself, the others can be stolen by idle threads.
+ *
+ * @author Alexander Jung (University of Tuebingen, Chair for Embedded Systems)
+ */
+#ifndef PICO_CNN_TASK_GRAPH_H
+#define PICO_CNN_TASK_GRAPH_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+#include "../parameters.h"
+#include "thread_pool.h"
+
+namespace pico_cnn {
+    namespace naive {
+
+        class TaskGraph {
+        public:
+            /**
+             * @param num_threads Number of operations expected to run at the same time, used to split the threads of
+             * the pool between inter- and intra-operator parallelism (see intra_op_threads()). 0 selects it from the
+             * width of the graph and the size of the pool.
+             */
+            explicit TaskGraph(uint32_t num_threads = 0);
+            ~TaskGraph();
+
+            TaskGraph(const TaskGraph&) = delete;
+            TaskGraph &operator=(const TaskGraph&) = delete;
+
+            /**
+             * @param task Work of a single operation.
+             * @return id of the task which can be used in add_dependency()
+             */
+            uint32_t add_task(std::function<void()> task);
+
+            /**
+             * Task 'task' will not be started before 'depends_on' has finished.
+             */
+            void add_dependency(uint32_t task, uint32_t depends_on);
+
+            /**
+             * Has to be called once after all tasks and dependencies were added. Determines the number of
+             * inter-operator threads.
+             */
+            void finalize();
+
+            /**
+             * Executes all tasks once, respecting their dependencies. The calling thread takes part in the execution.
+             * Must not be called concurrently for the same graph.
+             */
+            void run();
+
+            uint32_t num_tasks() const;
+            uint32_t num_threads() const;
+
+            /**
+             * @return maximum number of tasks that can be executed at the same time (width of the widest level)
+             */
+            uint32_t inter_op_width() const;
+
+            /**
+             * @return number of threads each operation may use internally
+             */
+            uint32_t intra_op_threads() const;
+
+        private:
+            struct Node : public Task {
+                void execute() override;
+
+                TaskGraph *graph;
+                uint32_t id;
+            };
+
+            /**
+             * Executes the task and all successors it makes ready, except those spawned into the group of the run.
+             */
+            void execute_task(uint32_t task);
+
+            std::vector<std::function<void()>> tasks_;
+            std::vector<std::vector<uint32_t>> successors_;
+            std::vector<uint32_t> num_predecessors_;
+            std::vector<uint32_t> initial_tasks_;
+            std::vector<Node> nodes_;
+
+            // per-run state, reset at the beginning of run()
+            std::atomic<uint32_t> *pending_;
+            TaskGroup *group_;
+
+            uint32_t requested_threads_;
+            uint32_t num_threads_;
+            uint32_t inter_op_width_;
+            uint32_t intra_op_threads_;
+            bool finalized_;
+        };
+    }
+}
+
+#endif //PICO_CNN_TASK_GRAPH_H
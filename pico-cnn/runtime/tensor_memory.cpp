@@ -0,0 +1,144 @@
+#include "tensor_memory.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace pico_cnn {
+    namespace naive {
+
+        struct TensorMemoryConfiguration {
+            TensorMemory memory;
+            bool prefault;
+        };
+
+        static TensorMemoryConfiguration &configuration() {
+            static TensorMemoryConfiguration configuration = []() {
+                TensorMemoryConfiguration from_environment = {TensorMemory::Heap, false};
+                const char *memory = std::getenv("PICO_CNN_TENSOR_MEMORY");
+                if(memory && std::strcmp(memory, "huge_pages") == 0) {
+                    from_environment.memory = TensorMemory::HugePages;
+                } else if(memory && std::strcmp(memory, "hugetlbfs") == 0) {
+                    from_environment.memory = TensorMemory::HugeTlbfs;
+                } else if(memory && std::strcmp(memory, "heap") != 0) {
+                    PRINT_ERROR("Unknown PICO_CNN_TENSOR_MEMORY " << memory << ", using the heap")
+                }
+                const char *prefault = std::getenv("PICO_CNN_PREFAULT");
+                from_environment.prefault = prefault && std::strcmp(prefault, "1") == 0;
+                return from_environment;
+            }();
+            return configuration;
+        }
+
+        void set_tensor_memory(TensorMemory memory, bool prefault) {
+            configuration().memory = memory;
+            configuration().prefault = prefault;
+        }
+
+        TensorMemory tensor_memory() {
+            return configuration().memory;
+        }
+
+        bool tensor_prefault() {
+            return configuration().prefault;
+        }
+
+#ifdef __linux__
+        static uint64_t round_up(uint64_t num_bytes, uint64_t multiple) {
+            return (num_bytes + multiple - 1) / multiple * multiple;
+        }
+
+        /**
+         * @return num_bytes (rounded up to whole pages) of zeros starting at a multiple of HugePageSize, nullptr if
+         * mmap fails
+         */
+        static fp_t *map_huge_pages(uint64_t num_bytes, bool prefault) {
+            const uint64_t page_size = sysconf(_SC_PAGESIZE);
+            const uint64_t mapped_bytes = round_up(num_bytes, page_size);
+
+            // one huge page more than needed, the unaligned head and tail are unmapped again
+            auto region = (char *) mmap(nullptr, mapped_bytes + HugePageSize, PROT_READ | PROT_WRITE,
+                                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if(region == MAP_FAILED) {
+                return nullptr;
+            }
+            auto data = (char *) round_up((uintptr_t) region, HugePageSize);
+            if(data > region) {
+                munmap(region, data - region);
+            }
+            munmap(data + mapped_bytes, region + HugePageSize - data);
+
+            // a tail shorter than a huge page stays on small pages
+            madvise(data, mapped_bytes, MADV_HUGEPAGE);
+
+            if(prefault) {
+                // MAP_POPULATE would fault small pages before madvise(), one write per page faults huge pages
+                for(uint64_t offset = 0; offset < mapped_bytes; offset += page_size) {
+                    ((volatile char *) data)[offset] = 0;
+                }
+            }
+
+            return (fp_t *) data;
+        }
+
+        static fp_t *map_hugetlbfs(uint64_t num_bytes, bool prefault) {
+            void *data = mmap(nullptr, round_up(num_bytes, HugePageSize), PROT_READ | PROT_WRITE,
+                              MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (prefault ? MAP_POPULATE : 0), -1, 0);
+            return data == MAP_FAILED ? nullptr : (fp_t *) data;
+        }
+#endif
+
+        fp_t *allocate_tensor_data(uint32_t num_elements, TensorMemory *memory) {
+            const TensorMemoryConfiguration &config = configuration();
+            const uint64_t num_bytes = (uint64_t) num_elements * sizeof(fp_t);
+
+#ifdef __linux__
+            if(config.memory != TensorMemory::Heap && num_bytes >= HugePageSize) {
+                fp_t *data = nullptr;
+                if(config.memory == TensorMemory::HugeTlbfs) {
+                    data = map_hugetlbfs(num_bytes, config.prefault);
+                    if(data) {
+                        *memory = TensorMemory::HugeTlbfs;
+                        return data;
+                    }
+                    static std::atomic<bool> warned(false);
+                    if(!warned.exchange(true)) {
+                        PRINT_INFO("No hugetlbfs pages available (see /proc/sys/vm/nr_hugepages), using transparent "
+                                   "huge pages instead")
+                    }
+                }
+                data = map_huge_pages(num_bytes, config.prefault);
+                if(data) {
+                    *memory = TensorMemory::HugePages;
+                    return data;
+                }
+            }
+#endif
+
+            *memory = TensorMemory::Heap;
+            return new fp_t[num_elements]();
+        }
+
+        void free_tensor_data(fp_t *data, uint32_t num_elements, TensorMemory memory) {
+#ifdef __linux__
+            const uint64_t num_bytes = (uint64_t) num_elements * sizeof(fp_t);
+            if(memory == TensorMemory::HugePages) {
+                munmap(data, round_up(num_bytes, sysconf(_SC_PAGESIZE)));
+                return;
+            } else if(memory == TensorMemory::HugeTlbfs) {
+                munmap(data, round_up(num_bytes, HugePageSize));
+                return;
+            }
+#else
+            (void) num_elements;
+            (void) memory;
+#endif
+            delete[] data;
+        }
+    }
+}
@@ -0,0 +1,56 @@
+/**
+ * @brief Selects how the data of Tensors is allocated. Large weights and activations can be placed on 2 MB huge pages
+ * (transparent huge pages with madvise(MADV_HUGEPAGE) or pages of a hugetlbfs pool with MAP_HUGETLB), which need 512
+ * times fewer dTLB entries and page faults than 4 KB pages, and can be pre-faulted when they are allocated, so the
+ * first run of a network does not pay for the page faults of freshly allocated tensors.
+ *
+ * The default is taken from the environment variables PICO_CNN_TENSOR_MEMORY ("heap", "huge_pages" or "hugetlbfs")
+ * and PICO_CNN_PREFAULT ("1"), so generated programs can use it without changes.
+ *
+ * @author Alexander Jung (University of Tuebingen, Chair for Embedded Systems)
+ */
+#ifndef PICO_CNN_TENSOR_MEMORY_H
+#define PICO_CNN_TENSOR_MEMORY_H
+
+#include <cstdint>
+#include <iostream>
+
+#include "../parameters.h"
+
+namespace pico_cnn {
+    namespace naive {
+
+        enum class TensorMemory {
+            // new[]
+            Heap,
+            // anonymous mmap aligned to 2 MB with MADV_HUGEPAGE
+            HugePages,
+            // mmap with MAP_HUGETLB from the pool of /proc/sys/vm/nr_hugepages, HugePages if it is exhausted
+            HugeTlbfs
+        };
+
+        // size of a huge page, smaller tensors are always allocated on the heap
+        constexpr uint64_t HugePageSize = 2 * 1024 * 1024;
+
+        /**
+         * Applies to all tensors created afterwards, e.g. call it before the Network is created. Only supported on
+         * Linux, other platforms always use the heap.
+         * @param prefault touch all pages of tensors allocated with mmap when they are allocated (tensors on the heap
+         * are always touched because they are initialized with zeros)
+         */
+        void set_tensor_memory(TensorMemory memory, bool prefault = false);
+
+        TensorMemory tensor_memory();
+        bool tensor_prefault();
+
+        /**
+         * @param memory receives how the data was allocated, which has to be passed to free_tensor_data()
+         * @return num_elements zero-initialized elements
+         */
+        fp_t *allocate_tensor_data(uint32_t num_elements, TensorMemory *memory);
+
+        void free_tensor_data(fp_t *data, uint32_t num_elements, TensorMemory memory);
+    }
+}
+
+#endif //PICO_CNN_TENSOR_MEMORY_H
@@ -0,0 +1,30 @@
+#include "thread_affinity.h"
+
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace pico_cnn {
+    namespace naive {
+
+        uint32_t num_cores() {
+            uint32_t cores = std::thread::hardware_concurrency();
+            return cores > 0 ? cores : 1;
+        }
+
+        bool pin_current_thread(uint32_t core) {
+#ifdef __linux__
+            cpu_set_t cpu_set;
+            CPU_ZERO(&cpu_set);
+            CPU_SET(core % num_cores(), &cpu_set);
+            return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpu_set) == 0;
+#else
+            (void) core;
+            return false;
+#endif
+        }
+    }
+}
@@ -0,0 +1,27 @@
+/**
+ * @brief Helper functions to pin threads to cores.
+ *
+ * @author Alexander Jung (University of Tuebingen, Chair for Embedded Systems)
+ */
+#ifndef PICO_CNN_THREAD_AFFINITY_H
+#define PICO_CNN_THREAD_AFFINITY_H
+
+#include <cstdint>
+
+namespace pico_cnn {
+    namespace naive {
+
+        /**
+         * @return number of cores available to the process (at least 1)
+         */
+        uint32_t num_cores();
+
+        /**
+         * Pins the calling thread to a single core. Core ids larger than the number of cores wrap around.
+         * @return false if pinning is not supported on this platform or failed
+         */
+        bool pin_current_thread(uint32_t core);
+    }
+}
+
+#endif //PICO_CNN_THREAD_AFFINITY_H
@@ -0,0 +1,334 @@
+#include "thread_pool.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#include "thread_affinity.h"
+
+namespace pico_cnn {
+    namespace naive {
+
+        // rounds an idle worker looks for tasks before it sleeps
+        static const uint32_t SpinRounds = 64;
+
+        // pool and deque of the calling thread if it is a worker
+        static thread_local ThreadPool *current_pool = nullptr;
+        static thread_local uint32_t current_deque = 0;
+
+        // limit of the calling thread set by IntraOpLimit, 0 if there is none
+        static thread_local uint32_t current_intra_op_limit = 0;
+
+        void ThreadPool::RangeTask::execute() {
+            uint32_t chunk;
+            while((chunk = next_chunk.fetch_add(1, std::memory_order_relaxed)) < num_chunks) {
+                uint32_t first = begin + chunk * chunk_size;
+                uint32_t last = (uint64_t) first + chunk_size < end ? first + chunk_size : end;
+                body(context, first, last);
+            }
+        }
+
+        ThreadPool::ThreadPool(uint32_t num_threads, bool pin_threads) :
+                num_threads_(num_threads > 0 ? num_threads : num_cores()),
+                pin_threads_(pin_threads),
+                num_queued_(0),
+                num_jobs_(0),
+                num_sleeping_(0),
+                wake_ups_(0),
+                shutdown_(false) {
+
+            deques_ = new Deque[num_threads_];
+            for(uint32_t worker_id = 0; worker_id + 1 < num_threads_; worker_id++) {
+                workers_.push_back(std::thread(&ThreadPool::worker_loop, this, worker_id));
+            }
+        }
+
+        ThreadPool::~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> lock(sleep_mutex_);
+                shutdown_ = true;
+            }
+            wake_up_.notify_all();
+            for(std::thread &worker: workers_) {
+                worker.join();
+            }
+            delete[] deques_;
+        }
+
+        void ThreadPool::submit(Task *task) {
+            task->group_ = nullptr;
+            if(workers_.empty()) {
+                task->execute();
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> lock(jobs_mutex_);
+                jobs_.push_back(task);
+                num_jobs_.fetch_add(1);
+            }
+
+            if(num_sleeping_.load() > 0) {
+                std::lock_guard<std::mutex> lock(sleep_mutex_);
+                wake_ups_++;
+                wake_up_.notify_one();
+            }
+        }
+
+        uint32_t ThreadPool::intra_op_threads() const {
+            if(current_intra_op_limit > 0) {
+                return MIN(current_intra_op_limit, num_threads_);
+            }
+            return num_threads_;
+        }
+
+        void ThreadPool::run_range(RangeTask &task, uint32_t begin, uint32_t end, uint32_t grain,
+                                   uint32_t num_threads) {
+            const uint32_t n = end - begin;
+
+            // a few chunks per thread, so threads which start late or are interrupted are balanced by the others
+            const uint32_t chunks_per_thread = 4;
+            task.begin = begin;
+            task.end = end;
+            task.chunk_size = MAX(MAX(grain, 1u), (n + chunks_per_thread * num_threads - 1) /
+                                                  (chunks_per_thread * num_threads));
+            task.num_chunks = (n + task.chunk_size - 1) / task.chunk_size;
+            task.next_chunk.store(0, std::memory_order_relaxed);
+
+            // every thread which picks up the task takes chunks until all are claimed
+            TaskGroup group(this);
+            const uint32_t num_helpers = MIN(task.num_chunks, num_threads) - 1;
+            for(uint32_t helper = 0; helper < num_helpers; helper++) {
+                group.run(&task);
+            }
+            task.execute();
+            group.wait();
+        }
+
+        bool ThreadPool::push(Task *task) {
+            Deque &deque = deques_[current_pool == this ? current_deque : num_threads_ - 1];
+            {
+                std::lock_guard<std::mutex> lock(deque.mutex);
+                if(deque.bottom - deque.top == DequeCapacity) {
+                    return false;
+                }
+                deque.tasks[deque.bottom % DequeCapacity] = task;
+                deque.bottom++;
+                num_queued_.fetch_add(1);
+            }
+
+            if(num_sleeping_.load() > 0) {
+                std::lock_guard<std::mutex> lock(sleep_mutex_);
+                wake_ups_++;
+                wake_up_.notify_one();
+            }
+            return true;
+        }
+
+        Task *ThreadPool::take() {
+            if(num_queued_.load(std::memory_order_relaxed) == 0) {
+                return nullptr;
+            }
+
+            // the most recent task of the own deque, its data is most likely still cached
+            const uint32_t own = current_pool == this ? current_deque : num_threads_ - 1;
+            {
+                Deque &deque = deques_[own];
+                std::lock_guard<std::mutex> lock(deque.mutex);
+                if(deque.bottom != deque.top) {
+                    deque.bottom--;
+                    num_queued_.fetch_sub(1);
+                    return deque.tasks[deque.bottom % DequeCapacity];
+                }
+            }
+
+            // the oldest task of another deque, which usually spawned the others and represents the most work
+            for(uint32_t i = 1; i < num_threads_; i++) {
+                Deque &deque = deques_[(own + i) % num_threads_];
+                std::lock_guard<std::mutex> lock(deque.mutex);
+                if(deque.bottom != deque.top) {
+                    Task *task = deque.tasks[deque.top % DequeCapacity];
+                    deque.top++;
+                    num_queued_.fetch_sub(1);
+                    return task;
+                }
+            }
+            return nullptr;
+        }
+
+        Task *ThreadPool::take_job() {
+            if(num_jobs_.load(std::memory_order_relaxed) == 0) {
+                return nullptr;
+            }
+            std::lock_guard<std::mutex> lock(jobs_mutex_);
+            if(jobs_.empty()) {
+                return nullptr;
+            }
+            Task *task = jobs_.front();
+            jobs_.pop_front();
+            num_jobs_.fetch_sub(1);
+            return task;
+        }
+
+        void ThreadPool::execute(Task *task) {
+            // the task may be spawned again or destroyed as soon as the group sees it finished
+            TaskGroup *group = task->group_;
+            task->execute();
+            if(group) {
+                group->pending_.fetch_sub(1, std::memory_order_acq_rel);
+            }
+        }
+
+        void ThreadPool::worker_loop(uint32_t worker_id) {
+            current_pool = this;
+            current_deque = worker_id;
+            if(pin_threads_ && !pin_current_thread(worker_id + 1)) {
+                PRINT_WARNING("Could not pin worker " << worker_id << " of the thread pool")
+            }
+
+            uint32_t idle_rounds = 0;
+            while(true) {
+                // chunks of running kernels first, they block the threads waiting for them
+                Task *task = take();
+                if(!task) {
+                    task = take_job();
+                }
+                if(task) {
+                    execute(task);
+                    idle_rounds = 0;
+                    continue;
+                }
+                if(++idle_rounds < SpinRounds) {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                std::unique_lock<std::mutex> lock(sleep_mutex_);
+                // a task pushed after this increment either is seen below or wakes this worker up
+                num_sleeping_.fetch_add(1);
+                wake_up_.wait(lock, [this] {
+                    return shutdown_ || wake_ups_ > 0 || num_queued_.load() > 0 || num_jobs_.load() > 0;
+                });
+                if(wake_ups_ > 0) {
+                    wake_ups_--;
+                }
+                num_sleeping_.fetch_sub(1);
+                if(shutdown_) {
+                    return;
+                }
+                idle_rounds = 0;
+            }
+        }
+
+        TaskGroup::TaskGroup(ThreadPool *pool) : pool_(pool), pending_(0) {
+
+        }
+
+        TaskGroup::TaskGroup() : TaskGroup(thread_pool()) {
+
+        }
+
+        TaskGroup::~TaskGroup() {
+            wait();
+        }
+
+        void TaskGroup::run(Task *task) {
+            // a task spawned several times may already be executed by other threads
+            if(task->group_ != this) {
+                task->group_ = this;
+            }
+            pending_.fetch_add(1, std::memory_order_relaxed);
+            if(!pool_->push(task)) {
+                ThreadPool::execute(task);
+            }
+        }
+
+        void TaskGroup::wait() {
+            while(pending_.load(std::memory_order_acquire) > 0) {
+                Task *task = pool_->take();
+                if(task) {
+                    ThreadPool::execute(task);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        IntraOpLimit::IntraOpLimit(uint32_t num_threads) : previous_(current_intra_op_limit) {
+            current_intra_op_limit = MAX(num_threads, 1u);
+        }
+
+        IntraOpLimit::~IntraOpLimit() {
+            current_intra_op_limit = previous_;
+        }
+
+        struct ThreadPoolConfiguration {
+            std::mutex mutex;
+            std::atomic<ThreadPool*> pool{nullptr};
+            uint32_t num_threads = 0;
+            bool pin_threads = false;
+            bool configured = false;
+        };
+
+        static ThreadPoolConfiguration &configuration() {
+            static ThreadPoolConfiguration configuration;
+            return configuration;
+        }
+
+        int32_t configure_thread_pool(uint32_t num_threads, bool pin_threads) {
+            ThreadPoolConfiguration &config = configuration();
+            std::lock_guard<std::mutex> lock(config.mutex);
+            if(config.pool.load() != nullptr) {
+                PRINT_ERROR("The thread pool is already running with " << config.pool.load()->num_threads()
+                            << " threads")
+                return 1;
+            }
+            config.num_threads = num_threads;
+            config.pin_threads = pin_threads;
+            config.configured = true;
+            return 0;
+        }
+
+        ThreadPool *thread_pool() {
+            ThreadPoolConfiguration &config = configuration();
+            ThreadPool *pool = config.pool.load(std::memory_order_acquire);
+            if(pool) {
+                return pool;
+            }
+
+            std::lock_guard<std::mutex> lock(config.mutex);
+            pool = config.pool.load();
+            if(pool) {
+                return pool;
+            }
+
+            uint32_t num_threads = 0;
+            bool pin_threads = false;
+            if(config.configured) {
+                num_threads = config.num_threads;
+                pin_threads = config.pin_threads;
+            } else {
+                const char *threads = std::getenv("PICO_CNN_NUM_THREADS");
+                if(threads) {
+                    char *end;
+                    long value = std::strtol(threads, &end, 10);
+                    if(*end != '\0' || value < 0) {
+                        PRINT_ERROR("Invalid PICO_CNN_NUM_THREADS " << threads << ", using one thread per core")
+                    } else {
+                        num_threads = value;
+                    }
+                }
+                const char *pin = std::getenv("PICO_CNN_PIN_THREADS");
+                pin_threads = pin && std::strcmp(pin, "1") == 0;
+            }
+
+            // workers of the global pool run until the process exits
+            pool = new ThreadPool(num_threads, pin_threads);
+            PRINT_DEBUG("Thread pool with " << pool->num_threads() << " threads")
+            config.pool.store(pool, std::memory_order_release);
+            return pool;
+        }
+
+        uint32_t intra_op_threads() {
+            return thread_pool()->intra_op_threads();
+        }
+    }
+}
@@ -0,0 +1,274 @@
+/**
+ * @brief pico_cnn::naive::ThreadPool is the work-stealing task runtime shared by all kernels and networks of a process.
+ * Every worker owns a deque of tasks: it pushes and pops tasks at the bottom (the most recently spawned and therefore
+ * cached task first), idle workers steal from the top of the other deques. Threads which are not part of the pool
+ * (e.g. the thread calling Network::run()) push into an additional shared deque.
+ *
+ * Parallelism is expressed with TaskGroup (spawn tasks and wait for them) and parallel_for() (split a range into
+ * chunks of at least a grain size). A thread waiting for a group executes pending tasks instead of blocking, so
+ * parallel_for() may be nested, e.g. inside an operation executed by a TaskGraph, without oversubscribing the cores:
+ * the number of threads is fixed by the pool, no matter how many networks and operations run at the same time.
+ * Independent jobs passed to submit() (e.g. whole runs of a network) are kept in a separate queue which only idle
+ * workers take from, so they are never executed nested inside the wait of a kernel.
+ *
+ * The global pool used by the layers is started on first use with the number of threads (including the calling
+ * thread) and the pinning set with configure_thread_pool() or the environment variables PICO_CNN_NUM_THREADS and
+ * PICO_CNN_PIN_THREADS ("1"). By default it has one thread per core and does not pin its workers.
+ *
+ * Tasks are not owned by the pool and spawning them in a TaskGroup does not allocate memory, so layers keep running
+ * without allocations.
+ *
+ * @author Alexander Jung (University of Tuebingen, Chair for Embedded Systems)
+ */
+#ifndef PICO_CNN_THREAD_POOL_H
+#define PICO_CNN_THREAD_POOL_H
+
+#include <cstdint>
+#include <iostream>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../parameters.h"
+
+namespace pico_cnn {
+    namespace naive {
+
+        class TaskGroup;
+        class ThreadPool;
+
+        /**
+         * Work executed by the pool. The same task may be spawned several times, also concurrently, if execute() can
+         * run concurrently.
+         */
+        class Task {
+        public:
+            virtual ~Task() = default;
+            virtual void execute() = 0;
+
+        private:
+            friend class TaskGroup;
+            friend class ThreadPool;
+
+            TaskGroup *group_ = nullptr;
+        };
+
+        class ThreadPool {
+        public:
+            // maximal number of tasks waiting in a deque, further tasks are executed immediately by the spawning thread
+            static constexpr uint32_t DequeCapacity = 1024;
+
+            /**
+             * @param num_threads number of threads executing tasks including the thread waiting for them, the pool
+             * starts num_threads - 1 workers. 0 selects one thread per core.
+             * @param pin_threads pin worker i to core i + 1, the calling thread usually runs on core 0
+             */
+            explicit ThreadPool(uint32_t num_threads = 0, bool pin_threads = false);
+
+            /**
+             * Stops the workers. No task may be pending.
+             */
+            ~ThreadPool();
+
+            ThreadPool(const ThreadPool&) = delete;
+            ThreadPool &operator=(const ThreadPool&) = delete;
+
+            uint32_t num_threads() const {
+                return num_threads_;
+            }
+
+            /**
+             * Executes the task on a worker without waiting for it, e.g. a whole run of a network. Submitted tasks are
+             * executed by idle workers in the order they were submitted, never by a thread waiting for a TaskGroup.
+             * The task must stay alive until it has finished. A pool without workers (a single thread) executes it
+             * immediately.
+             */
+            void submit(Task *task);
+
+            /**
+             * Calls function(first, last) for disjoint chunks [first, last) covering [begin, end), concurrently on the
+             * threads of the pool, and returns when all chunks are done. Chunks are at least grain elements long
+             * (except the last one), ranges of at most grain elements are executed by the calling thread only.
+             */
+            template<typename Function>
+            void parallel_for(uint32_t begin, uint32_t end, uint32_t grain, const Function &function) {
+                if(end <= begin) {
+                    return;
+                }
+                const uint32_t num_threads = intra_op_threads();
+                if(num_threads == 1 || end - begin <= grain) {
+                    function(begin, end);
+                    return;
+                }
+                RangeTask task;
+                task.body = [](const void *context, uint32_t first, uint32_t last) {
+                    (*static_cast<const Function *>(context))(first, last);
+                };
+                task.context = &function;
+                run_range(task, begin, end, grain, num_threads);
+            }
+
+            /**
+             * @return number of threads (including the calling thread) a parallel_for() of the calling thread is
+             * split among, all threads of the pool unless an IntraOpLimit of the calling thread is smaller
+             */
+            uint32_t intra_op_threads() const;
+
+        private:
+            friend class TaskGroup;
+
+            struct RangeTask : public Task {
+                void execute() override;
+
+                void (*body)(const void *context, uint32_t first, uint32_t last);
+                const void *context;
+                uint32_t begin;
+                uint32_t end;
+                uint32_t chunk_size;
+                uint32_t num_chunks;
+                std::atomic<uint32_t> next_chunk;
+            };
+
+            struct Deque {
+                std::mutex mutex;
+                Task *tasks[DequeCapacity];
+                // tasks are stored at [top, bottom) modulo DequeCapacity
+                uint64_t top = 0;
+                uint64_t bottom = 0;
+            };
+
+            void run_range(RangeTask &task, uint32_t begin, uint32_t end, uint32_t grain, uint32_t num_threads);
+
+            /**
+             * @return false if the deque of the calling thread is full
+             */
+            bool push(Task *task);
+
+            /**
+             * @return a task of the deque of the calling thread or one stolen from another deque, nullptr if there is
+             * none
+             */
+            Task *take();
+
+            /**
+             * @return the oldest task passed to submit(), nullptr if there is none
+             */
+            Task *take_job();
+
+            static void execute(Task *task);
+
+            void worker_loop(uint32_t worker_id);
+
+            uint32_t num_threads_;
+            bool pin_threads_;
+
+            // one deque per worker and the shared one of all other threads at index num_threads_ - 1
+            Deque *deques_;
+            std::atomic<uint32_t> num_queued_;
+
+            // tasks passed to submit()
+            std::mutex jobs_mutex_;
+            std::deque<Task*> jobs_;
+            std::atomic<uint32_t> num_jobs_;
+
+            std::vector<std::thread> workers_;
+            std::mutex sleep_mutex_;
+            std::condition_variable wake_up_;
+            std::atomic<uint32_t> num_sleeping_;
+            uint32_t wake_ups_;
+            bool shutdown_;
+        };
+
+        /**
+         * Tasks spawned with run() and waited for with wait(). The group must not be destroyed before wait() returned.
+         */
+        class TaskGroup {
+        public:
+            explicit TaskGroup(ThreadPool *pool);
+            TaskGroup();
+
+            ~TaskGroup();
+
+            TaskGroup(const TaskGroup&) = delete;
+            TaskGroup &operator=(const TaskGroup&) = delete;
+
+            /**
+             * Spawns the task, it may be executed by any thread of the pool and must stay alive until wait() returned.
+             */
+            void run(Task *task);
+
+            /**
+             * Executes pending tasks (of this or other groups, but not the ones passed to ThreadPool::submit()) until
+             * all tasks of this group are done.
+             */
+            void wait();
+
+        private:
+            friend class ThreadPool;
+
+            ThreadPool *pool_;
+            std::atomic<uint32_t> pending_;
+        };
+
+        /**
+         * Limits the number of threads the parallel_for() calls of the calling thread are split among while it is in
+         * scope, e.g. to the share of the pool left to an operation of a TaskGraph, or to 1 for the stages of a
+         * Pipeline which run on their own cores. Limits are nested, the innermost one applies.
+         */
+        class IntraOpLimit {
+        public:
+            explicit IntraOpLimit(uint32_t num_threads);
+            ~IntraOpLimit();
+
+            IntraOpLimit(const IntraOpLimit&) = delete;
+            IntraOpLimit &operator=(const IntraOpLimit&) = delete;
+
+        private:
+            uint32_t previous_;
+        };
+
+        /**
+         * @return ThreadPool::intra_op_threads() of the global pool for the calling thread
+         */
+        uint32_t intra_op_threads();
+
+        /**
+         * Sets the number of threads and the pinning of the global pool. Has to be called before the pool is used
+         * for the first time, e.g. before the first run of a network.
+         * @param num_threads 0 selects one thread per core
+         * @return 0 on success, 1 if the pool is already running
+         */
+        int32_t configure_thread_pool(uint32_t num_threads, bool pin_threads = false);
+
+        /**
+         * @return the global pool, started on the first call
+         */
+        ThreadPool *thread_pool();
+
+        // minimal number of multiply-adds (or comparable operations) of a chunk of a parallel loop, smaller chunks
+        // cost more to distribute than they save
+        constexpr uint64_t MinParallelWork = 16 * 1024;
+
+        /**
+         * @param work_per_item operations of a single iteration of the loop
+         * @return grain size for parallel_for()
+         */
+        inline uint32_t parallel_grain(uint64_t work_per_item) {
+            return work_per_item >= MinParallelWork ? 1 : (uint32_t) (MinParallelWork / MAX(work_per_item, (uint64_t) 1));
+        }
+
+        /**
+         * ThreadPool::parallel_for() on the global pool.
+         */
+        template<typename Function>
+        void parallel_for(uint32_t begin, uint32_t end, uint32_t grain, const Function &function) {
+            thread_pool()->parallel_for(begin, end, grain, function);
+        }
+    }
+}
+
+#endif //PICO_CNN_THREAD_POOL_H
@@ -0,0 +1,131 @@
+#include "weight_set.h"
+
+#include "../io/read_binary_weights.h"
+
+namespace pico_cnn {
+    namespace naive {
+
+        // every tensor and array of a set starts at a multiple of this number of elements (64 bytes)
+        static const uint64_t SetAlignment = 64 / sizeof(fp_t);
+
+        static uint64_t align(uint64_t offset) {
+            return (offset + SetAlignment - 1) / SetAlignment * SetAlignment;
+        }
+
+        WeightSet::WeightSet(Tensor **kernels, uint32_t num_kernels, Tensor **biases, uint32_t num_biases,
+                             SparseMatrix **sparse_kernels, uint32_t num_sparse_kernels) {
+
+            // fp_t and uint32_t have the same size, one alignment more for the start of the allocation
+            num_elements_ = SetAlignment;
+            for(uint32_t i = 0; i < num_kernels; i++) {
+                num_elements_ = align(num_elements_ + kernels[i]->num_elements());
+            }
+            for(uint32_t i = 0; i < num_biases; i++) {
+                num_elements_ = align(num_elements_ + biases[i]->num_elements());
+            }
+            for(uint32_t i = 0; i < num_sparse_kernels; i++) {
+                num_elements_ = align(num_elements_ + sparse_kernels[i]->num_rows() + 1);
+                num_elements_ = align(num_elements_ + sparse_kernels[i]->num_nonzeros());
+                num_elements_ = align(num_elements_ + sparse_kernels[i]->num_nonzeros());
+            }
+
+            data_ = allocate_tensor_data((uint32_t) num_elements_, &memory_);
+
+            fp_t *data = data_ + (SetAlignment - ((uintptr_t) data_ / sizeof(fp_t)) % SetAlignment) % SetAlignment;
+            auto take = [&](uint64_t num_elements) {
+                fp_t *begin = data;
+                data += align(num_elements);
+                return begin;
+            };
+
+            for(uint32_t i = 0; i < num_kernels; i++) {
+                kernels_.push_back(new Tensor(kernels[i]->num_dimensions(), kernels[i]->shape_,
+                                              take(kernels[i]->num_elements())));
+            }
+            for(uint32_t i = 0; i < num_biases; i++) {
+                biases_.push_back(new Tensor(biases[i]->num_dimensions(), biases[i]->shape_,
+                                             take(biases[i]->num_elements())));
+            }
+            for(uint32_t i = 0; i < num_sparse_kernels; i++) {
+                const SparseMatrix *kernel = sparse_kernels[i];
+                auto row_offsets = (uint32_t *) take(kernel->num_rows() + 1);
+                auto column_indices = (uint32_t *) take(kernel->num_nonzeros());
+                fp_t *values = take(kernel->num_nonzeros());
+                sparse_kernels_.push_back(new SparseMatrix(kernel->num_rows(), kernel->num_columns(),
+                                                           kernel->num_nonzeros(), row_offsets, column_indices,
+                                                           values));
+            }
+        }
+
+        WeightSet::~WeightSet() {
+            for(Tensor *kernel: kernels_) {
+                delete kernel;
+            }
+            for(Tensor *bias: biases_) {
+                delete bias;
+            }
+            for(SparseMatrix *kernel: sparse_kernels_) {
+                delete kernel;
+            }
+            free_tensor_data(data_, num_elements_, memory_);
+        }
+
+        void WeightSet::copy_from(Tensor **kernels, Tensor **biases, SparseMatrix **sparse_kernels) {
+            for(uint32_t i = 0; i < kernels_.size(); i++) {
+                std::memcpy(kernels_[i]->data_, kernels[i]->data_, kernels_[i]->size_bytes());
+            }
+            for(uint32_t i = 0; i < biases_.size(); i++) {
+                std::memcpy(biases_[i]->data_, biases[i]->data_, biases_[i]->size_bytes());
+            }
+            for(uint32_t i = 0; i < sparse_kernels_.size(); i++) {
+                const SparseMatrix *source = sparse_kernels[i];
+                SparseMatrix *matrix = sparse_kernels_[i];
+                std::memcpy(matrix->row_offsets_, source->row_offsets_, (source->num_rows() + 1) * sizeof(uint32_t));
+                std::memcpy(matrix->column_indices_, source->column_indices_,
+                            source->num_nonzeros() * sizeof(uint32_t));
+                std::memcpy(matrix->values_, source->values_, source->num_nonzeros() * sizeof(fp_t));
+            }
+        }
+
+        int32_t WeightSet::read(const char *path_to_weights_file) {
+            return read_binary_weights_checked(path_to_weights_file, kernels_.data(), kernels_.size(),
+                                               biases_.data(), biases_.size(),
+                                               sparse_kernels_.data(), sparse_kernels_.size());
+        }
+
+        bool WeightSet::matches(Tensor **kernels, Tensor **biases, SparseMatrix **sparse_kernels) const {
+            for(uint32_t i = 0; i < kernels_.size(); i++) {
+                if(kernels[i]->num_elements() != kernels_[i]->num_elements()) {
+                    return false;
+                }
+            }
+            for(uint32_t i = 0; i < biases_.size(); i++) {
+                if(biases[i]->num_elements() != biases_[i]->num_elements()) {
+                    return false;
+                }
+            }
+            for(uint32_t i = 0; i < sparse_kernels_.size(); i++) {
+                if(sparse_kernels[i]->num_rows() != sparse_kernels_[i]->num_rows() ||
+                   sparse_kernels[i]->num_columns() != sparse_kernels_[i]->num_columns() ||
+                   sparse_kernels[i]->num_nonzeros() != sparse_kernels_[i]->num_nonzeros()) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void WeightSet::use(Tensor **kernels, Tensor **biases, SparseMatrix **sparse_kernels) const {
+            for(uint32_t i = 0; i < kernels_.size(); i++) {
+                kernels[i]->use_external_data(kernels_[i]->data_);
+            }
+            for(uint32_t i = 0; i < biases_.size(); i++) {
+                biases[i]->use_external_data(biases_[i]->data_);
+            }
+            for(uint32_t i = 0; i < sparse_kernels_.size(); i++) {
+                sparse_kernels[i]->use_external_data(sparse_kernels_[i]->row_offsets_,
+                                                     sparse_kernels_[i]->column_indices_,
+                                                     sparse_kernels_[i]->values_);
+            }
+        }
+    }
+}
@@ -0,0 +1,72 @@
+/**
+ * @brief pico_cnn::naive::WeightSet is a copy of all kernels and biases of a network in a single allocation (see
+ * runtime/tensor_memory.h), which networks of the same type can be switched to. Used for reloading weights (see
+ * runtime/weights_reloader.h) and for replicating them per NUMA node (see runtime/numa.h).
+ *
+ * @author Alexander Jung (University of Tuebingen, Chair for Embedded Systems)
+ */
+#ifndef PICO_CNN_WEIGHT_SET_H
+#define PICO_CNN_WEIGHT_SET_H
+
+#include <cstdint>
+
+#include <vector>
+
+#include "../parameters.h"
+#include "../tensor.h"
+#include "../gemm/sparse_matrix.h"
+#include "tensor_memory.h"
+
+namespace pico_cnn {
+    namespace naive {
+
+        class WeightSet {
+        public:
+            /**
+             * Allocates kernels, biases and sparse kernels with the shapes of those of a network, every one starting at
+             * a multiple of 64 bytes. The data is zero, the network is not changed.
+             * @param num_kernels number of elements of kernels, the same for biases and sparse_kernels
+             */
+            WeightSet(Tensor **kernels, uint32_t num_kernels, Tensor **biases, uint32_t num_biases,
+                      SparseMatrix **sparse_kernels, uint32_t num_sparse_kernels);
+            ~WeightSet();
+
+            WeightSet(const WeightSet&) = delete;
+            WeightSet &operator=(const WeightSet&) = delete;
+
+            /**
+             * Copies the weights of a network of the same type into this set.
+             */
+            void copy_from(Tensor **kernels, Tensor **biases, SparseMatrix **sparse_kernels);
+
+            /**
+             * Reads a weights file into this set with read_binary_weights_checked().
+             * @return 0 on success, 1 if the file could not be read or does not match the network
+             */
+            int32_t read(const char *path_to_weights_file);
+
+            /**
+             * @return true if the tensors of a network have the shapes of this set
+             */
+            bool matches(Tensor **kernels, Tensor **biases, SparseMatrix **sparse_kernels) const;
+
+            /**
+             * Switches the kernels and biases of a network of the same type to the data of this set, which only
+             * exchanges their data pointers. Their own data is freed, the network must not be used after this set
+             * has been deleted.
+             */
+            void use(Tensor **kernels, Tensor **biases, SparseMatrix **sparse_kernels) const;
+
+        private:
+            fp_t *data_;
+            uint64_t num_elements_;
+            TensorMemory memory_;
+
+            std::vector<Tensor*> kernels_;
+            std::vector<Tensor*> biases_;
+            std::vector<SparseMatrix*> sparse_kernels_;
+        };
+    }
+}
+
+#endif //PICO_CNN_WEIGHT_SET_H
@@ -0,0 +1,114 @@
+#include "weights_reloader.h"
+
+#include <chrono>
+#include <thread>
+
+namespace pico_cnn {
+    namespace naive {
+
+        WeightsReloader::WeightsReloader(Tensor **kernels, uint32_t num_kernels, Tensor **biases, uint32_t num_biases,
+                                         SparseMatrix **sparse_kernels, uint32_t num_sparse_kernels,
+                                         uint32_t max_readers) :
+                num_kernels_(num_kernels),
+                num_biases_(num_biases),
+                num_sparse_kernels_(num_sparse_kernels),
+                readers_(new Reader[MAX(max_readers, 1u)]),
+                max_readers_(MAX(max_readers, 1u)),
+                num_readers_(1),
+                generation_(1) {
+
+            Reader &first = readers_[0];
+            first.kernels = kernels;
+            first.biases = biases;
+            first.sparse_kernels = sparse_kernels;
+            first.running.store(nullptr);
+
+            Version *version = allocate_version(1);
+            version->weights->copy_from(kernels, biases, sparse_kernels);
+            version->weights->use(kernels, biases, sparse_kernels);
+            first.generation = version->generation;
+
+            current_.store(version);
+        }
+
+        WeightsReloader::~WeightsReloader() {
+            free_version(current_.load());
+            delete[] readers_;
+        }
+
+        uint32_t WeightsReloader::add_reader(Tensor **kernels, Tensor **biases, SparseMatrix **sparse_kernels) {
+            if(num_readers_ == max_readers_) {
+                PRINT_ERROR_AND_DIE("WeightsReloader: more than " << max_readers_ << " networks added")
+            }
+
+            Version *version = current_.load();
+            if(!version->weights->matches(kernels, biases, sparse_kernels)) {
+                PRINT_ERROR_AND_DIE("WeightsReloader: the network does not match the first network")
+            }
+
+            Reader &reader = readers_[num_readers_];
+            reader.kernels = kernels;
+            reader.biases = biases;
+            reader.sparse_kernels = sparse_kernels;
+            reader.running.store(nullptr);
+            version->weights->use(kernels, biases, sparse_kernels);
+            reader.generation = version->generation;
+
+            return num_readers_++;
+        }
+
+        int32_t WeightsReloader::reload(const char *path_to_weights_file) {
+            std::lock_guard<std::mutex> lock(reload_mutex_);
+
+            Version *previous = current_.load();
+            Version *version = allocate_version(previous->generation + 1);
+
+            // the networks keep running with the previous version while the file is read
+            if(version->weights->read(path_to_weights_file) != 0) {
+                PRINT_ERROR("WeightsReloader: could not reload weights from " << path_to_weights_file
+                            << ", keeping generation " << previous->generation)
+                free_version(version);
+                return 1;
+            }
+
+            current_.store(version);
+            generation_.store(version->generation);
+
+            // grace period: runs which announced the previous version finish with it, all later runs use the new one
+            for(uint32_t i = 0; i < num_readers_; i++) {
+                while(readers_[i].running.load() == previous) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                }
+            }
+            free_version(previous);
+
+            PRINT_INFO("Reloaded weights from " << path_to_weights_file << " (generation " << version->generation
+                       << ")")
+            return 0;
+        }
+
+        std::future<int32_t> WeightsReloader::reload_async(const std::string &path_to_weights_file) {
+            return std::async(std::launch::async, [this, path_to_weights_file]() {
+                return reload(path_to_weights_file.c_str());
+            });
+        }
+
+        uint64_t WeightsReloader::generation() const {
+            return generation_.load();
+        }
+
+        WeightsReloader::Version *WeightsReloader::allocate_version(uint64_t generation) const {
+            const Reader &first = readers_[0];
+            auto version = new Version();
+            version->generation = generation;
+            version->weights = new WeightSet(first.kernels, num_kernels_, first.biases, num_biases_,
+                                             first.sparse_kernels, num_sparse_kernels_);
+            return version;
+        }
+
+        void WeightsReloader::free_version(Version *version) {
+            delete version->weights;
+            delete version;
+        }
+    }
+}
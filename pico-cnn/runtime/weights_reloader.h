@@ -0,0 +1,167 @@
+/**
+ * @brief pico_cnn::naive::WeightsReloader replaces the weights of running networks without stopping them, similar to
+ * read-copy-update: a new weights file is read into a new set of tensors in the background and validated against the
+ * shapes of the network, then the set is published with a single atomic store. Every run of a network is enclosed in
+ * begin_run() and end_run() (see WeightsRunGuard). begin_run() switches the kernels and biases of the network to the
+ * latest published set, which only changes their data pointers, so runs in flight finish with the weights they started
+ * with and the serving threads neither wait for nor copy any weights. Once no network runs with the previous set
+ * anymore (the grace period), the thread which reloaded frees it.
+ *
+ * @author Alexander Jung (University of Tuebingen, Chair for Embedded Systems)
+ */
+#ifndef PICO_CNN_WEIGHTS_RELOADER_H
+#define PICO_CNN_WEIGHTS_RELOADER_H
+
+#include <cstdint>
+
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../parameters.h"
+#include "../tensor.h"
+#include "../gemm/sparse_matrix.h"
+#include "weight_set.h"
+
+namespace pico_cnn {
+    namespace naive {
+
+        class WeightsReloader {
+        public:
+            /**
+             * Copies the current weights of a network into the first set, which becomes the weights of the network and
+             * of all networks added with add_reader().
+             * @param num_kernels number of elements of kernels, the same for biases and sparse_kernels (e.g.
+             * Network::num_kernels)
+             * @param max_readers maximal number of networks (including this one) which use the weights
+             */
+            WeightsReloader(Tensor **kernels, uint32_t num_kernels, Tensor **biases, uint32_t num_biases,
+                            SparseMatrix **sparse_kernels = nullptr, uint32_t num_sparse_kernels = 0,
+                            uint32_t max_readers = 1);
+
+            /**
+             * Frees all sets. The networks must not run anymore.
+             */
+            ~WeightsReloader();
+
+            WeightsReloader(const WeightsReloader&) = delete;
+            WeightsReloader &operator=(const WeightsReloader&) = delete;
+
+            /**
+             * Registers another network of the same type, e.g. one per serving thread, and switches it to the current
+             * set. Its own weights are freed, so it does not need to read them. Must not be called while any network
+             * runs.
+             * @return id of the network for begin_run() and end_run(), the network passed to the constructor has id 0
+             */
+            uint32_t add_reader(Tensor **kernels, Tensor **biases, SparseMatrix **sparse_kernels = nullptr);
+
+            /**
+             * Reads the weights file into a new set, publishes it and frees the previous set after the grace period.
+             * Blocks the calling thread until then, but never the networks. Reloads are serialized.
+             * @return 0 on success, 1 if the file could not be read or does not match the network, the current set
+             * stays published then
+             */
+            int32_t reload(const char *path_to_weights_file);
+
+            /**
+             * Same as reload(), but in a background thread.
+             * @return result of reload()
+             */
+            std::future<int32_t> reload_async(const std::string &path_to_weights_file);
+
+            /**
+             * Switches the network to the latest published set if necessary. Must be called by the thread running
+             * the network before every run, the network must not use other weights until end_run().
+             * @param reader id returned by add_reader(), 0 for the network passed to the constructor
+             */
+            void begin_run(uint32_t reader) {
+                Reader &state = readers_[reader];
+                Version *version = current_.load(std::memory_order_acquire);
+                // announce the version before it is used, the reloading thread either sees the announcement or this
+                // thread sees a newer version and announces that one instead (the version is not dereferenced before,
+                // it may already have been freed)
+                while(true) {
+                    state.running.store(version);
+                    Version *latest = current_.load();
+                    if(latest == version) {
+                        break;
+                    }
+                    version = latest;
+                }
+                // the address of a freed version may be reused by a later one, so the generations are compared
+                if(state.generation != version->generation) {
+                    version->weights->use(state.kernels, state.biases, state.sparse_kernels);
+                    state.generation = version->generation;
+                }
+            }
+
+            void end_run(uint32_t reader) {
+                readers_[reader].running.store(nullptr, std::memory_order_release);
+            }
+
+            /**
+             * @return number of sets published so far, 1 before the first successful reload()
+             */
+            uint64_t generation() const;
+
+        private:
+            struct Version {
+                uint64_t generation;
+                WeightSet *weights;
+            };
+
+            struct Reader {
+                Tensor **kernels;
+                Tensor **biases;
+                SparseMatrix **sparse_kernels;
+                // generation of the set used by the tensors of the network, only accessed by the thread running it
+                uint64_t generation;
+                // version of the run in flight, nullptr if the network does not run
+                std::atomic<Version*> running;
+                // every reader on its own cache line
+                char padding[64 - 4 * sizeof(void*) - sizeof(uint64_t)];
+            };
+
+            Version *allocate_version(uint64_t generation) const;
+            static void free_version(Version *version);
+
+            uint32_t num_kernels_;
+            uint32_t num_biases_;
+            uint32_t num_sparse_kernels_;
+
+            Reader *readers_;
+            uint32_t max_readers_;
+            uint32_t num_readers_;
+
+            std::atomic<Version*> current_;
+            // generation of current_, which may be freed by reload() while it is read by other threads
+            std::atomic<uint64_t> generation_;
+            std::mutex reload_mutex_;
+        };
+
+        /**
+         * Calls begin_run() on construction and end_run() on destruction.
+         */
+        class WeightsRunGuard {
+        public:
+            WeightsRunGuard(WeightsReloader *reloader, uint32_t reader) : reloader_(reloader), reader_(reader) {
+                reloader_->begin_run(reader_);
+            }
+
+            ~WeightsRunGuard() {
+                reloader_->end_run(reader_);
+            }
+
+            WeightsRunGuard(const WeightsRunGuard&) = delete;
+            WeightsRunGuard &operator=(const WeightsRunGuard&) = delete;
+
+        private:
+            WeightsReloader *reloader_;
+            uint32_t reader_;
+        };
+    }
+}
+
+#endif //PICO_CNN_WEIGHTS_RELOADER_H
@@ -1,45 +1,122 @@
 #include "tensor.h"
 
+#include <utility>
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+#include "runtime/thread_pool.h"
+
 namespace pico_cnn {
     namespace naive {
 
-        Tensor::Tensor(uint32_t x0): num_dimensions_(1) {
-            shape_ = new uint32_t[num_dimensions_]();
+        // edge length of the tiles of transpose_2d(), two 32x32 tiles occupy 8 KiB of the L1 cache
+        static const uint32_t TransposeTile = 32;
+
+        /**
+         * dst[col * dst_stride + row] = src[row * src_stride + col] for all rows and cols. The matrix is processed
+         * in tiles of TransposeTile x TransposeTile, so the strided accesses hit lines which are already cached, and
+         * every tile in blocks of 4x4 which are transposed in registers.
+         */
+        static void transpose_2d(const fp_t *src, uint32_t src_stride, fp_t *dst, uint32_t dst_stride,
+                                 uint32_t rows, uint32_t cols) {
+
+            for(uint32_t tile_row = 0; tile_row < rows; tile_row += TransposeTile) {
+                const uint32_t row_end = MIN(tile_row + TransposeTile, rows);
+
+                for(uint32_t tile_col = 0; tile_col < cols; tile_col += TransposeTile) {
+                    const uint32_t col_end = MIN(tile_col + TransposeTile, cols);
+
+                    uint32_t row = tile_row;
+                    for(; row + 4 <= row_end; row += 4) {
+                        const fp_t *src_block = src + row * src_stride;
+
+                        uint32_t col = tile_col;
+                        for(; col + 4 <= col_end; col += 4) {
+                            fp_t *dst_block = dst + col * dst_stride + row;
+#ifdef __SSE__
+                            __m128 row0 = _mm_loadu_ps(src_block + col);
+                            __m128 row1 = _mm_loadu_ps(src_block + src_stride + col);
+                            __m128 row2 = _mm_loadu_ps(src_block + 2 * src_stride + col);
+                            __m128 row3 = _mm_loadu_ps(src_block + 3 * src_stride + col);
+                            _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+                            _mm_storeu_ps(dst_block, row0);
+                            _mm_storeu_ps(dst_block + dst_stride, row1);
+                            _mm_storeu_ps(dst_block + 2 * dst_stride, row2);
+                            _mm_storeu_ps(dst_block + 3 * dst_stride, row3);
+#else
+                            for(uint32_t i = 0; i < 4; i++) {
+                                for(uint32_t j = 0; j < 4; j++) {
+                                    dst_block[i * dst_stride + j] = src_block[j * src_stride + col + i];
+                                }
+                            }
+#endif
+                        }
+
+                        for(; col < col_end; col++) {
+                            for(uint32_t i = 0; i < 4; i++) {
+                                dst[col * dst_stride + row + i] = src_block[i * src_stride + col];
+                            }
+                        }
+                    }
+
+                    for(; row < row_end; row++) {
+                        for(uint32_t col = tile_col; col < col_end; col++) {
+                            dst[col * dst_stride + row] = src[row * src_stride + col];
+                        }
+                    }
+                }
+            }
+        }
+
+        Tensor::Tensor(uint32_t x0): num_dimensions_(1), shape_(), owns_data_(true) {
             shape_[0] = x0;
             num_elements_ = x0;
-            data_ = new fp_t [num_elements_]();
+            data_ = allocate_tensor_data(num_elements_, &memory_);
         }
 
-        Tensor::Tensor(uint32_t x0, uint32_t x1): num_dimensions_(2) {
-            shape_ = new uint32_t[num_dimensions_]();
+        Tensor::Tensor(uint32_t x0, uint32_t x1): num_dimensions_(2), shape_(), owns_data_(true) {
             shape_[0] = x0;
             shape_[1] = x1;
             num_elements_ = x0*x1;
-            data_ = new fp_t [num_elements_]();
+            data_ = allocate_tensor_data(num_elements_, &memory_);
         }
 
-        Tensor::Tensor(uint32_t x0, uint32_t x1, uint32_t x2): num_dimensions_(3) {
-            shape_ = new uint32_t[num_dimensions_]();
+        Tensor::Tensor(uint32_t x0, uint32_t x1, uint32_t x2): num_dimensions_(3), shape_(), owns_data_(true) {
             shape_[0] = x0;
             shape_[1] = x1;
             shape_[2] = x2;
             num_elements_ = x0*x1*x2;
-            data_ = new fp_t [num_elements_]();
+            data_ = allocate_tensor_data(num_elements_, &memory_);
         }
 
-        Tensor::Tensor(uint32_t x0, uint32_t x1, uint32_t x2, uint32_t x3): num_dimensions_(4) {
-            shape_ = new uint32_t[num_dimensions_]();
+        Tensor::Tensor(uint32_t x0, uint32_t x1, uint32_t x2, uint32_t x3): num_dimensions_(4), shape_(), owns_data_(true) {
             shape_[0] = x0;
             shape_[1] = x1;
             shape_[2] = x2;
             shape_[3] = x3;
             num_elements_ = x0*x1*x2*x3;
-            data_ = new fp_t [num_elements_]();
+            data_ = allocate_tensor_data(num_elements_, &memory_);
+        }
+
+        Tensor::Tensor(uint32_t num_dimensions, const uint32_t *shape, fp_t *data):
+                num_dimensions_(num_dimensions), shape_(), data_(data), owns_data_(false),
+                memory_(TensorMemory::Heap) {
+            if(num_dimensions > 4) {
+                PRINT_ERROR_AND_DIE("Tensors have at most 4 dimensions, not " << num_dimensions)
+            }
+            num_elements_ = 1;
+            for(uint32_t i = 0; i < num_dimensions_; i++) {
+                shape_[i] = shape[i];
+                num_elements_ *= shape[i];
+            }
         }
 
         Tensor::~Tensor() {
-            delete[](data_);
-            delete [] shape_;
+            if(owns_data_) {
+                free_tensor_data(data_, num_elements_, memory_);
+            }
         }
 
         uint32_t Tensor::size_bytes() const {
@@ -143,6 +220,163 @@ namespace pico_cnn {
             }
         }
 
+        void Tensor::padded_shape(uint32_t *shape) const {
+            for(uint32_t i = 0; i < 4; i++) {
+                shape[i] = i < 4 - num_dimensions_ ? 1 : shape_[i - (4 - num_dimensions_)];
+            }
+        }
+
+        bool Tensor::broadcast_strides(const uint32_t *shape, uint32_t *strides) const {
+            uint32_t own_shape[4];
+            padded_shape(own_shape);
+
+            uint32_t stride = 1;
+            for(int32_t i = 3; i >= 0; i--) {
+                if(own_shape[i] == shape[i]) {
+                    strides[i] = shape[i] == 1 ? 0 : stride;
+                } else if(own_shape[i] == 1) {
+                    strides[i] = 0;
+                } else {
+                    return false;
+                }
+                stride *= own_shape[i];
+            }
+            return true;
+        }
+
+        enum class ElementwiseOp {
+            Assign,
+            Add,
+            Mul
+        };
+
+        /**
+         * output[i] = output[i] op input[i * stride] for n elements, stride is 1 or 0 for broadcast inputs. Both cases
+         * have their own loop, so the compiler vectorizes them.
+         */
+        template<ElementwiseOp Op>
+        static inline void elementwise_row(fp_t *output, const fp_t *input, uint32_t stride, uint32_t n) {
+            if(stride == 0) {
+                const fp_t value = input[0];
+                for(uint32_t i = 0; i < n; i++) {
+                    output[i] = Op == ElementwiseOp::Assign ? value :
+                                Op == ElementwiseOp::Add ? output[i] + value : output[i] * value;
+                }
+            } else {
+                for(uint32_t i = 0; i < n; i++) {
+                    output[i] = Op == ElementwiseOp::Assign ? input[i] :
+                                Op == ElementwiseOp::Add ? output[i] + input[i] : output[i] * input[i];
+                }
+            }
+        }
+
+        static inline void elementwise_row(ElementwiseOp op, fp_t *output, const fp_t *input, uint32_t stride,
+                                           uint32_t n) {
+            switch(op) {
+                case ElementwiseOp::Assign:
+                    elementwise_row<ElementwiseOp::Assign>(output, input, stride, n);
+                    break;
+                case ElementwiseOp::Add:
+                    elementwise_row<ElementwiseOp::Add>(output, input, stride, n);
+                    break;
+                case ElementwiseOp::Mul:
+                    elementwise_row<ElementwiseOp::Mul>(output, input, stride, n);
+                    break;
+            }
+        }
+
+        // maximal number of inputs combined in one pass, the strides of all inputs are kept on the stack
+        static const uint32_t MaxElementwiseInputs = 8;
+        // elements of the output which are combined with all inputs before moving on, so they stay in the L1 cache
+        static const uint32_t ElementwiseBlock = 2048;
+
+        /**
+         * output = inputs[0] op inputs[1] op ... with broadcasting, op is commutative. inputs[0] may be output.
+         */
+        static void elementwise(const Tensor *output, uint32_t num_inputs, Tensor **inputs, ElementwiseOp op) {
+            uint32_t shape[4];
+            output->padded_shape(shape);
+
+            uint32_t strides[MaxElementwiseInputs][4];
+            bool contiguous = true;
+            for(uint32_t k = 0; k < num_inputs; k++) {
+                if(!inputs[k]->broadcast_strides(shape, strides[k])) {
+                    PRINT_ERROR_AND_DIE("Input " << k << " can not be broadcast to the shape of the output")
+                }
+                contiguous = contiguous && inputs[k]->num_elements() == output->num_elements();
+            }
+
+            // the first input is not copied if the output accumulates in place
+            const uint32_t first = inputs[0]->data_ == output->data_ ? 1 : 0;
+
+            if(contiguous) {
+                // all inputs have the shape of the output and are processed like one long row
+                const uint32_t num_elements = output->num_elements();
+                parallel_for(0, num_elements, MAX(parallel_grain(num_inputs), ElementwiseBlock),
+                             [&](uint32_t begin, uint32_t end) {
+                    for(uint32_t block = begin; block < end; block += ElementwiseBlock) {
+                        const uint32_t n = MIN(ElementwiseBlock, end - block);
+                        for(uint32_t k = first; k < num_inputs; k++) {
+                            elementwise_row(k == 0 ? ElementwiseOp::Assign : op,
+                                            output->data_ + block, inputs[k]->data_ + block, 1, n);
+                        }
+                    }
+                });
+                return;
+            }
+
+            // the rows of the output are split between the threads
+            parallel_for(0, shape[0] * shape[1] * shape[2], parallel_grain((uint64_t) num_inputs * shape[3]),
+                         [&](uint32_t begin, uint32_t end) {
+                for(uint32_t row = begin; row < end; row++) {
+                    const uint32_t i0 = row / (shape[1] * shape[2]);
+                    const uint32_t i1 = row / shape[2] % shape[1];
+                    const uint32_t i2 = row % shape[2];
+                    fp_t *output_row = output->data_ + row * shape[3];
+                    for(uint32_t k = first; k < num_inputs; k++) {
+                        const fp_t *input_row = inputs[k]->data_ + i0 * strides[k][0] + i1 * strides[k][1] +
+                                                i2 * strides[k][2];
+                        elementwise_row(k == 0 ? ElementwiseOp::Assign : op,
+                                        output_row, input_row, strides[k][3], shape[3]);
+                    }
+                }
+            });
+        }
+
+        /**
+         * Moves an input which is output to the front, so it is not overwritten before it is read.
+         */
+        static void move_output_to_front(const Tensor *output, uint32_t num_inputs, Tensor **inputs) {
+            for(uint32_t k = 1; k < num_inputs; k++) {
+                if(inputs[k]->data_ == output->data_) {
+                    std::swap(inputs[0], inputs[k]);
+                    return;
+                }
+            }
+        }
+
+        void Tensor::add_from(uint32_t num_inputs, Tensor **inputs) const {
+            move_output_to_front(this, num_inputs, inputs);
+
+            elementwise(this, MIN(num_inputs, MaxElementwiseInputs), inputs, ElementwiseOp::Add);
+
+            // more inputs are accumulated into this tensor in further passes
+            Tensor *remaining[MaxElementwiseInputs];
+            for(uint32_t k = MaxElementwiseInputs; k < num_inputs; k += MaxElementwiseInputs - 1) {
+                const uint32_t num_remaining = MIN(num_inputs - k, MaxElementwiseInputs - 1);
+                remaining[0] = const_cast<Tensor*>(this);
+                std::memcpy(remaining + 1, inputs + k, num_remaining * sizeof(Tensor*));
+                elementwise(this, num_remaining + 1, remaining, ElementwiseOp::Add);
+            }
+        }
+
+        void Tensor::mul_from(Tensor *input, Tensor *factor) const {
+            Tensor *inputs[2] = {input, factor};
+            move_output_to_front(this, 2, inputs);
+
+            elementwise(this, 2, inputs, ElementwiseOp::Mul);
+        }
+
         fp_t *Tensor::get_ptr_to_channel(uint32_t x0, uint32_t x1) const {
 
 
@@ -293,6 +527,33 @@ namespace pico_cnn {
             return this->copy_with_padding_into(extended_tensor, padding, initializer);
         }
 
+        Tensor *Tensor::expand_with_padding_reusing(uint32_t *padding, Tensor *buffer, fp_t initializer) const {
+
+            if (buffer && buffer->num_dimensions_ == num_dimensions_) {
+                uint32_t padded_shape[4];
+                std::memcpy(padded_shape, shape_, sizeof(shape_));
+
+                if (num_dimensions_ == 4) {
+                    padded_shape[2] += padding[0] + padding[2];
+                    padded_shape[3] += padding[1] + padding[3];
+                } else if (num_dimensions_ == 3) {
+                    padded_shape[2] += padding[0] + padding[1];
+                } else if (num_dimensions_ == 2) {
+                    padded_shape[0] += padding[0] + padding[2];
+                    padded_shape[1] += padding[1] + padding[3];
+                } else {
+                    padded_shape[0] += padding[0] + padding[1];
+                }
+
+                if (std::memcmp(padded_shape, buffer->shape_, num_dimensions_ * sizeof(uint32_t)) == 0) {
+                    return this->copy_with_padding_into(buffer, padding, initializer);
+                }
+            }
+
+            delete buffer;
+            return this->expand_with_padding(padding, initializer);
+        }
+
         Tensor *Tensor::copy_with_padding_into(Tensor *dest, uint32_t *padding, fp_t initializer) const {
 
             uint32_t width_padded = dest->width();
@@ -390,6 +651,12 @@ namespace pico_cnn {
                     fp_t *input_channel_ptr;
                     fp_t *output_channel_ptr;
 
+                    // the input is a view which has been written in place
+                    if(input->data_ == this->get_ptr_to_channel(0, output_channel_counter)) {
+                        output_channel_counter += num_input_channels;
+                        continue;
+                    }
+
                     for (uint32_t input_channel = 0; input_channel < num_input_channels; input_channel++) {
 
                         input_channel_ptr = input->get_ptr_to_channel(0, input_channel);
@@ -407,5 +674,107 @@ namespace pico_cnn {
             }
         }
 
+        Tensor *Tensor::channel_view(uint32_t first_channel, uint32_t num_channels) const {
+            if((num_dimensions_ != 3 && num_dimensions_ != 4) || shape_[0] != 1 ||
+               first_channel + num_channels > shape_[1]) {
+                PRINT_ERROR_AND_DIE("Channels " << first_channel << " to " << first_channel + num_channels
+                                    << " can not be viewed as they are no contiguous part of the tensor")
+            }
+
+            uint32_t shape[4];
+            std::memcpy(shape, shape_, sizeof(shape));
+            shape[1] = num_channels;
+
+            return new Tensor(num_dimensions_, shape, get_ptr_to_channel(0, first_channel));
+        }
+
+        void Tensor::use_external_data(fp_t *data) {
+            if(owns_data_) {
+                free_tensor_data(data_, num_elements_, memory_);
+            }
+            data_ = data;
+            owns_data_ = false;
+        }
+
+        void Tensor::transpose_into(Tensor *dest, const uint32_t *permutation) const {
+
+            if(dest == this || dest->num_dimensions_ != num_dimensions_) {
+                PRINT_ERROR_AND_DIE("Destination of the transposition has to be a different tensor with "
+                                    << num_dimensions_ << " dimensions")
+            }
+            for(uint32_t i = 0; i < num_dimensions_; i++) {
+                if(permutation[i] >= num_dimensions_ || dest->shape_[i] != shape_[permutation[i]]) {
+                    PRINT_ERROR_AND_DIE("Shape of the destination does not match the permuted shape at position " << i)
+                }
+            }
+
+            // strides of every dimension of this tensor in this tensor and in dest
+            uint32_t input_strides[4];
+            uint32_t output_strides[4];
+            uint32_t input_stride = 1;
+            uint32_t output_stride = 1;
+            for(int32_t i = num_dimensions_ - 1; i >= 0; i--) {
+                input_strides[i] = input_stride;
+                input_stride *= shape_[i];
+                output_strides[permutation[i]] = output_stride;
+                output_stride *= dest->shape_[i];
+            }
+
+            // dimensions of size 1 do not change the layout, the others are listed in the order of dest
+            uint32_t dims[4];
+            uint32_t num_dims = 0;
+            bool in_order = true;
+            for(uint32_t i = 0; i < num_dimensions_; i++) {
+                if(shape_[permutation[i]] > 1) {
+                    in_order = in_order && (num_dims == 0 || dims[num_dims - 1] < permutation[i]);
+                    dims[num_dims++] = permutation[i];
+                }
+            }
+
+            if(in_order) {
+                std::memcpy(dest->data_, data_, num_elements_ * sizeof(fp_t));
+                return;
+            }
+
+            // innermost dimension of this tensor and of dest
+            uint32_t input_inner = 0;
+            for(uint32_t i = 0; i < num_dims; i++) {
+                input_inner = MAX(input_inner, dims[i]);
+            }
+            const uint32_t output_inner = dims[num_dims - 1];
+
+            // all other dimensions are iterated in the order of dest
+            uint32_t outer_sizes[3] = {1, 1, 1};
+            uint32_t outer_input_strides[3] = {0, 0, 0};
+            uint32_t outer_output_strides[3] = {0, 0, 0};
+            uint32_t num_outer = 0;
+            for(uint32_t i = 0; i < num_dims; i++) {
+                if(dims[i] != input_inner && dims[i] != output_inner) {
+                    outer_sizes[num_outer] = shape_[dims[i]];
+                    outer_input_strides[num_outer] = input_strides[dims[i]];
+                    outer_output_strides[num_outer] = output_strides[dims[i]];
+                    num_outer++;
+                }
+            }
+
+            for(uint32_t i0 = 0; i0 < outer_sizes[0]; i0++) {
+                for(uint32_t i1 = 0; i1 < outer_sizes[1]; i1++) {
+                    for(uint32_t i2 = 0; i2 < outer_sizes[2]; i2++) {
+                        const fp_t *src = data_ + i0 * outer_input_strides[0] + i1 * outer_input_strides[1] +
+                                          i2 * outer_input_strides[2];
+                        fp_t *dst = dest->data_ + i0 * outer_output_strides[0] + i1 * outer_output_strides[1] +
+                                    i2 * outer_output_strides[2];
+
+                        if(input_inner == output_inner) {
+                            std::memcpy(dst, src, shape_[input_inner] * sizeof(fp_t));
+                        } else {
+                            transpose_2d(src, input_strides[output_inner], dst, output_strides[input_inner],
+                                         shape_[output_inner], shape_[input_inner]);
+                        }
+                    }
+                }
+            }
+        }
+
     }
 }
\ No newline at end of file
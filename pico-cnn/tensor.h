@@ -15,6 +15,7 @@
 
 #include "parameters.h"
 #include "utils.h"
+#include "runtime/tensor_memory.h"
 
 namespace pico_cnn {
     namespace naive {
@@ -35,6 +36,13 @@ namespace pico_cnn {
             Tensor(uint32_t x0, uint32_t x1, uint32_t x2);
             Tensor(uint32_t x0, uint32_t x1, uint32_t x2, uint32_t x3);
 
+            /**
+             * Tensor on data owned by somebody else, e.g. weights embedded in the binary, which is not freed.
+             * @param num_dimensions at most 4
+             * @param shape num_dimensions extents
+             */
+            Tensor(uint32_t num_dimensions, const uint32_t *shape, fp_t *data);
+
             ~Tensor();
 
             inline fp_t &access(uint32_t x0) const {
@@ -83,14 +91,77 @@ namespace pico_cnn {
             Tensor *expand_with_padding(uint32_t *padding, fp_t initializer = 0.0) const;
             Tensor *copy_with_padding_into(Tensor *dest, uint32_t *padding, fp_t initializer = 0.0) const;
 
+            /**
+             * Same as expand_with_padding() but reuses buffer if it already has the padded shape. Only the inner part
+             * of buffer is overwritten if initializer is 0, so buffer must always be padded with the same initializer.
+             * Otherwise buffer is deleted and a new Tensor is returned.
+             * @return buffer or a new Tensor which has to be passed as buffer to the next call
+             */
+            Tensor *expand_with_padding_reusing(uint32_t *padding, Tensor *buffer, fp_t initializer = 0.0) const;
+
             void copy_data_into(Tensor *dest) const;
 
+            /**
+             * Inputs which are channel views of this tensor at their position in the concatenation (see
+             * channel_view()) are not copied, so producers writing into views make the concatenation free.
+             */
             void concatenate_from(uint32_t num_inputs, Tensor **inputs, uint32_t dimension) const;
 
+            /**
+             * @return Tensor of shape (1, num_channels, height, width), or (1, num_channels, width) for a 3D tensor,
+             * sharing the data of the channels [first_channel, first_channel + num_channels) of this tensor, which
+             * has to have a batch size of 1. The view does not own its data and must not be used after this tensor
+             * has been deleted.
+             */
+            Tensor *channel_view(uint32_t first_channel, uint32_t num_channels) const;
+
+            /**
+             * Frees the data of this tensor and uses data of the same size owned by somebody else instead, e.g. weights
+             * in shared memory (see io/shared_weights.h). Layers holding this tensor read the new data.
+             */
+            void use_external_data(fp_t *data);
+
+            /**
+             * Writes the tensor with permuted dimensions into dest (onnx Transpose): dimension i of dest is dimension
+             * permutation[i] of this tensor. Dimensions of size 1 are ignored. If the innermost dimension changes, the
+             * two innermost dimensions are transposed in tiles which fit into the L1 cache, otherwise whole rows are
+             * copied.
+             * @param dest Tensor of the permuted shape, must not share data with this tensor
+             * @param permutation one entry per dimension
+             */
+            void transpose_into(Tensor *dest, const uint32_t *permutation) const;
+
             bool add_tensor(Tensor *other) const;
             bool add_channel(Tensor *other, uint32_t batch, uint32_t channel) const;
             void mul_with_factor(Tensor *other, fp_t factor);
 
+            /**
+             * Shape of this tensor padded with leading dimensions of size 1 to 4 dimensions.
+             */
+            void padded_shape(uint32_t *shape) const;
+
+            /**
+             * Strides of this tensor broadcast to shape following the numpy rules: the shapes are aligned at the
+             * innermost dimension and dimensions of size 1 are repeated (stride 0).
+             * @param shape padded shape (4 dimensions) of the result of the element-wise operation
+             * @param strides 4 strides in elements
+             * @return false if this tensor can not be broadcast to shape
+             */
+            bool broadcast_strides(const uint32_t *shape, uint32_t *strides) const;
+
+            /**
+             * this = inputs[0] + ... + inputs[num_inputs - 1] computed in a single pass, the inputs are broadcast to
+             * the shape of this tensor. One of the inputs of the same shape may be this tensor, the other inputs are
+             * then accumulated in place. The order of inputs may be changed.
+             */
+            void add_from(uint32_t num_inputs, Tensor **inputs) const;
+
+            /**
+             * this = input * factor element-wise, both are broadcast to the shape of this tensor. input or factor may
+             * be this tensor.
+             */
+            void mul_from(Tensor *input, Tensor *factor) const;
+
             bool operator ==(const Tensor &other) const {
                 for (uint32_t i = 0; i < num_dimensions_; i++) {
                     if(shape_[i] != other.shape_[i]) {
@@ -111,9 +182,14 @@ namespace pico_cnn {
 
             //private:
             const uint32_t num_dimensions_;
-            uint32_t *shape_;
+            // stored inline, so creating a Tensor allocates only its data
+            uint32_t shape_[4];
             fp_t *data_;
             uint32_t num_elements_;
+            // false for views into the data of another tensor or into external data
+            bool owns_data_;
+            // how data_ was allocated if it is owned, see runtime/tensor_memory.h
+            TensorMemory memory_;
         };
     }
 }
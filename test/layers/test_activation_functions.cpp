@@ -181,6 +181,47 @@ void TestActivationFunctions::runTestParameterizedReLU() {
     delete param_relu_expected_output_tensor;
 }
 
+void TestActivationFunctions::runTestParameterizedReLUBroadcast() {
+    auto input = new pico_cnn::naive::Tensor(1, 3, 2, 2);
+    auto output = new pico_cnn::naive::Tensor(1, 3, 2, 2);
+    for(uint32_t i = 0; i < input->num_elements(); i++) {
+        input->access_blob(i) = (i % 2) ? 1.0 + i : -1.0 - i;
+    }
+
+    // one slope per channel (onnx shape (C, 1, 1))
+    auto channel_slope = new pico_cnn::naive::Tensor(3, 1, 1);
+    fp_t slopes[3] = {0.1, 0.2, 0.3};
+    for(uint32_t i = 0; i < 3; i++) {
+        channel_slope->access_blob(i) = slopes[i];
+    }
+
+    auto *layer = new pico_cnn::naive::ParameterizedReLU("param_relu", 0, pico_cnn::op_type::ParamReLU, channel_slope);
+    layer->run(input, output);
+
+    for(uint32_t i = 0; i < input->num_elements(); i++) {
+        fp_t expected = (i % 2) ? 1.0 + i : (-1.0 - i) * slopes[i / 4];
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(expected, output->access_blob(i), 1e-6);
+    }
+    delete layer;
+
+    // one slope for all elements
+    auto scalar_slope = new pico_cnn::naive::Tensor(1);
+    scalar_slope->access_blob(0) = 0.5;
+    layer = new pico_cnn::naive::ParameterizedReLU("param_relu", 0, pico_cnn::op_type::ParamReLU, scalar_slope);
+    layer->run(input, output);
+
+    for(uint32_t i = 0; i < input->num_elements(); i++) {
+        fp_t expected = (i % 2) ? 1.0 + i : (-1.0 - i) * 0.5;
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(expected, output->access_blob(i), 1e-6);
+    }
+    delete layer;
+
+    delete scalar_slope;
+    delete channel_slope;
+    delete output;
+    delete input;
+}
+
 void TestActivationFunctions::runTestSigmoid() {
     //PRINT_INFO("Test Sigmoid...")
     auto sigmoid_input_tensor = new pico_cnn::naive::Tensor(1, 10);
@@ -18,6 +18,7 @@ class TestActivationFunctions : public CPPUNIT_NS::TestFixture {
     CPPUNIT_TEST(runTestReLU);
     CPPUNIT_TEST(runTestLeakyReLU);
     CPPUNIT_TEST(runTestParameterizedReLU);
+    CPPUNIT_TEST(runTestParameterizedReLUBroadcast);
     CPPUNIT_TEST(runTestSigmoid);
     CPPUNIT_TEST(runTestSoftmax);
     CPPUNIT_TEST(runTestTanH);
@@ -37,6 +38,7 @@ public:
     void runTestReLU();
     void runTestLeakyReLU();
     void runTestParameterizedReLU();
+    void runTestParameterizedReLUBroadcast();
     void runTestSigmoid();
     void runTestSoftmax();
     void runTestTanH();
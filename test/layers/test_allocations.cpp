@@ -0,0 +1,153 @@
+#include "test_allocations.h"
+
+#include "test_helpers.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TestAllocations);
+
+/**
+ * Layers of a small network covering all layers which need scratch buffers (padded inputs, im2col, GEMM packing).
+ */
+struct TestNetwork {
+    TestNetwork() {
+        uint32_t padding[4] = {1, 1, 1, 1};
+        uint32_t stride[2] = {1, 1};
+        uint32_t pool_size[2] = {2, 2};
+        uint32_t pool_stride[2] = {2, 2};
+        uint32_t pool_padding[4] = {1, 1, 0, 0};
+        uint32_t padding_1d[2] = {1, 1};
+        uint32_t stride_1d[1] = {1};
+
+        input = new pico_cnn::naive::Tensor(1, 3, 16, 16);
+        conv_kernel = new pico_cnn::naive::Tensor(8, 3, 3, 3);
+        conv_bias = new pico_cnn::naive::Tensor(8);
+        conv_output = new pico_cnn::naive::Tensor(1, 8, 16, 16);
+        relu_output = new pico_cnn::naive::Tensor(1, 8, 16, 16);
+        pool_output = new pico_cnn::naive::Tensor(1, 8, 8, 8);
+        fc_input = new pico_cnn::naive::Tensor(1, 8 * 8 * 8);
+        fc_kernel = new pico_cnn::naive::Tensor(10, 8 * 8 * 8);
+        fc_bias = new pico_cnn::naive::Tensor(10);
+        fc_output = new pico_cnn::naive::Tensor(1, 10);
+        matmul_weights = new pico_cnn::naive::Tensor(10, 4);
+        matmul_output = new pico_cnn::naive::Tensor(1, 4);
+        softmax_output = new pico_cnn::naive::Tensor(1, 4);
+
+        input_1d = new pico_cnn::naive::Tensor(1, 2, 20);
+        conv_1d_kernel = new pico_cnn::naive::Tensor(4, 2, 3);
+        conv_1d_output = new pico_cnn::naive::Tensor(1, 4, 20);
+
+        fill_random(input, 1);
+        fill_random(conv_kernel, 2);
+        fill_random(conv_bias, 3);
+        fill_random(fc_kernel, 4);
+        fill_random(fc_bias, 5);
+        fill_random(matmul_weights, 6);
+        fill_random(input_1d, 7);
+        fill_random(conv_1d_kernel, 8);
+
+        conv = new pico_cnn::naive::Convolution("conv", 0, pico_cnn::op_type::Conv, conv_kernel, conv_bias,
+                                                padding, stride, 1);
+        relu = new pico_cnn::naive::ReLU("relu", 0, pico_cnn::op_type::ReLU);
+        pool = new pico_cnn::naive::MaxPooling("pool", 0, pico_cnn::op_type::MaxPool, pool_size, pool_stride,
+                                               pool_padding);
+        fc = new pico_cnn::naive::FullyConnected("fc", 0, pico_cnn::op_type::Gemm, fc_kernel, fc_bias);
+        matmul = new pico_cnn::naive::MatMul("matmul", 0, pico_cnn::op_type::MatMul, matmul_weights);
+        softmax = new pico_cnn::naive::Softmax("softmax", 0, pico_cnn::op_type::Softmax);
+        conv_1d = new pico_cnn::naive::Convolution("conv_1d", 0, pico_cnn::op_type::Conv, conv_1d_kernel, nullptr,
+                                                   padding_1d, stride_1d, 1);
+    }
+
+    ~TestNetwork() {
+        delete conv_1d;
+        delete softmax;
+        delete matmul;
+        delete fc;
+        delete pool;
+        delete relu;
+        delete conv;
+
+        for(pico_cnn::naive::Tensor *tensor: {input, conv_kernel, conv_bias, conv_output, relu_output, pool_output,
+                                              fc_input, fc_kernel, fc_bias, fc_output, matmul_weights, matmul_output,
+                                              softmax_output, input_1d, conv_1d_kernel, conv_1d_output}) {
+            delete tensor;
+        }
+    }
+
+    void run_conv_2d() {
+        ((pico_cnn::naive::Layer*) conv)->run(input, conv_output);
+        ((pico_cnn::naive::Layer*) relu)->run(conv_output, relu_output);
+        ((pico_cnn::naive::Layer*) pool)->run(relu_output, pool_output);
+        pool_output->copy_data_into(fc_input);
+        ((pico_cnn::naive::Layer*) fc)->run(fc_input, fc_output);
+        ((pico_cnn::naive::Layer*) matmul)->run(fc_output, matmul_output);
+        ((pico_cnn::naive::Layer*) softmax)->run(matmul_output, softmax_output);
+    }
+
+    void run_conv_1d() {
+        ((pico_cnn::naive::Layer*) conv_1d)->run(input_1d, conv_1d_output);
+    }
+
+    pico_cnn::naive::Tensor *input, *conv_kernel, *conv_bias, *conv_output, *relu_output, *pool_output, *fc_input,
+                            *fc_kernel, *fc_bias, *fc_output, *matmul_weights, *matmul_output, *softmax_output,
+                            *input_1d, *conv_1d_kernel, *conv_1d_output;
+
+    pico_cnn::naive::Convolution *conv, *conv_1d;
+    pico_cnn::naive::ReLU *relu;
+    pico_cnn::naive::MaxPooling *pool;
+    pico_cnn::naive::FullyConnected *fc;
+    pico_cnn::naive::MatMul *matmul;
+    pico_cnn::naive::Softmax *softmax;
+};
+
+void TestAllocations::setUp() {
+    TestFixture::setUp();
+}
+
+void TestAllocations::tearDown() {
+    TestFixture::tearDown();
+}
+
+void TestAllocations::runTestAllocationCounter() {
+    uint64_t allocations = pico_cnn::naive::num_allocations();
+
+    auto tensor = new pico_cnn::naive::Tensor(1, 2, 3, 4);
+    // the data of the Tensor and the Tensor itself, the shape is stored inline
+    CPPUNIT_ASSERT_EQUAL((uint64_t) 2, pico_cnn::naive::num_allocations() - allocations);
+    delete tensor;
+}
+
+void TestAllocations::runTestSteadyStateLayers() {
+    TestNetwork network;
+
+    // the first run allocates the scratch buffers of the layers
+    network.run_conv_2d();
+    network.run_conv_1d();
+
+    for(uint32_t run = 0; run < 3; run++) {
+        uint64_t allocations = pico_cnn::naive::num_allocations();
+        network.run_conv_2d();
+        network.run_conv_1d();
+        CPPUNIT_ASSERT_EQUAL((uint64_t) 0, pico_cnn::naive::num_allocations() - allocations);
+    }
+}
+
+void TestAllocations::runTestSteadyStateTaskGraph() {
+    TestNetwork first;
+    TestNetwork second;
+
+    // the two branches are run by different threads, possibly a different one in every run
+    pico_cnn::naive::TaskGraph task_graph(2);
+    uint32_t begin = task_graph.add_task([] {});
+    uint32_t first_branch = task_graph.add_task([&first] { first.run_conv_2d(); first.run_conv_1d(); });
+    uint32_t second_branch = task_graph.add_task([&second] { second.run_conv_2d(); second.run_conv_1d(); });
+    task_graph.add_dependency(first_branch, begin);
+    task_graph.add_dependency(second_branch, begin);
+    task_graph.finalize();
+
+    task_graph.run();
+
+    for(uint32_t run = 0; run < 10; run++) {
+        uint64_t allocations = pico_cnn::naive::num_allocations();
+        task_graph.run();
+        CPPUNIT_ASSERT_EQUAL((uint64_t) 0, pico_cnn::naive::num_allocations() - allocations);
+    }
+}
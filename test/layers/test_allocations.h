@@ -0,0 +1,26 @@
+#ifndef PICO_CNN_TEST_ALLOCATIONS_H
+#define PICO_CNN_TEST_ALLOCATIONS_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "../../pico-cnn/pico-cnn.h"
+#include "../../pico-cnn/runtime/allocation_counter.h"
+
+
+class TestAllocations : public CPPUNIT_NS::TestFixture {
+    CPPUNIT_TEST_SUITE(TestAllocations);
+    CPPUNIT_TEST(runTestAllocationCounter);
+    CPPUNIT_TEST(runTestSteadyStateLayers);
+    CPPUNIT_TEST(runTestSteadyStateTaskGraph);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() override;
+    void tearDown() override;
+
+    void runTestAllocationCounter();
+    void runTestSteadyStateLayers();
+    void runTestSteadyStateTaskGraph();
+};
+
+
+#endif //PICO_CNN_TEST_ALLOCATIONS_H
@@ -0,0 +1,168 @@
+#include "test_async_runner.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TestAsyncRunner);
+
+void TestAsyncRunner::setUp() {
+    TestFixture::setUp();
+}
+
+void TestAsyncRunner::tearDown() {
+    TestFixture::tearDown();
+}
+
+/**
+ * Submits a run which blocks until release is set, so the runs submitted afterwards stay pending.
+ */
+static std::shared_ptr<pico_cnn::naive::AsyncRun> submit_blocking_run(pico_cnn::naive::AsyncRunner &runner,
+                                                                      std::atomic<bool> &started,
+                                                                      std::atomic<bool> &release) {
+    std::shared_ptr<pico_cnn::naive::AsyncRun> run = runner.submit([&]() {
+        started.store(true);
+        while(!release.load()) {
+            std::this_thread::yield();
+        }
+    });
+    while(!started.load()) {
+        std::this_thread::yield();
+    }
+    return run;
+}
+
+void TestAsyncRunner::runTestOrder() {
+    pico_cnn::naive::ThreadPool pool(4);
+    pico_cnn::naive::AsyncRunner runner(&pool);
+
+    // runs of the same runner are executed one after another in the order they were submitted
+    const uint32_t num_runs = 100;
+    std::vector<uint32_t> order;
+    std::atomic<uint32_t> running(0);
+    std::atomic<uint32_t> overlaps(0);
+    std::vector<std::shared_ptr<pico_cnn::naive::AsyncRun>> runs;
+
+    for(uint32_t i = 0; i < num_runs; i++) {
+        runs.push_back(runner.submit([&order, &running, &overlaps, i]() {
+            if(running.fetch_add(1) != 0) {
+                overlaps.fetch_add(1);
+            }
+            order.push_back(i);
+            running.fetch_sub(1);
+        }));
+    }
+    for(std::shared_ptr<pico_cnn::naive::AsyncRun> &run: runs) {
+        CPPUNIT_ASSERT(run->wait() == pico_cnn::naive::RunStatus::Completed);
+        CPPUNIT_ASSERT(run->done());
+    }
+
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 0, overlaps.load());
+    CPPUNIT_ASSERT_EQUAL((size_t) num_runs, order.size());
+    for(uint32_t i = 0; i < num_runs; i++) {
+        CPPUNIT_ASSERT_EQUAL(i, order[i]);
+    }
+}
+
+void TestAsyncRunner::runTestCallback() {
+    pico_cnn::naive::ThreadPool pool(4);
+    pico_cnn::naive::AsyncRunner runner(&pool);
+
+    // the callback is called after the run and before the future becomes ready
+    std::atomic<bool> executed(false);
+    std::atomic<bool> called(false);
+    std::atomic<bool> executed_before_callback(false);
+    std::shared_ptr<pico_cnn::naive::AsyncRun> run = runner.submit(
+            [&]() { executed.store(true); },
+            [&](pico_cnn::naive::RunStatus status) {
+                CPPUNIT_ASSERT(status == pico_cnn::naive::RunStatus::Completed);
+                executed_before_callback.store(executed.load());
+                called.store(true);
+            });
+
+    std::shared_future<pico_cnn::naive::RunStatus> future = run->future();
+    CPPUNIT_ASSERT(future.get() == pico_cnn::naive::RunStatus::Completed);
+    CPPUNIT_ASSERT(called.load());
+    CPPUNIT_ASSERT(executed_before_callback.load());
+
+    // a finished run can not be cancelled anymore
+    CPPUNIT_ASSERT(!run->cancel());
+    CPPUNIT_ASSERT(run->wait() == pico_cnn::naive::RunStatus::Completed);
+}
+
+void TestAsyncRunner::runTestCancel() {
+    pico_cnn::naive::ThreadPool pool(4);
+    pico_cnn::naive::AsyncRunner runner(&pool);
+
+    std::atomic<bool> started(false);
+    std::atomic<bool> release(false);
+    std::shared_ptr<pico_cnn::naive::AsyncRun> first = submit_blocking_run(runner, started, release);
+
+    std::atomic<bool> executed(false);
+    pico_cnn::naive::RunStatus reported = pico_cnn::naive::RunStatus::Completed;
+    std::shared_ptr<pico_cnn::naive::AsyncRun> second = runner.submit(
+            [&]() { executed.store(true); },
+            [&](pico_cnn::naive::RunStatus status) { reported = status; });
+    std::shared_ptr<pico_cnn::naive::AsyncRun> third = runner.submit([]() {});
+
+    // the running run can not be cancelled, the pending one is cancelled immediately
+    CPPUNIT_ASSERT(!first->cancel());
+    CPPUNIT_ASSERT(second->cancel());
+    CPPUNIT_ASSERT(!second->cancel());
+    CPPUNIT_ASSERT(second->done());
+    CPPUNIT_ASSERT(reported == pico_cnn::naive::RunStatus::Cancelled);
+    CPPUNIT_ASSERT(!first->done());
+
+    release.store(true);
+    CPPUNIT_ASSERT(first->wait() == pico_cnn::naive::RunStatus::Completed);
+    CPPUNIT_ASSERT(second->wait() == pico_cnn::naive::RunStatus::Cancelled);
+    CPPUNIT_ASSERT(third->wait() == pico_cnn::naive::RunStatus::Completed);
+    runner.wait();
+    CPPUNIT_ASSERT(!executed.load());
+}
+
+void TestAsyncRunner::runTestSingleThread() {
+    // without workers the submitting thread executes the run before submit() returns
+    pico_cnn::naive::ThreadPool pool(1);
+    pico_cnn::naive::AsyncRunner runner(&pool);
+
+    uint32_t value = 0;
+    std::shared_ptr<pico_cnn::naive::AsyncRun> run = runner.submit([&]() { value = 42; });
+    CPPUNIT_ASSERT(run->done());
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 42, value);
+    CPPUNIT_ASSERT(run->wait() == pico_cnn::naive::RunStatus::Completed);
+}
+
+void TestAsyncRunner::runTestDestructor() {
+    pico_cnn::naive::ThreadPool pool(4);
+
+    std::atomic<bool> started(false);
+    std::atomic<bool> release(false);
+    std::atomic<uint32_t> executed(0);
+    std::shared_ptr<pico_cnn::naive::AsyncRun> first;
+    std::vector<std::shared_ptr<pico_cnn::naive::AsyncRun>> pending;
+    std::thread releaser;
+    {
+        pico_cnn::naive::AsyncRunner runner(&pool);
+        first = submit_blocking_run(runner, started, release);
+        for(uint32_t i = 0; i < 10; i++) {
+            pending.push_back(runner.submit([&]() { executed.fetch_add(1); }));
+        }
+
+        releaser = std::thread([&]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            release.store(true);
+        });
+        // the destructor cancels the pending runs and waits for the running one
+    }
+    releaser.join();
+
+    CPPUNIT_ASSERT(first->done());
+    CPPUNIT_ASSERT(first->wait() == pico_cnn::naive::RunStatus::Completed);
+    for(std::shared_ptr<pico_cnn::naive::AsyncRun> &run: pending) {
+        CPPUNIT_ASSERT(run->wait() == pico_cnn::naive::RunStatus::Cancelled);
+    }
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 0, executed.load());
+}
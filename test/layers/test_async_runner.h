@@ -0,0 +1,29 @@
+#ifndef PICO_CNN_TEST_ASYNC_RUNNER_H
+#define PICO_CNN_TEST_ASYNC_RUNNER_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "../../pico-cnn/pico-cnn.h"
+
+
+class TestAsyncRunner : public CPPUNIT_NS::TestFixture {
+    CPPUNIT_TEST_SUITE(TestAsyncRunner);
+    CPPUNIT_TEST(runTestOrder);
+    CPPUNIT_TEST(runTestCallback);
+    CPPUNIT_TEST(runTestCancel);
+    CPPUNIT_TEST(runTestSingleThread);
+    CPPUNIT_TEST(runTestDestructor);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() override;
+    void tearDown() override;
+
+    void runTestOrder();
+    void runTestCallback();
+    void runTestCancel();
+    void runTestSingleThread();
+    void runTestDestructor();
+};
+
+
+#endif //PICO_CNN_TEST_ASYNC_RUNNER_H
@@ -1,5 +1,7 @@
 #include "test_convolution.h"
 
+#include "test_helpers.h"
+
 CPPUNIT_TEST_SUITE_REGISTRATION(TestConvolution);
 
 void TestConvolution::setUp() {
@@ -608,3 +610,59 @@ void TestConvolution::runTestConvolution_8() {
     delete expected_output_tensor;
     delete kernel_tensor;
 }
+
+void TestConvolution::runTestConvolutionBands() {
+
+    // the column matrix of 64 input channels and a 3x3 kernel has 576 rows, so the 1600 output pixels do not fit into
+    // a single column band and the bands end in the middle of output rows
+    const uint32_t channels = 64, size = 40, filters = 8;
+    CPPUNIT_ASSERT(pico_cnn::naive::Convolution::ColumnBandElements / (channels * 9) < size * size);
+    CPPUNIT_ASSERT(pico_cnn::naive::Convolution::ColumnBandElements / (channels * 9) % size != 0);
+
+    auto input_tensor = new pico_cnn::naive::Tensor(1, channels, size, size);
+    auto output_tensor = new pico_cnn::naive::Tensor(1, filters, size, size);
+    auto kernel_tensor = new pico_cnn::naive::Tensor(filters, channels, 3, 3);
+    auto bias_tensor = new pico_cnn::naive::Tensor(filters);
+
+    fill_random(input_tensor, 1);
+    fill_random(kernel_tensor, 2);
+    fill_random(bias_tensor, 3);
+
+    uint32_t padding[4] = {1, 1, 1, 1};
+    uint32_t stride[2] = {1, 1};
+    auto *layer = new pico_cnn::naive::Convolution("conv", 0, pico_cnn::op_type::Conv,
+                                                   kernel_tensor, bias_tensor, padding, stride, 1);
+    layer->run(input_tensor, output_tensor);
+
+    for(uint32_t filter = 0; filter < filters; filter++) {
+        for(uint32_t row = 0; row < size; row++) {
+            for(uint32_t col = 0; col < size; col++) {
+                double expected = bias_tensor->access_blob(filter);
+                for(uint32_t channel = 0; channel < channels; channel++) {
+                    for(uint32_t kernel_row = 0; kernel_row < 3; kernel_row++) {
+                        for(uint32_t kernel_col = 0; kernel_col < 3; kernel_col++) {
+                            int32_t input_row = (int32_t) (row + kernel_row) - 1;
+                            int32_t input_col = (int32_t) (col + kernel_col) - 1;
+                            if(input_row < 0 || input_row >= (int32_t) size || input_col < 0 ||
+                               input_col >= (int32_t) size) {
+                                continue;
+                            }
+                            expected += kernel_tensor->access(filter, channel, kernel_row, kernel_col,
+                                                              channels, 3, 3) *
+                                        input_tensor->access(0, channel, input_row, input_col, channels, size, size);
+                        }
+                    }
+                }
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(expected, output_tensor->access(0, filter, row, col, filters, size, size),
+                                             1e-3);
+            }
+        }
+    }
+
+    delete layer;
+
+    delete input_tensor;
+    delete output_tensor;
+    delete kernel_tensor;
+    delete bias_tensor;
+}
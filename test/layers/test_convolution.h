@@ -22,6 +22,7 @@ class TestConvolution : public CPPUNIT_NS::TestFixture {
     CPPUNIT_TEST(runTestConvolution_6);
     CPPUNIT_TEST(runTestConvolution_7);
     CPPUNIT_TEST(runTestConvolution_8);
+    CPPUNIT_TEST(runTestConvolutionBands);
     CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -43,6 +44,7 @@ public:
     void runTestConvolution_6();
     void runTestConvolution_7();
     void runTestConvolution_8();
+    void runTestConvolutionBands();
 
 };
 
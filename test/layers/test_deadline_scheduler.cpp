@@ -0,0 +1,153 @@
+#include "test_deadline_scheduler.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <utility>
+#include <vector>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TestDeadlineScheduler);
+
+typedef pico_cnn::naive::DeadlineScheduler::Clock Clock;
+// (request, step) in the order the steps were executed, only written by the dispatcher thread
+typedef std::vector<std::pair<uint32_t, uint32_t>> StepLog;
+
+void TestDeadlineScheduler::setUp() {
+    TestFixture::setUp();
+}
+
+void TestDeadlineScheduler::tearDown() {
+    TestFixture::tearDown();
+}
+
+/**
+ * Submits a request whose first step blocks until release is set, so requests submitted afterwards are queued while it
+ * runs.
+ */
+static std::shared_future<pico_cnn::naive::RequestReport> submit_blocking(
+        pico_cnn::naive::DeadlineScheduler &scheduler, uint32_t request, uint32_t num_steps, const void *instance,
+        StepLog &log, std::atomic<bool> &started, std::atomic<bool> &release) {
+    std::shared_future<pico_cnn::naive::RequestReport> future = scheduler.submit([&, request](uint32_t step) {
+        if(step == 0) {
+            started.store(true);
+            while(!release.load()) {
+                std::this_thread::yield();
+            }
+        }
+        log.push_back(std::make_pair(request, step));
+    }, num_steps, instance);
+    while(!started.load()) {
+        std::this_thread::yield();
+    }
+    return future;
+}
+
+static std::shared_future<pico_cnn::naive::RequestReport> submit_logged(
+        pico_cnn::naive::DeadlineScheduler &scheduler, uint32_t request, uint32_t num_steps, const void *instance,
+        StepLog &log, Clock::time_point deadline, int32_t priority = 0) {
+    return scheduler.submit([&log, request](uint32_t step) {
+        log.push_back(std::make_pair(request, step));
+    }, num_steps, instance, deadline, priority);
+}
+
+void TestDeadlineScheduler::runTestPreemption() {
+    pico_cnn::naive::DeadlineScheduler scheduler;
+    int bulk_network, urgent_network;
+    StepLog log;
+    std::atomic<bool> started(false);
+    std::atomic<bool> release(false);
+
+    // the urgent request is executed between two steps of the bulk request
+    auto bulk = submit_blocking(scheduler, 0, 5, &bulk_network, log, started, release);
+    auto urgent = submit_logged(scheduler, 1, 3, &urgent_network, log, Clock::now() + std::chrono::hours(1));
+    release.store(true);
+    scheduler.wait();
+
+    StepLog expected = {{0, 0}, {1, 0}, {1, 1}, {1, 2}, {0, 1}, {0, 2}, {0, 3}, {0, 4}};
+    CPPUNIT_ASSERT(expected == log);
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 1, bulk.get().num_preemptions);
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 0, urgent.get().num_preemptions);
+    CPPUNIT_ASSERT(!urgent.get().deadline_missed);
+
+    pico_cnn::naive::SchedulerStatistics statistics = scheduler.statistics();
+    CPPUNIT_ASSERT_EQUAL((uint64_t) 2, statistics.num_completed);
+    CPPUNIT_ASSERT_EQUAL((uint64_t) 1, statistics.num_preemptions);
+}
+
+void TestDeadlineScheduler::runTestSameInstance() {
+    pico_cnn::naive::DeadlineScheduler scheduler;
+    int network;
+    StepLog log;
+    std::atomic<bool> started(false);
+    std::atomic<bool> release(false);
+
+    // a started request keeps its network until it has finished, no matter how urgent the others are
+    auto bulk = submit_blocking(scheduler, 0, 3, &network, log, started, release);
+    submit_logged(scheduler, 1, 2, &network, log, Clock::now());
+    release.store(true);
+    scheduler.wait();
+
+    StepLog expected = {{0, 0}, {0, 1}, {0, 2}, {1, 0}, {1, 1}};
+    CPPUNIT_ASSERT(expected == log);
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 0, bulk.get().num_preemptions);
+}
+
+void TestDeadlineScheduler::runTestOrder() {
+    int networks[4];
+    const Clock::time_point now = Clock::now();
+
+    // the priorities are the reverse of the deadlines, so the two policies execute the requests in opposite orders
+    for(pico_cnn::naive::SchedulingPolicy policy: {pico_cnn::naive::SchedulingPolicy::EarliestDeadline,
+                                                  pico_cnn::naive::SchedulingPolicy::HighestPriority}) {
+        pico_cnn::naive::DeadlineScheduler scheduler(policy);
+        StepLog log;
+        std::atomic<bool> started(false);
+        std::atomic<bool> release(false);
+
+        submit_blocking(scheduler, 0, 1, &networks[0], log, started, release);
+        submit_logged(scheduler, 1, 1, &networks[1], log, now + std::chrono::seconds(3), 3);
+        submit_logged(scheduler, 2, 1, &networks[2], log, now + std::chrono::seconds(1), 1);
+        submit_logged(scheduler, 3, 1, &networks[3], log, now + std::chrono::seconds(2), 2);
+        release.store(true);
+        scheduler.wait();
+
+        StepLog expected;
+        if(policy == pico_cnn::naive::SchedulingPolicy::EarliestDeadline) {
+            expected = {{0, 0}, {2, 0}, {3, 0}, {1, 0}};
+        } else {
+            expected = {{0, 0}, {1, 0}, {3, 0}, {2, 0}};
+        }
+        CPPUNIT_ASSERT(expected == log);
+    }
+}
+
+void TestDeadlineScheduler::runTestDeadlineMiss() {
+    pico_cnn::naive::DeadlineScheduler scheduler;
+    int network;
+    StepLog log;
+
+    auto missed = submit_logged(scheduler, 0, 2, &network, log, Clock::now() - std::chrono::milliseconds(1));
+    auto met = submit_logged(scheduler, 1, 2, &network, log, Clock::now() + std::chrono::hours(1));
+    auto without_deadline = scheduler.submit([](uint32_t) {}, 2, &network);
+    // requests without steps are finished immediately
+    auto empty = scheduler.submit([](uint32_t) {}, 0, &network);
+
+    pico_cnn::naive::RequestReport report = missed.get();
+    CPPUNIT_ASSERT(report.deadline_missed);
+    CPPUNIT_ASSERT(report.lateness_seconds > 0.0);
+    CPPUNIT_ASSERT(report.latency_seconds >= 0.0);
+
+    report = met.get();
+    CPPUNIT_ASSERT(!report.deadline_missed);
+    CPPUNIT_ASSERT(report.lateness_seconds < 0.0);
+
+    report = without_deadline.get();
+    CPPUNIT_ASSERT(!report.deadline_missed);
+    CPPUNIT_ASSERT_EQUAL(0.0, report.lateness_seconds);
+    CPPUNIT_ASSERT(!empty.get().deadline_missed);
+
+    pico_cnn::naive::SchedulerStatistics statistics = scheduler.statistics();
+    CPPUNIT_ASSERT_EQUAL((uint64_t) 4, statistics.num_completed);
+    CPPUNIT_ASSERT_EQUAL((uint64_t) 1, statistics.num_deadline_misses);
+    CPPUNIT_ASSERT(statistics.max_lateness_seconds > 0.0);
+}
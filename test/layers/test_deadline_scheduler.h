@@ -0,0 +1,27 @@
+#ifndef PICO_CNN_TEST_DEADLINE_SCHEDULER_H
+#define PICO_CNN_TEST_DEADLINE_SCHEDULER_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "../../pico-cnn/pico-cnn.h"
+
+
+class TestDeadlineScheduler : public CPPUNIT_NS::TestFixture {
+    CPPUNIT_TEST_SUITE(TestDeadlineScheduler);
+    CPPUNIT_TEST(runTestPreemption);
+    CPPUNIT_TEST(runTestSameInstance);
+    CPPUNIT_TEST(runTestOrder);
+    CPPUNIT_TEST(runTestDeadlineMiss);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() override;
+    void tearDown() override;
+
+    void runTestPreemption();
+    void runTestSameInstance();
+    void runTestOrder();
+    void runTestDeadlineMiss();
+};
+
+
+#endif //PICO_CNN_TEST_DEADLINE_SCHEDULER_H
@@ -0,0 +1,81 @@
+#include "test_fused_tiles.h"
+
+#include "test_helpers.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TestFusedTiles);
+
+/**
+ * Executes the operations of chain on a 3x23x19 input as a FusedTileGroup.
+ */
+static pico_cnn::naive::FusedTileGroup *create_group(ConvChain &chain, uint64_t cache_bytes, uint32_t tile_rows) {
+    auto group = new pico_cnn::naive::FusedTileGroup("conv1..pool", 1, 3, 23, 19);
+    group->add_operation([&chain](pico_cnn::naive::Tensor *in, pico_cnn::naive::Tensor *out, uint32_t pad_top,
+                                  uint32_t) { chain.conv1->run_rows(in, out, pad_top); },
+                         3, 1, 1, 1, 4, 19, 3 * 3 * 3 * 19 * sizeof(fp_t));
+    group->add_operation([&chain](pico_cnn::naive::Tensor *in, pico_cnn::naive::Tensor *out, uint32_t,
+                                  uint32_t) { chain.relu->run(in, out); },
+                         1, 1, 0, 0, 4, 19);
+    group->add_operation([&chain](pico_cnn::naive::Tensor *in, pico_cnn::naive::Tensor *out, uint32_t pad_top,
+                                  uint32_t) { chain.conv2->run_rows(in, out, pad_top); },
+                         3, 2, 1, 1, 6, 10, 4 * 3 * 3 * 10 * sizeof(fp_t));
+    group->add_operation([&chain](pico_cnn::naive::Tensor *in, pico_cnn::naive::Tensor *out, uint32_t,
+                                  uint32_t) { chain.pool->run(in, out); },
+                         2, 2, 0, 0, 6, 5);
+    group->finalize(cache_bytes, tile_rows);
+    return group;
+}
+
+void TestFusedTiles::setUp() {
+    TestFixture::setUp();
+}
+
+void TestFusedTiles::tearDown() {
+    TestFixture::tearDown();
+}
+
+void TestFusedTiles::runTestConvChain() {
+    ConvChain chain;
+    pico_cnn::naive::Tensor input(1, 3, 23, 19);
+    fill_random(&input, 1);
+    pico_cnn::naive::Tensor *expected = chain.run_layers(&input);
+
+    // tiles of a single row up to the whole image, the borders of the image are padded in the first and last tiles
+    for(uint32_t tile_rows: {1u, 2u, 4u, 5u, 6u}) {
+        pico_cnn::naive::FusedTileGroup *group = create_group(chain, 0, tile_rows);
+        CPPUNIT_ASSERT_EQUAL((uint32_t) 6, group->output_height());
+        CPPUNIT_ASSERT_EQUAL(tile_rows, group->tile_rows());
+        CPPUNIT_ASSERT_EQUAL((6 + tile_rows - 1) / tile_rows, group->num_tiles());
+
+        // runs twice, the bands are reused
+        for(uint32_t run = 0; run < 2; run++) {
+            pico_cnn::naive::Tensor output(1, 6, 6, 5);
+            group->run(&input, &output);
+            assert_almost_equal(expected, &output);
+        }
+        delete group;
+    }
+    delete expected;
+}
+
+void TestFusedTiles::runTestTileSize() {
+    ConvChain chain;
+
+    // a generous budget fits the whole image into one tile, nothing is recomputed
+    pico_cnn::naive::FusedTileGroup *group = create_group(chain, 64 * 1024 * 1024, 0);
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 1, group->num_tiles());
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, group->recomputation(), 1e-9);
+    const uint64_t whole_image = group->working_set_bytes();
+    delete group;
+
+    // a small budget splits it, the halo rows of neighbouring tiles are computed twice
+    group = create_group(chain, whole_image / 3, 0);
+    CPPUNIT_ASSERT(group->num_tiles() > 1);
+    CPPUNIT_ASSERT(group->working_set_bytes() <= whole_image / 3);
+    CPPUNIT_ASSERT(group->recomputation() > 1.0);
+    delete group;
+
+    // the smallest tile is a single row, even if it does not fit
+    group = create_group(chain, 1, 0);
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 1, group->tile_rows());
+    delete group;
+}
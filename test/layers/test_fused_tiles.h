@@ -0,0 +1,23 @@
+#ifndef PICO_CNN_TEST_FUSED_TILES_H
+#define PICO_CNN_TEST_FUSED_TILES_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "../../pico-cnn/pico-cnn.h"
+
+
+class TestFusedTiles : public CPPUNIT_NS::TestFixture {
+    CPPUNIT_TEST_SUITE(TestFusedTiles);
+    CPPUNIT_TEST(runTestConvChain);
+    CPPUNIT_TEST(runTestTileSize);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() override;
+    void tearDown() override;
+
+    void runTestConvChain();
+    void runTestTileSize();
+};
+
+
+#endif //PICO_CNN_TEST_FUSED_TILES_H
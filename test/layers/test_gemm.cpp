@@ -0,0 +1,434 @@
+#include "test_gemm.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TestGemm);
+
+static std::vector<fp_t> random_matrix(uint32_t num_elements, uint32_t seed) {
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<fp_t> distribution(-1.0, 1.0);
+    std::vector<fp_t> matrix(num_elements);
+    for(fp_t &element: matrix) {
+        element = distribution(generator);
+    }
+    return matrix;
+}
+
+/**
+ * @return random matrix in which about 70% of the elements are zero
+ */
+static std::vector<fp_t> pruned_matrix(uint32_t num_elements, uint32_t seed) {
+    std::vector<fp_t> matrix = random_matrix(num_elements, seed);
+    for(fp_t &element: matrix) {
+        if(std::fabs(element) < 0.7) {
+            element = 0;
+        }
+    }
+    return matrix;
+}
+
+/**
+ * C = alpha * op(A) * op(B) + beta * C computed by definition
+ */
+static void reference_sgemm(bool transpose_a, bool transpose_b, uint32_t m, uint32_t n, uint32_t k,
+                            fp_t alpha, const fp_t *a, uint32_t lda, const fp_t *b, uint32_t ldb,
+                            fp_t beta, fp_t *c, uint32_t ldc) {
+    for(uint32_t i = 0; i < m; i++) {
+        for(uint32_t j = 0; j < n; j++) {
+            double sum = 0;
+            for(uint32_t p = 0; p < k; p++) {
+                fp_t a_ip = transpose_a ? a[p * lda + i] : a[i * lda + p];
+                fp_t b_pj = transpose_b ? b[j * ldb + p] : b[p * ldb + j];
+                sum += a_ip * b_pj;
+            }
+            c[i * ldc + j] = alpha * sum + beta * c[i * ldc + j];
+        }
+    }
+}
+
+/**
+ * Compares provider with the reference for all combinations of transposed operands. The sizes are no multiples of
+ * the blocks of BlockedGemm and C is a sub-matrix (ldc > n).
+ */
+static void compare_with_reference(pico_cnn::naive::GemmProvider *provider) {
+    const uint32_t m = 70, n = 530, k = 300, ldc = n + 3;
+
+    for(uint32_t transpose = 0; transpose < 4; transpose++) {
+        bool transpose_a = transpose & 1;
+        bool transpose_b = transpose & 2;
+        uint32_t lda = transpose_a ? m : k;
+        uint32_t ldb = transpose_b ? k : n;
+
+        std::vector<fp_t> a = random_matrix(m * k, 1);
+        std::vector<fp_t> b = random_matrix(k * n, 2);
+        std::vector<fp_t> expected = random_matrix(m * ldc, 3);
+        std::vector<fp_t> c = expected;
+
+        reference_sgemm(transpose_a, transpose_b, m, n, k, 0.5, a.data(), lda, b.data(), ldb, 2, expected.data(), ldc);
+        provider->sgemm(transpose_a, transpose_b, m, n, k, 0.5, a.data(), lda, b.data(), ldb, 2, c.data(), ldc);
+
+        for(uint32_t i = 0; i < m * ldc; i++) {
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(expected[i], c[i], 1e-3);
+        }
+    }
+}
+
+void TestGemm::setUp() {
+    TestFixture::setUp();
+}
+
+void TestGemm::tearDown() {
+    pico_cnn::naive::select_gemm_provider(pico_cnn::naive::available_gemm_providers().front());
+    TestFixture::tearDown();
+}
+
+void TestGemm::runTestBlockedGemm() {
+    pico_cnn::naive::BlockedGemm blocked_gemm;
+    compare_with_reference(&blocked_gemm);
+}
+
+void TestGemm::runTestBlockedGemmBetaZero() {
+    pico_cnn::naive::BlockedGemm blocked_gemm;
+
+    fp_t a[6] = {1, 2, 3,
+                 4, 5, 6};
+    fp_t b[6] = {1, 0,
+                 0, 1,
+                 1, 1};
+    fp_t expected[4] = {4, 5,
+                        10, 11};
+
+    // C must not be read if beta == 0
+    fp_t c[4];
+    std::fill(c, c + 4, std::numeric_limits<fp_t>::quiet_NaN());
+
+    blocked_gemm.sgemm(false, false, 2, 2, 3, 1, a, 3, b, 2, 0, c, 2);
+
+    for(uint32_t i = 0; i < 4; i++) {
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(expected[i], c[i], 1e-6);
+    }
+}
+
+void TestGemm::runTestAllProviders() {
+    for(const std::string &name: pico_cnn::naive::available_gemm_providers()) {
+        CPPUNIT_ASSERT_EQUAL(0, pico_cnn::naive::select_gemm_provider(name));
+        CPPUNIT_ASSERT_EQUAL(name, std::string(pico_cnn::naive::gemm_provider()->name()));
+        compare_with_reference(pico_cnn::naive::gemm_provider());
+    }
+}
+
+void TestGemm::runTestSelectProvider() {
+    std::vector<std::string> providers = pico_cnn::naive::available_gemm_providers();
+    CPPUNIT_ASSERT(std::find(providers.begin(), providers.end(), "blocked") != providers.end());
+
+    CPPUNIT_ASSERT_EQUAL(0, pico_cnn::naive::select_gemm_provider("blocked"));
+    CPPUNIT_ASSERT_EQUAL(std::string("blocked"), std::string(pico_cnn::naive::gemm_provider()->name()));
+
+    // an unknown provider keeps the current one
+    CPPUNIT_ASSERT_EQUAL(1, pico_cnn::naive::select_gemm_provider("unknown"));
+    CPPUNIT_ASSERT_EQUAL(std::string("blocked"), std::string(pico_cnn::naive::gemm_provider()->name()));
+}
+
+void TestGemm::runTestFullyConnectedBatch() {
+    const uint32_t num_rows = 3, input_width = 37, output_width = 11;
+
+    auto input = new pico_cnn::naive::Tensor(num_rows, input_width);
+    auto kernel = new pico_cnn::naive::Tensor(output_width, input_width);
+    auto bias = new pico_cnn::naive::Tensor(output_width);
+    auto output = new pico_cnn::naive::Tensor(num_rows, output_width);
+
+    std::vector<fp_t> input_data = random_matrix(num_rows * input_width, 4);
+    std::vector<fp_t> kernel_data = random_matrix(output_width * input_width, 5);
+    std::vector<fp_t> bias_data = random_matrix(output_width, 6);
+    std::copy(input_data.begin(), input_data.end(), input->data_);
+    std::copy(kernel_data.begin(), kernel_data.end(), kernel->data_);
+    std::copy(bias_data.begin(), bias_data.end(), bias->data_);
+
+    auto layer = new pico_cnn::naive::FullyConnected("fc", 0, pico_cnn::op_type::Gemm, kernel, bias);
+    ((pico_cnn::naive::Layer*) layer)->run(input, output);
+
+    // every row of the batch is multiplied with the transposed kernel
+    for(uint32_t row = 0; row < num_rows; row++) {
+        for(uint32_t i = 0; i < output_width; i++) {
+            fp_t expected = bias_data[i];
+            for(uint32_t j = 0; j < input_width; j++) {
+                expected += input_data[row * input_width + j] * kernel_data[i * input_width + j];
+            }
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(expected, output->access(row, i, output_width), 1e-4);
+        }
+    }
+
+    delete layer;
+    delete output;
+    delete bias;
+    delete kernel;
+    delete input;
+}
+
+void TestGemm::runTestMatMulTransposed() {
+    const uint32_t num_rows = 5, input_width = 37, output_width = 11;
+
+    std::vector<fp_t> input_data = random_matrix(num_rows * input_width, 7);
+    std::vector<fp_t> weight_data = random_matrix(input_width * output_width, 8);
+
+    auto weights = new pico_cnn::naive::Tensor(input_width, output_width);
+    std::copy(weight_data.begin(), weight_data.end(), weights->data_);
+
+    for(uint32_t transpose = 0; transpose < 4; transpose++) {
+        bool transpose_input = transpose & 1;
+        bool transpose_output = transpose & 2;
+
+        auto input = transpose_input ? new pico_cnn::naive::Tensor(input_width, num_rows) :
+                                       new pico_cnn::naive::Tensor(num_rows, input_width);
+        auto output = transpose_output ? new pico_cnn::naive::Tensor(output_width, num_rows) :
+                                         new pico_cnn::naive::Tensor(num_rows, output_width);
+
+        for(uint32_t row = 0; row < num_rows; row++) {
+            for(uint32_t j = 0; j < input_width; j++) {
+                input->data_[transpose_input ? j * num_rows + row : row * input_width + j] =
+                        input_data[row * input_width + j];
+            }
+        }
+
+        auto layer = new pico_cnn::naive::MatMul("matmul", 0, pico_cnn::op_type::MatMul, weights,
+                                                 transpose_input, transpose_output);
+        ((pico_cnn::naive::Layer*) layer)->run(input, output);
+
+        for(uint32_t row = 0; row < num_rows; row++) {
+            for(uint32_t i = 0; i < output_width; i++) {
+                fp_t expected = 0;
+                for(uint32_t j = 0; j < input_width; j++) {
+                    expected += input_data[row * input_width + j] * weight_data[j * output_width + i];
+                }
+                fp_t actual = output->data_[transpose_output ? i * num_rows + row : row * output_width + i];
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(expected, actual, 1e-4);
+            }
+        }
+
+        delete layer;
+        delete output;
+        delete input;
+    }
+
+    delete weights;
+}
+
+void TestGemm::runTestSparseMatrix() {
+    const uint32_t num_rows = 13, num_columns = 29, n = 7, m = 6;
+
+    std::vector<fp_t> dense = pruned_matrix(num_rows * num_columns, 7);
+    dense[3 * num_columns + 5] = 1; // the row of the first row of the second multiplication is not empty
+    pico_cnn::naive::SparseMatrix *sparse = pico_cnn::naive::SparseMatrix::from_dense(dense.data(), num_rows,
+                                                                                     num_columns);
+
+    uint32_t num_nonzeros = std::count_if(dense.begin(), dense.end(), [](fp_t element) { return element != 0; });
+    CPPUNIT_ASSERT_EQUAL(num_nonzeros, sparse->num_nonzeros());
+    CPPUNIT_ASSERT_EQUAL(num_nonzeros, sparse->row_offsets_[num_rows]);
+    CPPUNIT_ASSERT(num_nonzeros < num_rows * num_columns / 2);
+
+    // C = S * B with C initialized to garbage (beta == 0)
+    std::vector<fp_t> b = random_matrix(num_columns * n, 8);
+    std::vector<fp_t> c(num_rows * n, std::numeric_limits<fp_t>::quiet_NaN());
+    std::vector<fp_t> expected(num_rows * n);
+    sparse->multiply(0, num_rows, n, b.data(), n, 0, c.data(), n);
+    reference_sgemm(false, false, num_rows, n, num_columns, 1, dense.data(), num_columns, b.data(), n,
+                    0, expected.data(), n);
+    for(uint32_t i = 0; i < num_rows * n; i++) {
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(expected[i], c[i], 1e-4);
+    }
+
+    // rows 3 to 7 accumulated into C (beta == 1)
+    sparse->multiply(3, 5, n, b.data(), n, 1, c.data(), n);
+    reference_sgemm(false, false, 5, n, num_columns, 1, dense.data() + 3 * num_columns, num_columns, b.data(), n,
+                    1, expected.data(), n);
+    for(uint32_t i = 0; i < num_rows * n; i++) {
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(expected[i], c[i], 1e-4);
+    }
+
+    // C = A * S^T, m is no multiple of the four rows computed together
+    std::vector<fp_t> a = random_matrix(m * num_columns, 9);
+    std::vector<fp_t> c_transposed(m * num_rows, std::numeric_limits<fp_t>::quiet_NaN());
+    std::vector<fp_t> expected_transposed(m * num_rows);
+    sparse->multiply_transposed(m, a.data(), num_columns, 0, c_transposed.data(), num_rows);
+    reference_sgemm(false, true, m, num_rows, num_columns, 1, a.data(), num_columns, dense.data(), num_columns,
+                    0, expected_transposed.data(), num_rows);
+    for(uint32_t i = 0; i < m * num_rows; i++) {
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(expected_transposed[i], c_transposed[i], 1e-4);
+    }
+
+    delete sparse;
+}
+
+void TestGemm::runTestSparseLayers() {
+    // fully connected layer with a pruned kernel
+    const uint32_t num_rows = 5, input_width = 37, output_width = 11;
+
+    auto input = new pico_cnn::naive::Tensor(num_rows, input_width);
+    auto kernel = new pico_cnn::naive::Tensor(output_width, input_width);
+    auto bias = new pico_cnn::naive::Tensor(output_width);
+    auto output = new pico_cnn::naive::Tensor(num_rows, output_width);
+    auto sparse_output = new pico_cnn::naive::Tensor(num_rows, output_width);
+
+    std::vector<fp_t> input_data = random_matrix(num_rows * input_width, 10);
+    std::vector<fp_t> kernel_data = pruned_matrix(output_width * input_width, 11);
+    std::vector<fp_t> bias_data = random_matrix(output_width, 12);
+    std::copy(input_data.begin(), input_data.end(), input->data_);
+    std::copy(kernel_data.begin(), kernel_data.end(), kernel->data_);
+    std::copy(bias_data.begin(), bias_data.end(), bias->data_);
+
+    pico_cnn::naive::SparseMatrix *sparse_kernel = pico_cnn::naive::SparseMatrix::from_dense(kernel->data_,
+                                                                                            output_width, input_width);
+
+    auto layer = new pico_cnn::naive::FullyConnected("fc", 0, pico_cnn::op_type::Gemm, kernel, bias);
+    auto sparse_layer = new pico_cnn::naive::FullyConnected("fc", 0, pico_cnn::op_type::Gemm, sparse_kernel, bias);
+    ((pico_cnn::naive::Layer*) layer)->run(input, output);
+    ((pico_cnn::naive::Layer*) sparse_layer)->run(input, sparse_output);
+
+    for(uint32_t i = 0; i < output->num_elements(); i++) {
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(output->data_[i], sparse_output->data_[i], 1e-4);
+    }
+
+    delete sparse_layer;
+    delete layer;
+    delete sparse_kernel;
+    delete sparse_output;
+    delete output;
+    delete bias;
+    delete kernel;
+    delete input;
+
+    // grouped 3x3 convolution with padding and stride and a pruned kernel
+    const uint32_t in_channels = 4, out_channels = 6, groups = 2, size = 9, output_size = 5;
+    uint32_t padding[4] = {1, 1, 1, 1};
+    uint32_t stride[2] = {2, 2};
+
+    auto conv_input = new pico_cnn::naive::Tensor(1, in_channels, size, size);
+    auto conv_kernel = new pico_cnn::naive::Tensor(out_channels, in_channels / groups, 3, 3);
+    auto conv_bias = new pico_cnn::naive::Tensor(out_channels);
+    auto conv_output = new pico_cnn::naive::Tensor(1, out_channels, output_size, output_size);
+    auto sparse_conv_output = new pico_cnn::naive::Tensor(1, out_channels, output_size, output_size);
+
+    std::vector<fp_t> conv_input_data = random_matrix(conv_input->num_elements(), 13);
+    std::vector<fp_t> conv_kernel_data = pruned_matrix(conv_kernel->num_elements(), 14);
+    std::vector<fp_t> conv_bias_data = random_matrix(out_channels, 15);
+    std::copy(conv_input_data.begin(), conv_input_data.end(), conv_input->data_);
+    std::copy(conv_kernel_data.begin(), conv_kernel_data.end(), conv_kernel->data_);
+    std::copy(conv_bias_data.begin(), conv_bias_data.end(), conv_bias->data_);
+
+    pico_cnn::naive::SparseMatrix *sparse_conv_kernel = pico_cnn::naive::SparseMatrix::from_dense(
+            conv_kernel->data_, out_channels, in_channels / groups * 3 * 3);
+
+    auto conv = new pico_cnn::naive::Convolution("conv", 0, pico_cnn::op_type::Conv, conv_kernel, conv_bias,
+                                                 padding, stride, groups);
+    auto sparse_conv = new pico_cnn::naive::Convolution("conv", 0, pico_cnn::op_type::Conv, sparse_conv_kernel,
+                                                        conv_bias, 3, 3, padding, stride, groups);
+    ((pico_cnn::naive::Layer*) conv)->run(conv_input, conv_output);
+    ((pico_cnn::naive::Layer*) sparse_conv)->run(conv_input, sparse_conv_output);
+
+    for(uint32_t i = 0; i < conv_output->num_elements(); i++) {
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(conv_output->data_[i], sparse_conv_output->data_[i], 1e-4);
+    }
+
+    delete sparse_conv;
+    delete conv;
+    delete sparse_conv_kernel;
+    delete sparse_conv_output;
+    delete conv_output;
+    delete conv_bias;
+    delete conv_kernel;
+    delete conv_input;
+}
+
+void TestGemm::runTestSparseInput() {
+    // a length that is no multiple of the four inputs compared at once, non-zeros in the tail
+    const uint32_t m = 6, n = 21, k = 43;
+
+    std::vector<fp_t> a = pruned_matrix(m * k, 16);
+    a[k - 1] = 0.5;
+    a[k - 2] = 0;
+    std::fill(a.begin() + 2 * k, a.begin() + 3 * k, 0); // empty row
+    std::vector<fp_t> dense_rows = random_matrix(3 * k, 17); // above SparseInputMaxDensity
+    std::copy(dense_rows.begin(), dense_rows.end(), a.begin() + 3 * k);
+
+    std::vector<uint32_t> indices(k);
+    uint32_t num_nonzeros = pico_cnn::naive::compress_nonzeros(a.data(), k, indices.data());
+    std::vector<uint32_t> expected_indices;
+    for(uint32_t i = 0; i < k; i++) {
+        if(a[i] != 0) {
+            expected_indices.push_back(i);
+        }
+    }
+    CPPUNIT_ASSERT_EQUAL((uint32_t) expected_indices.size(), num_nonzeros);
+    CPPUNIT_ASSERT(std::equal(expected_indices.begin(), expected_indices.end(), indices.begin()));
+    CPPUNIT_ASSERT_EQUAL(0u, pico_cnn::naive::compress_nonzeros(a.data() + 2 * k, k, indices.data()));
+
+    // C = A * B with C initialized to garbage (beta == 0), then accumulated (beta == 1), for the sparse rows, a single
+    // dense row (accumulated as well), the dense rows (multiplied densely) and all rows
+    const uint32_t first_rows[] = {0, 3, 3, 0}, num_rows[] = {3, 1, 3, 6};
+    std::vector<fp_t> b = random_matrix(k * n, 18);
+    std::vector<fp_t> expected(m * n);
+    for(uint32_t test = 0; test < 4; test++) {
+        std::vector<fp_t> c(num_rows[test] * n, std::numeric_limits<fp_t>::quiet_NaN());
+        const fp_t *a_rows = a.data() + first_rows[test] * k;
+        for(fp_t beta: {0.0f, 1.0f}) {
+            pico_cnn::naive::sparse_input_sgemm(num_rows[test], n, k, a_rows, k, b.data(), n, beta, c.data(), n,
+                                                indices.data());
+            reference_sgemm(false, false, num_rows[test], n, k, 1, a_rows, k, b.data(), n,
+                            beta, expected.data(), n);
+            for(uint32_t i = 0; i < num_rows[test] * n; i++) {
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(expected[i], c[i], 1e-4);
+            }
+        }
+    }
+
+    // fully connected layer behind a ReLU, the kernel is stored as (X, Y)
+    auto input = new pico_cnn::naive::Tensor(m, k);
+    auto kernel = new pico_cnn::naive::Tensor(n, k);
+    auto kernel_transposed = new pico_cnn::naive::Tensor(k, n);
+    auto bias = new pico_cnn::naive::Tensor(n);
+    auto output = new pico_cnn::naive::Tensor(m, n);
+    auto sparse_output = new pico_cnn::naive::Tensor(m, n);
+
+    std::vector<fp_t> bias_data = random_matrix(n, 19);
+    std::copy(a.begin(), a.end(), input->data_);
+    std::copy(bias_data.begin(), bias_data.end(), bias->data_);
+    for(uint32_t i = 0; i < k; i++) {
+        for(uint32_t j = 0; j < n; j++) {
+            kernel->data_[j * k + i] = b[i * n + j];
+            kernel_transposed->data_[i * n + j] = b[i * n + j];
+        }
+    }
+
+    auto layer = new pico_cnn::naive::FullyConnected("fc", 0, pico_cnn::op_type::Gemm, kernel, bias);
+    auto sparse_layer = new pico_cnn::naive::FullyConnected("fc", 0, pico_cnn::op_type::Gemm, kernel_transposed,
+                                                            bias, true);
+    ((pico_cnn::naive::Layer*) layer)->run(input, output);
+    ((pico_cnn::naive::Layer*) sparse_layer)->run(input, sparse_output);
+
+    for(uint32_t i = 0; i < output->num_elements(); i++) {
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(output->data_[i], sparse_output->data_[i], 1e-4);
+    }
+
+    // MatMul, whose weights are (X, Y) anyway
+    auto matmul = new pico_cnn::naive::MatMul("matmul", 0, pico_cnn::op_type::MatMul, kernel_transposed,
+                                              false, false, true);
+    ((pico_cnn::naive::Layer*) matmul)->run(input, sparse_output);
+    reference_sgemm(false, false, m, n, k, 1, a.data(), k, b.data(), n, 0, expected.data(), n);
+
+    for(uint32_t i = 0; i < sparse_output->num_elements(); i++) {
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(expected[i], sparse_output->data_[i], 1e-4);
+    }
+
+    delete matmul;
+    delete sparse_layer;
+    delete layer;
+    delete sparse_output;
+    delete output;
+    delete bias;
+    delete kernel_transposed;
+    delete kernel;
+    delete input;
+}
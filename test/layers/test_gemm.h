@@ -0,0 +1,38 @@
+#ifndef PICO_CNN_TEST_GEMM_H
+#define PICO_CNN_TEST_GEMM_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "../../pico-cnn/pico-cnn.h"
+#include "../../pico-cnn/gemm/blocked_gemm.h"
+
+
+class TestGemm : public CPPUNIT_NS::TestFixture {
+    CPPUNIT_TEST_SUITE(TestGemm);
+    CPPUNIT_TEST(runTestBlockedGemm);
+    CPPUNIT_TEST(runTestBlockedGemmBetaZero);
+    CPPUNIT_TEST(runTestAllProviders);
+    CPPUNIT_TEST(runTestSelectProvider);
+    CPPUNIT_TEST(runTestFullyConnectedBatch);
+    CPPUNIT_TEST(runTestMatMulTransposed);
+    CPPUNIT_TEST(runTestSparseMatrix);
+    CPPUNIT_TEST(runTestSparseLayers);
+    CPPUNIT_TEST(runTestSparseInput);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() override;
+    void tearDown() override;
+
+    void runTestBlockedGemm();
+    void runTestBlockedGemmBetaZero();
+    void runTestAllProviders();
+    void runTestSelectProvider();
+    void runTestFullyConnectedBatch();
+    void runTestMatMulTransposed();
+    void runTestSparseMatrix();
+    void runTestSparseLayers();
+    void runTestSparseInput();
+};
+
+
+#endif //PICO_CNN_TEST_GEMM_H
@@ -0,0 +1,100 @@
+/**
+ * @brief Helpers shared by the unit tests: random tensors, comparison of tensors and a small chain of layers which is
+ * executed layer by layer and by the depth-first runtimes (FusedTileGroup, LineBufferStream).
+ */
+#ifndef PICO_CNN_TEST_HELPERS_H
+#define PICO_CNN_TEST_HELPERS_H
+
+#include <random>
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "../../pico-cnn/pico-cnn.h"
+
+/**
+ * Fills tensor with values drawn uniformly from [-1, 1), the same seed yields the same values.
+ */
+static inline void fill_random(pico_cnn::naive::Tensor *tensor, uint32_t seed) {
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<fp_t> distribution(-1.0, 1.0);
+    for(uint32_t i = 0; i < tensor->num_elements(); i++) {
+        tensor->access_blob(i) = distribution(generator);
+    }
+}
+
+static inline void assert_almost_equal(pico_cnn::naive::Tensor *expected, pico_cnn::naive::Tensor *actual,
+                                       double tolerance = 1e-4) {
+    CPPUNIT_ASSERT_EQUAL(expected->num_elements(), actual->num_elements());
+    for(uint32_t i = 0; i < expected->num_elements(); i++) {
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(expected->access_blob(i), actual->access_blob(i), tolerance);
+    }
+}
+
+/**
+ * Conv 3x3 (padding 1) -> ReLU -> Conv 3x3 (stride 2, padding 1) -> MaxPool 2x2 on inputs with 3 channels and 19
+ * columns, the tests add its operations to the runtime they compare against run_layers().
+ */
+class ConvChain {
+public:
+    ConvChain() {
+        kernel1 = new pico_cnn::naive::Tensor(4, 3, 3, 3);
+        bias1 = new pico_cnn::naive::Tensor(4);
+        kernel2 = new pico_cnn::naive::Tensor(6, 4, 3, 3);
+        bias2 = new pico_cnn::naive::Tensor(6);
+        fill_random(kernel1, 2);
+        fill_random(bias1, 3);
+        fill_random(kernel2, 4);
+        fill_random(bias2, 5);
+
+        uint32_t padding[4] = {1, 1, 1, 1};
+        uint32_t stride1[2] = {1, 1};
+        uint32_t stride2[2] = {2, 2};
+        uint32_t pool_kernel[2] = {2, 2};
+        conv1 = new pico_cnn::naive::Convolution("conv1", 0, pico_cnn::op_type::Conv, kernel1, bias1, padding,
+                                                 stride1, 1);
+        relu = new pico_cnn::naive::ReLU("relu", 0, pico_cnn::op_type::ReLU);
+        conv2 = new pico_cnn::naive::Convolution("conv2", 0, pico_cnn::op_type::Conv, kernel2, bias2, padding,
+                                                 stride2, 1);
+        pool = new pico_cnn::naive::MaxPooling("pool", 0, pico_cnn::op_type::MaxPool, pool_kernel, stride2, nullptr);
+    }
+
+    ~ConvChain() {
+        delete pool;
+        delete conv2;
+        delete relu;
+        delete conv1;
+        delete bias2;
+        delete kernel2;
+        delete bias1;
+        delete kernel1;
+    }
+
+    ConvChain(const ConvChain&) = delete;
+    ConvChain &operator=(const ConvChain&) = delete;
+
+    static uint32_t output_height(uint32_t height) {
+        return ((height - 1) / 2 + 1) / 2;
+    }
+
+    /**
+     * @return output of the chain for input, computed one layer after another over the whole image
+     */
+    pico_cnn::naive::Tensor *run_layers(pico_cnn::naive::Tensor *input) {
+        const uint32_t height = input->height();
+        pico_cnn::naive::Tensor conv1_output(1, 4, height, 19);
+        pico_cnn::naive::Tensor relu_output(1, 4, height, 19);
+        pico_cnn::naive::Tensor conv2_output(1, 6, (height - 1) / 2 + 1, 10);
+        auto output = new pico_cnn::naive::Tensor(1, 6, output_height(height), 5);
+        conv1->run(input, &conv1_output);
+        relu->run(&conv1_output, &relu_output);
+        conv2->run(&relu_output, &conv2_output);
+        pool->run(&conv2_output, output);
+        return output;
+    }
+
+    pico_cnn::naive::Tensor *kernel1, *bias1, *kernel2, *bias2;
+    pico_cnn::naive::Convolution *conv1, *conv2;
+    pico_cnn::naive::ReLU *relu;
+    pico_cnn::naive::MaxPooling *pool;
+};
+
+#endif //PICO_CNN_TEST_HELPERS_H
@@ -0,0 +1,209 @@
+#include "test_jpeg_ingest.h"
+
+#include <jpeglib.h>
+#include "../../pico-cnn/io/read_jpeg.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TestJpegIngest);
+
+/**
+ * Writes a RGB image of size height x width, the color of each pixel is given by color(row, column, rgb).
+ */
+template<typename Color>
+static void write_test_jpeg(const char *jpeg_path, uint32_t height, uint32_t width, Color color) {
+    struct jpeg_compress_struct cinfo;
+    struct jpeg_error_mgr jerr;
+
+    FILE *jpeg_file = fopen(jpeg_path, "wb");
+
+    cinfo.err = jpeg_std_error(&jerr);
+    jpeg_create_compress(&cinfo);
+    jpeg_stdio_dest(&cinfo, jpeg_file);
+
+    cinfo.image_width = width;
+    cinfo.image_height = height;
+    cinfo.input_components = 3;
+    cinfo.in_color_space = JCS_RGB;
+    jpeg_set_defaults(&cinfo);
+    jpeg_set_quality(&cinfo, 100, TRUE);
+    jpeg_start_compress(&cinfo, TRUE);
+
+    JSAMPLE *scanline = new JSAMPLE[width * 3];
+    while(cinfo.next_scanline < cinfo.image_height) {
+        for(uint32_t column = 0; column < width; column++) {
+            color(cinfo.next_scanline, column, scanline + 3 * column);
+        }
+        (void) jpeg_write_scanlines(&cinfo, &scanline, 1);
+    }
+    delete[] scanline;
+
+    jpeg_finish_compress(&cinfo);
+    jpeg_destroy_compress(&cinfo);
+    fclose(jpeg_file);
+}
+
+/**
+ * Image split into four quadrants colored red, green, blue and white.
+ */
+static void quadrant_color(uint32_t row, uint32_t column, uint32_t height, uint32_t width, JSAMPLE *rgb) {
+    uint32_t quadrant = (row >= height / 2) * 2 + (column >= width / 2);
+    rgb[0] = (quadrant == 0 || quadrant == 3) ? 255 : 0;
+    rgb[1] = (quadrant == 1 || quadrant == 3) ? 255 : 0;
+    rgb[2] = (quadrant == 2 || quadrant == 3) ? 255 : 0;
+}
+
+void TestJpegIngest::setUp() {
+    TestFixture::setUp();
+}
+
+void TestJpegIngest::tearDown() {
+    TestFixture::tearDown();
+}
+
+void TestJpegIngest::runTestJpegIntoTensorFullSize() {
+
+    const char *jpeg_path = "test_jpeg_ingest_full_size.jpeg";
+    write_test_jpeg(jpeg_path, 24, 40, [](uint32_t row, uint32_t column, JSAMPLE *rgb) {
+        rgb[0] = (JSAMPLE) (row * 10);
+        rgb[1] = (JSAMPLE) (column * 6);
+        rgb[2] = (JSAMPLE) ((row + column) * 4);
+    });
+
+    // reference: read_jpeg() followed by scaling and mean subtraction
+    fp_t **image;
+    uint16_t height;
+    uint16_t width;
+    CPPUNIT_ASSERT_EQUAL((int32_t) 0, read_jpeg(&image, jpeg_path, -1.0, 1.0, &height, &width));
+    CPPUNIT_ASSERT_EQUAL((uint16_t) 24, height);
+    CPPUNIT_ASSERT_EQUAL((uint16_t) 40, width);
+
+    pico_cnn::naive::JpegPreprocessing preprocessing;
+    preprocessing.lower_bound = -1.0;
+    preprocessing.upper_bound = 1.0;
+    preprocessing.means[0] = 0.5;
+    preprocessing.means[1] = 0.25;
+    preprocessing.means[2] = -0.5;
+    preprocessing.fast_dct = false;
+
+    auto input_tensor = new pico_cnn::naive::Tensor(2, 3, 24, 40);
+    CPPUNIT_ASSERT_EQUAL((int32_t) 0, pico_cnn::naive::read_jpeg_into_tensor(jpeg_path, input_tensor, 1,
+                                                                             preprocessing));
+
+    for(uint32_t channel = 0; channel < 3; channel++) {
+        fp_t *data = input_tensor->get_ptr_to_channel(1, channel);
+        for(uint32_t i = 0; i < 24 * 40; i++) {
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(image[channel][i] - preprocessing.means[channel], data[i], 1e-5);
+        }
+        free(image[channel]);
+    }
+    free(image);
+
+    // RGB order
+    preprocessing.bgr = false;
+    CPPUNIT_ASSERT_EQUAL((int32_t) 0, pico_cnn::naive::read_jpeg_into_tensor(jpeg_path, input_tensor, 0,
+                                                                             preprocessing));
+    for(uint32_t i = 0; i < 24 * 40; i++) {
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(input_tensor->get_ptr_to_channel(1, 2)[i] - 0.5,
+                                     input_tensor->get_ptr_to_channel(0, 0)[i] + 0.5, 1e-5);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(input_tensor->get_ptr_to_channel(1, 0)[i] + 0.5,
+                                     input_tensor->get_ptr_to_channel(0, 2)[i] - 0.5, 1e-5);
+    }
+
+    // wrong tensor shape
+    auto wrong_tensor = new pico_cnn::naive::Tensor(1, 1, 24, 40);
+    CPPUNIT_ASSERT(pico_cnn::naive::read_jpeg_into_tensor(jpeg_path, wrong_tensor, 0, preprocessing) != 0);
+    CPPUNIT_ASSERT(pico_cnn::naive::read_jpeg_into_tensor(jpeg_path, input_tensor, 2, preprocessing) != 0);
+
+    delete wrong_tensor;
+    delete input_tensor;
+
+    remove(jpeg_path);
+}
+
+void TestJpegIngest::runTestJpegIntoTensorDownscaled() {
+
+    const char *jpeg_path = "test_jpeg_ingest_downscaled.jpeg";
+    write_test_jpeg(jpeg_path, 256, 320, [](uint32_t row, uint32_t column, JSAMPLE *rgb) {
+        quadrant_color(row, column, 256, 320, rgb);
+    });
+
+    pico_cnn::naive::JpegPreprocessing preprocessing;
+    preprocessing.lower_bound = 0.0;
+    preprocessing.upper_bound = 1.0;
+
+    // 1/8 (32x40), 1/4 (64x80) and no DCT scaling, followed by nearest neighbour resizing
+    const uint32_t sizes[3][2] = {{30, 30}, {50, 70}, {200, 300}};
+
+    for(auto size: sizes) {
+        const uint32_t height = size[0];
+        const uint32_t width = size[1];
+        auto input_tensor = new pico_cnn::naive::Tensor(1, 3, height, width);
+        CPPUNIT_ASSERT_EQUAL((int32_t) 0, pico_cnn::naive::read_jpeg_into_tensor(jpeg_path, input_tensor, 0,
+                                                                                 preprocessing));
+
+        // centers of the quadrants, away from the blurred edges
+        for(uint32_t quadrant = 0; quadrant < 4; quadrant++) {
+            uint32_t row = (quadrant / 2) * height / 2 + height / 4;
+            uint32_t column = (quadrant % 2) * width / 2 + width / 4;
+            JSAMPLE rgb[3];
+            quadrant_color(row, column, height, width, rgb);
+            for(uint32_t channel = 0; channel < 3; channel++) {
+                fp_t expected = rgb[2 - channel] / 255.0;
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(expected, input_tensor->get_ptr_to_channel(0, channel)[row * width + column],
+                                             0.05);
+            }
+        }
+
+        delete input_tensor;
+    }
+
+    remove(jpeg_path);
+}
+
+void TestJpegIngest::runTestJpegBatchIntoTensor() {
+
+    const uint32_t num_images = 5;
+    std::vector<std::string> jpeg_paths;
+
+    for(uint32_t image = 0; image < num_images; image++) {
+        jpeg_paths.push_back("test_jpeg_ingest_batch_" + std::to_string(image) + ".jpeg");
+        write_test_jpeg(jpeg_paths.back().c_str(), 48, 48, [image](uint32_t row, uint32_t column, JSAMPLE *rgb) {
+            rgb[0] = (JSAMPLE) (image * 50);
+            rgb[1] = 128;
+            rgb[2] = (JSAMPLE) (255 - image * 50);
+        });
+    }
+
+    pico_cnn::naive::JpegPreprocessing preprocessing;
+    preprocessing.means[0] = 100.0;
+
+    auto input_tensor = new pico_cnn::naive::Tensor(num_images, 3, 16, 16);
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 0, pico_cnn::naive::read_jpeg_batch_into_tensor(jpeg_paths, input_tensor,
+                                                                                    preprocessing, 3));
+
+    for(uint32_t image = 0; image < num_images; image++) {
+        for(uint32_t i = 0; i < 16 * 16; i++) {
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(255.0 - image * 50 - 100.0, input_tensor->get_ptr_to_channel(image, 0)[i], 2.0);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(128.0, input_tensor->get_ptr_to_channel(image, 1)[i], 2.0);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(image * 50.0, input_tensor->get_ptr_to_channel(image, 2)[i], 2.0);
+        }
+    }
+
+    // a missing and a corrupted image are reported, the other images are still decoded
+    FILE *corrupted = fopen(jpeg_paths[1].c_str(), "wb");
+    fputs("no jpeg", corrupted);
+    fclose(corrupted);
+    remove(jpeg_paths[3].c_str());
+
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 2, pico_cnn::naive::read_jpeg_batch_into_tensor(jpeg_paths, input_tensor,
+                                                                                    preprocessing, 2));
+
+    // more images than batches
+    jpeg_paths.push_back(jpeg_paths[0]);
+    CPPUNIT_ASSERT(pico_cnn::naive::read_jpeg_batch_into_tensor(jpeg_paths, input_tensor, preprocessing, 2) != 0);
+
+    delete input_tensor;
+
+    for(uint32_t image = 0; image < num_images; image++) {
+        remove(jpeg_paths[image].c_str());
+    }
+}
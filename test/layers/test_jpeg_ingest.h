@@ -0,0 +1,25 @@
+#ifndef PICO_CNN_TEST_JPEG_INGEST_H
+#define PICO_CNN_TEST_JPEG_INGEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "../../pico-cnn/pico-cnn.h"
+
+
+class TestJpegIngest : public CPPUNIT_NS::TestFixture {
+    CPPUNIT_TEST_SUITE(TestJpegIngest);
+    CPPUNIT_TEST(runTestJpegIntoTensorFullSize);
+    CPPUNIT_TEST(runTestJpegIntoTensorDownscaled);
+    CPPUNIT_TEST(runTestJpegBatchIntoTensor);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() override;
+    void tearDown() override;
+
+    void runTestJpegIntoTensorFullSize();
+    void runTestJpegIntoTensorDownscaled();
+    void runTestJpegBatchIntoTensor();
+};
+
+
+#endif //PICO_CNN_TEST_JPEG_INGEST_H
@@ -0,0 +1,138 @@
+#include "test_line_buffer_stream.h"
+
+#include "test_helpers.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TestLineBufferStream);
+
+/**
+ * ConvChain executed as a LineBufferStream.
+ */
+class StreamedConvChain : public ConvChain {
+public:
+    StreamedConvChain() {
+        stream = new pico_cnn::naive::LineBufferStream("conv1..pool", 1, 3, 19);
+        stream->add_operation([this](pico_cnn::naive::Tensor *in, pico_cnn::naive::Tensor *out, uint32_t pad_top,
+                                     uint32_t) { conv1->run_rows(in, out, pad_top); },
+                              3, 1, 1, 1, 4, 19);
+        stream->add_operation([this](pico_cnn::naive::Tensor *in, pico_cnn::naive::Tensor *out, uint32_t,
+                                     uint32_t) { relu->run(in, out); },
+                              1, 1, 0, 0, 4, 19);
+        stream->add_operation([this](pico_cnn::naive::Tensor *in, pico_cnn::naive::Tensor *out, uint32_t pad_top,
+                                     uint32_t) { conv2->run_rows(in, out, pad_top); },
+                              3, 2, 1, 1, 6, 10);
+        stream->add_operation([this](pico_cnn::naive::Tensor *in, pico_cnn::naive::Tensor *out, uint32_t,
+                                     uint32_t) { pool->run(in, out); },
+                              2, 2, 0, 0, 6, 5);
+        stream->finalize();
+    }
+
+    ~StreamedConvChain() {
+        delete stream;
+    }
+
+    /**
+     * Feeds the rows of input in chunks of chunk_rows rows and collects the emitted rows in output.
+     * @return number of rows emitted
+     */
+    uint32_t stream_rows(pico_cnn::naive::Tensor *input, uint32_t chunk_rows, pico_cnn::naive::Tensor *output) {
+        uint32_t next_row = 0;
+        stream->begin([&](const pico_cnn::naive::Tensor *row, uint32_t row_index) {
+            CPPUNIT_ASSERT_EQUAL(next_row, row_index);
+            for(uint32_t channel = 0; channel < 6; channel++) {
+                for(uint32_t x = 0; x < 5; x++) {
+                    output->access(0, channel, row_index, x, 6, output->height(), 5) = row->access(0, channel, 0, x,
+                                                                                                   6, 1, 5);
+                }
+            }
+            next_row++;
+        });
+
+        const uint32_t height = input->height();
+        for(uint32_t first = 0; first < height; first += chunk_rows) {
+            const uint32_t num_rows = MIN(chunk_rows, height - first);
+            pico_cnn::naive::Tensor chunk(1, 3, num_rows, 19);
+            for(uint32_t channel = 0; channel < 3; channel++) {
+                for(uint32_t y = 0; y < num_rows; y++) {
+                    for(uint32_t x = 0; x < 19; x++) {
+                        chunk.access(0, channel, y, x, 3, num_rows, 19) =
+                                input->access(0, channel, first + y, x, 3, height, 19);
+                    }
+                }
+            }
+            stream->push_rows(&chunk);
+        }
+        uint32_t num_rows = stream->finish();
+        CPPUNIT_ASSERT_EQUAL(next_row, num_rows);
+        return num_rows;
+    }
+
+    pico_cnn::naive::LineBufferStream *stream;
+};
+
+void TestLineBufferStream::setUp() {
+    TestFixture::setUp();
+}
+
+void TestLineBufferStream::tearDown() {
+    TestFixture::tearDown();
+}
+
+void TestLineBufferStream::runTestConvChain() {
+    StreamedConvChain chain;
+    pico_cnn::naive::Tensor input(1, 3, 23, 19);
+    fill_random(&input, 1);
+    pico_cnn::naive::Tensor *expected = chain.run_layers(&input);
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 6, chain.stream->output_height(23));
+
+    // single rows up to the whole image at once
+    for(uint32_t chunk_rows: {1u, 2u, 5u, 23u}) {
+        pico_cnn::naive::Tensor output(1, 6, 6, 5);
+        CPPUNIT_ASSERT_EQUAL((uint32_t) 6, chain.stream_rows(&input, chunk_rows, &output));
+        assert_almost_equal(expected, &output);
+    }
+
+    // runs twice, the windows are reused
+    for(uint32_t run = 0; run < 2; run++) {
+        pico_cnn::naive::Tensor output(1, 6, 6, 5);
+        chain.stream->run(&input, &output);
+        assert_almost_equal(expected, &output);
+    }
+    delete expected;
+}
+
+void TestLineBufferStream::runTestIncremental() {
+    StreamedConvChain chain;
+    pico_cnn::naive::Tensor row(1, 3, 1, 19);
+
+    uint32_t num_emitted = 0;
+    chain.stream->begin([&](const pico_cnn::naive::Tensor *, uint32_t) { num_emitted++; });
+
+    // output row r of the pool depends on the rows of conv2 up to 2 * r + 1, which depend on the input rows up to
+    // 4 * r + 4, so every fourth input row completes an output row
+    for(uint32_t y = 0; y < 23; y++) {
+        fill_random(&row, y);
+        chain.stream->push_rows(&row);
+        CPPUNIT_ASSERT_EQUAL(y >= 4 ? (y - 4) / 4 + 1 : 0, num_emitted);
+    }
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 6, chain.stream->finish());
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 6, num_emitted);
+}
+
+void TestLineBufferStream::runTestImageHeight() {
+    StreamedConvChain chain;
+    const uint64_t buffer_bytes = chain.stream->buffer_bytes();
+
+    // the windows hold kernel_height + stride_height rows of every operation
+    const uint64_t windows = (4 * 3 * 19 + 5 * 4 * 19 + 2 * 4 * 19 + 4 * 6 * 10) * sizeof(fp_t);
+    CPPUNIT_ASSERT(buffer_bytes >= windows);
+
+    // an image ten times as high needs the same memory
+    pico_cnn::naive::Tensor input(1, 3, 230, 19);
+    fill_random(&input, 6);
+    pico_cnn::naive::Tensor *expected = chain.run_layers(&input);
+    pico_cnn::naive::Tensor output(1, 6, StreamedConvChain::output_height(230), 5);
+    CPPUNIT_ASSERT_EQUAL(StreamedConvChain::output_height(230), chain.stream_rows(&input, 3, &output));
+    assert_almost_equal(expected, &output);
+    CPPUNIT_ASSERT_EQUAL(buffer_bytes, chain.stream->buffer_bytes());
+    delete expected;
+}
@@ -0,0 +1,25 @@
+#ifndef PICO_CNN_TEST_LINE_BUFFER_STREAM_H
+#define PICO_CNN_TEST_LINE_BUFFER_STREAM_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "../../pico-cnn/pico-cnn.h"
+
+
+class TestLineBufferStream : public CPPUNIT_NS::TestFixture {
+    CPPUNIT_TEST_SUITE(TestLineBufferStream);
+    CPPUNIT_TEST(runTestConvChain);
+    CPPUNIT_TEST(runTestIncremental);
+    CPPUNIT_TEST(runTestImageHeight);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() override;
+    void tearDown() override;
+
+    void runTestConvChain();
+    void runTestIncremental();
+    void runTestImageHeight();
+};
+
+
+#endif //PICO_CNN_TEST_LINE_BUFFER_STREAM_H
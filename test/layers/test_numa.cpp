@@ -0,0 +1,99 @@
+#include "test_numa.h"
+
+#include <cstdio>
+#include <fstream>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TestNuma);
+
+// sysfs of a dual-socket machine with hyper-threading and a node with memory only
+static const char *sysfs_root = "test_numa_sysfs";
+
+static void write_file(const std::string &path, const char *content) {
+    std::ofstream file(path);
+    file << content;
+}
+
+void TestNuma::setUp() {
+    mkdir(sysfs_root, 0755);
+    write_file(std::string(sysfs_root) + "/possible", "0-2\n");
+    const char *cpulists[] = {"0-1,4-5\n", "2-3,6-7\n", "\n"};
+    for(uint32_t node = 0; node < 3; node++) {
+        std::string directory = std::string(sysfs_root) + "/node" + std::to_string(node);
+        mkdir(directory.c_str(), 0755);
+        write_file(directory + "/cpulist", cpulists[node]);
+    }
+}
+
+void TestNuma::tearDown() {
+    for(uint32_t node = 0; node < 3; node++) {
+        std::string directory = std::string(sysfs_root) + "/node" + std::to_string(node);
+        std::remove((directory + "/cpulist").c_str());
+        rmdir(directory.c_str());
+    }
+    std::remove((std::string(sysfs_root) + "/possible").c_str());
+    rmdir(sysfs_root);
+}
+
+void TestNuma::runTestTopology() {
+    std::vector<uint32_t> cores = pico_cnn::naive::parse_cpulist("8-9,1,3-4\n");
+    CPPUNIT_ASSERT_EQUAL((size_t) 5, cores.size());
+    CPPUNIT_ASSERT_EQUAL(1u, cores[0]);
+    CPPUNIT_ASSERT_EQUAL(9u, cores[4]);
+
+    auto topology = pico_cnn::naive::NumaTopology::detect(sysfs_root);
+    CPPUNIT_ASSERT_EQUAL(2u, topology.num_nodes());
+    CPPUNIT_ASSERT_EQUAL((size_t) 4, topology.cores(1).size());
+    CPPUNIT_ASSERT_EQUAL(6u, topology.cores(1)[2]);
+
+    // workers alternate between the sockets
+    CPPUNIT_ASSERT_EQUAL(0u, topology.node_of_worker(0));
+    CPPUNIT_ASSERT_EQUAL(1u, topology.node_of_worker(1));
+    CPPUNIT_ASSERT_EQUAL(0u, topology.core_of_worker(0));
+    CPPUNIT_ASSERT_EQUAL(2u, topology.core_of_worker(1));
+    CPPUNIT_ASSERT_EQUAL(1u, topology.core_of_worker(2));
+    CPPUNIT_ASSERT_EQUAL(7u, topology.core_of_worker(7));
+    CPPUNIT_ASSERT_EQUAL(0u, topology.core_of_worker(8));
+
+    // without sysfs all cores form a single node
+    auto fallback = pico_cnn::naive::NumaTopology::detect("does_not_exist");
+    CPPUNIT_ASSERT_EQUAL(1u, fallback.num_nodes());
+    CPPUNIT_ASSERT_EQUAL((size_t) pico_cnn::naive::num_cores(), fallback.cores(0).size());
+}
+
+void TestNuma::runTestReplicas() {
+    auto topology = pico_cnn::naive::NumaTopology::detect(sysfs_root);
+
+    auto kernel = new pico_cnn::naive::Tensor(4, 1, 3, 3);
+    auto bias = new pico_cnn::naive::Tensor(4);
+    for(uint32_t i = 0; i < kernel->num_elements(); i++) {
+        kernel->access_blob(i) = i;
+    }
+    bias->access_blob(3) = 5;
+    pico_cnn::naive::Tensor *kernels[] = {kernel}, *biases[] = {bias};
+
+    auto weights = new pico_cnn::naive::NumaWeights(topology, kernels, 1, biases, 1);
+    CPPUNIT_ASSERT_EQUAL(2u, weights->num_replicas());
+    CPPUNIT_ASSERT(!kernel->owns_data_);
+
+    // a network of a worker on the second node reads its own copy
+    auto worker_kernel = new pico_cnn::naive::Tensor(4, 1, 3, 3);
+    auto worker_bias = new pico_cnn::naive::Tensor(4);
+    pico_cnn::naive::Tensor *worker_kernels[] = {worker_kernel}, *worker_biases[] = {worker_bias};
+    weights->use_replica(topology.node_of_worker(1), worker_kernels, worker_biases);
+
+    CPPUNIT_ASSERT(worker_kernel->data_ != kernel->data_);
+    CPPUNIT_ASSERT_EQUAL(0, (int32_t) ((uintptr_t) worker_kernel->data_ % 64));
+    for(uint32_t i = 0; i < kernel->num_elements(); i++) {
+        CPPUNIT_ASSERT_EQUAL((fp_t) i, worker_kernel->access_blob(i));
+    }
+    CPPUNIT_ASSERT_EQUAL((fp_t) 5, worker_bias->access_blob(3));
+
+    delete weights;
+    delete worker_bias;
+    delete worker_kernel;
+    delete bias;
+    delete kernel;
+}
@@ -0,0 +1,23 @@
+#ifndef PICO_CNN_TEST_NUMA_H
+#define PICO_CNN_TEST_NUMA_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "../../pico-cnn/pico-cnn.h"
+
+
+class TestNuma : public CPPUNIT_NS::TestFixture {
+    CPPUNIT_TEST_SUITE(TestNuma);
+    CPPUNIT_TEST(runTestTopology);
+    CPPUNIT_TEST(runTestReplicas);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() override;
+    void tearDown() override;
+
+    void runTestTopology();
+    void runTestReplicas();
+};
+
+
+#endif //PICO_CNN_TEST_NUMA_H
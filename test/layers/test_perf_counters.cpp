@@ -0,0 +1,94 @@
+#include "test_perf_counters.h"
+
+#include <sstream>
+#include <thread>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TestPerfCounters);
+
+/**
+ * Some work the compiler can not remove.
+ */
+static fp_t busy_work(uint32_t num_iterations) {
+    volatile fp_t sum = 0;
+    for(uint32_t i = 0; i < num_iterations; i++) {
+        sum = sum + (fp_t) i * 0.5f;
+    }
+    return sum;
+}
+
+void TestPerfCounters::setUp() {
+    TestFixture::setUp();
+}
+
+void TestPerfCounters::tearDown() {
+    TestFixture::tearDown();
+}
+
+void TestPerfCounters::runTestLayerProfiler() {
+    pico_cnn::naive::LayerProfiler profiler;
+
+    CPPUNIT_ASSERT_EQUAL(0u, profiler.add_layer("conv1", "Conv"));
+    CPPUNIT_ASSERT_EQUAL(1u, profiler.add_layer("relu1", "Relu"));
+    CPPUNIT_ASSERT_EQUAL(2u, profiler.add_layer("unused", "Softmax"));
+
+    for(uint32_t run = 0; run < 3; run++) {
+        pico_cnn::naive::PerfSample sample = profiler.begin();
+        busy_work(100000);
+        profiler.end(0, sample);
+
+        sample = profiler.begin();
+        busy_work(1000);
+        profiler.end(1, sample);
+    }
+
+    std::ostringstream report;
+    profiler.print(report);
+    std::string text = report.str();
+
+    CPPUNIT_ASSERT(text.find("conv1") != std::string::npos);
+    CPPUNIT_ASSERT(text.find("Relu") != std::string::npos);
+    CPPUNIT_ASSERT(text.find("unused") != std::string::npos);
+    CPPUNIT_ASSERT(text.find("total") != std::string::npos);
+
+    // without counters (e.g. in containers) the columns are reported as n/a
+    bool counters = pico_cnn::naive::LayerProfiler::available(pico_cnn::naive::PerfInstructions) &&
+                    pico_cnn::naive::LayerProfiler::available(pico_cnn::naive::PerfCycles);
+    CPPUNIT_ASSERT_EQUAL(!counters, text.find("conv1") < text.find("n/a") && text.find("n/a") < text.find("relu1"));
+}
+
+void TestPerfCounters::runTestLayerProfilerThreads() {
+    pico_cnn::naive::LayerProfiler profiler;
+    profiler.add_layer("first", "Conv");
+    profiler.add_layer("second", "Conv");
+
+    // every layer is measured on the thread running it, as in a TaskGraph
+    auto measure = [&profiler](uint32_t layer) {
+        for(uint32_t run = 0; run < 5; run++) {
+            pico_cnn::naive::PerfSample sample = profiler.begin();
+            busy_work(10000);
+            profiler.end(layer, sample);
+        }
+    };
+    std::thread first(measure, 0);
+    std::thread second(measure, 1);
+    first.join();
+    second.join();
+
+    std::ostringstream report;
+    profiler.print(report);
+    std::string text = report.str();
+
+    std::istringstream lines(text);
+    std::string line;
+    uint32_t num_layers = 0;
+    while(std::getline(lines, line)) {
+        std::istringstream fields(line);
+        std::string name, op_type;
+        uint32_t runs;
+        if(fields >> name >> op_type >> runs) {
+            CPPUNIT_ASSERT_EQUAL(5u, runs);
+            num_layers++;
+        }
+    }
+    CPPUNIT_ASSERT_EQUAL(2u, num_layers);
+}
@@ -0,0 +1,23 @@
+#ifndef PICO_CNN_TEST_PERF_COUNTERS_H
+#define PICO_CNN_TEST_PERF_COUNTERS_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "../../pico-cnn/pico-cnn.h"
+
+
+class TestPerfCounters : public CPPUNIT_NS::TestFixture {
+    CPPUNIT_TEST_SUITE(TestPerfCounters);
+    CPPUNIT_TEST(runTestLayerProfiler);
+    CPPUNIT_TEST(runTestLayerProfilerThreads);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() override;
+    void tearDown() override;
+
+    void runTestLayerProfiler();
+    void runTestLayerProfilerThreads();
+};
+
+
+#endif //PICO_CNN_TEST_PERF_COUNTERS_H
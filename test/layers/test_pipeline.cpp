@@ -0,0 +1,206 @@
+#include "test_pipeline.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TestPipeline);
+
+/**
+ * Yields until condition holds.
+ * @return false if it did not hold within a second
+ */
+template <typename Condition>
+static bool wait_until(Condition condition) {
+    auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while(!condition()) {
+        if(std::chrono::steady_clock::now() > timeout) {
+            return false;
+        }
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+void TestPipeline::setUp() {
+    TestFixture::setUp();
+}
+
+void TestPipeline::tearDown() {
+    TestFixture::tearDown();
+}
+
+void TestPipeline::runTestSpscRing() {
+
+    auto ring = new pico_cnn::naive::SpscRing<uint32_t>(3);
+    uint32_t value;
+
+    // head and tail are on separate cache lines
+    CPPUNIT_ASSERT_EQUAL((uintptr_t) 0, (uintptr_t) ring % 64);
+
+    CPPUNIT_ASSERT(!ring->try_pop(value));
+    CPPUNIT_ASSERT(ring->try_push(1));
+    CPPUNIT_ASSERT(ring->try_push(2));
+    CPPUNIT_ASSERT(ring->try_push(3));
+    CPPUNIT_ASSERT(!ring->try_push(4));
+
+    CPPUNIT_ASSERT(ring->try_pop(value));
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 1, value);
+    CPPUNIT_ASSERT(ring->try_push(4));
+
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 2, ring->pop());
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 3, ring->pop());
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 4, ring->pop());
+    CPPUNIT_ASSERT(!ring->try_pop(value));
+
+    delete ring;
+
+    // one producer and one consumer thread
+    auto shared_ring = new pico_cnn::naive::SpscRing<uint32_t>(4);
+    const uint32_t num_values = 10000;
+    std::thread producer([&] {
+        for(uint32_t i = 0; i < num_values; i++) {
+            shared_ring->push(i);
+        }
+    });
+    bool in_order = true;
+    for(uint32_t i = 0; i < num_values; i++) {
+        in_order = in_order && shared_ring->pop() == i;
+    }
+    producer.join();
+
+    CPPUNIT_ASSERT(in_order);
+
+    delete shared_ring;
+}
+
+void TestPipeline::runTestPipelineOrder() {
+
+    // stage 0: (2, 4) -> (2, 4) x + 1
+    // stage 1: (2, 4) -> (8) 2 * x
+    // stage 2: (8) -> (1) sum
+    auto pipeline = new pico_cnn::naive::Pipeline([] { return new pico_cnn::naive::Tensor(2, 4); }, 3, -1);
+    pipeline->add_stage([](pico_cnn::naive::Tensor *input, pico_cnn::naive::Tensor *output) {
+        for(uint32_t i = 0; i < input->num_elements(); i++) {
+            output->access_blob(i) = input->access_blob(i) + 1;
+        }
+    }, [] { return new pico_cnn::naive::Tensor(2, 4); });
+    pipeline->add_stage([](pico_cnn::naive::Tensor *input, pico_cnn::naive::Tensor *output) {
+        for(uint32_t i = 0; i < input->num_elements(); i++) {
+            output->access_blob(i) = 2 * input->access_blob(i);
+        }
+    }, [] { return new pico_cnn::naive::Tensor(8); });
+    pipeline->add_stage([](pico_cnn::naive::Tensor *input, pico_cnn::naive::Tensor *output) {
+        output->access_blob(0) = 0;
+        for(uint32_t i = 0; i < input->num_elements(); i++) {
+            output->access_blob(0) += input->access_blob(i);
+        }
+    }, [] { return new pico_cnn::naive::Tensor(1); });
+
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 3, pipeline->num_stages());
+
+    const uint64_t num_frames = 100;
+    std::vector<fp_t> results;
+
+    auto statistics = pipeline->run([&](pico_cnn::naive::Tensor *input, uint64_t frame) {
+        if(frame == num_frames) {
+            return false;
+        }
+        for(uint32_t i = 0; i < input->num_elements(); i++) {
+            input->access_blob(i) = frame;
+        }
+        return true;
+    }, [&](pico_cnn::naive::Tensor *output, uint64_t frame) {
+        CPPUNIT_ASSERT_EQUAL((uint64_t) results.size(), frame);
+        results.push_back(output->access_blob(0));
+    });
+
+    CPPUNIT_ASSERT_EQUAL(num_frames, statistics.num_frames);
+    CPPUNIT_ASSERT_EQUAL((size_t) 3, statistics.stage_busy_seconds.size());
+    CPPUNIT_ASSERT_EQUAL((size_t) num_frames, results.size());
+    for(uint64_t frame = 0; frame < num_frames; frame++) {
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(8 * 2 * (frame + 1.0), results[frame], 1e-3);
+    }
+
+    delete pipeline;
+}
+
+void TestPipeline::runTestPipelineSingleStage() {
+
+    // the kernels of a stage do not split their loops among the threads of the global pool
+    uint32_t stage_intra_op_threads = 0;
+
+    auto pipeline = new pico_cnn::naive::Pipeline([] { return new pico_cnn::naive::Tensor(1); }, 1, -1);
+    pipeline->add_stage([&](pico_cnn::naive::Tensor *input, pico_cnn::naive::Tensor *output) {
+        stage_intra_op_threads = pico_cnn::naive::intra_op_threads();
+        output->access_blob(0) = -input->access_blob(0);
+    }, [] { return new pico_cnn::naive::Tensor(1); });
+
+    fp_t sum = 0;
+
+    // the pipeline can be run several times
+    for(uint32_t run = 0; run < 2; run++) {
+        auto statistics = pipeline->run([](pico_cnn::naive::Tensor *input, uint64_t frame) {
+            input->access_blob(0) = frame;
+            return frame < 10;
+        }, [&](pico_cnn::naive::Tensor *output, uint64_t frame) {
+            sum += output->access_blob(0);
+        });
+
+        CPPUNIT_ASSERT_EQUAL((uint64_t) 10, statistics.num_frames);
+    }
+
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(-90.0, sum, 1e-3);
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 1, stage_intra_op_threads);
+
+    delete pipeline;
+}
+
+void TestPipeline::runTestPipelineEndWhileBusy() {
+    const uint32_t depth = 3;
+    auto pipeline = new pico_cnn::naive::Pipeline([] { return new pico_cnn::naive::Tensor(1); }, depth, -1);
+
+    std::atomic<bool> ending(false);
+    std::atomic<bool> source_ended(false);
+    std::atomic<uint64_t> frames_in(0);
+    std::atomic<bool> timed_out(false);
+
+    pipeline->add_stage([&](pico_cnn::naive::Tensor *input, pico_cnn::naive::Tensor *output) {
+        const uint64_t frame = (uint64_t) input->access_blob(0);
+        if(ending) {
+            // the source ends the stream while the stage still works on the last frame
+            if(frame == depth - 1 && !wait_until([&] { return source_ended.load(); })) {
+                timed_out = true;
+            }
+        } else {
+            // the source can fill all input tensors while the stage holds the first frame
+            if(frame == 0 && !wait_until([&] { return frames_in.load() == depth; })) {
+                timed_out = true;
+            }
+        }
+        output->access_blob(0) = frame;
+    }, [] { return new pico_cnn::naive::Tensor(1); });
+
+    for(uint32_t run = 0; run < 20; run++) {
+        ending = run % 2 == 0;
+        source_ended = false;
+        frames_in = 0;
+
+        auto statistics = pipeline->run([&](pico_cnn::naive::Tensor *input, uint64_t frame) {
+            if(frame == depth) {
+                source_ended = true;
+                return false;
+            }
+            input->access_blob(0) = frame;
+            frames_in++;
+            return true;
+        }, [&](pico_cnn::naive::Tensor *output, uint64_t frame) {
+            CPPUNIT_ASSERT_DOUBLES_EQUAL((fp_t) frame, output->access_blob(0), 1e-6);
+        });
+
+        CPPUNIT_ASSERT_EQUAL((uint64_t) depth, statistics.num_frames);
+        CPPUNIT_ASSERT(!timed_out);
+    }
+
+    delete pipeline;
+}
@@ -0,0 +1,27 @@
+#ifndef PICO_CNN_TEST_PIPELINE_H
+#define PICO_CNN_TEST_PIPELINE_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "../../pico-cnn/pico-cnn.h"
+
+
+class TestPipeline : public CPPUNIT_NS::TestFixture {
+    CPPUNIT_TEST_SUITE(TestPipeline);
+    CPPUNIT_TEST(runTestSpscRing);
+    CPPUNIT_TEST(runTestPipelineOrder);
+    CPPUNIT_TEST(runTestPipelineSingleStage);
+    CPPUNIT_TEST(runTestPipelineEndWhileBusy);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() override;
+    void tearDown() override;
+
+    void runTestSpscRing();
+    void runTestPipelineOrder();
+    void runTestPipelineSingleStage();
+    void runTestPipelineEndWhileBusy();
+};
+
+
+#endif //PICO_CNN_TEST_PIPELINE_H
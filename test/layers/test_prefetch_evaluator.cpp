@@ -0,0 +1,153 @@
+#include "test_prefetch_evaluator.h"
+
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TestPrefetchEvaluator);
+
+/**
+ * Sample i has label i % 10 and contains the value i in every element.
+ */
+class CountingSource : public pico_cnn::naive::SampleSource {
+public:
+    explicit CountingSource(uint32_t num_samples) : num_samples_(num_samples) {}
+
+    uint32_t num_samples() const override {
+        return num_samples_;
+    }
+
+    int32_t load(uint32_t index, pico_cnn::naive::Tensor *input, uint32_t *label) override {
+        for(uint32_t i = 0; i < input->num_elements(); i++) {
+            input->access_blob(i) = index;
+        }
+        *label = index % 10;
+        return 0;
+    }
+
+private:
+    uint32_t num_samples_;
+};
+
+void TestPrefetchEvaluator::setUp() {
+    TestFixture::setUp();
+}
+
+void TestPrefetchEvaluator::tearDown() {
+    TestFixture::tearDown();
+}
+
+void TestPrefetchEvaluator::runTestPrefetchEvaluatorAccuracy() {
+
+    auto source = new CountingSource(100);
+    auto output_tensor = new pico_cnn::naive::Tensor(1, 10);
+
+    auto evaluator = new pico_cnn::naive::PrefetchEvaluator(source, [] {
+        return new pico_cnn::naive::Tensor(1, 1, 2, 2);
+    }, 4, 3);
+
+    // "network" predicting class (x + offset) % 10 first, followed by the next classes with decreasing score:
+    // the correct class is ranked (10 - offset) % 10, so it is within the top-5 for offset 0 and offset >= 6
+    for(uint32_t offset = 0; offset < 10; offset++) {
+        uint32_t expected_order = 0;
+        bool in_order = true;
+        auto result = evaluator->evaluate([&](pico_cnn::naive::Tensor *input, pico_cnn::naive::Tensor *output) {
+            uint32_t sample = (uint32_t) input->access_blob(0);
+            in_order = in_order && sample == expected_order++;
+            for(uint32_t i = 0; i < 10; i++) {
+                output->access_blob((sample + offset + i) % 10) = 10.0 - i;
+            }
+        }, output_tensor);
+
+        CPPUNIT_ASSERT(in_order);
+        CPPUNIT_ASSERT_EQUAL((uint32_t) 100, result.num_samples);
+        CPPUNIT_ASSERT_EQUAL((uint32_t) 0, result.num_errors);
+        CPPUNIT_ASSERT_EQUAL(offset == 0 ? (uint32_t) 100 : (uint32_t) 0, result.top1_correct);
+        CPPUNIT_ASSERT_EQUAL(offset == 0 || offset >= 6 ? (uint32_t) 100 : (uint32_t) 0, result.top5_correct);
+    }
+
+    auto result = evaluator->evaluate([](pico_cnn::naive::Tensor *input, pico_cnn::naive::Tensor *output) {
+        for(uint32_t i = 0; i < 10; i++) {
+            output->access_blob(i) = (i == ((uint32_t) input->access_blob(0)) % 10) ? 1.0 : 0.0;
+        }
+    }, output_tensor, 25);
+
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 25, result.num_samples);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, result.top1_accuracy, 1e-6);
+
+    delete evaluator;
+    delete output_tensor;
+    delete source;
+}
+
+void TestPrefetchEvaluator::runTestMnistSource() {
+
+    // two 2x2 images in idx format (big-endian header)
+    const char *images_path = "test_mnist_source_images.idx3-ubyte";
+    const char *labels_path = "test_mnist_source_labels.idx1-ubyte";
+
+    uint8_t images[16 + 8] = {0, 0, 8, 3, 0, 0, 0, 2, 0, 0, 0, 2, 0, 0, 0, 2,
+                              0, 255, 51, 102,
+                              255, 255, 0, 0};
+    uint8_t labels[8 + 2] = {0, 0, 8, 1, 0, 0, 0, 2, 7, 3};
+
+    FILE *file = fopen(images_path, "wb");
+    fwrite(images, 1, sizeof(images), file);
+    fclose(file);
+    file = fopen(labels_path, "wb");
+    fwrite(labels, 1, sizeof(labels), file);
+    fclose(file);
+
+    auto source = new pico_cnn::naive::MnistSource(images_path, labels_path, 0, 1, 0.0, 1.0);
+    CPPUNIT_ASSERT(source->valid());
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 2, source->num_samples());
+
+    auto input_tensor = new pico_cnn::naive::Tensor(1, 1, 4, 4);
+    auto expected_tensor = new pico_cnn::naive::Tensor(1, 1, 4, 4);
+    uint32_t label;
+
+    CPPUNIT_ASSERT_EQUAL((int32_t) 0, source->load(1, input_tensor, &label));
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 3, label);
+    expected_tensor->access(0, 0, 1, 1, 1, 4, 4) = 1.0;
+    expected_tensor->access(0, 0, 1, 2, 1, 4, 4) = 1.0;
+    CPPUNIT_ASSERT(*input_tensor == *expected_tensor);
+
+    CPPUNIT_ASSERT_EQUAL((int32_t) 0, source->load(0, input_tensor, &label));
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 7, label);
+    expected_tensor->access(0, 0, 1, 1, 1, 4, 4) = 0.0;
+    expected_tensor->access(0, 0, 1, 2, 1, 4, 4) = 1.0;
+    expected_tensor->access(0, 0, 2, 1, 1, 4, 4) = 0.2;
+    expected_tensor->access(0, 0, 2, 2, 1, 4, 4) = 0.4;
+    CPPUNIT_ASSERT(*input_tensor == *expected_tensor);
+
+    CPPUNIT_ASSERT(source->load(2, input_tensor, &label) != 0);
+
+    // concurrent loads of different images use their own buffers and do not wait for each other
+    std::atomic<uint32_t> mismatches(0);
+    std::vector<std::thread> threads;
+    for(uint32_t thread = 0; thread < 4; thread++) {
+        threads.push_back(std::thread([&, thread] {
+            pico_cnn::naive::Tensor tensor(1, 1, 4, 4);
+            uint32_t thread_label;
+            for(uint32_t i = 0; i < 1000; i++) {
+                uint32_t index = (thread + i) % 2;
+                if(source->load(index, &tensor, &thread_label) != 0 || thread_label != (index == 0 ? 7u : 3u) ||
+                   fabs(tensor.access(0, 0, 1, 1, 1, 4, 4) - (index == 0 ? 0.0 : 1.0)) > 1e-5) {
+                    mismatches.fetch_add(1);
+                }
+            }
+        }));
+    }
+    for(std::thread &thread: threads) {
+        thread.join();
+    }
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 0, mismatches.load());
+
+    delete expected_tensor;
+    delete input_tensor;
+    delete source;
+
+    remove(images_path);
+    remove(labels_path);
+}
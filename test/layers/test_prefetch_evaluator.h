@@ -0,0 +1,23 @@
+#ifndef PICO_CNN_TEST_PREFETCH_EVALUATOR_H
+#define PICO_CNN_TEST_PREFETCH_EVALUATOR_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "../../pico-cnn/pico-cnn.h"
+
+
+class TestPrefetchEvaluator : public CPPUNIT_NS::TestFixture {
+    CPPUNIT_TEST_SUITE(TestPrefetchEvaluator);
+    CPPUNIT_TEST(runTestPrefetchEvaluatorAccuracy);
+    CPPUNIT_TEST(runTestMnistSource);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() override;
+    void tearDown() override;
+
+    void runTestPrefetchEvaluatorAccuracy();
+    void runTestMnistSource();
+};
+
+
+#endif //PICO_CNN_TEST_PREFETCH_EVALUATOR_H
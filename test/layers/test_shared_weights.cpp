@@ -0,0 +1,83 @@
+#include "test_shared_weights.h"
+
+#include <cstdio>
+
+#include <sys/mman.h>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TestSharedWeights);
+
+static const char *weights_path = "test_shared_weights.weights.bin";
+static const char *segment_name = "/pico-cnn-test-shared-weights";
+
+/**
+ * Writes a weights file with a single convolution with a kernel of shape (2, 1, 1, 2) and two biases.
+ */
+static void write_test_weights(const char *path, const fp_t *kernel, const fp_t *bias) {
+    FILE *file = fopen(path, "wb");
+    fputs("FD\ntest\n", file);
+    uint32_t num_layers = 1;
+    fwrite(&num_layers, sizeof(num_layers), 1, file);
+    fputs("conv\nConv\n", file);
+    uint32_t kernel_shape[4] = {2, 1, 1, 2};
+    fwrite(kernel_shape, sizeof(uint32_t), 4, file);
+    fwrite(kernel, sizeof(fp_t), 4, file);
+    uint32_t num_biases = 2;
+    fwrite(&num_biases, sizeof(num_biases), 1, file);
+    fwrite(bias, sizeof(fp_t), 2, file);
+    fputs("end\n", file);
+    fclose(file);
+}
+
+void TestSharedWeights::setUp() {
+    const fp_t kernel[4] = {1, 2, 3, 4};
+    const fp_t bias[2] = {5, 6};
+    write_test_weights(weights_path, kernel, bias);
+    shm_unlink(segment_name);
+}
+
+void TestSharedWeights::tearDown() {
+    shm_unlink(segment_name);
+    std::remove(weights_path);
+}
+
+void TestSharedWeights::runTestCreateAndAttach() {
+    // the first network creates the segment from the weights file
+    auto kernel = new pico_cnn::naive::Tensor(2, 1, 1, 2);
+    auto bias = new pico_cnn::naive::Tensor(2);
+    pico_cnn::naive::Tensor *kernels[] = {kernel}, *biases[] = {bias};
+
+    CPPUNIT_ASSERT_EQUAL(0, read_shared_weights(weights_path, segment_name, kernels, 1, biases, 1));
+    CPPUNIT_ASSERT(!kernel->owns_data_);
+    CPPUNIT_ASSERT_EQUAL(0, (int32_t) ((uintptr_t) kernel->data_ % 64));
+    CPPUNIT_ASSERT_EQUAL((fp_t) 4, kernel->data_[3]);
+    CPPUNIT_ASSERT_EQUAL((fp_t) 6, bias->data_[1]);
+
+    // the second one attaches without reading the weights file
+    auto attached_kernel = new pico_cnn::naive::Tensor(2, 1, 1, 2);
+    auto attached_bias = new pico_cnn::naive::Tensor(2);
+    pico_cnn::naive::Tensor *attached_kernels[] = {attached_kernel}, *attached_biases[] = {attached_bias};
+
+    CPPUNIT_ASSERT_EQUAL(0, read_shared_weights("does_not_exist.weights.bin", segment_name,
+                                                attached_kernels, 1, attached_biases, 1));
+    CPPUNIT_ASSERT(!attached_kernel->owns_data_);
+    for(uint32_t i = 0; i < 4; i++) {
+        CPPUNIT_ASSERT_EQUAL(kernel->data_[i], attached_kernel->data_[i]);
+    }
+    CPPUNIT_ASSERT_EQUAL((fp_t) 5, attached_bias->data_[0]);
+
+    // a network with other shapes is rejected
+    auto other_kernel = new pico_cnn::naive::Tensor(2, 1, 1, 3);
+    pico_cnn::naive::Tensor *other_kernels[] = {other_kernel};
+    CPPUNIT_ASSERT_EQUAL(1, read_shared_weights(weights_path, segment_name, other_kernels, 1, attached_biases, 1, nullptr,
+                                                0, 100));
+    CPPUNIT_ASSERT(other_kernel->owns_data_);
+
+    CPPUNIT_ASSERT_EQUAL(0, unlink_shared_weights(segment_name));
+    CPPUNIT_ASSERT_EQUAL(1, unlink_shared_weights(segment_name));
+
+    delete other_kernel;
+    delete attached_bias;
+    delete attached_kernel;
+    delete bias;
+    delete kernel;
+}
@@ -0,0 +1,21 @@
+#ifndef PICO_CNN_TEST_SHARED_WEIGHTS_H
+#define PICO_CNN_TEST_SHARED_WEIGHTS_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "../../pico-cnn/pico-cnn.h"
+
+
+class TestSharedWeights : public CPPUNIT_NS::TestFixture {
+    CPPUNIT_TEST_SUITE(TestSharedWeights);
+    CPPUNIT_TEST(runTestCreateAndAttach);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() override;
+    void tearDown() override;
+
+    void runTestCreateAndAttach();
+};
+
+
+#endif //PICO_CNN_TEST_SHARED_WEIGHTS_H
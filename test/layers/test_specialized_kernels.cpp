@@ -0,0 +1,116 @@
+#include "test_specialized_kernels.h"
+
+#include "test_helpers.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TestSpecializedKernels);
+
+/**
+ * Runs pico_cnn::naive::Convolution and the specialized Conv2d on the same random input and compares the outputs.
+ */
+template<uint32_t OutChannels, uint32_t KernelHeight, uint32_t KernelWidth, uint32_t StrideHeight, uint32_t StrideWidth,
+         uint32_t InChannels, uint32_t InHeight, uint32_t InWidth,
+         uint32_t PadTop, uint32_t PadLeft, uint32_t PadBottom, uint32_t PadRight, uint32_t Groups>
+static void compare_conv2d(bool with_bias) {
+    typedef pico_cnn::naive::Conv2d<OutChannels, KernelHeight, KernelWidth, StrideHeight, StrideWidth,
+                                    InChannels, InHeight, InWidth, PadTop, PadLeft, PadBottom, PadRight, Groups> Conv;
+
+    auto input = new pico_cnn::naive::Tensor(1, InChannels, InHeight, InWidth);
+    auto kernel = new pico_cnn::naive::Tensor(OutChannels, InChannels / Groups, KernelHeight, KernelWidth);
+    auto bias = new pico_cnn::naive::Tensor(OutChannels);
+    auto expected = new pico_cnn::naive::Tensor(1, OutChannels, Conv::OutHeight, Conv::OutWidth);
+    auto output = new pico_cnn::naive::Tensor(1, OutChannels, Conv::OutHeight, Conv::OutWidth);
+
+    fill_random(input, 1);
+    fill_random(kernel, 2);
+    fill_random(bias, 3);
+
+    uint32_t padding[4] = {PadTop, PadLeft, PadBottom, PadRight};
+    uint32_t stride[2] = {StrideHeight, StrideWidth};
+    bool padding_needed = PadTop + PadLeft + PadBottom + PadRight > 0;
+
+    auto generic = new pico_cnn::naive::Convolution("conv", 0, pico_cnn::op_type::Conv, kernel,
+                                                    with_bias ? bias : nullptr, padding_needed ? padding : nullptr,
+                                                    stride, Groups);
+    auto specialized = new Conv("conv", 0, pico_cnn::op_type::Conv, kernel, with_bias ? bias : nullptr);
+
+    generic->run(input, expected);
+    specialized->run(input, output);
+
+    assert_almost_equal(expected, output);
+
+    delete specialized;
+    delete generic;
+    delete output;
+    delete expected;
+    delete bias;
+    delete kernel;
+    delete input;
+}
+
+void TestSpecializedKernels::setUp() {
+    TestFixture::setUp();
+}
+
+void TestSpecializedKernels::tearDown() {
+    TestFixture::tearDown();
+}
+
+void TestSpecializedKernels::runTestConv2d() {
+    compare_conv2d<4, 3, 3, 1, 1, 3, 10, 10, 0, 0, 0, 0, 1>(true);
+    compare_conv2d<5, 1, 1, 1, 1, 6, 7, 9, 0, 0, 0, 0, 1>(false);
+    compare_conv2d<2, 5, 5, 1, 1, 2, 12, 12, 0, 0, 0, 0, 1>(true);
+}
+
+void TestSpecializedKernels::runTestConv2dPaddingStride() {
+    compare_conv2d<4, 3, 3, 1, 1, 3, 8, 8, 1, 1, 1, 1, 1>(true);
+    compare_conv2d<3, 3, 3, 2, 2, 2, 9, 9, 1, 1, 1, 1, 1>(true);
+    compare_conv2d<3, 5, 3, 2, 1, 2, 11, 7, 2, 0, 1, 1, 1>(false);
+    compare_conv2d<2, 11, 11, 4, 4, 3, 31, 31, 2, 2, 2, 2, 1>(true);
+}
+
+void TestSpecializedKernels::runTestConv2dGroups() {
+    // depthwise
+    compare_conv2d<4, 3, 3, 1, 1, 4, 8, 8, 1, 1, 1, 1, 4>(true);
+    compare_conv2d<4, 3, 3, 2, 2, 4, 9, 9, 1, 1, 1, 1, 4>(false);
+}
+
+template<uint32_t KernelHeight, uint32_t KernelWidth, uint32_t StrideHeight, uint32_t StrideWidth,
+         uint32_t Channels, uint32_t InHeight, uint32_t InWidth,
+         uint32_t PadTop, uint32_t PadLeft, uint32_t PadBottom, uint32_t PadRight>
+static void compare_max_pool2d() {
+    typedef pico_cnn::naive::MaxPool2d<KernelHeight, KernelWidth, StrideHeight, StrideWidth,
+                                       Channels, InHeight, InWidth, PadTop, PadLeft, PadBottom, PadRight> Pool;
+
+    auto input = new pico_cnn::naive::Tensor(1, Channels, InHeight, InWidth);
+    auto expected = new pico_cnn::naive::Tensor(1, Channels, Pool::OutHeight, Pool::OutWidth);
+    auto output = new pico_cnn::naive::Tensor(1, Channels, Pool::OutHeight, Pool::OutWidth);
+
+    fill_random(input, 4);
+
+    uint32_t kernel_size[2] = {KernelHeight, KernelWidth};
+    uint32_t padding[4] = {PadTop, PadLeft, PadBottom, PadRight};
+    uint32_t stride[2] = {StrideHeight, StrideWidth};
+    bool padding_needed = PadTop + PadLeft + PadBottom + PadRight > 0;
+
+    auto generic = new pico_cnn::naive::MaxPooling("pool", 0, pico_cnn::op_type::MaxPool, kernel_size, stride,
+                                                   padding_needed ? padding : nullptr);
+    auto specialized = new Pool("pool", 0, pico_cnn::op_type::MaxPool);
+
+    generic->run(input, expected);
+    specialized->run(input, output);
+
+    assert_almost_equal(expected, output);
+
+    delete specialized;
+    delete generic;
+    delete output;
+    delete expected;
+    delete input;
+}
+
+void TestSpecializedKernels::runTestMaxPool2d() {
+    compare_max_pool2d<2, 2, 2, 2, 3, 8, 8, 0, 0, 0, 0>();
+    compare_max_pool2d<3, 3, 2, 2, 2, 9, 9, 0, 0, 0, 0>();
+    compare_max_pool2d<3, 3, 1, 1, 2, 6, 6, 1, 1, 1, 1>();
+    compare_max_pool2d<2, 2, 2, 2, 2, 7, 7, 0, 0, 1, 1>();
+}
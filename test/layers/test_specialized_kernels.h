@@ -0,0 +1,27 @@
+#ifndef PICO_CNN_TEST_SPECIALIZED_KERNELS_H
+#define PICO_CNN_TEST_SPECIALIZED_KERNELS_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "../../pico-cnn/pico-cnn.h"
+
+
+class TestSpecializedKernels : public CPPUNIT_NS::TestFixture {
+    CPPUNIT_TEST_SUITE(TestSpecializedKernels);
+    CPPUNIT_TEST(runTestConv2d);
+    CPPUNIT_TEST(runTestConv2dPaddingStride);
+    CPPUNIT_TEST(runTestConv2dGroups);
+    CPPUNIT_TEST(runTestMaxPool2d);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() override;
+    void tearDown() override;
+
+    void runTestConv2d();
+    void runTestConv2dPaddingStride();
+    void runTestConv2dGroups();
+    void runTestMaxPool2d();
+};
+
+
+#endif //PICO_CNN_TEST_SPECIALIZED_KERNELS_H
@@ -0,0 +1,116 @@
+#include "test_task_graph.h"
+
+#include <atomic>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TestTaskGraph);
+
+void TestTaskGraph::setUp() {
+    TestFixture::setUp();
+}
+
+void TestTaskGraph::tearDown() {
+    TestFixture::tearDown();
+}
+
+void TestTaskGraph::runTestTaskGraphDiamond() {
+
+    // a -> (b, c) -> d, every task records its position in the execution order
+    std::atomic<uint32_t> counter(0);
+    uint32_t position[4] = {0, 0, 0, 0};
+
+    auto graph = new pico_cnn::naive::TaskGraph(4);
+
+    uint32_t a = graph->add_task([&] { position[0] = counter.fetch_add(1); });
+    uint32_t b = graph->add_task([&] { position[1] = counter.fetch_add(1); });
+    uint32_t c = graph->add_task([&] { position[2] = counter.fetch_add(1); });
+    uint32_t d = graph->add_task([&] { position[3] = counter.fetch_add(1); });
+
+    graph->add_dependency(b, a);
+    graph->add_dependency(c, a);
+    graph->add_dependency(d, b);
+    graph->add_dependency(d, c);
+    graph->finalize();
+
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 2, graph->inter_op_width());
+
+    graph->run();
+
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 4, counter.load());
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 0, position[0]);
+    CPPUNIT_ASSERT(position[1] > position[0] && position[1] < position[3]);
+    CPPUNIT_ASSERT(position[2] > position[0] && position[2] < position[3]);
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 3, position[3]);
+
+    delete graph;
+}
+
+void TestTaskGraph::runTestTaskGraphWidth() {
+
+    auto graph = new pico_cnn::naive::TaskGraph();
+
+    // chain of three tasks next to five independent tasks
+    uint32_t first = graph->add_task([] {});
+    uint32_t second = graph->add_task([] {});
+    uint32_t third = graph->add_task([] {});
+    graph->add_dependency(second, first);
+    graph->add_dependency(third, second);
+    for(uint32_t i = 0; i < 5; i++) {
+        graph->add_task([] {});
+    }
+    graph->finalize();
+
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 8, graph->num_tasks());
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 6, graph->inter_op_width());
+    CPPUNIT_ASSERT(graph->num_threads() >= 1 && graph->num_threads() <= 6);
+    CPPUNIT_ASSERT(graph->intra_op_threads() >= 1);
+
+    delete graph;
+}
+
+void TestTaskGraph::runTestTaskGraphRepeatedRuns() {
+
+    // every layer of the graph sums up the values of the previous one, the result only
+    // matches if all dependencies were respected in every run
+    const uint32_t width = 8;
+    const uint32_t depth = 6;
+    uint32_t values[depth][width];
+
+    auto graph = new pico_cnn::naive::TaskGraph(4);
+
+    uint32_t ids[depth][width];
+    for(uint32_t level = 0; level < depth; level++) {
+        for(uint32_t i = 0; i < width; i++) {
+            ids[level][i] = graph->add_task([&values, level, i, width] {
+                if(level == 0) {
+                    values[level][i] = 1;
+                } else {
+                    uint32_t sum = 0;
+                    for(uint32_t j = 0; j < width; j++) {
+                        sum += values[level - 1][j];
+                    }
+                    values[level][i] = sum;
+                }
+            });
+            if(level > 0) {
+                for(uint32_t j = 0; j < width; j++) {
+                    graph->add_dependency(ids[level][i], ids[level - 1][j]);
+                }
+            }
+        }
+    }
+
+    for(uint32_t run = 0; run < 50; run++) {
+        std::memset(values, 0, sizeof(values));
+        graph->run();
+
+        uint32_t expected = 1;
+        for(uint32_t level = 0; level < depth; level++) {
+            for(uint32_t i = 0; i < width; i++) {
+                CPPUNIT_ASSERT_EQUAL(expected, values[level][i]);
+            }
+            expected *= width;
+        }
+    }
+
+    delete graph;
+}
@@ -0,0 +1,26 @@
+
+#ifndef PICO_CNN_TEST_TASK_GRAPH_H
+#define PICO_CNN_TEST_TASK_GRAPH_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "../../pico-cnn/pico-cnn.h"
+
+
+class TestTaskGraph : public CPPUNIT_NS::TestFixture {
+    CPPUNIT_TEST_SUITE(TestTaskGraph);
+    CPPUNIT_TEST(runTestTaskGraphDiamond);
+    CPPUNIT_TEST(runTestTaskGraphWidth);
+    CPPUNIT_TEST(runTestTaskGraphRepeatedRuns);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() override;
+    void tearDown() override;
+
+    void runTestTaskGraphDiamond();
+    void runTestTaskGraphWidth();
+    void runTestTaskGraphRepeatedRuns();
+};
+
+
+#endif //PICO_CNN_TEST_TASK_GRAPH_H
@@ -1,5 +1,7 @@
 #include "test_tensor.h"
 
+#include <algorithm>
+
 CPPUNIT_TEST_SUITE_REGISTRATION(TestTensor);
 
 void TestTensor::setUp(){
@@ -401,3 +403,278 @@ void TestTensor::runTestTensorConcatDim0() {
     delete expected_output_tensor;
     delete output_tensor;
 }
+
+/**
+ * Compares Tensor::transpose_into() with the element-wise definition for one permutation of a 4D tensor.
+ */
+static void compare_transpose(uint32_t x0, uint32_t x1, uint32_t x2, uint32_t x3, const uint32_t *permutation) {
+    const uint32_t shape[4] = {x0, x1, x2, x3};
+    auto *input = new pico_cnn::naive::Tensor(x0, x1, x2, x3);
+    auto *output = new pico_cnn::naive::Tensor(shape[permutation[0]], shape[permutation[1]],
+                                               shape[permutation[2]], shape[permutation[3]]);
+
+    for(uint32_t i = 0; i < input->num_elements(); i++) {
+        input->access_blob(i) = i;
+    }
+
+    input->transpose_into(output, permutation);
+
+    uint32_t index[4];
+    for(index[0] = 0; index[0] < x0; index[0]++) {
+        for(index[1] = 0; index[1] < x1; index[1]++) {
+            for(index[2] = 0; index[2] < x2; index[2]++) {
+                for(index[3] = 0; index[3] < x3; index[3]++) {
+                    fp_t expected = input->access(index[0], index[1], index[2], index[3], x1, x2, x3);
+                    fp_t actual = output->access(index[permutation[0]], index[permutation[1]],
+                                                 index[permutation[2]], index[permutation[3]],
+                                                 shape[permutation[1]], shape[permutation[2]],
+                                                 shape[permutation[3]]);
+                    CPPUNIT_ASSERT_EQUAL(expected, actual);
+                }
+            }
+        }
+    }
+
+    delete input;
+    delete output;
+}
+
+void TestTensor::runTestTensorTranspose() {
+    // NCHW -> NHWC and back, sizes are no multiples of the tiles
+    const uint32_t to_nhwc[4] = {0, 2, 3, 1};
+    const uint32_t to_nchw[4] = {0, 3, 1, 2};
+    compare_transpose(2, 37, 5, 41, to_nhwc);
+    compare_transpose(2, 5, 41, 37, to_nchw);
+
+    // innermost dimension is kept, only rows are moved
+    const uint32_t swap_outer[4] = {2, 1, 0, 3};
+    compare_transpose(3, 4, 5, 6, swap_outer);
+
+    // dimensions of size 1 are ignored
+    const uint32_t swap_unit[4] = {0, 2, 1, 3};
+    compare_transpose(1, 1, 7, 9, swap_unit);
+    const uint32_t reverse[4] = {3, 2, 1, 0};
+    compare_transpose(1, 64, 1, 33, reverse);
+
+    // 2D
+    auto *matrix = new pico_cnn::naive::Tensor(70, 35);
+    auto *transposed = new pico_cnn::naive::Tensor(35, 70);
+    for(uint32_t i = 0; i < matrix->num_elements(); i++) {
+        matrix->access_blob(i) = i;
+    }
+    const uint32_t transpose_2d[2] = {1, 0};
+    matrix->transpose_into(transposed, transpose_2d);
+    for(uint32_t row = 0; row < 70; row++) {
+        for(uint32_t col = 0; col < 35; col++) {
+            CPPUNIT_ASSERT_EQUAL(matrix->access(row, col, 35), transposed->access(col, row, 70));
+        }
+    }
+
+    delete matrix;
+    delete transposed;
+}
+
+void TestTensor::runTestTensorChannelView() {
+    auto *output_tensor = new pico_cnn::naive::Tensor(1, 5, 3, 3);
+    auto *expected_output_tensor = new pico_cnn::naive::Tensor(1, 5, 3, 3);
+
+    // channels 0 and 1 are written through a view, channels 2 to 4 are copied from a separate tensor
+    pico_cnn::naive::Tensor *view = output_tensor->channel_view(0, 2);
+    auto *input_tensor = new pico_cnn::naive::Tensor(1, 3, 3, 3);
+
+    CPPUNIT_ASSERT_EQUAL(4u, view->num_dimensions());
+    CPPUNIT_ASSERT_EQUAL(2u, view->num_channels());
+    CPPUNIT_ASSERT_EQUAL(18u, view->num_elements());
+
+    for(uint32_t i = 0; i < view->num_elements(); i++) {
+        view->access_blob(i) = i + 1;
+    }
+    for(uint32_t i = 0; i < input_tensor->num_elements(); i++) {
+        input_tensor->access_blob(i) = i + 19;
+    }
+    for(uint32_t i = 0; i < expected_output_tensor->num_elements(); i++) {
+        expected_output_tensor->access_blob(i) = i + 1;
+    }
+
+    pico_cnn::naive::Tensor* inputs[2] = {view, input_tensor};
+    output_tensor->concatenate_from(2, inputs, 1);
+
+    CPPUNIT_ASSERT(*output_tensor == *expected_output_tensor);
+
+    // a view at the wrong position is copied
+    pico_cnn::naive::Tensor *shifted_view = output_tensor->channel_view(3, 2);
+    pico_cnn::naive::Tensor* shifted_inputs[2] = {shifted_view, input_tensor};
+    output_tensor->concatenate_from(2, shifted_inputs, 1);
+    for(uint32_t i = 0; i < 18; i++) {
+        CPPUNIT_ASSERT_EQUAL((fp_t) (i + 28), output_tensor->access_blob(i));
+    }
+
+    // deleting a view keeps the data of the tensor
+    delete view;
+    delete shifted_view;
+    CPPUNIT_ASSERT_EQUAL((fp_t) 19, output_tensor->access(0, 2, 0, 0, 5, 3, 3));
+
+    auto *tensor_3d = new pico_cnn::naive::Tensor(1, 4, 7);
+    pico_cnn::naive::Tensor *view_3d = tensor_3d->channel_view(1, 2);
+    view_3d->access(0, 0, 0, 2, 7) = 1;
+    CPPUNIT_ASSERT_EQUAL((fp_t) 1, tensor_3d->access(0, 1, 0, 4, 7));
+    delete view_3d;
+    delete tensor_3d;
+
+    delete input_tensor;
+    delete expected_output_tensor;
+    delete output_tensor;
+}
+
+void TestTensor::runTestTensorAddFrom() {
+    const uint32_t num_inputs = 10;
+    pico_cnn::naive::Tensor *inputs[num_inputs];
+    for(uint32_t k = 0; k < num_inputs; k++) {
+        inputs[k] = new pico_cnn::naive::Tensor(1, 3, 4, 5);
+        for(uint32_t i = 0; i < inputs[k]->num_elements(); i++) {
+            inputs[k]->access_blob(i) = k * 1000 + i;
+        }
+    }
+    auto *output = new pico_cnn::naive::Tensor(1, 3, 4, 5);
+
+    // more inputs than combined in a single pass
+    pico_cnn::naive::Tensor *all_inputs[num_inputs];
+    std::copy(inputs, inputs + num_inputs, all_inputs);
+    output->add_from(num_inputs, all_inputs);
+    for(uint32_t i = 0; i < output->num_elements(); i++) {
+        CPPUNIT_ASSERT_EQUAL((fp_t) (45000 + 10 * i), output->access_blob(i));
+    }
+
+    // the second input is accumulated in place into the first one
+    pico_cnn::naive::Tensor *residual[2] = {inputs[1], inputs[0]};
+    inputs[0]->add_from(2, residual);
+    for(uint32_t i = 0; i < output->num_elements(); i++) {
+        CPPUNIT_ASSERT_EQUAL((fp_t) (1000 + 2 * i), inputs[0]->access_blob(i));
+    }
+
+    // per-channel bias (C, 1, 1) and scalar
+    auto *bias = new pico_cnn::naive::Tensor(3, 1, 1);
+    auto *scalar = new pico_cnn::naive::Tensor(1);
+    for(uint32_t c = 0; c < 3; c++) {
+        bias->access_blob(c) = c + 1;
+    }
+    scalar->access_blob(0) = 0.5;
+    pico_cnn::naive::Tensor *broadcast[3] = {inputs[2], bias, scalar};
+    output->add_from(3, broadcast);
+    for(uint32_t i = 0; i < output->num_elements(); i++) {
+        CPPUNIT_ASSERT_EQUAL((fp_t) (2000 + i + i / 20 + 1 + 0.5), output->access_blob(i));
+    }
+
+    // row vector broadcast along the rows of a matrix
+    auto *matrix = new pico_cnn::naive::Tensor(2, 3);
+    auto *row = new pico_cnn::naive::Tensor(3);
+    auto *sum = new pico_cnn::naive::Tensor(2, 3);
+    for(uint32_t i = 0; i < 6; i++) {
+        matrix->access_blob(i) = i;
+    }
+    for(uint32_t i = 0; i < 3; i++) {
+        row->access_blob(i) = 10 * i;
+    }
+    pico_cnn::naive::Tensor *matrix_inputs[2] = {row, matrix};
+    sum->add_from(2, matrix_inputs);
+    for(uint32_t i = 0; i < 6; i++) {
+        CPPUNIT_ASSERT_EQUAL((fp_t) (i + 10 * (i % 3)), sum->access_blob(i));
+    }
+
+    delete sum;
+    delete row;
+    delete matrix;
+    delete scalar;
+    delete bias;
+    delete output;
+    for(uint32_t k = 0; k < num_inputs; k++) {
+        delete inputs[k];
+    }
+}
+
+void TestTensor::runTestTensorMulFrom() {
+    auto *input = new pico_cnn::naive::Tensor(1, 2, 3, 3);
+    auto *output = new pico_cnn::naive::Tensor(1, 2, 3, 3);
+    for(uint32_t i = 0; i < input->num_elements(); i++) {
+        input->access_blob(i) = i;
+    }
+
+    auto *factor = new pico_cnn::naive::Tensor(1, 2, 1, 1);
+    factor->access_blob(0) = 2;
+    factor->access_blob(1) = -1;
+    output->mul_from(input, factor);
+    for(uint32_t i = 0; i < output->num_elements(); i++) {
+        CPPUNIT_ASSERT_EQUAL((fp_t) (i < 9 ? 2.0 * i : -1.0 * i), output->access_blob(i));
+    }
+
+    // in place with the same shape
+    output->mul_from(input, output);
+    for(uint32_t i = 0; i < output->num_elements(); i++) {
+        CPPUNIT_ASSERT_EQUAL((fp_t) (i < 9 ? 2.0 * i * i : -1.0 * i * i), output->access_blob(i));
+    }
+
+    delete factor;
+    delete output;
+    delete input;
+}
+
+void TestTensor::runTestTensorExternalData() {
+    // weights embedded in the binary: the tensor and the sparse matrix read the data in place and do not free it
+    alignas(64) static fp_t data[2 * 3] = {1, 0, 2, 0, 0, 3};
+    const uint32_t shape[] = {2, 3};
+
+    auto tensor = new pico_cnn::naive::Tensor(2, shape, data);
+    CPPUNIT_ASSERT_EQUAL(2u, tensor->num_dimensions());
+    CPPUNIT_ASSERT_EQUAL(6u, tensor->num_elements());
+    CPPUNIT_ASSERT(tensor->data_ == data);
+    CPPUNIT_ASSERT(!tensor->owns_data_);
+    CPPUNIT_ASSERT_EQUAL((fp_t) 3, tensor->access(1, 2, tensor->width()));
+    delete tensor;
+
+    static uint32_t row_offsets[] = {0, 2, 3}, column_indices[] = {0, 2, 2};
+    static fp_t values[] = {1, 2, 3};
+    auto sparse = new pico_cnn::naive::SparseMatrix(2, 3, 3, row_offsets, column_indices, values);
+    fp_t b[3] = {1, 10, 100}, c[2];
+    sparse->multiply(0, 2, 1, b, 1, 0, c, 1);
+    CPPUNIT_ASSERT_EQUAL((fp_t) 201, c[0]);
+    CPPUNIT_ASSERT_EQUAL((fp_t) 300, c[1]);
+    delete sparse;
+
+    CPPUNIT_ASSERT_EQUAL((fp_t) 3, data[5]);
+    CPPUNIT_ASSERT_EQUAL((fp_t) 3, values[2]);
+}
+
+void TestTensor::runTestTensorHugePages() {
+    pico_cnn::naive::set_tensor_memory(pico_cnn::naive::TensorMemory::HugePages, true);
+
+    // two huge pages and a tail of small pages
+    auto large = new pico_cnn::naive::Tensor(1, 2, 1024 * 1024 / 4 + 100);
+    auto small = new pico_cnn::naive::Tensor(1, 16);
+#ifdef __linux__
+    CPPUNIT_ASSERT(large->memory_ == pico_cnn::naive::TensorMemory::HugePages);
+    CPPUNIT_ASSERT_EQUAL((uintptr_t) 0, (uintptr_t) large->data_ % pico_cnn::naive::HugePageSize);
+#endif
+    CPPUNIT_ASSERT(small->memory_ == pico_cnn::naive::TensorMemory::Heap);
+
+    for(uint32_t i = 0; i < large->num_elements(); i++) {
+        CPPUNIT_ASSERT_EQUAL((fp_t) 0, large->access_blob(i));
+    }
+    large->access_blob(large->num_elements() - 1) = 1;
+
+    // without a hugetlbfs pool, transparent huge pages are used instead
+    pico_cnn::naive::set_tensor_memory(pico_cnn::naive::TensorMemory::HugeTlbfs);
+    auto hugetlbfs = new pico_cnn::naive::Tensor(pico_cnn::naive::HugePageSize / sizeof(fp_t));
+#ifdef __linux__
+    CPPUNIT_ASSERT(hugetlbfs->memory_ != pico_cnn::naive::TensorMemory::Heap);
+#endif
+    hugetlbfs->access_blob(0) = 1;
+
+    pico_cnn::naive::set_tensor_memory(pico_cnn::naive::TensorMemory::Heap);
+    auto heap = new pico_cnn::naive::Tensor(1, 2, 1024 * 1024 / 4 + 100);
+    CPPUNIT_ASSERT(heap->memory_ == pico_cnn::naive::TensorMemory::Heap);
+
+    delete heap;
+    delete hugetlbfs;
+    delete small;
+    delete large;
+}
@@ -16,6 +16,12 @@ class TestTensor : public CPPUNIT_NS::TestFixture {
     CPPUNIT_TEST(runTestTensorGetPtr);
     CPPUNIT_TEST(runTestTensorExpandPadding);
     CPPUNIT_TEST(runTestTensorConcatDim0);
+    CPPUNIT_TEST(runTestTensorTranspose);
+    CPPUNIT_TEST(runTestTensorChannelView);
+    CPPUNIT_TEST(runTestTensorAddFrom);
+    CPPUNIT_TEST(runTestTensorMulFrom);
+    CPPUNIT_TEST(runTestTensorExternalData);
+    CPPUNIT_TEST(runTestTensorHugePages);
     CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -30,6 +36,12 @@ public:
     void runTestTensorGetPtr();
     void runTestTensorExpandPadding();
     void runTestTensorConcatDim0();
+    void runTestTensorTranspose();
+    void runTestTensorChannelView();
+    void runTestTensorAddFrom();
+    void runTestTensorMulFrom();
+    void runTestTensorExternalData();
+    void runTestTensorHugePages();
 
 };
 
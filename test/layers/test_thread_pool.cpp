@@ -0,0 +1,243 @@
+#include "test_thread_pool.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TestThreadPool);
+
+void TestThreadPool::setUp() {
+    TestFixture::setUp();
+}
+
+void TestThreadPool::tearDown() {
+    TestFixture::tearDown();
+}
+
+/**
+ * Spawns two children per level until depth is 0, every leaf increments leaves.
+ */
+class TreeTask : public pico_cnn::naive::Task {
+public:
+    TreeTask(pico_cnn::naive::ThreadPool *pool, uint32_t depth, std::atomic<uint32_t> *leaves) :
+            pool_(pool), depth_(depth), leaves_(leaves) {}
+
+    void execute() override {
+        if(depth_ == 0) {
+            leaves_->fetch_add(1);
+            return;
+        }
+        TreeTask left(pool_, depth_ - 1, leaves_);
+        TreeTask right(pool_, depth_ - 1, leaves_);
+        pico_cnn::naive::TaskGroup group(pool_);
+        group.run(&left);
+        group.run(&right);
+        group.wait();
+    }
+
+private:
+    pico_cnn::naive::ThreadPool *pool_;
+    uint32_t depth_;
+    std::atomic<uint32_t> *leaves_;
+};
+
+void TestThreadPool::runTestParallelFor() {
+    pico_cnn::naive::ThreadPool pool(4);
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 4, pool.num_threads());
+
+    // every element has to be visited exactly once and all chunks but the last are at least grain long
+    const uint32_t begin = 3;
+    const uint32_t end = 10000;
+    const uint32_t grain = 7;
+    std::vector<uint32_t> visits(end, 0);
+    std::atomic<uint32_t> short_chunks(0);
+
+    for(uint32_t run = 0; run < 20; run++) {
+        pool.parallel_for(begin, end, grain, [&](uint32_t first, uint32_t last) {
+            if(last - first < grain && last != end) {
+                short_chunks.fetch_add(1);
+            }
+            for(uint32_t i = first; i < last; i++) {
+                visits[i]++;
+            }
+        });
+    }
+
+    for(uint32_t i = 0; i < end; i++) {
+        CPPUNIT_ASSERT_EQUAL(i < begin ? (uint32_t) 0 : (uint32_t) 20, visits[i]);
+    }
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 0, short_chunks.load());
+
+    // ranges up to the grain size are not split
+    uint32_t calls = 0;
+    pool.parallel_for(0, 100, 100, [&](uint32_t first, uint32_t last) {
+        CPPUNIT_ASSERT_EQUAL((uint32_t) 0, first);
+        CPPUNIT_ASSERT_EQUAL((uint32_t) 100, last);
+        calls++;
+    });
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 1, calls);
+}
+
+void TestThreadPool::runTestNestedParallelFor() {
+    pico_cnn::naive::ThreadPool pool(4);
+
+    // inner loops run on the same threads as the outer loop, e.g. kernels inside the operations of a TaskGraph
+    const uint32_t rows = 16;
+    const uint32_t columns = 1000;
+    std::vector<uint32_t> matrix(rows * columns, 0);
+
+    pool.parallel_for(0, rows, 1, [&](uint32_t first_row, uint32_t last_row) {
+        for(uint32_t row = first_row; row < last_row; row++) {
+            pool.parallel_for(0, columns, 10, [&](uint32_t first, uint32_t last) {
+                for(uint32_t column = first; column < last; column++) {
+                    matrix[row * columns + column] += row + column;
+                }
+            });
+        }
+    });
+
+    for(uint32_t row = 0; row < rows; row++) {
+        for(uint32_t column = 0; column < columns; column++) {
+            CPPUNIT_ASSERT_EQUAL(row + column, matrix[row * columns + column]);
+        }
+    }
+}
+
+void TestThreadPool::runTestTaskGroup() {
+    pico_cnn::naive::ThreadPool pool(4);
+
+    // tasks spawning tasks from the workers, which are stolen by the others
+    std::atomic<uint32_t> leaves(0);
+    TreeTask root(&pool, 10, &leaves);
+    pico_cnn::naive::TaskGroup group(&pool);
+    group.run(&root);
+    group.wait();
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 1024, leaves.load());
+
+    // more tasks than fit into a deque are executed by the spawning thread
+    const uint32_t num_tasks = 3 * pico_cnn::naive::ThreadPool::DequeCapacity;
+    std::vector<TreeTask> tasks(num_tasks, TreeTask(&pool, 0, &leaves));
+    leaves.store(0);
+    for(TreeTask &task: tasks) {
+        group.run(&task);
+    }
+    group.wait();
+    CPPUNIT_ASSERT_EQUAL(num_tasks, leaves.load());
+}
+
+void TestThreadPool::runTestSingleThread() {
+    // without workers the waiting thread executes all tasks
+    pico_cnn::naive::ThreadPool pool(1);
+
+    std::atomic<uint32_t> leaves(0);
+    TreeTask root(&pool, 6, &leaves);
+    pico_cnn::naive::TaskGroup group(&pool);
+    group.run(&root);
+    group.wait();
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 64, leaves.load());
+
+    uint32_t sum = 0;
+    pool.parallel_for(0, 100, 1, [&](uint32_t first, uint32_t last) {
+        for(uint32_t i = first; i < last; i++) {
+            sum += i;
+        }
+    });
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 4950, sum);
+}
+
+/**
+ * Records the thread executing it, optionally blocks until released.
+ */
+class JobTask : public pico_cnn::naive::Task {
+public:
+    explicit JobTask(std::atomic<bool> *release = nullptr) : release_(release), started(false), done(false) {}
+
+    void execute() override {
+        thread = std::this_thread::get_id();
+        started.store(true);
+        while(release_ && !release_->load()) {
+            std::this_thread::yield();
+        }
+        done.store(true);
+    }
+
+    std::atomic<bool> *release_;
+    std::thread::id thread;
+    std::atomic<bool> started;
+    std::atomic<bool> done;
+};
+
+void TestThreadPool::runTestSubmit() {
+    pico_cnn::naive::ThreadPool pool(2);
+
+    // the only worker is busy with the first job, the second one waits for it
+    std::atomic<bool> release(false);
+    JobTask blocking(&release);
+    pool.submit(&blocking);
+    while(!blocking.started.load()) {
+        std::this_thread::yield();
+    }
+
+    std::atomic<uint32_t> leaves(0);
+    TreeTask tree(&pool, 3, &leaves);
+    pico_cnn::naive::TaskGroup group(&pool);
+    group.run(&tree);
+    JobTask queued;
+    pool.submit(&queued);
+
+    // the waiting thread executes the tasks of the group, but not the submitted job
+    group.wait();
+    const bool nested = queued.done.load();
+
+    release.store(true);
+    while(!queued.done.load()) {
+        std::this_thread::yield();
+    }
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 8, leaves.load());
+    CPPUNIT_ASSERT(!nested);
+    CPPUNIT_ASSERT(queued.thread == blocking.thread);
+    CPPUNIT_ASSERT(queued.thread != std::this_thread::get_id());
+}
+
+void TestThreadPool::runTestIntraOpLimit() {
+    pico_cnn::naive::ThreadPool pool(4);
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 4, pool.intra_op_threads());
+
+    std::mutex mutex;
+    std::vector<std::thread::id> threads;
+    uint32_t num_chunks = 0;
+    auto record = [&](uint32_t first, uint32_t last) {
+        std::lock_guard<std::mutex> lock(mutex);
+        threads.push_back(std::this_thread::get_id());
+        num_chunks++;
+    };
+
+    {
+        // a limit of 1 keeps the whole loop on the calling thread
+        pico_cnn::naive::IntraOpLimit limit(1);
+        CPPUNIT_ASSERT_EQUAL((uint32_t) 1, pool.intra_op_threads());
+        pool.parallel_for(0, 10000, 1, record);
+        for(const std::thread::id &thread : threads) {
+            CPPUNIT_ASSERT(thread == std::this_thread::get_id());
+        }
+
+        // nested limits apply innermost first and are restored when they go out of scope
+        {
+            pico_cnn::naive::IntraOpLimit inner(2);
+            CPPUNIT_ASSERT_EQUAL((uint32_t) 2, pool.intra_op_threads());
+
+            // the loop is split among the limited number of threads only
+            threads.clear();
+            num_chunks = 0;
+            pool.parallel_for(0, 10000, 1, record);
+            CPPUNIT_ASSERT(num_chunks <= 4 * 2);
+        }
+        CPPUNIT_ASSERT_EQUAL((uint32_t) 1, pool.intra_op_threads());
+    }
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 4, pool.intra_op_threads());
+
+    // limits above the size of the pool have no effect
+    pico_cnn::naive::IntraOpLimit limit(16);
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 4, pool.intra_op_threads());
+}
@@ -0,0 +1,31 @@
+#ifndef PICO_CNN_TEST_THREAD_POOL_H
+#define PICO_CNN_TEST_THREAD_POOL_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "../../pico-cnn/pico-cnn.h"
+
+
+class TestThreadPool : public CPPUNIT_NS::TestFixture {
+    CPPUNIT_TEST_SUITE(TestThreadPool);
+    CPPUNIT_TEST(runTestParallelFor);
+    CPPUNIT_TEST(runTestNestedParallelFor);
+    CPPUNIT_TEST(runTestTaskGroup);
+    CPPUNIT_TEST(runTestSingleThread);
+    CPPUNIT_TEST(runTestSubmit);
+    CPPUNIT_TEST(runTestIntraOpLimit);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() override;
+    void tearDown() override;
+
+    void runTestParallelFor();
+    void runTestNestedParallelFor();
+    void runTestTaskGroup();
+    void runTestSingleThread();
+    void runTestSubmit();
+    void runTestIntraOpLimit();
+};
+
+
+#endif //PICO_CNN_TEST_THREAD_POOL_H
@@ -0,0 +1,173 @@
+#include "test_weights_reloader.h"
+
+#include <chrono>
+#include <cstdio>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TestWeightsReloader);
+
+static const char *weights_path = "test_weights_reloader.weights.bin";
+static const char *other_weights_path = "test_weights_reloader_other.weights.bin";
+static const char *third_weights_path = "test_weights_reloader_third.weights.bin";
+
+/**
+ * Writes a weights file with a single convolution with a kernel of shape (2, 1, 1, width) and two biases.
+ */
+static void write_test_weights(const char *path, uint32_t width, fp_t value) {
+    FILE *file = fopen(path, "wb");
+    fputs("FD\ntest\n", file);
+    uint32_t num_layers = 1;
+    fwrite(&num_layers, sizeof(num_layers), 1, file);
+    fputs("conv\nConv\n", file);
+    uint32_t kernel_shape[4] = {2, 1, 1, width};
+    fwrite(kernel_shape, sizeof(uint32_t), 4, file);
+    for(uint32_t i = 0; i < 2 * width; i++) {
+        fwrite(&value, sizeof(fp_t), 1, file);
+    }
+    uint32_t num_biases = 2;
+    fwrite(&num_biases, sizeof(num_biases), 1, file);
+    fwrite(&value, sizeof(fp_t), 1, file);
+    fwrite(&value, sizeof(fp_t), 1, file);
+    fputs("end\n", file);
+    fclose(file);
+}
+
+void TestWeightsReloader::setUp() {
+    write_test_weights(weights_path, 2, 7);
+    write_test_weights(other_weights_path, 3, 8);
+    write_test_weights(third_weights_path, 2, 9);
+}
+
+void TestWeightsReloader::tearDown() {
+    std::remove(weights_path);
+    std::remove(other_weights_path);
+    std::remove(third_weights_path);
+}
+
+void TestWeightsReloader::runTestReload() {
+    auto kernel = new pico_cnn::naive::Tensor(2, 1, 1, 2);
+    auto bias = new pico_cnn::naive::Tensor(2);
+    kernel->access_blob(3) = 1;
+    pico_cnn::naive::Tensor *kernels[] = {kernel}, *biases[] = {bias};
+
+    auto reloader = new pico_cnn::naive::WeightsReloader(kernels, 1, biases, 1, nullptr, 0, 2);
+    CPPUNIT_ASSERT(!kernel->owns_data_);
+    CPPUNIT_ASSERT_EQUAL((fp_t) 1, kernel->access_blob(3));
+    CPPUNIT_ASSERT_EQUAL((uint64_t) 1, reloader->generation());
+
+    // the second network uses the weights of the first one
+    auto other_kernel = new pico_cnn::naive::Tensor(2, 1, 1, 2);
+    auto other_bias = new pico_cnn::naive::Tensor(2);
+    pico_cnn::naive::Tensor *other_kernels[] = {other_kernel}, *other_biases[] = {other_bias};
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 1, reloader->add_reader(other_kernels, other_biases));
+    CPPUNIT_ASSERT_EQUAL(kernel->data_, other_kernel->data_);
+
+    CPPUNIT_ASSERT_EQUAL(0, reloader->reload(weights_path));
+    CPPUNIT_ASSERT_EQUAL((uint64_t) 2, reloader->generation());
+
+    // the networks switch at their next run
+    for(uint32_t reader = 0; reader < 2; reader++) {
+        pico_cnn::naive::WeightsRunGuard guard(reloader, reader);
+    }
+    CPPUNIT_ASSERT_EQUAL((fp_t) 7, kernel->access_blob(3));
+    CPPUNIT_ASSERT_EQUAL((fp_t) 7, other_bias->access_blob(1));
+    CPPUNIT_ASSERT_EQUAL(0, (int32_t) ((uintptr_t) kernel->data_ % 64));
+
+    delete reloader;
+    delete other_bias;
+    delete other_kernel;
+    delete bias;
+    delete kernel;
+}
+
+void TestWeightsReloader::runTestReloadMismatch() {
+    auto kernel = new pico_cnn::naive::Tensor(2, 1, 1, 2);
+    auto bias = new pico_cnn::naive::Tensor(2);
+    pico_cnn::naive::Tensor *kernels[] = {kernel}, *biases[] = {bias};
+
+    auto reloader = new pico_cnn::naive::WeightsReloader(kernels, 1, biases, 1);
+
+    // kernel of another shape, missing file, bias missing in the network
+    CPPUNIT_ASSERT_EQUAL(1, reloader->reload(other_weights_path));
+    CPPUNIT_ASSERT_EQUAL(1, reloader->reload("does_not_exist.weights.bin"));
+    auto other_kernel = new pico_cnn::naive::Tensor(2, 1, 1, 2);
+    pico_cnn::naive::Tensor *other_kernels[] = {other_kernel};
+    auto without_bias = new pico_cnn::naive::WeightsReloader(other_kernels, 1, nullptr, 0);
+    CPPUNIT_ASSERT_EQUAL(1, without_bias->reload(weights_path));
+    delete without_bias;
+    delete other_kernel;
+
+    CPPUNIT_ASSERT_EQUAL((uint64_t) 1, reloader->generation());
+    reloader->begin_run(0);
+    CPPUNIT_ASSERT_EQUAL((fp_t) 0, kernel->access_blob(3));
+    reloader->end_run(0);
+
+    delete reloader;
+    delete bias;
+    delete kernel;
+}
+
+void TestWeightsReloader::runTestReloadDuringRun() {
+    auto kernel = new pico_cnn::naive::Tensor(2, 1, 1, 2);
+    auto bias = new pico_cnn::naive::Tensor(2);
+    pico_cnn::naive::Tensor *kernels[] = {kernel}, *biases[] = {bias};
+
+    auto reloader = new pico_cnn::naive::WeightsReloader(kernels, 1, biases, 1);
+
+    reloader->begin_run(0);
+    fp_t *old_data = kernel->data_;
+    auto result = reloader->reload_async(weights_path);
+
+    // the new set is published, but the run in flight keeps the old one, which is not freed before the run ends
+    while(reloader->generation() != 2) {
+        std::this_thread::yield();
+    }
+    CPPUNIT_ASSERT(result.wait_for(std::chrono::milliseconds(20)) == std::future_status::timeout);
+    CPPUNIT_ASSERT_EQUAL(old_data, kernel->data_);
+    CPPUNIT_ASSERT_EQUAL((fp_t) 0, kernel->access_blob(3));
+    reloader->end_run(0);
+
+    CPPUNIT_ASSERT_EQUAL(0, result.get());
+
+    reloader->begin_run(0);
+    CPPUNIT_ASSERT_EQUAL((fp_t) 7, kernel->access_blob(3));
+    reloader->end_run(0);
+
+    delete reloader;
+    delete bias;
+    delete kernel;
+}
+
+void TestWeightsReloader::runTestIdleReader() {
+    auto kernel = new pico_cnn::naive::Tensor(2, 1, 1, 2);
+    auto bias = new pico_cnn::naive::Tensor(2);
+    pico_cnn::naive::Tensor *kernels[] = {kernel}, *biases[] = {bias};
+    auto idle_kernel = new pico_cnn::naive::Tensor(2, 1, 1, 2);
+    auto idle_bias = new pico_cnn::naive::Tensor(2);
+    pico_cnn::naive::Tensor *idle_kernels[] = {idle_kernel}, *idle_biases[] = {idle_bias};
+
+    auto reloader = new pico_cnn::naive::WeightsReloader(kernels, 1, biases, 1, nullptr, 0, 2);
+    CPPUNIT_ASSERT_EQUAL((uint32_t) 1, reloader->add_reader(idle_kernels, idle_biases));
+
+    // the second network does not run while its set is replaced twice, the set of the second reload may be allocated
+    // where the freed set of the first one was
+    CPPUNIT_ASSERT_EQUAL(0, reloader->reload(weights_path));
+    reloader->begin_run(0);
+    CPPUNIT_ASSERT_EQUAL((fp_t) 7, kernel->access_blob(3));
+    reloader->end_run(0);
+    CPPUNIT_ASSERT_EQUAL(0, reloader->reload(third_weights_path));
+    CPPUNIT_ASSERT_EQUAL((uint64_t) 3, reloader->generation());
+
+    for(uint32_t reader = 0; reader < 2; reader++) {
+        pico_cnn::naive::WeightsRunGuard guard(reloader, reader);
+    }
+    CPPUNIT_ASSERT(idle_kernel->data_ == kernel->data_);
+    CPPUNIT_ASSERT(idle_bias->data_ == bias->data_);
+    CPPUNIT_ASSERT_EQUAL((fp_t) 9, idle_kernel->access_blob(3));
+    CPPUNIT_ASSERT_EQUAL((fp_t) 9, idle_bias->access_blob(1));
+
+    delete reloader;
+    delete idle_bias;
+    delete idle_kernel;
+    delete bias;
+    delete kernel;
+}
@@ -0,0 +1,27 @@
+#ifndef PICO_CNN_TEST_WEIGHTS_RELOADER_H
+#define PICO_CNN_TEST_WEIGHTS_RELOADER_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "../../pico-cnn/pico-cnn.h"
+
+
+class TestWeightsReloader : public CPPUNIT_NS::TestFixture {
+    CPPUNIT_TEST_SUITE(TestWeightsReloader);
+    CPPUNIT_TEST(runTestReload);
+    CPPUNIT_TEST(runTestReloadMismatch);
+    CPPUNIT_TEST(runTestReloadDuringRun);
+    CPPUNIT_TEST(runTestIdleReader);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() override;
+    void tearDown() override;
+
+    void runTestReload();
+    void runTestReloadMismatch();
+    void runTestReloadDuringRun();
+    void runTestIdleReader();
+};
+
+
+#endif //PICO_CNN_TEST_WEIGHTS_RELOADER_H
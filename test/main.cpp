@@ -5,7 +5,8 @@ int32_t main(int32_t argc, char **argv) {
     CppUnit::TextUi::TestRunner runner;
     CppUnit::TestFactoryRegistry &registry = CppUnit::TestFactoryRegistry::getRegistry();
     runner.addTest(registry.makeTest());
-    bool success = runner.run();
+    // an optional argument selects a single test suite, e.g. ./unit_tests TestAllocations
+    bool success = runner.run(argc > 1 ? argv[1] : "");
 
     return !success;
 }